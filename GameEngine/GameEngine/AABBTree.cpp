@@ -0,0 +1,419 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "AABBTree.h"
+
+#include <algorithm>
+
+#include "MathKernels.h" //defines ENGINE_SSE, and includes the intrinsics
+
+
+static inline AABB combine(const AABB& a, const AABB& b) noexcept
+{
+	AABB box;
+	box.min = glm::min(a.min, b.min);
+	box.max = glm::max(a.max, b.max);
+	return box;
+}
+
+static inline FLOAT_TYPE surfaceArea(const AABB& box) noexcept //halved, only the comparisons matter
+{
+	glm::vec3 d = box.max - box.min;
+	return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+static inline bool contains(const AABB& outer, const AABB& inner) noexcept
+{
+	return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+		&& inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+}
+
+
+//AABBTree definitions:
+
+
+int AABBTree::createProxy(const AABB& box, int data)
+{
+	int proxy = allocateNode();
+	Node& node = nodes[proxy];
+	node.box.min = box.min - glm::vec3(AABB_TREE_MARGIN);
+	node.box.max = box.max + glm::vec3(AABB_TREE_MARGIN);
+	node.data = data;
+	node.height = 0;
+
+	insertLeaf(proxy);
+	++numOfProxies;
+	return proxy;
+}
+
+
+//=================================================
+
+
+void AABBTree::destroyProxy(int proxy)
+{
+	myAssert(proxy >= 0 && proxy < int(nodes.size()) && nodes[proxy].isLeaf());
+
+	removeLeaf(proxy);
+	freeNode(proxy);
+	--numOfProxies;
+}
+
+
+//=================================================
+
+
+bool AABBTree::moveProxy(int proxy, const AABB& box, const glm::vec3& displacement)
+{
+	myAssert(proxy >= 0 && proxy < int(nodes.size()) && nodes[proxy].isLeaf());
+
+	if (contains(nodes[proxy].box, box)) return false;
+
+	removeLeaf(proxy);
+
+	//the new fat AABB, which also covers the next steps if the box keeps moving the same way:
+	AABB fat;
+	fat.min = box.min - glm::vec3(AABB_TREE_MARGIN);
+	fat.max = box.max + glm::vec3(AABB_TREE_MARGIN);
+	glm::vec3 ahead = AABB_TREE_DISPLACEMENT_MULTIPLIER * displacement;
+	fat.min += glm::min(ahead, glm::vec3(0.0f));
+	fat.max += glm::max(ahead, glm::vec3(0.0f));
+	nodes[proxy].box = fat;
+
+	insertLeaf(proxy);
+	return true;
+}
+
+
+//=================================================
+
+
+void AABBTree::clear() noexcept
+{
+	nodes.clear();
+	root = AABB_TREE_NULL_NODE;
+	freeList = AABB_TREE_NULL_NODE;
+	numOfProxies = 0;
+}
+
+
+//=================================================
+
+
+int AABBTree::getData(int proxy) const noexcept
+{
+	return nodes[proxy].data;
+}
+
+void AABBTree::setData(int proxy, int data) noexcept
+{
+	nodes[proxy].data = data;
+}
+
+const AABB& AABBTree::getFatAABB(int proxy) const noexcept
+{
+	return nodes[proxy].box;
+}
+
+int AABBTree::getNumOfProxies() const noexcept
+{
+	return numOfProxies;
+}
+
+int AABBTree::getHeight() const noexcept
+{
+	return root == AABB_TREE_NULL_NODE ? 0 : nodes[root].height;
+}
+
+
+//=================================================
+
+
+int AABBTree::allocateNode()
+{
+	if (freeList == AABB_TREE_NULL_NODE)
+	{
+		nodes.push_back(Node());
+		nodes.back().parent = AABB_TREE_NULL_NODE;
+		freeList = int(nodes.size()) - 1;
+	}
+
+	int index = freeList;
+	freeList = nodes[index].parent;
+
+	Node& node = nodes[index];
+	node.parent = AABB_TREE_NULL_NODE;
+	node.child1 = AABB_TREE_NULL_NODE;
+	node.child2 = AABB_TREE_NULL_NODE;
+	node.height = 0;
+	node.data = -1;
+	return index;
+}
+
+void AABBTree::freeNode(int index) noexcept
+{
+	nodes[index].parent = freeList;
+	nodes[index].height = -1;
+	freeList = index;
+}
+
+
+//=================================================
+
+
+void AABBTree::insertLeaf(int leaf)
+{
+	if (root == AABB_TREE_NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	//find the best sibling: go down the tree choosing the child with the smallest cost, where the cost of a
+	//node is the area it would add to the tree if the leaf were inserted next to it(or below it):
+	const AABB leafBox = nodes[leaf].box;
+	int index = root;
+	while (!nodes[index].isLeaf())
+	{
+		const Node& node = nodes[index];
+		FLOAT_TYPE area = surfaceArea(node.box);
+		FLOAT_TYPE combinedArea = surfaceArea(combine(node.box, leafBox));
+
+		FLOAT_TYPE cost = 2.0f * combinedArea; //of making a new parent for this node and the leaf
+		FLOAT_TYPE inheritanceCost = 2.0f * (combinedArea - area); //the minimum cost of going down
+
+		FLOAT_TYPE childCost[2];
+		int children[2] = { node.child1, node.child2 };
+		for (int c = 0; c < 2; ++c)
+		{
+			const Node& child = nodes[children[c]];
+			FLOAT_TYPE newArea = surfaceArea(combine(child.box, leafBox));
+			childCost[c] = child.isLeaf() ? newArea + inheritanceCost
+				: newArea - surfaceArea(child.box) + inheritanceCost;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1]) break;
+		index = childCost[0] < childCost[1] ? children[0] : children[1];
+	}
+
+	//--------------------------------------
+	//make a new parent for the sibling and the leaf:
+	int sibling = index;
+	int oldParent = nodes[sibling].parent;
+	int newParent = allocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == AABB_TREE_NULL_NODE) root = newParent;
+	else if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+	else nodes[oldParent].child2 = newParent;
+
+	fixUpwards(nodes[leaf].parent);
+}
+
+
+//=================================================
+
+
+void AABBTree::removeLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	//the sibling takes the place of the parent:
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent == AABB_TREE_NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = AABB_TREE_NULL_NODE;
+		freeNode(parent);
+		return;
+	}
+
+	if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+	else nodes[grandParent].child2 = sibling;
+	nodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	fixUpwards(grandParent);
+}
+
+
+//=================================================
+
+
+void AABBTree::fixUpwards(int index)
+{
+	while (index != AABB_TREE_NULL_NODE)
+	{
+		index = balance(index);
+
+		Node& node = nodes[index];
+		node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+		node.box = combine(nodes[node.child1].box, nodes[node.child2].box);
+
+		index = node.parent;
+	}
+}
+
+
+//=================================================
+
+
+int AABBTree::balance(int a)
+//if one child of a is two levels higher than the other, it's rotated up(its highest child stays under it,
+//and the other takes its place under a)
+{
+	if (nodes[a].isLeaf() || nodes[a].height < 2) return a;
+
+	int b = nodes[a].child1;
+	int c = nodes[a].child2;
+	int heightDifference = nodes[c].height - nodes[b].height;
+	if (heightDifference >= -1 && heightDifference <= 1) return a;
+
+	int up = heightDifference > 1 ? c : b; //the child that goes up
+	int other = up == c ? b : c; //the child that stays under a
+	int f = nodes[up].child1;
+	int g = nodes[up].child2;
+
+	//swap a and up:
+	nodes[up].child1 = a;
+	nodes[up].parent = nodes[a].parent;
+	nodes[a].parent = up;
+
+	if (nodes[up].parent == AABB_TREE_NULL_NODE) root = up;
+	else if (nodes[nodes[up].parent].child1 == a) nodes[nodes[up].parent].child1 = up;
+	else nodes[nodes[up].parent].child2 = up;
+
+	//the highest child of up stays, and the other one replaces up under a:
+	int stay = nodes[f].height > nodes[g].height ? f : g;
+	int move = stay == f ? g : f;
+	nodes[up].child2 = stay;
+	if (up == c) nodes[a].child2 = move;
+	else nodes[a].child1 = move;
+	nodes[move].parent = a;
+
+	nodes[a].box = combine(nodes[other].box, nodes[move].box);
+	nodes[a].height = 1 + std::max(nodes[other].height, nodes[move].height);
+	nodes[up].box = combine(nodes[a].box, nodes[stay].box);
+	nodes[up].height = 1 + std::max(nodes[a].height, nodes[stay].height);
+
+	return up;
+}
+
+
+//=================================================
+
+
+bool AABBTree::validate() const
+{
+	bool ok = true;
+	if (root != AABB_TREE_NULL_NODE)
+	{
+		ok = nodes[root].parent == AABB_TREE_NULL_NODE;
+		validateNode(root, ok);
+	}
+
+	//the free nodes plus the used ones(two per proxy, minus the root) must be all the nodes:
+	int numOfFree = 0;
+	for (int index = freeList; index != AABB_TREE_NULL_NODE && numOfFree <= int(nodes.size()); index = nodes[index].parent)
+		++numOfFree;
+	int used = numOfProxies > 0 ? 2 * numOfProxies - 1 : 0;
+	return ok && numOfFree + used == int(nodes.size());
+}
+
+int AABBTree::validateNode(int index, bool& ok) const
+{
+	const Node& node = nodes[index];
+	if (node.isLeaf())
+	{
+		ok = ok && node.height == 0 && node.child2 == AABB_TREE_NULL_NODE;
+		return 0;
+	}
+
+	ok = ok && nodes[node.child1].parent == index && nodes[node.child2].parent == index;
+	int height1 = validateNode(node.child1, ok);
+	int height2 = validateNode(node.child2, ok);
+
+	ok = ok && node.height == 1 + std::max(height1, height2);
+	ok = ok && contains(node.box, nodes[node.child1].box) && contains(node.box, nodes[node.child2].box);
+	return node.height;
+}
+
+
+//=================================================
+
+
+unsigned int AABBTree::packetTest(const AABB& box, const float* packet, const float* maxFractions, int numOfRays) noexcept
+{
+	const float* origins = packet;
+	const float* inverses = packet + 3 * AABB_TREE_MAX_PACKET_SIZE;
+	unsigned int mask = 0;
+
+#if defined(ENGINE_SSE)
+	//4 rays at a time(the rays after numOfRays have a maxFraction of 0, so they never hit):
+	for (int first = 0; first < numOfRays; first += 4)
+	{
+		__m128 enter = _mm_setzero_ps();
+		__m128 exit = _mm_load_ps(maxFractions + first);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			__m128 origin = _mm_load_ps(origins + axis * AABB_TREE_MAX_PACKET_SIZE + first);
+			__m128 inverse = _mm_load_ps(inverses + axis * AABB_TREE_MAX_PACKET_SIZE + first);
+			__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(float(box.min[axis])), origin), inverse);
+			__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(float(box.max[axis])), origin), inverse);
+			enter = _mm_max_ps(enter, _mm_min_ps(t1, t2));
+			exit = _mm_min_ps(exit, _mm_max_ps(t1, t2));
+		}
+		__m128 hit = _mm_and_ps(_mm_cmple_ps(enter, exit), _mm_cmpgt_ps(_mm_load_ps(maxFractions + first), _mm_setzero_ps()));
+		mask |= unsigned(_mm_movemask_ps(hit)) << first;
+	}
+#else
+	for (int ray = 0; ray < numOfRays; ++ray)
+	{
+		float enter = 0.0f, exit = maxFractions[ray];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float origin = origins[axis * AABB_TREE_MAX_PACKET_SIZE + ray];
+			float inverse = inverses[axis * AABB_TREE_MAX_PACKET_SIZE + ray];
+			float t1 = (float(box.min[axis]) - origin) * inverse;
+			float t2 = (float(box.max[axis]) - origin) * inverse;
+			enter = std::max(enter, std::min(t1, t2));
+			exit = std::min(exit, std::max(t1, t2));
+		}
+		if (enter <= exit && maxFractions[ray] > 0.0f) mask |= 1u << ray;
+	}
+#endif
+
+	return mask;
+}
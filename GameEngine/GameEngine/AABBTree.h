@@ -0,0 +1,313 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares and defines the AABBTree class, a dynamic
+bounding volume hierarchy of AABBs. The PhysicsEngine keeps one for the static bodies and another for the
+dynamic ones, and gameplay and AI code can query them too(overlap, raycast and shape cast queries).
+	Each proxy(a leaf) has a "fat" AABB, larger than the real box by AABB_TREE_MARGIN and extended in
+the direction the box is moving, so a box that moves a little stays inside it and the tree isn't changed.
+Only when a box leaves its fat AABB the proxy is removed and inserted again. The leaves are inserted next
+to the sibling that least increases the surface area of the tree, and the tree is kept balanced with
+rotations(like an AVL tree), so the queries stay logarithmic whatever the order the boxes were added.
+	The nodes are stored in one array, and freed nodes are reused, so the proxies are identified by
+indices that stay valid until they are destroyed.
+*/
+//#################################################################################
+
+#ifndef AABB_TREE
+#define AABB_TREE
+
+
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "PhysicalComponents.h"
+
+#include "GlobalDefines.h"
+
+
+#define AABB_TREE_MARGIN 2.0f //how much larger than the boxes the fat AABBs are, on each side
+#define AABB_TREE_DISPLACEMENT_MULTIPLIER 4.0f //the fat AABBs are extended by this many steps of motion
+#define AABB_TREE_STACK_SIZE 256 //nodes waiting to be visited by a query(the tree height is kept logarithmic)
+#define AABB_TREE_NULL_NODE -1
+#define AABB_TREE_MAX_PACKET_SIZE 32 //rays traversed together by raycastPacket()(the bits of a mask)
+
+
+//##################################################
+//AABBTree class declaration:
+
+
+class AABBTree
+{
+public:
+
+	int createProxy(const AABB&, int data); //returns the proxy id. The data is given back by the queries
+	void destroyProxy(int proxy);
+
+	/*
+		moveProxy - change the box of a proxy. The proxy is only inserted again if the box isn't inside its
+		fat AABB anymore(the new fat AABB is extended in the direction of the displacement). Returns true
+		if it was inserted again
+	*/
+	bool moveProxy(int proxy, const AABB&, const glm::vec3& displacement);
+	void clear() noexcept; //destroy all the proxies
+
+	int getData(int proxy) const noexcept;
+	void setData(int proxy, int data) noexcept;
+	const AABB& getFatAABB(int proxy) const noexcept;
+	int getNumOfProxies() const noexcept;
+	int getHeight() const noexcept; //0 for a tree with one proxy(or none)
+	bool validate() const; //check the links, heights and boxes of all the nodes(used by the benchmarks)
+
+	/*
+		query - call callback(int proxy) for each proxy whose fat AABB overlaps the box. The query stops
+		if the callback returns false
+	*/
+	template<typename F>
+	void query(const AABB&, const F& callback) const;
+
+	/*
+		raycast - call callback(int proxy, FLOAT_TYPE maxFraction) for each proxy whose fat AABB is hit by the
+		segment from origin to origin + displacement, before maxFraction(starting at 1). The callback returns
+		the new maxFraction: the fraction of its own hit to clip the ray, the given maxFraction to go on, or 0
+		to stop the query
+	*/
+	template<typename F>
+	void raycast(const glm::vec3& origin, const glm::vec3& displacement, const F& callback) const;
+
+	/*
+		shapeCast - like raycast(), but for a box moving by displacement: the proxies whose fat AABB is hit by
+		the box along the way are given to the callback
+	*/
+	template<typename F>
+	void shapeCast(const AABB& box, const glm::vec3& displacement, const F& callback) const;
+
+	/*
+		raycastPacket - like raycast(), for up to AABB_TREE_MAX_PACKET_SIZE rays at once: the tree is traversed
+		only once, each node is tested against 4 rays at a time with SSE, and a mask keeps the rays that hit
+		it, so the others don't go down to its children. The callback is callback(int proxy, int ray,
+		FLOAT_TYPE maxFraction), and maxFractions has the fraction each ray starts clipped at(usually 1), and is
+		updated with the values the callback returns. The traversal is the cheapest when the rays start and end
+		near each other
+	*/
+	template<typename F>
+	void raycastPacket(const glm::vec3* origins, const glm::vec3* displacements, int numOfRays,
+		FLOAT_TYPE* maxFractions, const F& callback) const;
+
+private:
+
+	struct Node
+	{
+		bool isLeaf() const noexcept { return child1 == AABB_TREE_NULL_NODE; }
+
+		AABB box; //the fat AABB for the leaves, and the union of the children for the other nodes
+		int parent; //also the next free node, for the free nodes
+		int child1;
+		int child2;
+		int height; //0 for the leaves, -1 for the free nodes
+		int data;
+	};
+
+	int allocateNode();
+	void freeNode(int) noexcept;
+	void insertLeaf(int);
+	void removeLeaf(int);
+	int balance(int); //do a rotation if the node is unbalanced, returns the node that took its place
+	void fixUpwards(int); //recompute the boxes and heights from a node to the root, balancing them
+	int validateNode(int, bool& ok) const; //returns the height of the subtree
+
+	template<typename F>
+	void cast(const glm::vec3& origin, const glm::vec3& displacement, const glm::vec3& extents, const F&) const;
+
+	//the rays of a packet in SoA layout(the origins and the inverses of the displacements, x, y and z arrays),
+	//and the mask of the ones that hit a box before their maxFractions(an array padded with zeros):
+	static unsigned int packetTest(const AABB&, const float* packet, const float* maxFractions, int numOfRays) noexcept;
+
+	std::vector<Node> nodes;
+	int root = AABB_TREE_NULL_NODE;
+	int freeList = AABB_TREE_NULL_NODE;
+	int numOfProxies = 0;
+};
+
+
+//=================================================
+//AABBTree template definitions:
+
+
+template<typename F>
+void AABBTree::query(const AABB& box, const F& callback) const
+{
+	if (root == AABB_TREE_NULL_NODE) return;
+
+	int stack[AABB_TREE_STACK_SIZE];
+	int size = 0;
+	stack[size++] = root;
+
+	while (size > 0)
+	{
+		const Node& node = nodes[stack[--size]];
+		if (!node.box.overlaps(box)) continue;
+
+		if (node.isLeaf())
+		{
+			if (!callback(int(&node - nodes.data()))) return;
+		}
+		else
+		{
+			myAssert(size + 2 <= AABB_TREE_STACK_SIZE);
+			stack[size++] = node.child1;
+			stack[size++] = node.child2;
+		}
+	}
+}
+
+
+//=================================================
+
+
+template<typename F>
+void AABBTree::raycast(const glm::vec3& origin, const glm::vec3& displacement, const F& callback) const
+{
+	cast(origin, displacement, glm::vec3(0.0f), callback);
+}
+
+template<typename F>
+void AABBTree::shapeCast(const AABB& box, const glm::vec3& displacement, const F& callback) const
+{
+	//the same as casting the center of the box against the nodes grown by its half size:
+	cast(0.5f * (box.min + box.max), displacement, 0.5f * (box.max - box.min), callback);
+}
+
+
+//=================================================
+
+
+template<typename F>
+void AABBTree::cast(const glm::vec3& origin, const glm::vec3& displacement, const glm::vec3& extents, const F& callback) const
+{
+	if (root == AABB_TREE_NULL_NODE) return;
+
+	FLOAT_TYPE maxFraction = 1.0f;
+	int stack[AABB_TREE_STACK_SIZE];
+	int size = 0;
+	stack[size++] = root;
+
+	while (size > 0)
+	{
+		const Node& node = nodes[stack[--size]];
+
+		//the slab test, against the node box grown by the extents:
+		FLOAT_TYPE enter = 0.0f, exit = maxFraction;
+		bool hit = true;
+		for (int axis = 0; axis < 3 && hit; ++axis)
+		{
+			FLOAT_TYPE low = node.box.min[axis] - extents[axis];
+			FLOAT_TYPE high = node.box.max[axis] + extents[axis];
+			if (displacement[axis] == 0.0f)
+				hit = origin[axis] >= low && origin[axis] <= high;
+			else
+			{
+				FLOAT_TYPE t1 = (low - origin[axis]) / displacement[axis];
+				FLOAT_TYPE t2 = (high - origin[axis]) / displacement[axis];
+				if (t1 > t2) std::swap(t1, t2);
+				if (t1 > enter) enter = t1;
+				if (t2 < exit) exit = t2;
+				hit = enter <= exit;
+			}
+		}
+		if (!hit) continue;
+
+		if (node.isLeaf())
+		{
+			maxFraction = callback(int(&node - nodes.data()), maxFraction);
+			if (maxFraction <= 0.0f) return;
+		}
+		else
+		{
+			myAssert(size + 2 <= AABB_TREE_STACK_SIZE);
+			stack[size++] = node.child1;
+			stack[size++] = node.child2;
+		}
+	}
+}
+
+
+//=================================================
+
+
+template<typename F>
+void AABBTree::raycastPacket(const glm::vec3* origins, const glm::vec3* displacements, int numOfRays,
+	FLOAT_TYPE* maxFractions, const F& callback) const
+{
+	myAssert(numOfRays >= 0 && numOfRays <= AABB_TREE_MAX_PACKET_SIZE);
+	if (root == AABB_TREE_NULL_NODE || numOfRays == 0) return;
+
+	//the divisions of the slab tests are done once for the whole traversal. A ray parallel to an axis gets
+	//a huge inverse instead of an infinite one(that would give NaNs for the boxes it starts on the side of):
+	alignas(16) float packet[6 * AABB_TREE_MAX_PACKET_SIZE] = {};
+	alignas(16) float fractions[AABB_TREE_MAX_PACKET_SIZE] = {};
+	for (int ray = 0; ray < numOfRays; ++ray)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			FLOAT_TYPE d = displacements[ray][axis];
+			packet[axis * AABB_TREE_MAX_PACKET_SIZE + ray] = origins[ray][axis];
+			packet[(3 + axis) * AABB_TREE_MAX_PACKET_SIZE + ray] = d != 0.0f ? 1.0f / d : 1e30f;
+		}
+		fractions[ray] = maxFractions[ray];
+	}
+
+	//each node waiting to be visited keeps the rays that hit its parent:
+	std::pair<int, unsigned int> stack[AABB_TREE_STACK_SIZE];
+	int size = 0;
+	stack[size++] = { root, numOfRays == AABB_TREE_MAX_PACKET_SIZE ? ~0u : (1u << numOfRays) - 1u };
+
+	while (size > 0)
+	{
+		std::pair<int, unsigned int> entry = stack[--size];
+		const Node& node = nodes[entry.first];
+
+		unsigned int mask = packetTest(node.box, packet, fractions, numOfRays) & entry.second;
+		if (mask == 0) continue;
+
+		if (node.isLeaf())
+		{
+			for (int ray = 0; ray < numOfRays; ++ray)
+			{
+				if (mask & (1u << ray))
+					fractions[ray] = float(callback(entry.first, ray, FLOAT_TYPE(fractions[ray])));
+			}
+		}
+		else
+		{
+			myAssert(size + 2 <= AABB_TREE_STACK_SIZE);
+			stack[size++] = { node.child1, mask };
+			stack[size++] = { node.child2, mask };
+		}
+	}
+
+	for (int ray = 0; ray < numOfRays; ++ray)
+		maxFractions[ray] = fractions[ray];
+}
+
+
+#endif // !AABB_TREE
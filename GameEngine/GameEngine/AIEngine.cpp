@@ -21,6 +21,7 @@ gabrielgf6000@gmail.com
 
 
 #include "AIEngine.h"
+#include "Profiler.h"
 
 
 void AIEngine::intialize(World* w) 
@@ -39,13 +40,18 @@ void AIEngine::onNotify(Message msg)
 
 void AIEngine::update(FLOAT_TYPE dt)
 {
+	PROFILE_ZONE("AIEngine::update");
+
 	if (iterations > 0) { --iterations; return; };
 	iterations = 15;
 
 	CharacterComponent* player = world->currentScene->getCharacterComponent(world->playerId);
 	RigidBodyComponent<Box>* playerPhysicalComp = world->currentScene->getBoxRigidBodyComponent(world->playerId);
 
-	//update each character component in the scene(only the ones controlled by AI)
+	//update each character component in the scene(only the ones controlled by AI). This stays serial: it only
+	//runs every 16th frame, and each character is just a seek() and a few flags, so a job would cost more
+	//than the work it does(fan it out with JobSystem::parallelForEach() if the behaviours get expensive, but
+	//binomialWandering() shares one random engine, so it would need one per job first)
 	for (int i = 0; i < world->currentScene->characterComponents.getSize(); ++i)
 	{
 		CharacterComponent* charComp = &(world->currentScene->characterComponents[i]);
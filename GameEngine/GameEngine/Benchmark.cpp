@@ -0,0 +1,115 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <fstream>
+#include <vector>
+
+#include "JobSystem.h"
+#include "BenchmarkHelpers.h"
+
+
+//helper functions:
+
+volatile FLOAT_TYPE benchmarkSink = 0.0f;
+
+
+struct BenchmarkResult //one line of the results file
+{
+	std::string benchmark;
+	int n;
+	double value;
+	std::string unit;
+};
+
+static std::vector<BenchmarkResult> benchmarkResults;
+static int failedChecks = 0;
+
+void recordResult(const std::string& benchmark, int n, double value, const std::string& unit)
+{
+	benchmarkResults.push_back({ benchmark, n, value, unit });
+}
+
+const char* checkResult(bool passed, const char* failure)
+{
+	if (passed) return "OK";
+	++failedChecks;
+	return failure;
+}
+
+static bool writeResults(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file) return false;
+
+	file << "benchmark,n,value,unit\n";
+	for (const BenchmarkResult& result : benchmarkResults)
+		file << result.benchmark << ',' << result.n << ',' << result.value << ',' << result.unit << '\n';
+	return bool(file);
+}
+
+
+//#############################################################################################
+
+
+int runBenchmarks(const std::string& resultsPath)
+{
+	std::cout << "\n========================================================================\n"
+		<< "Running Benchmarks: \n\n";
+
+	failedChecks = 0;
+	benchmarkResults.clear();
+	JobSystem::instance().initialize(); //the same threads the game uses
+
+	benchmarkObjectPool();
+	benchmarkComponentPool();
+	benchmarkEntityAllocator();
+	benchmarkTransformHierarchy();
+	benchmarkSceneFile();
+	benchmarkSceneStreaming();
+	benchmarkJobSystem();
+	benchmarkMessageQueue();
+	benchmarkProfiler();
+	benchmarkSyntheticScenes();
+	benchmarkBroadPhase();
+	benchmarkAABBTree();
+	benchmarkNarrowPhase();
+	benchmarkRigidBodyStore();
+	benchmarkSleepingBodies();
+	benchmarkParallelPhysics();
+	benchmarkContinuousCollision();
+	benchmarkPhysicsQueries();
+	benchmarkCollisionLayers();
+	benchmarkContactSolver();
+	benchmarkHeightField();
+
+	if (writeResults(resultsPath))
+		std::cout << "\nResults written to " << resultsPath << '\n';
+	else
+		std::cout << "!WARNING: couldn't create the results file " << resultsPath << ";\n";
+
+	if (failedChecks > 0)
+		std::cout << "\n!ERROR: " << failedChecks << " check(s) FAILED;\n";
+	else
+		std::cout << "\nAll the checks passed\n";
+	return failedChecks;
+}
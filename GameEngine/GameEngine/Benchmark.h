@@ -0,0 +1,194 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the engine benchmarks. They
+are run(instead of the game) when the executable is started with the "-benchmark" argument, and
+print the cost of each measured operation for several container sizes, so that it's possible to
+see how each operation scales.
+	The results of the synthetic scene benchmarks are also written to a CSV file(one "benchmark,n,value,unit"
+line per measure), so the scaling curves of the game systems can be compared between versions.
+	Each benchmark is defined in the test file of its module(e.g. PhysicsTests.cpp), with the helpers of
+BenchmarkHelpers.h, and the executable exits with an error code if any of their checks fails.
+*/
+//#################################################################################
+
+#ifndef ENGINE_BENCHMARK
+#define ENGINE_BENCHMARK
+
+
+#include <iostream>
+#include <string>
+
+#include "GlobalDefines.h"
+
+
+/*
+	runBenchmarks - run every benchmark and print the results to the standard output. The results of
+	benchmarkSyntheticScenes() are also written to the CSV file. Return the number of failed checks(the
+	benchmarks also check the results of what they measure, printing OK or FAILED)
+*/
+int runBenchmarks(const std::string& resultsPath = "benchmark_results.csv");
+
+/*
+	benchmarkObjectPool - measure iteration, insert/erase and handle access costs of the ObjectPool
+	with 50 to 100k elements. Each cost is printed per element/operation, so it should stay flat
+	as the pool grows
+*/
+void benchmarkObjectPool();
+
+/*
+	benchmarkComponentPool - measure the entity lookup cost of the ComponentPool(through the sparse
+	set) against the linear scan it replaced, with 50 to 100k components
+*/
+void benchmarkComponentPool();
+
+/*
+	benchmarkEntityAllocator - measure the cost of creating, validating and deleting entities with
+	50 to 100k entities alive(like a burst of projectiles being spawned and destroyed)
+*/
+void benchmarkEntityAllocator();
+
+/*
+	benchmarkTransformHierarchy - measure the cost of computing the world transform of every object of
+	a scene with deep hierarchies(chains of 8 objects), walking the parents of each object(the old
+	way) against the flattened TransformHierarchy pass, checking that the pass finds the same transforms
+*/
+void benchmarkTransformHierarchy();
+
+/*
+	benchmarkSceneFile - save a scene with 1k to 100k entities(with hierarchies and deleted entities in
+	the middle) to a scene file, load it back into an empty scene and compare both(the round trip test),
+	then measure the save and load times. Only TransformComponents are used, since the other components
+	need the graphics and the physics systems to be created
+*/
+void benchmarkSceneFile();
+
+/*
+	benchmarkSceneStreaming - change between two scenes of 1k to 100k entities through the World streaming
+	functions(loadSceneAsync(), requestCurrentScene() and update()), and print the longest update() call,
+	which is the longest stall a frame would have, against the time of a synchronous load and delete
+*/
+void benchmarkSceneStreaming();
+
+/*
+	benchmarkJobSystem - measure the cost of running a job, check that dependent jobs run after their
+	dependencies, and compare a serial loop with JobSystem::parallelFor() over 1k to 1M elements
+*/
+void benchmarkJobSystem();
+
+/*
+	benchmarkMessageQueue - store 1k to 1M messages in a Subject from several jobs at once, then send them
+	with notify(), checking that no message is lost and that the messages of each producer arrive in order
+*/
+void benchmarkMessageQueue();
+
+/*
+	benchmarkProfiler - measure the cost of a profiler zone(disabled and enabled), record nested zones from
+	several jobs, print their statistics and export them to "benchmark_trace.json"
+*/
+void benchmarkProfiler();
+
+/*
+	benchmarkSyntheticScenes - generate scenes of 1k to 100k entities(see SceneGenerator.h) and measure the
+	throughput of each game system on them: the component lookups, the pool iteration and entity churn, the
+	PhysicsEngine update, the animation sampling(boneTransform()), the particle update, the
+	GraphicalSystem transform pass and the state stored for the interpolation between two ticks(checking that
+	the draws interpolated halfway are halfway). It uses the null graphics backend, and the measures that need the
+	model or the texture are skipped if they can't be loaded
+*/
+void benchmarkSyntheticScenes();
+
+/*
+	benchmarkBroadPhase - move 1k to 100k boxes a little in each step(like the rigid bodies of a scene) and
+	measure the SweepAndPrune update, checking its pairs against testing every pair of boxes(up to 10k boxes)
+*/
+void benchmarkBroadPhase();
+
+/*
+	benchmarkAABBTree - build AABBTrees of 1k to 100k boxes, move them, measure the overlap, raycast and shape
+	cast queries(checking them against testing every box, up to 10k boxes), and measure the physics update in
+	scenes where most of the bodies are static
+*/
+void benchmarkAABBTree();
+
+/*
+	benchmarkNarrowPhase - test 100k random pairs of boxes with detectBoxToBox2(), with NarrowPhase::testPair()
+	and in the NarrowPhase batches, checking that the results are the same, and measure the pairs per second
+*/
+void benchmarkNarrowPhase();
+
+/*
+	benchmarkRigidBodyStore - integrate 1k to 100k bodies with RigidBodyStore::integrate() and with the scalar
+	loop the PhysicsEngine used before it(one body at a time, on interleaved data), checking that the results are
+	the same, and measure the bodies per second
+*/
+void benchmarkRigidBodyStore();
+
+/*
+	benchmarkSleepingBodies - measure the physics update in scenes of 1k to 100k boxes resting on the ground, while
+	they are awake and after they fall asleep, and check that pushing or rotating one of them wakes it
+*/
+void benchmarkSleepingBodies();
+
+/*
+	benchmarkParallelPhysics - simulate a pile of 1k to 10k boxes and a cluster of spheres with the narrow phases
+	run by one thread and by the JobSystem, checking that the positions and the collision messages are the same,
+	bit by bit, and measure both
+*/
+void benchmarkParallelPhysics();
+
+/*
+	benchmarkContinuousCollision - shoot 100 to 10k fast boxes at a thin wall, and fast spheres at a large sphere,
+	with and without the fast flag, counting the bodies that pass through and measuring the cost of the steps
+*/
+void benchmarkContinuousCollision();
+
+/*
+	benchmarkPhysicsQueries - cast 10k rays and do sphere and box overlaps in scenes of 1k to 100k rotated boxes,
+	checking the results against testing every box, and measure single raycasts against batch raycasts
+*/
+void benchmarkPhysicsQueries();
+
+/*
+	benchmarkCollisionLayers - simulate a pile of 1k to 10k boxes with all of them colliding, with half of them on a
+	layer that doesn't collide with itself, and with a trigger box around the pile, counting the pairs sent to the
+	narrow phase and checking that the filtered pairs never collide and that the trigger doesn't change anything
+*/
+void benchmarkCollisionLayers();
+
+/*
+	benchmarkContactSolver - simulate 10 to 1k stacks of 8 boxes on the ground, and measure the step time, how much
+	the boxes still move(the jitter) after they should be resting, the error of the height of the stacks and how
+	long they take to fall asleep, checking that every stack stays standing. Then check that the restitution and
+	the friction of each box change how it bounces and slides
+*/
+void benchmarkContactSolver();
+
+/*
+	benchmarkHeightField - build a heightfield from a grid mesh of a wavy terrain, checking its heights and normals,
+	its save and load round trip(and that a file built from another transform is refused) and the cost of the
+	lookups, then drop 100 to 1k boxes on a flat ground made of a static box and on a flat heightfield, counting
+	the pairs and the step time of each, and on the wavy heightfield, checking that the boxes come to rest on its
+	surface
+*/
+void benchmarkHeightField();
+
+
+#endif // !ENGINE_BENCHMARK
@@ -0,0 +1,86 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the helpers shared by the benchmark files(the
+*Tests.cpp files, one for each module, see Benchmark.h): the clock of the measures, the results written to the
+CSV file, the checks counted by runBenchmarks() and the setup of the physics benchmarks.
+*/
+//#################################################################################
+
+#ifndef BENCHMARK_HELPERS
+#define BENCHMARK_HELPERS
+
+
+#include <chrono>
+#include <string>
+
+#include "World.h"
+#include "PhysicsEngine.h"
+
+#include "GlobalDefines.h"
+
+
+using BenchClock = std::chrono::high_resolution_clock;
+
+inline double nanosecondsSince(BenchClock::time_point start)
+{
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - start).count());
+}
+
+extern volatile FLOAT_TYPE benchmarkSink; //keeps the compiler from removing the measured loops
+
+/*
+	recordResult - add a line to the CSV file written by runBenchmarks()
+*/
+void recordResult(const std::string& benchmark, int n, double value, const std::string& unit);
+
+/*
+	checkResult - count a check of the benchmarks, and return what is printed for it: "OK" if it passed, or the
+	failure word. runBenchmarks() returns the number of failed checks
+*/
+const char* checkResult(bool passed, const char* failure = "FAILED");
+
+
+//the setup of the physics benchmarks: a World with its first scene current, and a PhysicsEngine working on it
+struct PhysicsFixture
+{
+	PhysicsFixture()
+	{
+		world.initalize();
+		world.setCurrentScene(0);
+		scene = world.currentScene;
+		physics.initialize(&world);
+	}
+
+	Entity addStaticBox(int sizeX, int sizeY, int sizeZ, glm::vec3 position) //usually the ground
+	{
+		Entity e = scene->createEntity();
+		physics.addBoxPhysicalComponent(e, sizeX, sizeY, sizeZ, position);
+		scene->getBoxRigidBodyComponent(e)->setMass(-1.0f); //infinite mass
+		return e;
+	}
+
+	World world;
+	Scene* scene = nullptr;
+	PhysicsEngine physics;
+};
+
+
+#endif // !BENCHMARK_HELPERS
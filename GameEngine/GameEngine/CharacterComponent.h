@@ -122,6 +122,7 @@ private:
 
 	friend class GameplayHandler;
 	friend class AIEngine;
+	friend class SceneSerializer;
 
 	
 	//model data:
@@ -33,6 +33,7 @@ detection and response.
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <utility>
 
 
 #include <glm/glm.hpp>
@@ -85,6 +86,64 @@ inline bool boundSphereTest(glm::vec3 p1, glm::vec3 p2, FLOAT_TYPE r1, FLOAT_TYP
 }
 
 
+//========================================================================================================
+
+
+//continuous collision detection: take a sphere moving by displacement and a sphere that isn't moving, and
+//return true if they touch along the way. Sets the time of impact, as a fraction of the displacement in (0, 1].
+//Spheres that already overlap at the start return false(the discrete test solves them)
+inline bool sweptSphereTest(const Sphere& sp1, glm::vec3 displacement, const Sphere& sp2, FLOAT_TYPE& toi) noexcept
+{
+	//a ray from the center of sp1 against a sphere with the two radius, at the center of sp2:
+	glm::vec3 offset = sp1.pos - sp2.pos;
+	FLOAT_TYPE radius = sp1.radius + sp2.radius;
+	FLOAT_TYPE c = glm::dot(offset, offset) - radius * radius;
+	if (c <= 0.0f) return false; //already overlaping
+
+	FLOAT_TYPE a = glm::dot(displacement, displacement);
+	FLOAT_TYPE b = glm::dot(offset, displacement);
+	if (a <= 0.0f || b >= 0.0f) return false; //not moving toward sp2
+
+	FLOAT_TYPE delta = b * b - a * c;
+	if (delta < 0.0f) return false; //the ray misses it
+
+	toi = (-b - std::sqrt(delta)) / a;
+	return toi <= 1.0f;
+}
+
+
+//========================================================================================================
+
+
+//the same for two AABBs(the bounds of two bodies): returns true if the first one, moving by displacement,
+//penetrates the second along the way(the boxes that already overlap at the start return false, the ones that
+//only touch return true with toi = 0 if they are moving into each other)
+inline bool sweptAABBTest(const AABB& box1, glm::vec3 displacement, const AABB& box2, FLOAT_TYPE& toi) noexcept
+{
+	bool overlaping = true;
+	FLOAT_TYPE enter = 0.0f, exit = 1.0f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		overlaping = overlaping && box1.max[axis] > box2.min[axis] && box1.min[axis] < box2.max[axis];
+		if (displacement[axis] == 0.0f)
+		{
+			if (box1.max[axis] <= box2.min[axis] || box1.min[axis] >= box2.max[axis]) return false;
+			continue;
+		}
+
+		FLOAT_TYPE t1 = (box2.min[axis] - box1.max[axis]) / displacement[axis];
+		FLOAT_TYPE t2 = (box2.max[axis] - box1.min[axis]) / displacement[axis];
+		if (t1 > t2) std::swap(t1, t2);
+		if (t1 > enter) enter = t1;
+		if (t2 < exit) exit = t2;
+		if (enter >= exit) return false;
+	}
+
+	toi = enter;
+	return !overlaping;
+}
+
+
 //========================================================================================================
 
 //returns the index of vertices with the max and min projections, also returns their respective projection values 
@@ -145,7 +204,8 @@ inline int getMaxProjectionVertex(const glm::vec3* vertices, const glm::vec3& ve
 //========================================================================================================
 
 //take two boxes and their respective model matrices as input, and also returns a separation vector
-//in the fifth parameter. Returns true if penetration or collision happened
+//in the fifth parameter. Returns true if penetration or collision happened(the NarrowPhase class gives
+//the same result without transforming the vertices, and tests many pairs at once, see NarrowPhase.h)
 inline bool detectBoxToBox2(const Box& b1, const Box& b2, const glm::mat4& model1, 
 							const glm::mat4& model2, glm::vec3& separ, bool a2) noexcept
 {
@@ -166,8 +226,6 @@ inline bool detectBoxToBox2(const Box& b1, const Box& b2, const glm::mat4& model
 	separVecs[1] = glm::normalize(model1 * glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
 	separVecs[2] = glm::normalize(model1 * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f));
 
-	std::vector<FLOAT_TYPE> overlaps;
-
 	glm::vec3 centerToCenter = b2.pos - b1.pos; //a vector from b1 center to b2 center
 	FLOAT_TYPE mtvLength = 0.0f;
 	//--------------------------------------
@@ -622,13 +680,17 @@ inline void resolveSphereToSphere(RigidBodyComponent<Sphere>& sp1, RigidBodyComp
 
 
 
-inline void resolveBoxToBox(RigidBodyComponent<Box>& box1, RigidBodyComponent<Box>& box2, 
-							glm::vec3 separVec) noexcept
+inline void separateBoxes(RigidBodyComponent<Box>& box1, RigidBodyComponent<Box>& box2, glm::vec3 separVec,
+							FLOAT_TYPE maxPenetration) noexcept
+//correct the penetration of two boxes beyond maxPenetration at once. The rest of it, and their velocities, are
+//solved by the contact solver of the PhysicsEngine(moving the boxes here pushes the ones below them in a stack
+//into the boxes under them, so it's only done for the deep penetrations)
 {
 	if (glm::dot(separVec, box1.getPosition() - box2.getPosition()) >= 0) separVec *= -1.0f;
-	if (glm::length(separVec) <= 0.001f) return;
+	FLOAT_TYPE penetration = glm::length(separVec);
+	if (penetration <= glm::max(maxPenetration, 0.001f)) return;
+	separVec *= (penetration - maxPenetration) / penetration;
 
-	//correct penetration:
 	FLOAT_TYPE totalMass = (box1.mass > 0.0 ? box1.mass : 0.0f) + (box2.mass > 0.0 ? box2.mass : 0.0f);
 	if (totalMass > 0.0f)
 	{
@@ -643,43 +705,6 @@ inline void resolveBoxToBox(RigidBodyComponent<Box>& box1, RigidBodyComponent<Bo
 			box2.move(separVec * (box2.mass > 0.0f ? 1.0f : 0.0f));
 		}
 	}
-	
-	//now add velocity due to collision
-	glm::vec3 normal = glm::length(separVec) >= 0.0001f
-		? glm::normalize(separVec)
-		: glm::normalize(box2.getPosition() - box1.getPosition());
-
-	//-----------------------------
-	//apply the impulse:
-
-	//get the relative velocity
-	glm::vec3 relVel = box2.linearVelocity - box1.linearVelocity;
-
-	
-	if (glm::dot(relVel, normal) >= 0.0) return; //they aren't moving toward each other
-
-	FLOAT_TYPE impulse = ((1.0f - 0.2f) * glm::dot(relVel, normal)) / 
-		(1.0f / (box1.mass > 0.0f ? box1.mass : 1.0f) + (1.0f / (box2.mass > 0 ? box2.mass : 1.0f)));
-	
-	if(box1.mass > 0.0f)
-		box1.linearVelocity += impulse * normal / box1.mass;
-	if (box2.mass > 0.0f)
-		box2.linearVelocity -= impulse * normal / box2.mass;
-
-	//-----------------------------
-	//compute and apply friction:
-	
-	if (fabs(glm::dot(relVel, normal)) < 0.001f) return; //don't compute friction
-
-	
-	glm::vec3 tangent = relVel - (glm::dot(relVel, normal) * normal);
-	if(glm::length(tangent) < 0.0001) return; 
-	tangent = glm::normalize(tangent);
-	
-	if (box1.mass > 0.0f)
-		box1.linearVelocity -= (0.8f * impulse) * tangent / box1.mass;
-	if (box2.mass > 0.0f)
-		box2.linearVelocity += (0.8f * impulse) * tangent / box2.mass;
 }
 
 
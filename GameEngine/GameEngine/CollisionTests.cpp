@@ -0,0 +1,390 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "SweepAndPrune.h"
+#include "AABBTree.h"
+#include "NarrowPhase.h"
+#include "CollisionHandling.h"
+#include "SceneGenerator.h"
+#include "GraphicalSystem.h"
+#include "GameplayHandler.h"
+#include "BenchmarkHelpers.h"
+
+
+void benchmarkBroadPhase()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const FLOAT_TYPE spacing = 40.0f; //the same density of the synthetic scenes
+	const int steps = 20;
+	std::default_random_engine generator(42);
+	std::uniform_real_distribution<FLOAT_TYPE> random01(0.0f, 1.0f);
+
+	std::cout << "SweepAndPrune(boxes of 10 to 30 units, moving up to 1 unit per step):\n";
+
+	for (int n : sizes)
+	{
+		FLOAT_TYPE area = spacing * std::sqrt(FLOAT_TYPE(n));
+		std::vector<glm::vec3> positions(n), sizes(n);
+		for (int i = 0; i < n; ++i)
+		{
+			positions[i] = glm::vec3(area * random01(generator), spacing * random01(generator), area * random01(generator));
+			sizes[i] = glm::vec3(10.0f + 20.0f * random01(generator));
+		}
+
+		SweepAndPrune broadPhase;
+		std::vector<AABB> boxes(n);
+		double updateTime = 0.0;
+		long long swaps = 0;
+		bool ok = true;
+
+		for (int step = 0; step <= steps; ++step) //the first step sorts from scratch, and isn't measured
+		{
+			for (int i = 0; i < n; ++i)
+			{
+				positions[i] += glm::vec3(random01(generator) - 0.5f, random01(generator) - 0.5f, random01(generator) - 0.5f);
+				boxes[i].min = positions[i] - 0.5f * sizes[i];
+				boxes[i].max = positions[i] + 0.5f * sizes[i];
+			}
+
+			auto start = BenchClock::now();
+			broadPhase.update(boxes.data(), n);
+			if (step > 0)
+			{
+				updateTime += nanosecondsSince(start);
+				swaps += broadPhase.getNumOfSwaps();
+			}
+
+			//the pairs must be the ones found by testing all of them(in the same order):
+			if (n <= 10000 && (step == 0 || step == steps))
+			{
+				std::vector<SweepAndPrune::Pair> allPairs;
+				for (int i = 0; i < n; ++i)
+					for (int j = i + 1; j < n; ++j)
+						if (boxes[i].overlaps(boxes[j])) allPairs.push_back({ i, j });
+
+				const std::vector<SweepAndPrune::Pair>& pairs = broadPhase.getPairs();
+				ok = ok && pairs.size() == allPairs.size();
+				for (size_t p = 0; ok && p < pairs.size(); ++p)
+					ok = pairs[p].first == allPairs[p].first && pairs[p].second == allPairs[p].second;
+			}
+		}
+
+		double stepCost = updateTime / (1000000.0 * steps);
+		std::cout << "  N = " << n
+			<< ", pairs: " << (n <= 10000 ? checkResult(ok) : "not checked")
+			<< " (" << broadPhase.getPairs().size() << ")"
+			<< ", update: " << stepCost << " ms/step"
+			<< ", " << updateTime / (double(steps) * n) << " ns/box"
+			<< ", swaps: " << swaps / steps << " per step\n";
+
+		recordResult("sweep_and_prune_update", n, stepCost, "ms/step");
+	}
+}
+
+
+//=============================================================================================
+
+
+static bool segmentHitsBox(const glm::vec3& origin, const glm::vec3& displacement, const AABB& box) noexcept
+//the slab test done by AABBTree::raycast(), to check its results
+{
+	FLOAT_TYPE enter = 0.0f, exit = 1.0f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (displacement[axis] == 0.0f)
+		{
+			if (origin[axis] < box.min[axis] || origin[axis] > box.max[axis]) return false;
+			continue;
+		}
+		FLOAT_TYPE t1 = (box.min[axis] - origin[axis]) / displacement[axis];
+		FLOAT_TYPE t2 = (box.max[axis] - origin[axis]) / displacement[axis];
+		enter = std::max(enter, std::min(t1, t2));
+		exit = std::min(exit, std::max(t1, t2));
+	}
+	return enter <= exit;
+}
+
+
+void benchmarkAABBTree()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const FLOAT_TYPE spacing = 40.0f;
+	const int steps = 20;
+	const int queries = 10000;
+	std::default_random_engine generator(42);
+	std::uniform_real_distribution<FLOAT_TYPE> random01(0.0f, 1.0f);
+
+	std::cout << "AABBTree(boxes of 10 to 30 units, queries of 50 units, rays of 200 units):\n";
+
+	for (int n : sizes)
+	{
+		FLOAT_TYPE area = spacing * std::sqrt(FLOAT_TYPE(n));
+		std::vector<glm::vec3> positions(n), sizes(n);
+		std::vector<AABB> boxes(n);
+		for (int i = 0; i < n; ++i)
+		{
+			positions[i] = glm::vec3(area * random01(generator), spacing * random01(generator), area * random01(generator));
+			sizes[i] = glm::vec3(10.0f + 20.0f * random01(generator));
+			boxes[i].min = positions[i] - 0.5f * sizes[i];
+			boxes[i].max = positions[i] + 0.5f * sizes[i];
+		}
+
+		//--------------------------------------
+		AABBTree tree;
+		std::vector<int> proxies(n);
+		auto start = BenchClock::now();
+		for (int i = 0; i < n; ++i)
+			proxies[i] = tree.createProxy(boxes[i], i);
+		double insertCost = nanosecondsSince(start) / n;
+		bool ok = tree.validate();
+
+		//the boxes move up to 1 unit per step(most of them stay inside their fat AABBs):
+		double moveTime = 0.0;
+		long long reinserted = 0;
+		for (int step = 0; step < steps; ++step)
+		{
+			std::vector<glm::vec3> displacements(n);
+			for (int i = 0; i < n; ++i)
+			{
+				displacements[i] = glm::vec3(random01(generator) - 0.5f, random01(generator) - 0.5f, random01(generator) - 0.5f);
+				boxes[i].min += displacements[i];
+				boxes[i].max += displacements[i];
+			}
+
+			start = BenchClock::now();
+			for (int i = 0; i < n; ++i)
+				reinserted += tree.moveProxy(proxies[i], boxes[i], displacements[i]);
+			moveTime += nanosecondsSince(start);
+		}
+		double moveCost = moveTime / (double(steps) * n);
+		ok = ok && tree.validate();
+
+		//--------------------------------------
+		//overlap queries, raycasts and shape casts from random points:
+		std::vector<AABB> queryBoxes(queries);
+		std::vector<glm::vec3> rayDirections(queries);
+		for (int q = 0; q < queries; ++q)
+		{
+			glm::vec3 center(area * random01(generator), spacing * random01(generator), area * random01(generator));
+			queryBoxes[q].min = center - glm::vec3(25.0f);
+			queryBoxes[q].max = center + glm::vec3(25.0f);
+			rayDirections[q] = 200.0f * glm::normalize(glm::vec3(random01(generator) - 0.5f, 0.2f * (random01(generator) - 0.5f),
+				random01(generator) - 0.5f));
+		}
+
+		long long found = 0;
+		start = BenchClock::now();
+		for (const AABB& box : queryBoxes)
+			tree.query(box, [&](int) { ++found; return true; });
+		double queryCost = nanosecondsSince(start) / queries;
+
+		long long hits = 0;
+		start = BenchClock::now();
+		for (int q = 0; q < queries; ++q)
+		{
+			glm::vec3 origin = 0.5f * (queryBoxes[q].min + queryBoxes[q].max);
+			tree.raycast(origin, rayDirections[q], [&](int, FLOAT_TYPE maxFraction) { ++hits; return maxFraction; });
+		}
+		double raycastCost = nanosecondsSince(start) / queries;
+
+		long long swept = 0;
+		start = BenchClock::now();
+		for (int q = 0; q < queries; ++q)
+			tree.shapeCast(queryBoxes[q], rayDirections[q], [&](int, FLOAT_TYPE maxFraction) { ++swept; return maxFraction; });
+		double shapeCastCost = nanosecondsSince(start) / queries;
+
+		//the results must be the ones found by testing all the fat AABBs(for some of the queries):
+		if (n <= 10000)
+		{
+			long long allFound = 0, allHits = 0, treeFound = 0, treeHits = 0;
+			for (int q = 0; q < 100; ++q)
+			{
+				glm::vec3 origin = 0.5f * (queryBoxes[q].min + queryBoxes[q].max);
+				for (int i = 0; i < n; ++i)
+				{
+					allFound += tree.getFatAABB(proxies[i]).overlaps(queryBoxes[q]);
+					allHits += segmentHitsBox(origin, rayDirections[q], tree.getFatAABB(proxies[i]));
+				}
+				tree.query(queryBoxes[q], [&](int) { ++treeFound; return true; });
+				tree.raycast(origin, rayDirections[q], [&](int, FLOAT_TYPE maxFraction) { ++treeHits; return maxFraction; });
+			}
+			ok = ok && allFound == treeFound && allHits == treeHits;
+		}
+
+		std::cout << "  N = " << n
+			<< ", tree: " << checkResult(ok) << " (height " << tree.getHeight() << ")"
+			<< ", insert: " << insertCost << " ns/box"
+			<< ", move: " << moveCost << " ns/box(" << reinserted / steps << " reinserted per step)\n"
+			<< "    query: " << queryCost << " ns(" << found / queries << " found)"
+			<< ", raycast: " << raycastCost << " ns(" << hits / queries << " hit)"
+			<< ", shapeCast: " << shapeCastCost << " ns(" << swept / queries << " hit)\n";
+
+		recordResult("aabb_tree_insert", n, insertCost, "ns/box");
+		recordResult("aabb_tree_move", n, moveCost, "ns/box");
+		recordResult("aabb_tree_query", n, queryCost, "ns/query");
+		recordResult("aabb_tree_raycast", n, raycastCost, "ns/query");
+		recordResult("aabb_tree_shape_cast", n, shapeCastCost, "ns/query");
+	}
+
+	//--------------------------------------
+	//a level made mostly of static boxes: they are only tested against the dynamic boxes near them
+	std::cout << "PhysicsEngine::update() with 90% static bodies(synthetic scenes):\n";
+	SceneGenerator::Settings settings;
+	settings.boxRigidBodies = 1.0f;
+	settings.staticBodies = 0.9f;
+	settings.parentDepth = 1;
+	settings.pointLights = 0.0f; //only the bodies are needed(and the lights would create their shadow maps)
+	GraphicalSystem graphics; //not used without images, models, characters and lights
+	GameplayHandler gameplay;
+
+	for (int n : sizes)
+	{
+		PhysicsFixture fixture;
+		PhysicsEngine& physics = fixture.physics;
+		settings.numOfEntities = n;
+		SceneGenerator::generate(fixture.world, physics, graphics, gameplay, settings);
+
+		auto start = BenchClock::now();
+		physics.update(); //builds the trees
+		double buildTime = nanosecondsSince(start) / 1000000.0;
+
+		int rounds = 20000 / n + 10;
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			physics.update();
+		double stepTime = nanosecondsSince(start) / (1000000.0 * rounds);
+
+		std::cout << "  N = " << n
+			<< ", static: " << physics.getStaticTree().getNumOfProxies()
+			<< ", dynamic: " << physics.getDynamicTree().getNumOfProxies()
+			<< ", first step: " << buildTime << " ms"
+			<< ", step: " << stepTime << " ms\n";
+
+		recordResult("solve_for_boxes_static_level", n, stepTime, "ms/step");
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkNarrowPhase()
+{
+	const int n = 100000;
+	const int rounds = 5;
+	std::default_random_engine generator(42);
+	std::uniform_real_distribution<FLOAT_TYPE> random01(0.0f, 1.0f);
+
+	//random boxes of 2 to 20 units, near enough for about half of the pairs to collide(a quarter of the
+	//pairs aren't rotated, to test the parallel axes too):
+	std::vector<Box> boxes1(n), boxes2(n);
+	std::vector<glm::mat4> models1(n), models2(n);
+	auto randomBox = [&](Box& box, glm::mat4& model, const glm::vec3& pos, bool rotated)
+	{
+		box.setSize(2 + int(18.0f * random01(generator)), 2 + int(18.0f * random01(generator)), 2 + int(18.0f * random01(generator)));
+		box.pos = pos;
+		model = glm::translate(glm::mat4(1.0f), pos);
+		if (rotated)
+		{
+			glm::vec3 axis(random01(generator) - 0.5f, random01(generator) - 0.5f, random01(generator) - 0.5f);
+			model = glm::rotate(model, 6.2832f * random01(generator), glm::normalize(axis + glm::vec3(0.001f)));
+		}
+	};
+	for (int i = 0; i < n; ++i)
+	{
+		bool rotated = i % 4 != 0;
+		glm::vec3 pos(100.0f * random01(generator), 100.0f * random01(generator), 100.0f * random01(generator));
+		randomBox(boxes1[i], models1[i], pos, rotated);
+		pos += 30.0f * glm::vec3(random01(generator) - 0.5f, random01(generator) - 0.5f, random01(generator) - 0.5f);
+		randomBox(boxes2[i], models2[i], pos, rotated);
+	}
+
+	//--------------------------------------
+	//the reference(detectBoxToBox2), one pair at a time with projected radii, and the batches:
+	std::vector<glm::vec3> reference(n);
+	std::vector<unsigned char> referenceHits(n);
+	auto start = BenchClock::now();
+	for (int r = 0; r < rounds; ++r)
+		for (int i = 0; i < n; ++i)
+			referenceHits[i] = detectBoxToBox2(boxes1[i], boxes2[i], models1[i], models2[i], reference[i], false);
+	double referenceTime = nanosecondsSince(start) / 1000000000.0;
+
+	glm::vec3 separ;
+	int hits = 0;
+	start = BenchClock::now();
+	for (int r = 0; r < rounds; ++r)
+		for (int i = 0; i < n; ++i)
+			hits += NarrowPhase::testPair(boxes1[i], boxes2[i], models1[i], models2[i], separ);
+	double scalarTime = nanosecondsSince(start) / 1000000000.0;
+	benchmarkSink = FLOAT_TYPE(hits);
+
+	NarrowPhase narrowPhase;
+	double fillTime = 0.0, solveTime = 0.0;
+	for (int r = 0; r < rounds; ++r)
+	{
+		start = BenchClock::now();
+		narrowPhase.clear();
+		for (int i = 0; i < n; ++i)
+			narrowPhase.addPair(boxes1[i], boxes2[i], models1[i], models2[i]);
+		fillTime += nanosecondsSince(start) / 1000000000.0;
+
+		start = BenchClock::now();
+		narrowPhase.solve();
+		solveTime += nanosecondsSince(start) / 1000000000.0;
+	}
+
+	//--------------------------------------
+	//the results must be the ones of detectBoxToBox2(the separation vectors can only differ by rounding):
+	int collisions = 0, different = 0;
+	FLOAT_TYPE maxError = 0.0f;
+	for (int i = 0; i < n; ++i)
+	{
+		bool hit = narrowPhase.getResult(i, separ);
+		collisions += hit;
+		if (hit != bool(referenceHits[i])) { ++different; continue; }
+		if (!hit) continue;
+
+		FLOAT_TYPE error = glm::length(separ - reference[i]) / (1.0f + glm::length(reference[i]));
+		maxError = std::max(maxError, error);
+		different += error > 0.001f;
+	}
+
+	double pairs = double(n) * rounds;
+	std::cout << "NarrowPhase(" << n << " random pairs, " << collisions << " colliding):\n"
+		<< "  results: " << checkResult(different == 0, "DIFFERENT") << " (" << different << " different, max relative error "
+		<< maxError << ")\n"
+		<< "  detectBoxToBox2: " << pairs / referenceTime / 1000000.0 << " M pairs/s"
+		<< ", testPair: " << pairs / scalarTime / 1000000.0 << " M pairs/s"
+		<< ", batched(" << NarrowPhase::getNumOfLanes() << " lanes): " << pairs / solveTime / 1000000.0 << " M pairs/s"
+		<< "(" << pairs / (fillTime + solveTime) / 1000000.0 << " with addPair)\n";
+
+	recordResult("narrow_phase_reference", n, pairs / referenceTime, "pairs/s");
+	recordResult("narrow_phase_scalar", n, pairs / scalarTime, "pairs/s");
+	recordResult("narrow_phase_batched", n, pairs / solveTime, "pairs/s");
+	recordResult("narrow_phase_batched_with_fill", n, pairs / (fillTime + solveTime), "pairs/s");
+}
@@ -0,0 +1,279 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the ComponentPool class, an
+ObjectPool of components that also keeps a sparse set indexed by entityIndex(Entity). The sparse set
+maps each entity to the handle of its component, so finding, testing and removing the component of an entity
+is O(1) instead of a scan over the whole pool.
+	T is expected to derive from Component(it must have a getEntityId() method). An entity can have
+at most one component in each pool. A stale Entity(one whose index was reused by a newer entity)
+never finds the newer entity's component, since the lookup also compares the component's entity id.
+	The ObjectPool is a member(not a base class), and only its read-only part is forwarded, so no component
+can be added or removed without updating the sparse set and the version.
+*/
+//#################################################################################
+
+#ifndef COMPONENT_POOL
+#define COMPONENT_POOL
+
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include "ObjectPool.h"
+#include "Entity.h"
+
+#include "GlobalDefines.h"
+
+
+//##################################################
+//ComponentPool class declaration:
+
+
+template<typename T>
+class ComponentPool
+{
+public:
+
+	/*
+		constructor
+				params: initial size
+						default value for all pool elements
+	*/
+	ComponentPool(int, const T&);
+
+	//the changes to the pool(they keep the sparse set up to date):
+	void push_back(const T&) noexcept;
+	PoolHandle insert(const T&) noexcept;
+	void erase(int) noexcept;
+	void erase(PoolHandle) noexcept;
+
+	//entity based access:
+	T* getByEntity(Entity) noexcept; //returns nullptr if the entity doesn't have a component in this pool
+	const T* getByEntity(Entity) const noexcept;
+	bool has(Entity) const noexcept;
+	bool eraseEntity(Entity) noexcept; //returns false if the entity doesn't have a component in this pool
+	PoolHandle getEntityHandle(Entity) const noexcept;
+
+	//the rest of the ObjectPool interface(see ObjectPool.h):
+	T& operator[](int i) noexcept { return pool[i]; }
+	const T& operator[](int i) const noexcept { return pool[i]; }
+	int getReseved() const noexcept { return pool.getReseved(); }
+	void reserve(int n) { pool.reserve(n); }
+	int getSize() const noexcept { return pool.getSize(); }
+	T& front() noexcept { return pool.front(); }
+	T& back() noexcept { return pool.back(); }
+	T* get(PoolHandle h) noexcept { return pool.get(h); }
+	const T* get(PoolHandle h) const noexcept { return pool.get(h); }
+	bool isValid(PoolHandle h) const noexcept { return pool.isValid(h); }
+	PoolHandle getHandle(int i) const noexcept { return pool.getHandle(i); }
+	typename std::vector<T>::iterator begin() noexcept { return pool.begin(); }
+	typename std::vector<T>::iterator end() noexcept { return pool.end(); }
+	typename std::vector<T>::const_iterator begin() const noexcept { return pool.begin(); }
+	typename std::vector<T>::const_iterator end() const noexcept { return pool.end(); }
+
+	//the version changes each time a component is added or removed(so pointers to the components may be
+	//invalid), or when touch() is called, to tell that the relations between the components have changed:
+	unsigned int getVersion() const noexcept { return version; }
+	void touch() noexcept { ++version; }
+
+private:
+
+	ObjectPool<T> pool;
+	std::vector<PoolHandle> sparse; //sparse[entityIndex(e)] is the handle of the component of the entity e
+	unsigned int version = 0;
+
+	PoolHandle find(Entity) const noexcept;
+	void unlink(Entity, PoolHandle) noexcept;
+};
+
+
+//=================================================
+
+
+template<typename T>
+ComponentPool<T>::ComponentPool(int n, const T& defaultVal)
+	:pool{ n, defaultVal }
+{
+	sparse.reserve(n);
+}
+
+
+//=================================================
+
+
+template<typename T>
+void ComponentPool<T>::push_back(const T& t) noexcept
+{
+	insert(t);
+}
+
+
+//=================================================
+
+
+template<typename T>
+PoolHandle ComponentPool<T>::insert(const T& t) noexcept
+{
+	Entity id = t.getEntityId();
+	if (id < 0) //components without an entity are not indexed
+	{
+		++version;
+		return pool.insert(t);
+	}
+
+	if (has(id))
+	{
+		std::cout << "!WARNING: ComponentPool::insert() CALLED FOR AN ENTITY THAT ALREADY HAS THIS COMPONENT. "
+			"THE OLD COMPONENT WAS REPLACED;\n";
+		eraseEntity(id);
+	}
+
+	++version;
+	PoolHandle h = pool.insert(t);
+	int index = entityIndex(id);
+	if (int(sparse.size()) <= index)
+		sparse.resize(index + 1);
+	sparse[index] = h;
+
+	return h;
+}
+
+
+//=================================================
+
+
+template<typename T>
+void ComponentPool<T>::erase(int i) noexcept
+{
+	if (!(i >= 0 && i < pool.getSize()))
+	{
+		pool.erase(i); //let the ObjectPool warn about it
+		return;
+	}
+
+	unlink(pool[i].getEntityId(), pool.getHandle(i));
+	pool.erase(i);
+	++version;
+}
+
+
+//=================================================
+
+
+template<typename T>
+void ComponentPool<T>::erase(PoolHandle h) noexcept
+{
+	const T* t = pool.get(h);
+	if (t)
+	{
+		unlink(t->getEntityId(), h);
+		++version;
+	}
+
+	pool.erase(h);
+}
+
+
+//=================================================
+
+
+template<typename T>
+T* ComponentPool<T>::getByEntity(Entity id) noexcept
+{
+	return pool.get(find(id));
+}
+
+template<typename T>
+const T* ComponentPool<T>::getByEntity(Entity id) const noexcept
+{
+	return pool.get(find(id));
+}
+
+
+//=================================================
+
+
+template<typename T>
+bool ComponentPool<T>::has(Entity id) const noexcept
+{
+	return !find(id).isNull();
+}
+
+
+//=================================================
+
+
+template<typename T>
+bool ComponentPool<T>::eraseEntity(Entity id) noexcept
+{
+	PoolHandle h = find(id);
+	if (h.isNull()) return false;
+
+	sparse[entityIndex(id)] = PoolHandle();
+	pool.erase(h);
+	++version;
+	return true;
+}
+
+
+//=================================================
+
+
+template<typename T>
+PoolHandle ComponentPool<T>::getEntityHandle(Entity id) const noexcept
+{
+	return find(id);
+}
+
+
+//=================================================
+
+
+template<typename T>
+PoolHandle ComponentPool<T>::find(Entity id) const noexcept
+//returns the handle of the entity's component, or a null handle
+{
+	if (id < 0) return PoolHandle();
+
+	int index = entityIndex(id);
+	if (index >= int(sparse.size())) return PoolHandle();
+
+	const T* t = pool.get(sparse[index]);
+	if (!t || t->getEntityId() != id) return PoolHandle(); //no component, or it belongs to another generation
+
+	return sparse[index];
+}
+
+
+//=================================================
+
+
+template<typename T>
+void ComponentPool<T>::unlink(Entity id, PoolHandle h) noexcept
+//remove the entity from the sparse set, if it points to the handle h
+{
+	if (id >= 0 && entityIndex(id) < int(sparse.size()) && sparse[entityIndex(id)] == h)
+		sparse[entityIndex(id)] = PoolHandle();
+}
+
+
+#endif // !COMPONENT_POOL
@@ -21,6 +21,8 @@ gabrielgf6000@gmail.com
 
 #include "Entity.h"
 
+#include <iostream>
+
 
 
 //Component definitions:
@@ -47,4 +49,106 @@ void Component::enable() noexcept
 void Component::disable() noexcept
 {
 	actived = false;
-}
\ No newline at end of file
+}
+
+
+
+//#############################################################################################
+//EntityAllocator definitions:
+
+
+Entity EntityAllocator::create() noexcept
+{
+	int index = freeHead;
+	if (index != NULL_ENTITY) //reuse the index that has been free for longer
+	{
+		freeHead = nextFree[index];
+		if (freeHead == NULL_ENTITY) freeTail = NULL_ENTITY;
+	}
+	else //no free index, so create a new one
+	{
+		if (generations.size() > ENTITY_INDEX_MASK)
+		{
+			std::cout << "!WARNING: EntityAllocator::create() FAILED, ALL THE ENTITY INDICES ARE IN USE;\n";
+			return NULL_ENTITY;
+		}
+
+		index = int(generations.size());
+		generations.push_back(0);
+		nextFree.push_back(NULL_ENTITY);
+	}
+
+	nextFree[index] = ENTITY_ALIVE;
+	++count;
+
+	return makeEntity(index, generations[index]);
+}
+
+
+//=============================================================================================
+
+
+bool EntityAllocator::destroy(Entity e) noexcept
+{
+	if (!isAlive(e)) return false;
+
+	//increasing the generation invalidates every handle to the deleted entity:
+	int index = entityIndex(e);
+	generations[index] = uint16_t((generations[index] + 1) & ENTITY_GENERATION_MASK);
+
+	//push the index to the free list's end:
+	nextFree[index] = NULL_ENTITY;
+	if (freeTail != NULL_ENTITY) nextFree[freeTail] = index;
+	else freeHead = index;
+	freeTail = index;
+
+	--count;
+	return true;
+}
+
+
+//=============================================================================================
+
+
+bool EntityAllocator::isAlive(Entity e) const noexcept
+{
+	if (e < 0) return false;
+
+	int index = entityIndex(e);
+	return index < int(generations.size())
+		&& nextFree[index] == ENTITY_ALIVE
+		&& generations[index] == entityGeneration(e);
+}
+
+
+//=============================================================================================
+
+
+int EntityAllocator::getCount() const noexcept
+{
+	return count;
+}
+
+
+//=============================================================================================
+
+
+void EntityAllocator::getAlive(std::vector<Entity>& out) const
+{
+	out.reserve(out.size() + count);
+	for (int i = 0; i < int(generations.size()); ++i)
+		if (nextFree[i] == ENTITY_ALIVE)
+			out.push_back(makeEntity(i, generations[i]));
+}
+
+
+//=============================================================================================
+
+
+void EntityAllocator::clear() noexcept
+{
+	generations.clear();
+	nextFree.clear();
+	freeHead = freeTail = NULL_ENTITY;
+	count = 0;
+}
@@ -23,6 +23,11 @@ this header defines the Component class, which is a base class for all types of
 components in the game, like phisicalComponent, graphicalComponent and so on. Components 
 and entities are meant to be stored in the World and Scene classes, so all a Component need
 to hold is its specific data and an integer that represents the entity in which it belongs.
+	An Entity is a 32 bit handle: the low ENTITY_INDEX_BITS bits are an index(reused after the entity
+is deleted) and the bits above them are the generation of that index, so a handle kept after its
+entity was deleted can be told apart from the new entity that reuses the index. The sign bit is
+never used, so a negative Entity(like NULL_ENTITY) still means "no entity", and the entities of
+generation 0 have the same value as their index.
 */
 //###########################################################################################
 
@@ -30,9 +35,55 @@ to hold is its specific data and an integer that represents the entity in which
 #define ENTITY_HANDLER
 
 
+#include <cstdint>
+#include <vector>
+
 #include "GlobalDefines.h"
 
-using Entity = int; //an entity is just an indentifier
+using Entity = int; //an entity is just an indentifier(index + generation, see above)
+
+
+#define NULL_ENTITY -1
+#define ENTITY_INDEX_BITS 20
+#define ENTITY_INDEX_MASK 0x000FFFFF //2^20 entities can be alive at the same time
+#define ENTITY_GENERATION_MASK 0x7FF //11 bits, so the sign bit is never set
+
+inline int entityIndex(Entity e) noexcept { return e & ENTITY_INDEX_MASK; }
+inline int entityGeneration(Entity e) noexcept { return (e >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK; }
+inline Entity makeEntity(int index, int generation) noexcept
+{
+	return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+}
+
+
+//##################################################################################
+//the EntityAllocator class:
+
+
+/*
+	EntityAllocator - creates and deletes entities in O(1). The indices of deleted entities are
+	kept in a free list and reused in the order they were freed(so each index takes as long as
+	possible to be reused, and its generation to wrap around)
+*/
+class EntityAllocator
+{
+public:
+	Entity create() noexcept; //returns NULL_ENTITY if all the indices are in use
+	bool destroy(Entity) noexcept; //returns false if the entity isn't alive
+	bool isAlive(Entity) const noexcept; //false for deleted(stale) handles
+	int getCount() const noexcept;
+	void getAlive(std::vector<Entity>&) const; //append all the alive entities to the vector
+	void clear() noexcept;
+
+private:
+	std::vector<uint16_t> generations; //current generation of each index
+	std::vector<int> nextFree; //next index in the free list(ENTITY_ALIVE if the index is in use)
+	int freeHead = NULL_ENTITY;
+	int freeTail = NULL_ENTITY;
+	int count = 0;
+
+	static constexpr int ENTITY_ALIVE = -2;
+};
 
 
 //##################################################################################
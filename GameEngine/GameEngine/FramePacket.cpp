@@ -0,0 +1,41 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "FramePacket.h"
+
+
+//FramePacket definitions:
+
+
+void FramePacket::clear() noexcept
+{
+	images.clear();
+	models.clear();
+	interactableObjects.clear();
+	characters.clear();
+	bones.clear();
+	dirLights.clear();
+	pointLights.clear();
+	particlePositions.clear();
+	particleColors.clear();
+	hudImages.clear();
+	physicsBoxes.clear();
+}
@@ -0,0 +1,133 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the FramePacket class, an immutable copy
+of everything the GraphicalSystem needs to draw one frame.
+	A packet is filled by GraphicalSystem::captureFrame() at the end of a simulation tick, and then only
+read by GraphicalSystem::render(). As the renderer never touches the Scene, the game loop can draw frame
+N from one packet while the simulation computes frame N + 1 and fills another one(see Game::gameLoop()).
+	The packets only keep world space data(the final model matrices, the bone palettes, the light
+matrices) and pointers to the Models, which are assets that are never changed after being loaded. The
+transforms, the camera and the character animations are captured between the last two simulation ticks(see
+GraphicalSystem::recordTick()), so the frames don't have to follow the tick rate.
+*/
+//#################################################################################
+
+#ifndef FRAME_PACKET
+#define FRAME_PACKET
+
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ModelComponent.h"
+
+#include "GlobalDefines.h"
+
+
+class FramePacket
+{
+public:
+
+	struct SpriteDraw //an ImageComponent
+	{
+		glm::mat4 model;
+		unsigned int texture; //the OpenGL ids of the textures(0 if the sprite doesn't have it)
+		unsigned int normalMap;
+		unsigned int emissionMap;
+		int rows, columns; //the sprite sheet frame
+		int row, column;
+	};
+
+	struct ModelDraw //a ModelComponent, InteractableObjectComponent or CharacterComponent
+	{
+		glm::mat4 model; //with the model offset and the facing direction already applied
+		const Model* mesh;
+		int rows, columns; //the sprite sheet frame
+		int row, column;
+		int firstBone, numOfBones; //a range of bones(numOfBones is 0 if the model isn't animated)
+		bool actived;
+	};
+
+	struct DirLightDraw
+	{
+		glm::vec3 color;
+		glm::vec3 direction;
+		glm::mat4 lightMatrix;
+		unsigned int depthTexture;
+		bool shadowCaster;
+	};
+
+	struct PointLightDraw
+	{
+		glm::mat4 model;
+		glm::vec3 position;
+		glm::vec3 color;
+		FLOAT_TYPE constantAttenuation;
+		FLOAT_TYPE linearAttenuation;
+		FLOAT_TYPE quadraticAttenuation;
+		FLOAT_TYPE radius;
+		glm::mat4 faceMatrices[6]; //+x, -x, +y, -y, +z and -z
+		unsigned int depthCubeMap;
+		bool actived;
+	};
+
+	struct HudImageDraw
+	{
+		glm::vec2 position;
+		glm::vec2 size;
+		FLOAT_TYPE horizontalPercent;
+		unsigned int texture;
+	};
+
+	struct BoxDraw //a box rigid body or an active hit box(only captured when drawing the physics boxes)
+	{
+		glm::mat4 model;
+		glm::vec3 size;
+	};
+
+	void clear() noexcept; //empty all the vectors, but keep their memory
+
+	//----------------------------------------------------
+	//Data:
+
+	glm::vec3 camPosition = glm::vec3(0.0f);
+	glm::vec3 camDirection = glm::vec3(0.0f, 0.0f, -1.0f);
+	glm::vec2 cursorPos = glm::vec2(0.0f);
+
+	std::vector<SpriteDraw> images;
+	std::vector<ModelDraw> models;
+	std::vector<ModelDraw> interactableObjects;
+	std::vector<ModelDraw> characters;
+	std::vector<glm::mat4> bones; //the bone palettes of all the animated ModelDraws
+
+	std::vector<DirLightDraw> dirLights;
+	std::vector<PointLightDraw> pointLights;
+
+	std::vector<glm::vec3> particlePositions; //only the particles that are alive
+	std::vector<glm::vec4> particleColors;
+
+	std::vector<HudImageDraw> hudImages;
+	std::vector<BoxDraw> physicsBoxes;
+};
+
+
+#endif // !FRAME_PACKET
@@ -154,7 +154,10 @@ void Game::initializeGame()
 	TextureHandler::instance().addTexture("Assets/images/wandNormalMap.png"); //17
 
 	//Hide mouse cursor:
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
+	if (window) glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
+
+	//start the worker threads used by all the systems(see JobSystem.h):
+	JobSystem::instance().initialize();
 
 	//initialize the world:
 	world.initalize();
@@ -163,20 +166,26 @@ void Game::initializeGame()
 	//Systems initialization:
 	//------------------------------------------------
 	aiEngine.intialize(&world);
-	aiEngine.addObserver(physicsEngine);
+	aiEngine.addObserver(physicsEngine, MessageType::APPLY_FORCE);
+	aiEngine.addObserver(physicsEngine, MessageType::APPLY_VERTICAL_FORCE);
 
 	graphicsEngine.initialize(&world, window); 
 	graphicsEngine.bloom = true;
 
 	physicsEngine.initialize(&world);
-	physicsEngine.addObserver(gameplayHandler);
+	physicsEngine.addObserver(gameplayHandler, MessageType::COLLISION_OCCURRED);
 
 	InputHandler::instance().Initialize(&world, window);  //create and initialize the InputHandler
-	InputHandler::instance().addObserver(gameplayHandler);
+	for (MessageType type : { MessageType::KEY_PRESSED, MessageType::KEY_RELEASED, MessageType::KEY_HOLD_ON,
+		MessageType::MOUSE_BUTTOM_PRESSED, MessageType::MOUSE_BUTTOM_RELEASED })
+		InputHandler::instance().addObserver(gameplayHandler, type);
 
 	gameplayHandler.initialize(&world, window);
-	gameplayHandler.addObserver(physicsEngine);
-	gameplayHandler.addObserver(graphicsEngine);
+	gameplayHandler.addObserver(physicsEngine, MessageType::APPLY_FORCE);
+	gameplayHandler.addObserver(physicsEngine, MessageType::APPLY_VERTICAL_FORCE);
+	gameplayHandler.addObserver(graphicsEngine, MessageType::PLAY);
+	gameplayHandler.addObserver(graphicsEngine, MessageType::STOP);
+	gameplayHandler.addObserver(graphicsEngine, MessageType::MOUSE_POSITION_NOTIFICATION);
 
 	//networkHandler.initializeSocket("14000");
 	
@@ -184,7 +193,7 @@ void Game::initializeGame()
 	ModelHandler::instance().loadModel("Assets/Models/lampModel/", "lampPost.fbx"); //1
 	ModelHandler::instance().loadModel("Assets/Models/boxModel/", "box2.fbx"); //2
 	ModelHandler::instance().loadModel("Assets/Models/gryphonModel/", "gryphon.dae"); //3
-	ModelHandler::instance().loadModel("Assets/Models/terrain/", "terrain.glb", true, 1, 1, true); //4
+	ModelHandler::instance().loadModel("Assets/Models/terrain/", "terrain.glb", true, 1, 1, true, true); //4(its mesh is the ground collider)
 	ModelHandler::instance().loadModel("Assets/Models/sword/", "sword.glb", true, 1, 1, true); //5
 	ModelHandler::instance().loadModel("Assets/Models/wand/", "wand_Back.glb", true, 1, 1, true); //6
 	ModelHandler::instance().loadModel("Assets/Models/mage/", "player.glb", true, 4, 4, true); //7
@@ -201,6 +210,7 @@ void Game::initializeGame()
 	//world.currentScene->getSphereRigidBodyComponent(id)->setMass(10.0f);
 	physicsEngine.addBoxPhysicalComponent(id, 16, 44, 12, glm::vec3(0.0f, 20.0f, 0.0f));
 	world.currentScene->getBoxRigidBodyComponent(id)->setMass(10.0f);
+	world.currentScene->getBoxRigidBodyComponent(id)->fast = true; //a jump moves it more than its half size
 
 	tComp->setPosition(glm::vec3(0.0f, 0.0f, 160.0f));
 	tComp->setScale(glm::vec3(32.0f, 32.0f, 32.0f));
@@ -259,9 +269,6 @@ void Game::initializeGame()
 	//graphicsEngine.addImageComponent(id2, TextureHandler::instance().get(1), 1, 1);
 	graphicsEngine.addModelComponent(id2, ModelHandler::instance().getModel(4));
 
-	physicsEngine.addBoxPhysicalComponent(id2, 640, 2, 640, glm::vec3(0.0f, -20.0f, 0.0f));
-	world.currentScene->getBoxRigidBodyComponent(id2)->setMass(-1); //infinite mass
-
 	//ImageComponent* imagComp = world.currentScene->getImageComponent(id2);
 	//myAssert(imagComp);
 	tComp = world.currentScene->getTransformComponent(id2);
@@ -272,7 +279,35 @@ void Game::initializeGame()
 	//tComp->setPosition(glm::vec3(0.0f, -20.0f, 0.0f));
 	//tComp->rotate(-90.0f, glm::vec3(1.0f, 0.0f, 0.0f));
 	//tComp->rotate(180.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+	//the terrain was already drawn at y = -20: its old ground collider was a static box at (0, -20, 0), and the
+	//PhysicsEngine moved its transform to the box. It stays there, so the heightfield matches what is drawn:
+	tComp->setPosition(glm::vec3(0.0f, -20.0f, 0.0f));
 	tComp->setScale(glm::vec3(50.0f, 50.0f, 50.0f));
+
+	//the ground collider is the heightfield of the terrain(in world space). The cooked file is only used if it
+	//was built from the same mesh and transform:
+	const Model* terrain = ModelHandler::instance().getModel(4);
+	glm::mat4 terrainTransform = tComp->getScaledTransform(tComp->getScale());
+	uint64_t terrainHash = HeightField::hashSource(terrain->getMeshPositions(), terrain->getMeshIndices(), terrainTransform, 4.0f);
+
+	HeightField ground;
+	try
+	{
+		ground.load("Assets/Models/terrain/terrain.heightfield", terrainHash);
+	}
+	catch (const std::runtime_error&) //not cooked yet(or an old one), so it's sampled from the mesh
+	{
+		ground.build(terrain->getMeshPositions(), terrain->getMeshIndices(), terrainTransform, 4.0f);
+		try
+		{
+			ground.save("Assets/Models/terrain/terrain.heightfield");
+		}
+		catch (const std::runtime_error& e)
+		{
+			std::cerr << e.what();
+		}
+	}
+	physicsEngine.setHeightField(std::move(ground));
 	//set transforms hierarchy:
 	//tComp = &(world.currentScene->getTransformComponent(id));
 	//tComp->setParent(id2);
@@ -510,6 +545,7 @@ void Game::initializeGame()
 	//world.currentScene->getSphereRigidBodyComponent(id)->setMass(10.0f);
 	physicsEngine.addBoxPhysicalComponent(id8, 16, 40, 12, glm::vec3(0.0f, 20.0f, 0.0f));
 	world.currentScene->getBoxRigidBodyComponent(id8)->setMass(10.0f);
+	world.currentScene->getBoxRigidBodyComponent(id8)->fast = true;
 
 	tComp->setPosition(glm::vec3(0.0f, 0.0f, 160.0f));
 	tComp->setScale(1.2f * glm::vec3(26.0f, 26.0f, 26.0f));
@@ -581,120 +617,203 @@ void Game::gameLoop()
 	//CharacterComponent* cComp = world.currentScene->getCharacterComponent(0);
 
 	//fps counting variables:
-	double currentTime = glfwGetTime();
+	double currentTime = GameClock::instance().getTime();
 	int frameCount = 0;
 	int simulationsCount = 0;
 
 	
-	double previous = glfwGetTime();
+	double previous = GameClock::instance().getTime();
 	double lag = 0.0f;
 
-	std::chrono::time_point<std::chrono::steady_clock> physicalTime;
-	auto currentTime3 = std::chrono::high_resolution_clock::now();
-
 	glfwSwapInterval(0);
 	
 	std::cout << "\n========================================================================\n"
 		<< "Starting Game Loop: \n\n";
 
+	//the frame is pipelined: while this thread renders the packet of frame N, frame N + 1 is simulated(and
+	//captured to the other packet) by the JobSystem. The first packet is captured here, so there's always one to render
+	graphicsEngine.captureFrame(framePackets[0]);
+	int renderedPacket = 0;
+
 	//the game loop:
 	while (!glfwWindowShouldClose(window) && running)
 	{
-		
+		PROFILE_ZONE("Game::frame");
 		
 		//frameStart:
-		double frameBegin = glfwGetTime();
+		double frameBegin = GameClock::instance().getTime();
 		double timeElapsed = frameBegin - previous; //time elapsed since frame start, in seconds
 		previous = frameBegin;
+		lag += timeElapsed;
+
+		//nothing is being simulated now, so this is where the main thread changes the World:
+		{
+			PROFILE_ZONE("Game::pollEvents");
+			glfwPollEvents();
+			InputHandler::instance().poll(); //GLFW only allows reading the input in the main thread
+		}
+		world.update(); //publish streamed Scenes and release a part of the unloaded ones
 		
 		//===================================================================================
-		//Input, physics and AI:
-		
-		auto time3 = std::chrono::high_resolution_clock::now();
-		auto time2 = std::chrono::high_resolution_clock::now();
+		//Input, physics and AI(frame N + 1, in another thread):
 
-		lag += timeElapsed;
-		while (physicsEngine.getTimeStep() <= lag)
-		{
+		FramePacket& simulatedPacket = framePackets[1 - renderedPacket];
+		JobCounter simulation;
+		JobSystem::instance().run([&]() {
+			PROFILE_ZONE("Game::simulation");
+			while (physicsEngine.getTimeStep() <= lag)
+			{
+				//the state before the last tick of the frame(the frame is drawn between it and the state after the tick):
+				if (lag - physicsEngine.getTimeStep() < physicsEngine.getTimeStep())
+					graphicsEngine.recordTick();
 
-		
-			//Send and clear all messages:
-			InputHandler::instance().notify();
-			gameplayHandler.notify();
-			physicsEngine.notify();
-			aiEngine.notify();
-			graphicsEngine.update();
-
-			simulationsCount += 1;
-			lag -= physicsEngine.getTimeStep();
-
-			//handle Input:
-			InputHandler::instance().update();
-
-			//physics update:
-			time3 = std::chrono::high_resolution_clock::now();
-			physicsEngine.update();
-			time2 = std::chrono::high_resolution_clock::now();
-			//Game logic:
-			gameplayHandler.update();
-			aiEngine.update(physicsEngine.getTimeStep());
-
-			//update camera pos:
-			glm::vec3 newPos = gameplayHandler.getCameraPos(); //the camera position is handled by the gameplay
-																//handler, to handle things like cut scenes
-																//and switching the character controlled by the
-																//player.
-
-			//if (glm::length(graphicsEngine.camPosition - newPos) >= 1.0f)
-			graphicsEngine.camPosition = newPos;
+				simulateTick();
+				simulationsCount += 1;
+				lag -= physicsEngine.getTimeStep();
+			}
 
-			
-		}
+			//the end of the tick: copy what the renderer needs, interpolated by the time left(so the frame rate
+			//doesn't have to follow the tick rate. If no tick was simulated, it's the same state a little later)
+			graphicsEngine.captureFrame(simulatedPacket, FLOAT_TYPE(lag / physicsEngine.getTimeStep()));
+		}, &simulation);
 
-		
-		glfwPollEvents();
-	
 
 		//====================================================================================
-		//Rendering
+		//Rendering(frame N, in this thread)
 		int width, height;
 		glfwGetWindowSize(window, &width, &height);
 		int offset = (-16.0f * FLOAT_TYPE(height) / 18) + (FLOAT_TYPE(width) / 2);
 
+		graphicsEngine.render(framePackets[renderedPacket], offset, width, height);
 		
-		
-		graphicsEngine.render(offset, width, height);
-		
-		auto time1 = std::chrono::high_resolution_clock::now();
-		
-		
-		//auto time1 = glfwGetTime();//std::chrono::high_resolution_clock::now();
+		//wait for the simulation, and then render its packet in the next frame:
+		{
+			PROFILE_ZONE("Game::waitSimulation");
+			JobSystem::instance().wait(simulation);
+		}
+		renderedPacket = 1 - renderedPacket;
 	
 		++frameCount;
 		
-		if (glfwGetTime() - currentTime >= 1.0) //if one second has been elapsed
+		if (GameClock::instance().getTime() - currentTime >= 1.0) //if one second has been elapsed
 		{
 			std::cout << "FPS: " << frameCount << ", "<< "Simulations: " << simulationsCount << ' ' 
 				<< world.currentScene->transformComponents.getSize() <<'\n';
 			frameCount = 0;
 			simulationsCount = 0;
-			currentTime = glfwGetTime();
+			currentTime = GameClock::instance().getTime();
 		}
 
 		//==========================================================================
 		
 		
 		if (frameCount == 12)
-		{
-			std::cout << "FrameDur: " << std::chrono::duration_cast<std::chrono::microseconds>(time1 - time2).count()
-				<< ", " << std::chrono::duration_cast<std::chrono::microseconds>(time2 - time3).count() << '\n';
-
 			networkHandler.update();
-		}
 	}
 
 	
 
 	glfwDestroyWindow(window);
 	glfwTerminate();
-}
\ No newline at end of file
+}
+
+
+
+
+//######################################################################################################
+
+
+
+
+void Game::initializeHeadless()
+//used instead of initializeWindow(): no window and no OpenGL context are created
+{
+	GraphicsBackend::set(GraphicsBackend::Type::NONE);
+	GameClock::instance().setDeterministic(true);
+	window = nullptr;
+
+	std::cout << "!HEADLESS MODE: NULL GRAPHICS BACKEND AND DETERMINISTIC CLOCK;\n";
+}
+
+
+
+
+//######################################################################################################
+
+
+
+
+void Game::headlessLoop(int numOfTicks)
+{
+	std::cout << "\n========================================================================\n"
+		<< "Starting Headless Loop(" << numOfTicks << " ticks): \n\n";
+
+	auto start = std::chrono::steady_clock::now();
+	auto lastReport = start;
+	int reportTicks = 0;
+
+	for (int tick = 0; tick < numOfTicks && running; ++tick)
+	{
+		PROFILE_ZONE("Game::frame");
+
+		world.update(); //publish streamed Scenes and release a part of the unloaded ones
+		simulateTick();
+		GameClock::instance().advance(physicsEngine.getTimeStep()); //the time doesn't depend on how fast it runs
+		++reportTicks;
+
+		auto now = std::chrono::steady_clock::now();
+		if (now - lastReport >= std::chrono::seconds(1))
+		{
+			std::cout << "Ticks: " << reportTicks << "/s, simulated time: " << GameClock::instance().getTime() << "s\n";
+			reportTicks = 0;
+			lastReport = now;
+		}
+	}
+
+	double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double simulatedTime = GameClock::instance().getTime();
+	std::cout << "Headless loop ended: " << numOfTicks << " ticks, " << simulatedTime << "s simulated in "
+		<< wallTime << "s(" << (wallTime > 0.0 ? simulatedTime / wallTime : 0.0) << "x real time)\n";
+}
+
+
+
+
+//######################################################################################################
+
+
+
+
+void Game::simulateTick()
+//one fixed tick of the input, physics, gameplay and AI
+{
+	PROFILE_ZONE("Game::tick");
+
+	//Send and clear all messages:
+	{
+		PROFILE_ZONE("Game::messages");
+		InputHandler::instance().notify();
+		gameplayHandler.notify();
+		physicsEngine.notify();
+		aiEngine.notify();
+	}
+	graphicsEngine.update();
+
+	//handle Input:
+	InputHandler::instance().update();
+
+	//physics update:
+	physicsEngine.update();
+	//Game logic:
+	gameplayHandler.update();
+	aiEngine.update(physicsEngine.getTimeStep());
+
+	//update camera pos:
+	glm::vec3 newPos = gameplayHandler.getCameraPos(); //the camera position is handled by the gameplay
+														//handler, to handle things like cut scenes
+														//and switching the character controlled by the
+														//player.
+
+	//if (glm::length(graphicsEngine.camPosition - newPos) >= 1.0f)
+	graphicsEngine.camPosition = newPos;
+}
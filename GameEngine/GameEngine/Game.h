@@ -51,6 +51,10 @@ the game and coupling all the engines.
 #include "GameplayHandler.h"
 #include "AIEngine.h"
 #include "NetworkHandler.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "GraphicsBackend.h"
+#include "GameClock.h"
 
 #include "GlobalDefines.h"
 
@@ -62,8 +66,10 @@ class Game
 public:
 
 	void initializeWindow();
+	void initializeHeadless(); //instead of initializeWindow(): null graphics backend and deterministic clock
 	void initializeGame();
 	void gameLoop();
+	void headlessLoop(int numOfTicks); //run the simulation as fast as possible, without rendering
 	void handleMultiplayer(); //ask the player if it wants to play offline, open to lan or
 										//connect to the world of another player and then initializes the networkHandler 
 										//according to it's answer
@@ -71,7 +77,7 @@ public:
 	World world;
 	
 private:
-	GLFWwindow* window; 
+	GLFWwindow* window = nullptr; 
 	bool running = true;
 
 	//Game systems:
@@ -81,7 +87,10 @@ private:
 	AIEngine aiEngine;
 	NetworkHandler networkHandler;
 
+	FramePacket framePackets[2]; //the packet being rendered and the one being filled by the simulation
+
 	//Private funcions:
+	void simulateTick();
 	
 };
 
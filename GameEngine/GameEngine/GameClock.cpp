@@ -0,0 +1,72 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "GameClock.h"
+
+
+//GameClock definitions:
+
+
+GameClock::GameClock()
+	:epoch{ std::chrono::steady_clock::now() }
+{
+
+}
+
+
+//=================================================
+
+
+double GameClock::getTime() const noexcept
+{
+	if (deterministic) return deterministicTime;
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+
+//=================================================
+
+
+unsigned int GameClock::getRandomSeed() const noexcept
+{
+	if (deterministic) return GAME_CLOCK_DETERMINISTIC_SEED;
+	return static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count());
+}
+
+
+//=================================================
+
+
+void GameClock::setDeterministic(bool value) noexcept
+{
+	deterministic = value;
+	deterministicTime = 0.0;
+}
+
+bool GameClock::isDeterministic() const noexcept
+{
+	return deterministic;
+}
+
+void GameClock::advance(double seconds) noexcept
+{
+	if (deterministic) deterministicTime += seconds;
+}
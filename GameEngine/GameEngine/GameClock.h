@@ -0,0 +1,74 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the GameClock class, the time source of
+all the game systems(instead of glfwGetTime(), which needs GLFW to be initialized).
+	By default the clock follows the real time. In deterministic mode(used by the headless mode) it only
+moves when advance() is called, by exactly the time passed, so a simulation that advances it by a fixed
+tick gives the same results in every run, no matter how fast it runs. The random seeds are fixed in
+this mode too(see getRandomSeed()).
+*/
+//#################################################################################
+
+#ifndef GAME_CLOCK
+#define GAME_CLOCK
+
+
+#include <chrono>
+
+#include "GlobalDefines.h"
+
+
+#define GAME_CLOCK_DETERMINISTIC_SEED 20201219u //the seed returned by getRandomSeed() in deterministic mode
+
+
+class GameClock
+{
+public:
+
+	static GameClock& instance()
+	{
+		static GameClock clockInstance;
+		return clockInstance;
+	}
+
+	double getTime() const noexcept; //in seconds
+	unsigned int getRandomSeed() const noexcept; //the seed for the random generators of the systems
+
+	/*
+		setDeterministic - change the mode. The deterministic time starts at 0. It must be set before
+		the systems and the Scenes are created(they take their random seeds when created)
+	*/
+	void setDeterministic(bool) noexcept;
+	bool isDeterministic() const noexcept;
+	void advance(double seconds) noexcept; //move the deterministic time(the real time can't be moved)
+
+private:
+
+	GameClock(); //this class is a singleton
+	GameClock(const GameClock&) = delete;
+
+	std::chrono::steady_clock::time_point epoch;
+	bool deterministic = false;
+	double deterministicTime = 0.0; //note: only the thread that runs the simulation should advance it
+};
+
+
+#endif // !GAME_CLOCK
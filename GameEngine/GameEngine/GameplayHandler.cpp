@@ -20,6 +20,8 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "GameplayHandler.h"
+#include "Profiler.h"
+#include "GameClock.h"
 
 //####################################################
 //GameplayHandler definitions:
@@ -33,30 +35,32 @@ void GameplayHandler::initialize(World* w, GLFWwindow* win)
 
 	
 	//----------------------------------------------------------------
-	//initialize the huds:
+	//initialize the huds(there are none without a window, like with the null graphics backend):
 
 	//initialize the player status bar
-	w->playerStatusBar.images[0].initialize(TextureHandler::instance().get(9), 1, 1);
-	w->playerStatusBar.imagesPositions[0] = glm::vec2(-172.0f / 240.0f, 121.0f / 135.0f);
-	w->playerStatusBar.horizontalPercent[0] = 1.0f;
-
-	w->playerStatusBar.images[1].initialize(TextureHandler::instance().get(10), 1, 1);
-	w->playerStatusBar.imagesPositions[1] = glm::vec2(-172.0f / 240.0f, 106.0f / 135.0f);
-	w->playerStatusBar.horizontalPercent[1] = 1.0f;
+	if (win)
+	{
+		w->playerStatusBar.images[0].initialize(TextureHandler::instance().get(9), 1, 1);
+		w->playerStatusBar.imagesPositions[0] = glm::vec2(-172.0f / 240.0f, 121.0f / 135.0f);
+		w->playerStatusBar.horizontalPercent[0] = 1.0f;
 
-	w->playerStatusBar.images[2].initialize(TextureHandler::instance().get(11), 1, 1);
-	w->playerStatusBar.imagesPositions[2] = glm::vec2(-172.0f / 240.0f, 91.0f / 135.0f);
-	w->playerStatusBar.horizontalPercent[2] = 1.0f;
+		w->playerStatusBar.images[1].initialize(TextureHandler::instance().get(10), 1, 1);
+		w->playerStatusBar.imagesPositions[1] = glm::vec2(-172.0f / 240.0f, 106.0f / 135.0f);
+		w->playerStatusBar.horizontalPercent[1] = 1.0f;
 
-	w->playerStatusBar.images[3].initialize(TextureHandler::instance().get(12), 1, 1);
-	w->playerStatusBar.imagesPositions[3] = glm::vec2(-170.0f / 240.0f, 110.0f / 135.0f);
-	w->playerStatusBar.horizontalPercent[3] = 1.0f;
+		w->playerStatusBar.images[2].initialize(TextureHandler::instance().get(11), 1, 1);
+		w->playerStatusBar.imagesPositions[2] = glm::vec2(-172.0f / 240.0f, 91.0f / 135.0f);
+		w->playerStatusBar.horizontalPercent[2] = 1.0f;
 
+		w->playerStatusBar.images[3].initialize(TextureHandler::instance().get(12), 1, 1);
+		w->playerStatusBar.imagesPositions[3] = glm::vec2(-170.0f / 240.0f, 110.0f / 135.0f);
+		w->playerStatusBar.horizontalPercent[3] = 1.0f;
+	}
 
 	//---------------------------------------------------------------------------------
-	//load effects from file:
+	//load effects from file(not in the headless mode, where no player input starts them):
 
-	loadEffects();
+	if (win) loadEffects();
 }
 
 
@@ -65,6 +69,8 @@ void GameplayHandler::initialize(World* w, GLFWwindow* win)
 
 void GameplayHandler::update()
 {
+	PROFILE_ZONE("GameplayHandler::update");
+
 	//Update the player hud data:
 	myAssert(world->currentScene->getEntity(playerId));
 	CharacterComponent* player = world->currentScene->getCharacterComponent(playerId);
@@ -75,7 +81,7 @@ void GameplayHandler::update()
 	world->playerStatusBar.horizontalPercent[2] = FLOAT_TYPE(player->energy) / player->maxEnergy;
 
 
-	FLOAT_TYPE deltaTime = glfwGetTime() - timer;
+	FLOAT_TYPE deltaTime = GameClock::instance().getTime() - timer;
 
 	//update every character in the scene:
 	for (int i = 0; i < world->currentScene->characterComponents.getSize(); ++i)
@@ -112,7 +118,7 @@ void GameplayHandler::update()
 		{
 			Message msg;
 			msg.type = MessageType::APPLY_FORCE;
-			msg.data = charComp->getEntityId();
+			msg.idata[0] = charComp->getEntityId(); //entities don't fit in the 16 bit data field
 			msg.fdata[0] = resultantForce.x;
 			msg.fdata[1] = resultantForce.y;
 			msg.fdata[2] = resultantForce.z;
@@ -140,15 +146,14 @@ void GameplayHandler::update()
 	handleInteractableObjects();
 
 
-	timer = glfwGetTime();
+	timer = GameClock::instance().getTime();
 
 	//---------------------------
-	double x, y;
-	glfwGetCursorPos(window, &x, &y);
+	glm::vec2 cursorPos = InputHandler::instance().getCursorPos(); //read in the main thread(see InputHandler::poll())
 	Message mousePosMsg;
 	mousePosMsg.type = MessageType::MOUSE_POSITION_NOTIFICATION;
-	mousePosMsg.fdata[0] = x;
-	mousePosMsg.fdata[1] = y;
+	mousePosMsg.fdata[0] = cursorPos.x;
+	mousePosMsg.fdata[1] = cursorPos.y;
 	storeMessage(mousePosMsg);
 }
 
@@ -159,10 +164,10 @@ void GameplayHandler::update()
 void GameplayHandler::setPlayer(int id)
 {
 	myAssert(world->currentScene->getEntity(id));
-	for(int i = 0; i < world->currentScene->characterComponents.getSize(); ++i)
-		if (world->currentScene->characterComponents[i].getEntityId() == id) { world->playerId = id; playerId = id; return; }
+	myAssert(world->currentScene->characterComponents.has(id)); //the player must be a character
 
-	myAssert(false);
+	world->playerId = id;
+	playerId = id;
 }
 
 
@@ -180,7 +185,7 @@ void GameplayHandler::onNotify(Message msg)
 	{
 		CharacterComponent* playerCharComp = world->currentScene->getCharacterComponent(playerId);
 		myAssert(playerCharComp);
-		if (msg.fdata[0] != playerId && msg.fdata[1] != playerId) return ;
+		if (msg.idata[0] != playerId && msg.idata[1] != playerId) return ;
 
 		playerCharComp->onGround = 3;
 		
@@ -42,6 +42,7 @@ components in the game, for giving responses for input messages and also control
 #include "InteractableObjectComponent.h"
 #include "TextureHandler.h"
 #include "ModelComponent.h"
+#include "InputHandling.h"
 
 #include "GlobalDefines.h"
 
@@ -52,7 +53,7 @@ public:
 	/*
 		initialize - initialize the whole class, also loading save data and effects from file.
 		params: a pointer to the world that contain the scenes(this world will be filled with save data)
-				a pointer to a window
+				a pointer to a window(nullptr in the headless mode, then the huds and the effects aren't loaded)
 		//note: will throw if the params are invalid or if the save data cannot be loaded from file
 	*/
 	void initialize(World*, GLFWwindow*);
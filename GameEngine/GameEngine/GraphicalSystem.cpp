@@ -20,6 +20,9 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "GraphicalSystem.h"
+#include "Profiler.h"
+#include "GraphicsBackend.h"
+#include "GameClock.h"
 
 
 
@@ -208,8 +211,9 @@ void GraphicalSystem::initialize(World* w, GLFWwindow* win)
 	//set the world:
 	myAssert(w);
 	world = w;
-	myAssert(win);
 	window = win;
+	if (GraphicsBackend::isNull()) return; //there's no window nor OpenGL context(the headless mode)
+	myAssert(win);
 
 	//=====================================================
 	//load shaders:
@@ -825,8 +829,8 @@ void GraphicalSystem::onNotify(Message msg)
 	if (msg.type == MessageType::PLAY || msg.type == MessageType::STOP)
 	{
 		//std::cout << "NOTIFIED " << msg.fdata[0] << "\n";
-		myAssert(world->currentScene->getEntity(msg.data));
-		ImageComponent* imagComp = world->currentScene->getImageComponent(msg.data);
+		myAssert(world->currentScene->getEntity(msg.idata[0]));
+		ImageComponent* imagComp = world->currentScene->getImageComponent(msg.idata[0]);
 		myAssert(imagComp);
 		msg.type == MessageType::PLAY 
 			? imagComp->play(msg.fdata[1], msg.fdata[0]) 
@@ -853,14 +857,7 @@ void GraphicalSystem::addNormalMap(Entity id, const Texture* nMap)
 {
 	myAssert(world->currentScene->getEntity(id));
 
-	for (int i = 0; i < world->currentScene->imageComponents.getSize(); ++i)
-	{
-		if (world->currentScene->imageComponents[i].getEntityId() == id) 
-		{
-			world->currentScene->imageComponents[i].normalMap = nMap; return; 
-		}
-	}
-	myAssert(false);
+	world->currentScene->getImageComponent(id)->normalMap = nMap;
 }
 
 
@@ -871,14 +868,7 @@ void GraphicalSystem::addEmissionMap(Entity id, const Texture* eMap)
 {
 	myAssert(world->currentScene->getEntity(id));
 
-	for (int i = 0; i < world->currentScene->imageComponents.getSize(); ++i)
-	{
-		if (world->currentScene->imageComponents[i].getEntityId() == id) 
-		{
-			world->currentScene->imageComponents[i].emissionMap = eMap; return;
-		}
-	}
-	myAssert(false);
+	world->currentScene->getImageComponent(id)->emissionMap = eMap;
 }
 
 
@@ -1086,31 +1076,19 @@ glm::mat4 GraphicalSystem::normalizeRows(int nRows, glm::mat4 mat) const noexcep
 inline glm::mat4 GraphicalSystem::getFullTransform(Entity id, FLOAT_TYPE w, FLOAT_TYPE h, FLOAT_TYPE z) const
 {
 	myAssert(world->currentScene->getEntity(id));
-	//glm::mat4 fullTransform = glm::mat4(1.0f);
-
-	glm::vec3 scale(w, h, z);
 
 	const TransformComponent* current = world->currentScene->getTransformComponent(id);
-	//auto tComp = world->currentScene->getTransformComponent(id);
-	//fullTransform = tComp->getTransform();
 
 	//scale the matrix by the sprite scale
+	glm::vec3 scale(w, h, z);
 	scale.x *= current->getScale().x;
 	scale.y *= current->getScale().y;
 	scale.z *= current->getScale().z;
-	glm::mat4 fullTransform = current->getScaledTransform(glm::vec3(scale));
-
-	
 
-	while (current->getParent() >= 0)
-	{
-		//set current to the TransformComponent of it's parent 
-		current = world->currentScene->getTransformComponent(current->getParent());
-		//combine the parent and child transform: (note that the parent's scale will not affect
-		//it childs, this is done by normalizing the columns of the 3x3 uper matrix)
-		fullTransform = normalizeRows(3, current->getTransform()) * fullTransform;
-	}
-	
+	//combine it with the cached transform of the parents(note that the parent's scale will not affect
+	//it childs):
+	glm::mat4 fullTransform;
+	multiplyMat4(current->getParentWorldTransform(), current->getScaledTransform(glm::vec3(scale)), fullTransform);
 	return fullTransform;
 }
 
@@ -1121,23 +1099,8 @@ inline glm::mat4 GraphicalSystem::getFullTransform(Entity id, FLOAT_TYPE w, FLOA
 glm::mat4 GraphicalSystem::getFullTransform2(Entity id) const
 {
 	myAssert(world->currentScene->getEntity(id));
-	// = glm::mat4(1.0f);
-
-	const TransformComponent* current = world->currentScene->getTransformComponent(id);
-	glm::mat4 fullTransform =
-		current->getTransform();
 
-	//const TransformComponent* current = world->currentScene->getTransformComponent(id);
-	while (current->getParent() >= 0)
-	{
-		//set current to the TransformComponent of it's parent
-		current = world->currentScene->getTransformComponent(current->getParent());
-		//combine the parent and child transform: (note that the parent's scale will not affect
-		//it childs, this is done normalizing the columns of the 3x3 uper matrix)
-		fullTransform = normalizeRows(3, current->getTransform()) * fullTransform;
-	}
-
-	return fullTransform;
+	return world->currentScene->getTransformComponent(id)->getWorldTransform();
 }
 
 
@@ -1147,29 +1110,8 @@ glm::mat4 GraphicalSystem::getFullTransform2(Entity id) const
 glm::quat GraphicalSystem::getFullRotationQuaternion(Entity id) const
 {
 	myAssert(world->currentScene->getEntity(id));
-	glm::quat fullQuaternion;
-
 
-	//iterate over all TransformComponents 
-	for (int i = 0; i < world->currentScene->transformComponents.getSize(); ++i)
-	{
-		if (world->currentScene->transformComponents[i].getEntityId() == id)
-		{
-			fullQuaternion = world->currentScene->transformComponents[i].getOrientation();
-
-			const TransformComponent* current = &(world->currentScene->transformComponents[i]);
-			while (current->getParent() >= 0)
-			{
-				//set current to the TransformComponent of it's parent
-				current = world->currentScene->getTransformComponent(current->getParent());
-				//combine the parent and child transform: (note that the parent's scale will not affect
-				//it childs, this is done normalizing the columns of the 3x3 uper matrix)
-				fullQuaternion = current->getOrientation() * fullQuaternion;
-			}
-			break;
-		}
-	}
-	return fullQuaternion;
+	return world->currentScene->getTransformComponent(id)->getWorldOrientation();
 }
 
 
@@ -1178,6 +1120,8 @@ glm::quat GraphicalSystem::getFullRotationQuaternion(Entity id) const
 
 void GraphicalSystem::renderDepthMaps()
 {
+	PROFILE_ZONE("Render::depthMaps");
+
 	//set the framebuffer:
 	glBindFramebuffer(GL_FRAMEBUFFER, shadowFrameBuffer);
 	glDepthFunc(GL_LEQUAL);
@@ -1191,26 +1135,20 @@ void GraphicalSystem::renderDepthMaps()
 	glUseProgram(programs[1].getId());
 	glm::mat4 viewAndProj;
 	glm::vec3 lightPos;
-	//render the scene for each directional light:
-	for (int i = 0; i < world->currentScene->dirLightComponents.getSize(); ++i)
+	//render the scene for each directional light(their matrices were computed by captureFrame()):
+	for (const FramePacket::DirLightDraw& dirLight : frame->dirLights)
 	{
-		DirLightComponent* dirLightComp = &(world->currentScene->dirLightComponents[i]);
-
-		if (!dirLightComp->actived || !dirLightComp->shadowCaster)
+		if (!dirLight.shadowCaster)
 			continue;
 
-		myAssert(dirLightComp);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dirLightComp->depthTexture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dirLight.depthTexture, 0);
 		glClear(GL_DEPTH_BUFFER_BIT);
-
-		lightPos = glm::vec3(getFullTransform2(dirLightComp->getEntityId()) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
-		dirLightComp->updateMatrix(lightPos);
 		
 		//set the matrix to the light point of view:
 		//viewAndProj = glm::ortho(-400.0f, 400.0f, -400.0f, 400.0f, 0.1f, 400.0f) *
 		//	glm::lookAt(lightPos, lightPos + iter->direction, glm::vec3(0.0f, 1.0f, 0.0f));
 		//render the full scene to the shadowFrameBuffer's depth buffer
-		renderSceneGeometry(programs[1], dirLightComp->lightMatrix);
+		renderSceneGeometry(programs[1], dirLight.lightMatrix);
 	}
 
 
@@ -1225,14 +1163,12 @@ void GraphicalSystem::renderDepthMaps()
 	glUseProgram(programs[6].getId());
 
 	glm::mat4 lightProj;
-	for (int i = 0; i < world->currentScene->pointLightComponents.getSize(); ++i)
+	for (const FramePacket::PointLightDraw& pointLight : frame->pointLights)
 	{
-		PointLightComponent* pointLightComp = &(world->currentScene->pointLightComponents[i]);
-
-		if (!pointLightComp->actived)
+		if (!pointLight.actived)
 			continue;
 
-		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, pointLightComp->depthCubeMap, 0);
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, pointLight.depthCubeMap, 0);
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 			myAssert(false);
 
@@ -1242,9 +1178,7 @@ void GraphicalSystem::renderDepthMaps()
 		//set the light specific variables:
 		FLOAT_TYPE farPlane = 800.0f;
 
-		lightPos = glm::vec3(getFullTransform2(pointLightComp->getEntityId()) * glm::vec4(glm::vec3(0.0f), 1.0f));
-
-		pointLightComp->updateMatrices(lightPos);
+		lightPos = pointLight.position;
 
 		//set uniforms:
 		programs[6].setVec3("lightPos", lightPos);
@@ -1252,22 +1186,22 @@ void GraphicalSystem::renderDepthMaps()
 
 		//programs[6].setMat4("faceMatrices[0]", pointLightComp->posXDepthMapMatrix);
 		glUniformMatrix4fv(glGetUniformLocation(programs[6].getId(), "faceMatrices[0]"),
-			1, GL_FALSE, glm::value_ptr(pointLightComp->posXDepthMapMatrix));
+			1, GL_FALSE, glm::value_ptr(pointLight.faceMatrices[0]));
 		//programs[6].setMat4("faceMatrices[1]", pointLightComp->negXDepthMapMatrix);
 		glUniformMatrix4fv(glGetUniformLocation(programs[6].getId(), "faceMatrices[1]"),
-			1, GL_FALSE, glm::value_ptr(pointLightComp->negXDepthMapMatrix));
+			1, GL_FALSE, glm::value_ptr(pointLight.faceMatrices[1]));
 		//programs[6].setMat4("faceMatrices[2]", pointLightComp->posYDepthMapMatrix);
 		glUniformMatrix4fv(glGetUniformLocation(programs[6].getId(), "faceMatrices[2]"),
-			1, GL_FALSE, glm::value_ptr(pointLightComp->posYDepthMapMatrix));
+			1, GL_FALSE, glm::value_ptr(pointLight.faceMatrices[2]));
 		//programs[6].setMat4("faceMatrices[3]", pointLightComp->negYDepthMapMatrix);
 		glUniformMatrix4fv(glGetUniformLocation(programs[6].getId(), "faceMatrices[3]"),
-			1, GL_FALSE, glm::value_ptr(pointLightComp->negYDepthMapMatrix));
+			1, GL_FALSE, glm::value_ptr(pointLight.faceMatrices[3]));
 		//programs[6].setMat4("faceMatrices[4]", pointLightComp->posZDepthMapMatrix);
 		glUniformMatrix4fv(glGetUniformLocation(programs[6].getId(), "faceMatrices[4]"),
-			1, GL_FALSE, glm::value_ptr(pointLightComp->posZDepthMapMatrix));
+			1, GL_FALSE, glm::value_ptr(pointLight.faceMatrices[4]));
 		//programs[6].setMat4("faceMatrices[5]", pointLightComp->negZDepthMapMatrix);
 		glUniformMatrix4fv(glGetUniformLocation(programs[6].getId(), "faceMatrices[5]"),
-			1, GL_FALSE, glm::value_ptr(pointLightComp->negZDepthMapMatrix));
+			1, GL_FALSE, glm::value_ptr(pointLight.faceMatrices[5]));
 
 		//and them draw to the point light depth buffer:
 
@@ -1289,6 +1223,7 @@ void GraphicalSystem::renderDepthMaps()
 
 void GraphicalSystem::renderLightMap()
 {
+	PROFILE_ZONE("Render::lightMap");
 
 	glBindFramebuffer(GL_FRAMEBUFFER, lightningFrameBuffer);
 	glViewport(0, 0, bufferDefaultSize.x, bufferDefaultSize.y);
@@ -1392,6 +1327,8 @@ void GraphicalSystem::renderLightMap()
 
 void GraphicalSystem::applyBloom()
 {
+	PROFILE_ZONE("Render::bloom");
+
 	glViewport(0, 0, bufferDefaultSize.x / 4, bufferDefaultSize.y / 4);
 
 	bool horizontal = true, firstIteration = true;
@@ -1428,6 +1365,8 @@ void GraphicalSystem::applyBloom()
 //this function blurries the upper part of the screen, to boost the notion of perspective
 void GraphicalSystem::applyBlur()
 {
+	PROFILE_ZONE("Render::blur");
+
 	glBindFramebuffer(GL_FRAMEBUFFER, blurPingPongFrameBuffers[0]);
 	glViewport(0, 0, bufferDefaultSize.x, bufferDefaultSize.y);
 
@@ -1459,6 +1398,8 @@ void GraphicalSystem::applyBlur()
 
 void GraphicalSystem::drawHuds(int offset, int width ,int height)
 {
+	PROFILE_ZONE("Render::huds");
+
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glViewport(offset, 0, width - (2 * offset), height);
 	glDisable(GL_DEPTH_TEST);
@@ -1469,17 +1410,17 @@ void GraphicalSystem::drawHuds(int offset, int width ,int height)
 	glm::vec2 position;
 	glm::vec2 size;
 
-	for (int i = 0; i < world->playerStatusBar.numberOfImages; ++i)
+	for (const FramePacket::HudImageDraw& hudImage : frame->hudImages)
 	{
-		position = world->playerStatusBar.getSpritePos(i);
-		size = glm::vec2(world->playerStatusBar.getImage(i)->width, world->playerStatusBar.getImage(i)->height);
+		position = hudImage.position;
+		size = hudImage.size;
 		programs[11].setVec2("hudPos", position.x, position.y);
 		programs[11].setVec2("hudSize", size.x, size.y);
 		programs[11].setVec2("screenSize", width, height);
-		programs[11].setFLOAT_TYPE("horizontalPercent", world->playerStatusBar.getSpriteHorizontalPercent(i));
+		programs[11].setFLOAT_TYPE("horizontalPercent", hudImage.horizontalPercent);
 
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, world->playerStatusBar.getImage(i)->getTexture()->getGlId());
+		glBindTexture(GL_TEXTURE_2D, hudImage.texture);
 
 		programs[11].setInt("tex", 0);
 
@@ -1494,6 +1435,8 @@ void GraphicalSystem::drawHuds(int offset, int width ,int height)
 
 void GraphicalSystem::drawCursor(int offset, int width, int height)
 {
+	PROFILE_ZONE("Render::cursor");
+
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glViewport(offset, 0, width - (2 * offset) , height);
 	glDisable(GL_DEPTH_TEST);
@@ -1505,7 +1448,7 @@ void GraphicalSystem::drawCursor(int offset, int width, int height)
 	glBindTexture(GL_TEXTURE_2D, cursor.getTexture()->getGlId()); //bind the mouse texture
 
 	programs[12].setInt("tex", 0);
-	programs[12].setVec2("mousePos", cursorPos.x, cursorPos.y);
+	programs[12].setVec2("mousePos", frame->cursorPos.x, frame->cursorPos.y);
 	programs[12].setVec2("screenSize", width - (2 * offset), height);
 
 	glBindVertexArray(offscreenVAO); 
@@ -1520,6 +1463,8 @@ void GraphicalSystem::drawCursor(int offset, int width, int height)
 
 void GraphicalSystem::drawPhysicsBoxes(int offset, int width, int height)
 {
+	PROFILE_ZONE("Render::physicsBoxes");
+
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glViewport(offset, 0, width - (2 * offset), height);
 	//glDisable(GL_DEPTH_TEST);
@@ -1537,31 +1482,11 @@ void GraphicalSystem::drawPhysicsBoxes(int offset, int width, int height)
 	
 	programs[13].setMat4("viewAndProj", viewAndProj);
 	 
-	//walk through each physical component and draw their boxes:
-	for (int i = 0; i < world->currentScene->boxRigidBodyComponents.getSize(); ++i)
+	//walk through each captured box(the rigid bodies and the active hit boxes) and draw it:
+	for (const FramePacket::BoxDraw& box : frame->physicsBoxes)
 	{
-		RigidBodyComponent<Box>* boxComp = &(world->currentScene->boxRigidBodyComponents[i]);
-		//if (iter->mass < 0.0f) continue;
-		programs[13].setMat4("model", normalizeRows(3, getFullTransform2(boxComp->getEntityId())));
-		programs[13].setVec3("size", boxComp->getSize());
-		//std::cout << iter->getSize().x << ',' << iter->getSize().y << ',' << iter->getSize().z << '\n';
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-	}
-
-	for (int i = 0; i < world->currentScene->interactableObjectComponents.getSize(); ++i)
-	{
-		InteractableObjectComponent* intObjComp = &(world->currentScene->interactableObjectComponents[i]);
-
-		if (!(intObjComp->isEffectActive))
-			continue;
-
-		glm::mat4 model = intObjComp->transform;
-		//if (intObjComp->holder >= 0)
-		//	model[3] = glm::vec4(world->currentScene->getTransformComponent(intObjComp->holder)->getPosition(), 1.0f);;
-		//model[3] = glm::vec4(intObjComp->hitBox.pos, 1.0f);
-
-		programs[13].setMat4("model", model);
-		programs[13].setVec3("size", intObjComp->hitBox.getSize());
+		programs[13].setMat4("model", box.model);
+		programs[13].setVec3("size", box.size);
 		glDrawArrays(GL_TRIANGLES, 0, 36);
 	}
 
@@ -1576,6 +1501,8 @@ void GraphicalSystem::drawPhysicsBoxes(int offset, int width, int height)
 
 void GraphicalSystem::renderDirLights(int, int, int)
 {
+	PROFILE_ZONE("Render::dirLights");
+
 	glm::mat4 viewAndProj = projection * cameraView;
 
 	glBindFramebuffer(GL_FRAMEBUFFER, offScreenFrameBuffer);
@@ -1603,35 +1530,29 @@ void GraphicalSystem::renderDirLights(int, int, int)
 	glBindTexture(GL_TEXTURE_2D, gAlbedoSpecular);
 	programs[18].setInt("gAlbedoSpec", 2);
 
-	programs[18].setVec3("viewPos", camPosition);
+	programs[18].setVec3("viewPos", frame->camPosition);
 	
 	
 	//glDisable(GL_CULL_FACE);
 
-	for (int i = 0; i < world->currentScene->dirLightComponents.getSize(); ++i)
+	for (const FramePacket::DirLightDraw& dirLight : frame->dirLights) //only the active ones are captured
 	{
-		DirLightComponent* dirLightComp = &(world->currentScene->dirLightComponents[i]);
-		//glm::mat4 model = getFullTransform2(dirLightComp->getEntityId());
-
-		if (!dirLightComp->actived)
-			continue;
-
 		//--------------------------------
 		//lightning pass:
 
 		glBlendEquation(GL_FUNC_ADD);
 		glBlendFunc(GL_ONE, GL_ONE);
 
-		programs[18].setVec3("light.color", dirLightComp->lightColor);
-		programs[18].setVec3("light.direction", -glm::normalize(dirLightComp->direction));
-		programs[18].setMat4("light.pvm", dirLightComp->lightMatrix);
+		programs[18].setVec3("light.color", dirLight.color);
+		programs[18].setVec3("light.direction", -glm::normalize(dirLight.direction));
+		programs[18].setMat4("light.pvm", dirLight.lightMatrix);
 		programs[18].setVec2("screenSize", bufferDefaultSize.x, bufferDefaultSize.y);
 
 
-		if (dirLightComp->shadowCaster)
+		if (dirLight.shadowCaster)
 		{
 			glActiveTexture(GL_TEXTURE3);
-			glBindTexture(GL_TEXTURE_2D, dirLightComp->depthTexture);
+			glBindTexture(GL_TEXTURE_2D, dirLight.depthTexture);
 			programs[18].setInt("shadowMap", 3);
 			programs[18].setBool("useShadowMap", true);
 		}
@@ -1656,6 +1577,8 @@ void GraphicalSystem::renderDirLights(int, int, int)
 
 void GraphicalSystem::renderPointLights(int, int, int)
 {
+	PROFILE_ZONE("Render::pointLights");
+
 	glm::mat4 viewAndProj = projection * cameraView;
 
 	glBindFramebuffer(GL_FRAMEBUFFER, offScreenFrameBuffer);
@@ -1685,7 +1608,7 @@ void GraphicalSystem::renderPointLights(int, int, int)
 	glBindTexture(GL_TEXTURE_2D, gAlbedoSpecular);
 	programs[15].setInt("gAlbedoSpec", 2);
 
-	programs[15].setVec3("viewPos", camPosition);
+	programs[15].setVec3("viewPos", frame->camPosition);
 
 	glEnable(GL_BLEND);
 	glEnable(GL_CULL_FACE);
@@ -1693,10 +1616,9 @@ void GraphicalSystem::renderPointLights(int, int, int)
 	glDisable(GL_DEPTH_TEST);
 	//glDisable(GL_CULL_FACE);
 
-	for (int i = 0; i < world->currentScene->pointLightComponents.getSize(); ++i)
+	for (const FramePacket::PointLightDraw& pointLight : frame->pointLights)
 	{
-		PointLightComponent* pointLightComp = &(world->currentScene->pointLightComponents[i]);
-		glm::mat4 model = getFullTransform2(pointLightComp->getEntityId());
+		const glm::mat4& model = pointLight.model;
 		
 		//--------------------------------
 		//lightning pass:
@@ -1711,19 +1633,18 @@ void GraphicalSystem::renderPointLights(int, int, int)
 		//glEnable(GL_BLEND);
 
 		glActiveTexture(GL_TEXTURE3);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, pointLightComp->depthCubeMap);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, pointLight.depthCubeMap);
 		programs[15].setInt("light.depthCubeMap", 3);
 		programs[15].setInt("light.farPlane", 800);
-		programs[15].setVec3("light.pos",
-			glm::vec3(model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)));
-		programs[15].setVec3("light.color", pointLightComp->lightColor);
-		programs[15].setFLOAT_TYPE("light.kConstant", pointLightComp->constantAttenuation);
-		programs[15].setFLOAT_TYPE("light.kLinear", pointLightComp->linearAttenuation);
-		programs[15].setFLOAT_TYPE("light.kQuadratic", pointLightComp->quadraticAttenuation);
-		programs[15].setFLOAT_TYPE("light.radius", pointLightComp->radius / 2);
+		programs[15].setVec3("light.pos", pointLight.position);
+		programs[15].setVec3("light.color", pointLight.color);
+		programs[15].setFLOAT_TYPE("light.kConstant", pointLight.constantAttenuation);
+		programs[15].setFLOAT_TYPE("light.kLinear", pointLight.linearAttenuation);
+		programs[15].setFLOAT_TYPE("light.kQuadratic", pointLight.quadraticAttenuation);
+		programs[15].setFLOAT_TYPE("light.radius", pointLight.radius / 2);
 
 		programs[15].setVec2("screenSize", bufferDefaultSize.x, bufferDefaultSize.y);
-		programs[15].setFLOAT_TYPE("sphereRadius", pointLightComp->radius / 2);
+		programs[15].setFLOAT_TYPE("sphereRadius", pointLight.radius / 2);
 
 		programs[15].setMat4("model", model);
 		programs[15].setMat4("viewAndProj", viewAndProj);
@@ -1746,6 +1667,8 @@ void GraphicalSystem::renderPointLights(int, int, int)
 
 void GraphicalSystem::renderEmissionMaps(int offset, int width, int height)
 {
+	PROFILE_ZONE("Render::emissionMaps");
+
 	glBindFramebuffer(GL_FRAMEBUFFER, offScreenFrameBuffer);
 	glViewport(0, 0, bufferDefaultSize.x, bufferDefaultSize.y);
 	glEnable(GL_BLEND);
@@ -1775,13 +1698,10 @@ void GraphicalSystem::renderEmissionMaps(int offset, int width, int height)
 
 void GraphicalSystem::renderParticles(int, int, int)
 {
+	PROFILE_ZONE("Render::particles");
+
 	glm::mat4 viewAndProj = projection * cameraView;
-	int i = 0;
-	int j = 0;
-	static float positions[3 * 200];
-	static float colors[4 * 200];
-	int pCount = world->currentScene->particleSystem.particlePool.size();
-	int count = 0;
+	int pCount = int(frame->particlePositions.size()); //only the alive particles are captured
 	
 
 
@@ -1801,41 +1721,53 @@ void GraphicalSystem::renderParticles(int, int, int)
 	glUniformMatrix4fv(glGetUniformLocation(programs[20].getId(), "projAndView"), 1, GL_FALSE, glm::value_ptr(viewAndProj));
 	
 
-	for(i = 0; i < pCount; ++i) //draw the particles as instanced points, 500 each time
+	for (int first = 0; first < pCount; first += 200) //draw the particles as instanced points, 200 each time
 	{
-		if (world->currentScene->particleSystem.particlePool.particles[i].life <= 0)
-			continue;
+		int count = pCount - first < 200 ? pCount - first : 200;
+
+		//configure uniforms and draw(the packet arrays are already packed): 
+		glUniform3fv(glGetUniformLocation(programs[20].getId(), "positions"), count, 
+			glm::value_ptr(frame->particlePositions[first]));
+		glUniform4fv(glGetUniformLocation(programs[20].getId(), "colors"), count, 
+			glm::value_ptr(frame->particleColors[first]));
+		glDrawArraysInstanced(GL_POINTS, 0, 1, count);
+	}
 
-		//fill the positions and colors arrays
-		glm::vec3 pos = world->currentScene->particleSystem.particlePool.particles[i].position;
-		glm::vec4 color = world->currentScene->particleSystem.particlePool.particles[i].color;
 
-		positions[(j * 3) + 0] = pos.x;
-		positions[(j * 3) + 1] = pos.y;
-		positions[(j * 3) + 2] = pos.z;
+	glDisable(GL_BLEND);
+}
 
-		colors[(j * 4) + 0] = color.x;
-		colors[(j * 4) + 1] = color.y;
-		colors[(j * 4) + 2] = color.z;
-		colors[(j * 4) + 3] = color.w;
-		
-		++j;
 
-		if (j == 200 || (i == pCount && j != 0))
-		{
-			//configure uniforms and draw: 
-			glUniform3fv(glGetUniformLocation(programs[20].getId(), "positions"), j, &(positions[0]));
-			glUniform4fv(glGetUniformLocation(programs[20].getId(), "colors"), j, &(colors[0]));
-			//std::cout << "->>" << j << '\n';
-			glDrawArraysInstanced(GL_POINTS, 0, 1, j);
+//---------------------------------------------------------------------------------------------------------
 
-			j = 0;
-		}
-	
-	}
 
+void GraphicalSystem::sampleAnimations(FLOAT_TYPE alpha)
+//each component only writes its own bone transforms(the models are just read), so they can be computed in parallel
+{
+	PROFILE_ZONE("GraphicalSystem::sampleAnimations");
 
-	glDisable(GL_BLEND);
+	Scene* scene = world->currentScene;
+	FLOAT_TYPE time = FLOAT_TYPE(GameClock::instance().getTime());
+
+	JobSystem::instance().parallelForEach(scene->modelComponents, ANIMATION_GRAIN_SIZE, [time](ModelComponent& modelComp) {
+		if (!modelComp.model || modelComp.model->mBoneData.empty() || modelComp.model->sceneData.animations.empty())
+			return;
+
+		FLOAT_TYPE duration = FLOAT_TYPE(modelComp.model->sceneData.animations[0].duration) 
+			/ modelComp.model->sceneData.animations[0].ticksPerSecond;
+
+		std::vector<glm::mat4> transforms;
+		modelComp.boneTransform(0, std::fmod(time, duration), transforms); //updates modelComp.mBoneTransforms
+	});
+
+	JobSystem::instance().parallelForEach(scene->characterComponents, ANIMATION_GRAIN_SIZE, [this, alpha](CharacterComponent& charComp) {
+		const Model* charModel = charComp.getModel();
+		if (!charComp.isActived() || !charModel || charModel->mBoneData.empty() || charModel->sceneData.animations.empty())
+			return;
+
+		std::vector<glm::mat4> transforms;
+		charComp.boneTransform(charComp.getCurrentAnimation(), getAnimationTime(charComp, alpha), transforms);
+	});
 }
 
 
@@ -1844,6 +1776,11 @@ void GraphicalSystem::renderParticles(int, int, int)
 
 void GraphicalSystem::reloadTransforms()
 {
+	PROFILE_ZONE("GraphicalSystem::reloadTransforms");
+
+	//update the world transforms of all the dirty TransformComponents(parents before children, in one pass):
+	world->currentScene->transformHierarchy.update(world->currentScene->transformComponents);
+
 	if (scaledFullTransforms.capacity() < 
 		world->currentScene->imageComponents.getSize() + 
 		world->currentScene->modelComponents.getSize() +
@@ -1853,33 +1790,29 @@ void GraphicalSystem::reloadTransforms()
 		scaledFullTransforms.reserve((scaledFullTransforms.capacity() > 10 ? scaledFullTransforms.capacity() : 10) * 2);
 	}
 	scaledFullTransforms.clear(); //reset objects and size, but not the capacity
+	scaledFullTransformIndices.assign(scaledFullTransformIndices.size(), -1);
 
 	//load all transform components from all Entities that have a ImageComponent, ModelComponent or intObjComp
 	for (int i = 0; i < world->currentScene->imageComponents.getSize(); ++i)
 	{
 		const ImageComponent* imagComp = &(world->currentScene->imageComponents[i]);
-		scaledFullTransforms.push_back(
-			std::pair<glm::mat4, Entity>(
-				getFullTransform(imagComp->getEntityId(), imagComp->spt.width, imagComp->spt.height), 
-				imagComp->getEntityId()));
+		addScaledFullTransform(imagComp->getEntityId(), 
+			getFullTransform(imagComp->getEntityId(), imagComp->spt.width, imagComp->spt.height));
 	}
 	for (int i = 0; i < world->currentScene->modelComponents.getSize(); ++i)
 	{
 		Entity eId = world->currentScene->modelComponents[i].getEntityId();
-		scaledFullTransforms.push_back(
-			std::pair<glm::mat4, Entity>(getFullTransform(eId, 1.0f, 1.0f), eId));
+		addScaledFullTransform(eId, getFullTransform(eId, 1.0f, 1.0f));
 	}
 	for (int i = 0; i < world->currentScene->interactableObjectComponents.getSize(); ++i)
 	{
-		const InteractableObjectComponent* intObjComp = &(world->currentScene->interactableObjectComponents[i]);
-		scaledFullTransforms.push_back(
-			std::pair<glm::mat4, Entity>(getFullTransform(intObjComp->getEntityId(), 1.0f, 1.0f), intObjComp->getEntityId()));
+		Entity eId = world->currentScene->interactableObjectComponents[i].getEntityId();
+		addScaledFullTransform(eId, getFullTransform(eId, 1.0f, 1.0f));
 	}
 	for (int i = 0; i < world->currentScene->characterComponents.getSize(); ++i)
 	{
 		Entity eId = world->currentScene->characterComponents[i].getEntityId();
-		scaledFullTransforms.push_back(
-			std::pair<glm::mat4, Entity>(getFullTransform(eId, 1.0f, 1.0f), eId));
+		addScaledFullTransform(eId, getFullTransform(eId, 1.0f, 1.0f));
 	}
 
 }
@@ -1888,10 +1821,31 @@ void GraphicalSystem::reloadTransforms()
 //---------------------------------------------------------------------------------------------------------
 
 
+void GraphicalSystem::addScaledFullTransform(Entity id, const glm::mat4& transform)
+{
+	int index = entityIndex(id);
+	if (index >= int(scaledFullTransformIndices.size()))
+		scaledFullTransformIndices.resize(index + 1, -1);
+
+	//an entity with more than one of these components uses the transform of the first one:
+	if (scaledFullTransformIndices[index] >= 0) return;
+
+	scaledFullTransformIndices[index] = int(scaledFullTransforms.size());
+	scaledFullTransforms.push_back(std::pair<glm::mat4, Entity>(transform, id));
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
 glm::mat4 GraphicalSystem::getScaledFullTransfom(Entity id) const
 {
-	for (int i = 0; i < scaledFullTransforms.size(); ++i)
-		if (scaledFullTransforms[i].second == id) return scaledFullTransforms[i].first;
+	int index = id >= 0 ? entityIndex(id) : -1;
+	if (index >= 0 && index < int(scaledFullTransformIndices.size()) && scaledFullTransformIndices[index] >= 0)
+	{
+		const std::pair<glm::mat4, int>& entry = scaledFullTransforms[scaledFullTransformIndices[index]];
+		if (entry.second == id) return entry.first;
+	}
 	myAssert(false); //entity not found
 	return identityMatrix;
 }
@@ -1900,20 +1854,399 @@ glm::mat4 GraphicalSystem::getScaledFullTransfom(Entity id) const
 //---------------------------------------------------------------------------------------------------------
 
 
-void GraphicalSystem::render(int offset, int width, int height)
+void GraphicalSystem::captureBones(FramePacket& packet, FramePacket::ModelDraw& draw, const std::vector<glm::mat4>& boneTransforms)
 {
-	
-	glfwSwapBuffers(window);
-	
-	
+	draw.firstBone = int(packet.bones.size());
+	draw.numOfBones = 0;
+	if (draw.mesh->mBoneData.empty() || draw.mesh->sceneData.animations.empty() || boneTransforms.empty())
+		return;
+
+	packet.bones.insert(packet.bones.end(), boneTransforms.begin(), boneTransforms.end());
+	draw.numOfBones = int(boneTransforms.size());
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
+glm::mat4 GraphicalSystem::getDrawTransform(const ImageComponent& imagComp) const
+{
+	return getScaledFullTransfom(imagComp.getEntityId());
+}
+
+glm::mat4 GraphicalSystem::getDrawTransform(const ModelComponent& modelComp) const
+{
+	glm::mat4 model = getScaledFullTransfom(modelComp.getEntityId());
+	model[3] += glm::vec4(modelComp.pos, 0.0f);
+	return model;
+}
+
+glm::mat4 GraphicalSystem::getDrawTransform(const InteractableObjectComponent& intObjComp) const
+{
+	//if the object is holded by some character, it uses the character transform instead of its own:
+	const CharacterComponent* charComp = intObjComp.holder >= 0 
+		? world->currentScene->getCharacterComponent(intObjComp.holder) : nullptr;
+	if (charComp)
+		return getDrawTransform(*charComp);
+
+	glm::mat4 model = intObjComp.transform * getScaledFullTransfom(intObjComp.getEntityId());
+	model[3] += glm::vec4(intObjComp.pos, 0.0f);
+	return model;
+}
+
+glm::mat4 GraphicalSystem::getDrawTransform(const CharacterComponent& charComp) const
+{
+	glm::mat4 model = getScaledFullTransfom(charComp.getEntityId());
+	model[3] += glm::vec4(charComp.getModelPos(), 0.0f);
+
+	//rotate according to the direction the character is facing
+	return model * glm::rotate(glm::mat4(1.0), charComp.getDirection() * glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
+void GraphicalSystem::recordTick()
+{
+	PROFILE_ZONE("GraphicalSystem::recordTick");
+
+	Scene* scene = world->currentScene;
+	reloadTransforms();
+	++recordedTick;
+	tickCamPosition = camPosition;
+	tickCamDirection = camDirection;
+
+	for (int i = 0; i < scene->imageComponents.getSize(); ++i)
+		if (scene->imageComponents[i].actived)
+			storeTickState(IMAGE_DRAW, scene->imageComponents[i].getEntityId(), getDrawTransform(scene->imageComponents[i]));
+
+	for (int i = 0; i < scene->modelComponents.getSize(); ++i)
+		storeTickState(MODEL_DRAW, scene->modelComponents[i].getEntityId(), getDrawTransform(scene->modelComponents[i]));
+
+	for (int i = 0; i < scene->interactableObjectComponents.getSize(); ++i)
+	{
+		const InteractableObjectComponent& intObjComp = scene->interactableObjectComponents[i];
+		if (intObjComp.model)
+			storeTickState(INTERACTABLE_DRAW, intObjComp.getEntityId(), getDrawTransform(intObjComp));
+	}
+
+	for (int i = 0; i < scene->characterComponents.getSize(); ++i)
+	{
+		const CharacterComponent& charComp = scene->characterComponents[i];
+		if (charComp.getModel())
+			storeTickState(CHARACTER_DRAW, charComp.getEntityId(), getDrawTransform(charComp), charComp.getCurrentAnimation(),
+				charComp.getAnimationTime());
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
+void GraphicalSystem::storeTickState(DrawKind kind, Entity id, const glm::mat4& model, int animation, FLOAT_TYPE animationTime)
+{
+	std::vector<TickState>& states = tickStates[kind];
+	int index = entityIndex(id);
+	if (index >= int(states.size()))
+		states.resize(index + 1);
+
+	TickState& state = states[index];
+	state.entity = id;
+	state.tick = recordedTick;
+	state.model = model;
+	state.animation = animation;
+	state.animationTime = animationTime;
+}
+
+const GraphicalSystem::TickState* GraphicalSystem::getTickState(DrawKind kind, Entity id) const noexcept
+{
+	const std::vector<TickState>& states = tickStates[kind];
+	int index = entityIndex(id);
+	if (index >= int(states.size()) || states[index].entity != id || states[index].tick != recordedTick)
+		return nullptr; //it didn't exist(or wasn't drawn) before the last tick
+	return &states[index];
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
+static glm::mat4 interpolateTransform(const glm::mat4& from, const glm::mat4& to, FLOAT_TYPE alpha)
+//the translations and the scales are interpolated linearly, and the rotations with a slerp
+{
+	glm::vec3 fromScale(glm::length(glm::vec3(from[0])), glm::length(glm::vec3(from[1])), glm::length(glm::vec3(from[2])));
+	glm::vec3 toScale(glm::length(glm::vec3(to[0])), glm::length(glm::vec3(to[1])), glm::length(glm::vec3(to[2])));
+	if (glm::determinant(glm::mat3(from)) * glm::determinant(glm::mat3(to)) <= 0.0f 
+		|| fromScale.x * fromScale.y * fromScale.z == 0.0f || toScale.x * toScale.y * toScale.z == 0.0f)
+		return to; //a mirrored or flat transform(it doesn't have a rotation to interpolate)
+
+	glm::quat fromRotation = glm::quat_cast(glm::mat3(glm::vec3(from[0]) / fromScale.x, glm::vec3(from[1]) / fromScale.y,
+		glm::vec3(from[2]) / fromScale.z));
+	glm::quat toRotation = glm::quat_cast(glm::mat3(glm::vec3(to[0]) / toScale.x, glm::vec3(to[1]) / toScale.y,
+		glm::vec3(to[2]) / toScale.z));
+
+	glm::mat4 result = glm::mat4_cast(glm::slerp(fromRotation, toRotation, alpha));
+	glm::vec3 scale = glm::mix(fromScale, toScale, alpha);
+	result[0] *= scale.x;
+	result[1] *= scale.y;
+	result[2] *= scale.z;
+	result[3] = glm::mix(from[3], to[3], alpha);
+	return result;
+}
+
+glm::mat4 GraphicalSystem::interpolateDraw(DrawKind kind, Entity id, const glm::mat4& model, FLOAT_TYPE alpha) const
+{
+	if (alpha >= 1.0f) return model;
+
+	const TickState* state = getTickState(kind, id);
+	if (!state || state->model == model) return model;
+	return interpolateTransform(state->model, model, alpha);
+}
+
+FLOAT_TYPE GraphicalSystem::getAnimationTime(const CharacterComponent& charComp, FLOAT_TYPE alpha) const
+{
+	FLOAT_TYPE time = charComp.getAnimationTime();
+	if (alpha >= 1.0f) return time;
+
+	const TickState* state = getTickState(CHARACTER_DRAW, charComp.getEntityId());
+	if (!state || state->animation != charComp.getCurrentAnimation()) return time; //a new animation starts at its beginning
+
+	//the time is wrapped at the end of the animation:
+	FLOAT_TYPE duration = FLOAT_TYPE(charComp.getModel()->sceneData.animations[state->animation].duration);
+	if (time < state->animationTime) time += duration;
+	time = state->animationTime + alpha * (time - state->animationTime);
+	return time >= duration ? time - duration : time;
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
+void GraphicalSystem::captureFrame(FramePacket& packet, FLOAT_TYPE alpha)
+{
+	PROFILE_ZONE("GraphicalSystem::captureFrame");
+
+	Scene* scene = world->currentScene;
+	if (recordedTick == 0) alpha = 1.0f; //there's nothing to interpolate from
 
 	//==================================================
-	//reload transforms:
+	//reload transforms and animations:
 	reloadTransforms();
+	sampleAnimations(alpha);
+
+	packet.clear();
+	packet.camPosition = alpha < 1.0f ? glm::mix(tickCamPosition, camPosition, alpha) : camPosition;
+	packet.camDirection = alpha < 1.0f ? glm::mix(tickCamDirection, camDirection, alpha) : camDirection;
+	packet.cursorPos = cursorPos;
+
+	//==================================================
+	//images:
+	for (int i = 0; i < scene->imageComponents.getSize(); ++i)
+	{
+		const ImageComponent* imagComp = &(scene->imageComponents[i]);
+		if (!imagComp->actived)
+			continue;
+
+		FramePacket::SpriteDraw sprite;
+		sprite.model = interpolateDraw(IMAGE_DRAW, imagComp->getEntityId(), getDrawTransform(*imagComp), alpha);
+		sprite.texture = imagComp->spt.getTexture()->getGlId();
+		sprite.normalMap = imagComp->normalMap ? imagComp->normalMap->getGlId() : 0;
+		sprite.emissionMap = imagComp->emissionMap ? imagComp->emissionMap->getGlId() : 0;
+		sprite.rows = imagComp->spt.rows;
+		sprite.columns = imagComp->spt.columns;
+		sprite.row = imagComp->spt.currentRow;
+		sprite.column = imagComp->spt.currentColumn;
+		packet.images.push_back(sprite);
+	}
+
+	//==================================================
+	//models:
+	FramePacket::ModelDraw draw;
+	for (int i = 0; i < scene->modelComponents.getSize(); ++i)
+	{
+		const ModelComponent* modelComp = &(scene->modelComponents[i]);
+		myAssert(modelComp->model);
+
+		draw.model = interpolateDraw(MODEL_DRAW, modelComp->getEntityId(), getDrawTransform(*modelComp), alpha);
+		draw.mesh = modelComp->model;
+		draw.rows = modelComp->model->mMaterial.animations;
+		draw.columns = modelComp->model->mMaterial.framesPerAnimation;
+		draw.row = modelComp->currentRow;
+		draw.column = modelComp->currentColumn;
+		draw.actived = true;
+		captureBones(packet, draw, modelComp->mBoneTransforms);
+		packet.models.push_back(draw);
+	}
+
+	//the models of the InteractableObjectComponents:
+	for (int i = 0; i < scene->interactableObjectComponents.getSize(); ++i)
+	{
+		InteractableObjectComponent* intObjComp = &(scene->interactableObjectComponents[i]);
+		if (intObjComp->model == nullptr)
+			continue;
+
+		//see if the object is holded by some character:
+		const CharacterComponent* charComp = intObjComp->holder >= 0 
+			? scene->getCharacterComponent(intObjComp->holder) : nullptr;
+
+		draw.model = interpolateDraw(INTERACTABLE_DRAW, intObjComp->getEntityId(), getDrawTransform(*intObjComp), alpha);
+		draw.mesh = intObjComp->model;
+		draw.rows = intObjComp->model->mMaterial.animations;
+		draw.columns = intObjComp->model->mMaterial.framesPerAnimation;
+		draw.row = intObjComp->currentRow;
+		draw.column = intObjComp->currentColumn;
+		draw.actived = intObjComp->isActived();
+
+		//if the object is holded by a character, the animation id and time used will be the character ones:
+		if (draw.actived && !intObjComp->model->mBoneData.empty() && !intObjComp->model->sceneData.animations.empty())
+			intObjComp->boneTransform(charComp ? charComp->getCurrentAnimation() : intObjComp->currentAnimation,
+				charComp ? getAnimationTime(*charComp, alpha) : intObjComp->animationTime);
+		captureBones(packet, draw, intObjComp->mBoneTransforms);
+		packet.interactableObjects.push_back(draw);
+	}
+
+	//the models of the CharacterComponents:
+	for (int i = 0; i < scene->characterComponents.getSize(); ++i)
+	{
+		const CharacterComponent* charComp = &(scene->characterComponents[i]);
+		const Model* charModel = charComp->getModel();
+		if (!charModel)
+			continue;
+
+		draw.model = interpolateDraw(CHARACTER_DRAW, charComp->getEntityId(), getDrawTransform(*charComp), alpha);
+		draw.mesh = charModel;
+		draw.rows = charModel->mMaterial.animations;
+		draw.columns = charModel->mMaterial.framesPerAnimation;
+		draw.row = charComp->getCurrentRow();
+		draw.column = charComp->getCurrentColumn();
+		draw.actived = charComp->isActived();
+		captureBones(packet, draw, charComp->mBoneTransforms);
+		packet.characters.push_back(draw);
+	}
+
+	//==================================================
+	//lights(their matrices are updated here, as the renderer can't change the Scene):
+	for (int i = 0; i < scene->dirLightComponents.getSize(); ++i)
+	{
+		DirLightComponent* dirLightComp = &(scene->dirLightComponents[i]);
+		if (!dirLightComp->actived)
+			continue;
+
+		if (dirLightComp->shadowCaster)
+			dirLightComp->updateMatrix(glm::vec3(getFullTransform2(dirLightComp->getEntityId())[3]));
+
+		FramePacket::DirLightDraw dirLight;
+		dirLight.color = dirLightComp->lightColor;
+		dirLight.direction = dirLightComp->direction;
+		dirLight.lightMatrix = dirLightComp->lightMatrix;
+		dirLight.depthTexture = dirLightComp->depthTexture;
+		dirLight.shadowCaster = dirLightComp->shadowCaster;
+		packet.dirLights.push_back(dirLight);
+	}
+
+	for (int i = 0; i < scene->pointLightComponents.getSize(); ++i)
+	{
+		PointLightComponent* pointLightComp = &(scene->pointLightComponents[i]);
+
+		FramePacket::PointLightDraw pointLight;
+		pointLight.model = getFullTransform2(pointLightComp->getEntityId());
+		pointLight.position = glm::vec3(pointLight.model[3]);
+		pointLight.actived = pointLightComp->actived;
+		if (pointLight.actived)
+			pointLightComp->updateMatrices(pointLight.position);
+
+		pointLight.color = pointLightComp->lightColor;
+		pointLight.constantAttenuation = pointLightComp->constantAttenuation;
+		pointLight.linearAttenuation = pointLightComp->linearAttenuation;
+		pointLight.quadraticAttenuation = pointLightComp->quadraticAttenuation;
+		pointLight.radius = pointLightComp->radius;
+		pointLight.faceMatrices[0] = pointLightComp->posXDepthMapMatrix;
+		pointLight.faceMatrices[1] = pointLightComp->negXDepthMapMatrix;
+		pointLight.faceMatrices[2] = pointLightComp->posYDepthMapMatrix;
+		pointLight.faceMatrices[3] = pointLightComp->negYDepthMapMatrix;
+		pointLight.faceMatrices[4] = pointLightComp->posZDepthMapMatrix;
+		pointLight.faceMatrices[5] = pointLightComp->negZDepthMapMatrix;
+		pointLight.depthCubeMap = pointLightComp->depthCubeMap;
+		packet.pointLights.push_back(pointLight);
+	}
+
+	//==================================================
+	//particles(only the alive ones):
+	const ParticlePool& particlePool = scene->particleSystem.particlePool;
+	for (int i = 0; i < particlePool.size(); ++i)
+	{
+		if (particlePool.particles[i].life <= 0)
+			continue;
+
+		packet.particlePositions.push_back(particlePool.particles[i].position);
+		packet.particleColors.push_back(particlePool.particles[i].color);
+	}
+
+	//==================================================
+	//huds(they aren't initialized without a window, see GameplayHandler::initialize()):
+	for (int i = 0; window && i < world->playerStatusBar.numberOfImages; ++i)
+	{
+		const Sprite* image = world->playerStatusBar.getImage(i);
+
+		FramePacket::HudImageDraw hudImage;
+		hudImage.position = world->playerStatusBar.getSpritePos(i);
+		hudImage.size = glm::vec2(image->width, image->height);
+		hudImage.horizontalPercent = world->playerStatusBar.getSpriteHorizontalPercent(i);
+		hudImage.texture = image->getTexture()->getGlId();
+		packet.hudImages.push_back(hudImage);
+	}
+
+	//==================================================
+	//physics boxes(just for debugging):
+	if (!physicsBoxes)
+		return;
+
+	for (int i = 0; i < scene->boxRigidBodyComponents.getSize(); ++i)
+	{
+		const RigidBodyComponent<Box>* boxComp = &(scene->boxRigidBodyComponents[i]);
+		packet.physicsBoxes.push_back({ normalizeRows(3, getFullTransform2(boxComp->getEntityId())), boxComp->getSize() });
+	}
+	for (int i = 0; i < scene->interactableObjectComponents.getSize(); ++i)
+	{
+		const InteractableObjectComponent* intObjComp = &(scene->interactableObjectComponents[i]);
+		if (intObjComp->isEffectActive)
+			packet.physicsBoxes.push_back({ intObjComp->transform, intObjComp->hitBox.getSize() });
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
+void GraphicalSystem::render(int offset, int width, int height)
+//capture the current Scene and draw it right away(without overlapping the simulation and the rendering)
+{
+	captureFrame(ownPacket);
+	render(ownPacket, offset, width, height);
+}
+
+
+//---------------------------------------------------------------------------------------------------------
+
+
+void GraphicalSystem::render(const FramePacket& packet, int offset, int width, int height)
+{
+	PROFILE_ZONE("GraphicalSystem::render");
+
+	if (GraphicsBackend::isNull()) return;
+	frame = &packet; //everything drawn below is read from the packet(the Scene may be changing in another thread)
+
+	{
+		PROFILE_ZONE("Render::swapBuffers"); //it waits for the GPU to finish the previous frame
+		glfwSwapBuffers(window);
+	}
+	
+	
 
 	//==================================================
 	//update camera:
-	cameraView = glm::lookAt(camPosition, camPosition + camDirection, glm::vec3(0.0f, 1.0f, 0.0f));
+	cameraView = glm::lookAt(frame->camPosition, frame->camPosition + frame->camDirection, glm::vec3(0.0f, 1.0f, 0.0f));
 
 	//==================================================================================================
 	//render to the gBuffer
@@ -1939,7 +2272,8 @@ void GraphicalSystem::render(int offset, int width, int height)
 	//configure uniforms:
 	//programs[14].setVec3("viewPos", camPosition);
 
-	glUniform3f(glGetUniformLocation(programs[14].getId(), "viewPos"), camPosition.x, camPosition.y, camPosition.z);
+	glUniform3f(glGetUniformLocation(programs[14].getId(), "viewPos"), frame->camPosition.x, frame->camPosition.y, 
+		frame->camPosition.z);
 
 	
 	glm::mat4 viewAndProj = projection * cameraView;
@@ -1948,7 +2282,10 @@ void GraphicalSystem::render(int offset, int width, int height)
 
 	
 	
-	renderScene(programs[14], viewAndProj, true, true , 50);
+	{
+		PROFILE_ZONE("Render::gBuffer");
+		renderScene(programs[14], viewAndProj, true, true , 50);
+	}
 	
 	//render the particles
 	renderParticles(width, height, offset);
@@ -2020,6 +2357,7 @@ void GraphicalSystem::render(int offset, int width, int height)
 	//====================================================
 	//draw to the default framebuffer
 
+	PROFILE_ZONE("Render::composite");
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glViewport(offset, 0, width - (2*offset) , height);
@@ -2065,11 +2403,14 @@ void GraphicalSystem::render(int offset, int width, int height)
 
 
 
-	//drawPhysicsBoxes(offset, width, height); //used for debugging the physics engine
+	if (physicsBoxes)
+		drawPhysicsBoxes(offset, width, height); //used for debugging the physics engine
 	
 
 	drawHuds(offset, width, height);
 	drawCursor(offset, width, height);
+
+	frame = nullptr;
 }
 
 
@@ -2083,6 +2424,8 @@ void GraphicalSystem::render(int offset, int width, int height)
 
 void GraphicalSystem::update()
 {
+	PROFILE_ZONE("GraphicalSystem::update");
+
 	//update graphical components:
 	for (int i = 0; i < world->currentScene->imageComponents.getSize(); ++i)
 		world->currentScene->imageComponents[i].update();
@@ -2111,35 +2454,32 @@ void GraphicalSystem::renderSceneImages(ShaderProgram& shader,
 
 	glm::mat4 model(1.0f);
 	glBindVertexArray(spriteVAO);
-	for (int i = 0; i < world->currentScene->imageComponents.getSize(); ++i)
+	for (const FramePacket::SpriteDraw& sprite : frame->images) //only the active ImageComponents are captured
 	{
-		ImageComponent* imagComp = &(world->currentScene->imageComponents[i]);
-		if (!imagComp->actived)
-			continue;
 		//glUseProgram(programs[0].getId());
 
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, (*imagComp).spt.getTexture()->getGlId());
+		glBindTexture(GL_TEXTURE_2D, sprite.texture);
 		//shader.setInt("tex", 0);
 		glUniform1i(glGetUniformLocation(shader.getId(), "tex"), 0);
 
 
 
-		if (useNormalMaps && imagComp->normalMap)
+		if (useNormalMaps && sprite.normalMap)
 		{
 			shader.setBool("useNormalMap", true);
 			glActiveTexture(GL_TEXTURE1);
-			glBindTexture(GL_TEXTURE_2D, imagComp->normalMap->getGlId());
+			glBindTexture(GL_TEXTURE_2D, sprite.normalMap);
 			shader.setInt("normalsTex", 1);
 		}
 		else
 			shader.setBool("useNormalMap", false);
 
-		if (useEmissionMaps && imagComp->emissionMap)
+		if (useEmissionMaps && sprite.emissionMap)
 		{
 			shader.setBool("useEmissionMap", true);
 			glActiveTexture(GL_TEXTURE2);
-			glBindTexture(GL_TEXTURE_2D, imagComp->emissionMap->getGlId());
+			glBindTexture(GL_TEXTURE_2D, sprite.emissionMap);
 			shader.setInt("emissionTex", 2);
 		}
 		else shader.setBool("useEmissionMap", false);
@@ -2149,7 +2489,7 @@ void GraphicalSystem::renderSceneImages(ShaderProgram& shader,
 		shader.setFLOAT_TYPE("materialSpecular", 32.0f);
 
 		//get the transformation matrix:
-		model = getScaledFullTransfom(imagComp->getEntityId());//getFullTransform(imagComp->getEntityId(), imagComp->spt.width, imagComp->spt.height);
+		model = sprite.model;
 
 		
 		glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "model"), 1, GL_FALSE, glm::value_ptr(model));
@@ -2157,10 +2497,10 @@ void GraphicalSystem::renderSceneImages(ShaderProgram& shader,
 			glm::value_ptr(glm::mat3(glm::transpose(glm::inverse(model)))));
 
 		glUniform1i(glGetUniformLocation(shader.getId(), "modelSpriteSheet"), false);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), imagComp->spt.rows);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), imagComp->spt.columns);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), imagComp->spt.currentRow);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), imagComp->spt.currentColumn);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), sprite.rows);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), sprite.columns);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), sprite.row);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), sprite.column);
 
 
 		glDrawArrays(GL_TRIANGLES, 0, 12);
@@ -2185,64 +2525,52 @@ void GraphicalSystem::renderSceneModels(ShaderProgram& shader,
 	glCullFace(GL_BACK);
 
 	glm::mat4 model(1.0f);
-	for (int i = 0; i < world->currentScene->modelComponents.getSize(); ++i)
+	for (const FramePacket::ModelDraw& draw : frame->models)
 	{
-		ModelComponent* modelComp = &(world->currentScene->modelComponents[i]);
-		myAssert(modelComp && modelComp->model);
-		//std::cout << "-> Size: " << modelComp->model->mEntries[0].materialIndex << '\n';
+		const Model* mesh = draw.mesh;
+		myAssert(mesh);
 
 		//configure animation data:
 		glUniform1i(glGetUniformLocation(shader.getId(), "modelSpriteSheet"), false);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), modelComp->model->mMaterial.animations);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), modelComp->model->mMaterial.framesPerAnimation);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), modelComp->currentRow);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), modelComp->currentColumn);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), mesh->mMaterial.animations);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), mesh->mMaterial.framesPerAnimation);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), draw.row);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), draw.column);
 
 		//-------------------------------------------------------
 		//configure the bones data
 
-		if (modelComp->model->mBoneData.size() > 0 && modelComp->model->sceneData.animations.size() > 0)
+		if (draw.numOfBones > 0)
 		{
-			//std::cout << "Duration: " << modelComp->model->sceneData.animations[0].duration << '\t'
-			//	<< modelComp->model->sceneData.animations[0].channels.size() << '\n';
-
 			shader.setBool("useBones", true);
-			myAssert(modelComp->model->mBoneData.size() <= 50);
-
-			FLOAT_TYPE duration = FLOAT_TYPE(modelComp->model->sceneData.animations[0].duration) / modelComp->model->sceneData.animations[0].ticksPerSecond;
-
-			std::vector<glm::mat4> transforms;
-
-			//update the mBoneData vector with the bones transforms
-			modelComp->boneTransform(0, std::fmod(glfwGetTime(), duration), transforms);
-
+			myAssert(mesh->mBoneData.size() <= 50);
 
+			//the bone palette captured by captureFrame():
 			glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "boneTransforms"),
-				modelComp->mBoneTransforms.size(), GL_FALSE, glm::value_ptr(modelComp->mBoneTransforms[0]));
+				draw.numOfBones, GL_FALSE, glm::value_ptr(frame->bones[draw.firstBone]));
 		}
 		else
 			shader.setBool("useBones", false);
 
 
 
-		for (int j = 0; j < modelComp->model->mEntries.size(); ++j) //walk through all meshes of the model
+		for (int j = 0; j < mesh->mEntries.size(); ++j) //walk through all meshes of the model
 		{
-			//myAssert(modelComp->model->mMaterials.size() != 0);
-			const Material* material = &(modelComp->model->mMaterial);
+			//myAssert(mesh->mMaterials.size() != 0);
+			const Material* material = &(mesh->mMaterial);
 
 			myAssert(material);
 			shader.setFLOAT_TYPE("materialSpecular", material->Ns);
 
-			model = getScaledFullTransfom(modelComp->getEntityId());
-			model[3] += glm::vec4(modelComp->pos, 0.0f);
+			model = draw.model;
 
 			glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "model"), 1, GL_FALSE, glm::value_ptr(model));
 			glUniformMatrix3fv(glGetUniformLocation(shader.getId(), "modelInverse"), 1, GL_FALSE,
 				glm::value_ptr(glm::mat3(glm::transpose(glm::inverse(model)))));
 
 
-			//std::cout << "Bones:" << modelComp->model->mBoneData.size() << "\tAnimations:"
-			//	<< modelComp->model->sceneData.animations.size() << "\n";
+			//std::cout << "Bones:" << mesh->mBoneData.size() << "\tAnimations:"
+			//	<< mesh->sceneData.animations.size() << "\n";
 
 
 			//----------------------------------
@@ -2305,13 +2633,13 @@ void GraphicalSystem::renderSceneModels(ShaderProgram& shader,
 			else shader.setBool("useMetallicMap", false);
 
 			//Draw the mesh:
-			glBindVertexArray(modelComp->model->VAO);
+			glBindVertexArray(mesh->VAO);
 
 			glDrawElementsBaseVertex(GL_TRIANGLES,
-				modelComp->model->mEntries[j].numOfIndices,
+				mesh->mEntries[j].numOfIndices,
 				GL_UNSIGNED_INT,
-				(void*)(modelComp->model->mEntries[j].baseIndex * sizeof(unsigned int)),
-				modelComp->model->mEntries[j].baseVertex);
+				(void*)(mesh->mEntries[j].baseIndex * sizeof(unsigned int)),
+				mesh->mEntries[j].baseVertex);
 
 			glBindVertexArray(0);
 		}
@@ -2340,75 +2668,34 @@ void GraphicalSystem::renderSceneIntObjects(ShaderProgram& shader,
 	glCullFace(GL_BACK);
 
 	glm::mat4 model(1.0f);
-	for (int i = 0; i < world->currentScene->interactableObjectComponents.getSize(); ++i)
+	for (const FramePacket::ModelDraw& draw : frame->interactableObjects) //only the ones with a model are captured
 	{
-		InteractableObjectComponent* intObjComp = &(world->currentScene->interactableObjectComponents[i]);
-		myAssert(intObjComp);
-
-		if (intObjComp->model == nullptr)
-			continue;
-
-		const CharacterComponent* charComp = nullptr;
-		//see if the object is holded by some character:
-		if (intObjComp->holder >= 0)
-		{
-			charComp = world->currentScene->getCharacterComponent(intObjComp->holder);
-
-			//use the character transform instead of the object
-			model = getScaledFullTransfom(intObjComp->holder);
-			model[3] += glm::vec4(charComp->getModelPos(), 0.0f);
-
-			//rotate according to the direction the character is facing
-			glm::mat4 rotMat = glm::rotate(glm::mat4(1.0), charComp->getDirection() * glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-			model = model * rotMat;
-		}
-		else //else, use the object transform
-		{
-			model = intObjComp->transform * getScaledFullTransfom(intObjComp->getEntityId());
-			model[3] += glm::vec4(intObjComp->pos, 0.0f);
-		}
-		//std::cout << "-> Size: " << modelComp->model->mEntries[0].materialIndex << '\n';
+		const Model* mesh = draw.mesh;
+		myAssert(mesh);
 
+		//the transform of the holder, if the object is holded by some character, was used by captureFrame():
+		model = draw.model;
 
-		if (!intObjComp->isActived())
+		if (!draw.actived)
 			continue;
 
 		glUniform1i(glGetUniformLocation(shader.getId(), "modelSpriteSheet"), false);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), intObjComp->model->mMaterial.animations);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), intObjComp->model->mMaterial.framesPerAnimation);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), intObjComp->currentRow);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), intObjComp->currentColumn);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), mesh->mMaterial.animations);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), mesh->mMaterial.framesPerAnimation);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), draw.row);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), draw.column);
 
 		//-------------------------------------------------------
 		//bind the bones data
 
-		if (intObjComp->model->mBoneData.size() > 0 && intObjComp->model->sceneData.animations.size() > 0)
+		if (draw.numOfBones > 0)
 		{
-			//std::cout << "Duration: " << modelComp->model->sceneData.animations[0].duration << '\t'
-			//	<< modelComp->model->sceneData.animations[0].channels.size() << '\n';
-
 			shader.setBool("useBones", true);
-			myAssert(intObjComp->model->mBoneData.size() <= 50);
-
-			//FLOAT_TYPE duration = FLOAT_TYPE(intObjComp->model->sceneData.animations[0].duration) / intObjComp->model->sceneData.animations[0].ticksPerSecond;
-
-			const std::vector<glm::mat4>* transforms = nullptr;
+			myAssert(mesh->mBoneData.size() <= 50);
 
-			//if the object is holded by a character, the animation id and time used will be the character ones
-			int animationIndex = (intObjComp->holder >= 0)
-				? charComp->getCurrentAnimation()
-				: intObjComp->currentAnimation;
-			FLOAT_TYPE animTime = (intObjComp->holder >= 0)
-				? charComp->getAnimationTime()
-				: intObjComp->animationTime;
-
-			//-------------------
-			//update and get the bone transforms:
-			transforms = &(intObjComp->boneTransform(animationIndex, animTime));
-			
-			//and send them to the gpu:
+			//send the bone transforms(sampled with the holder's animation, if any, by captureFrame()) to the gpu:
 			glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "boneTransforms"),
-				transforms->size(), GL_FALSE, glm::value_ptr((*transforms)[0]));
+				draw.numOfBones, GL_FALSE, glm::value_ptr(frame->bones[draw.firstBone]));
 		}
 		else
 			shader.setBool("useBones", false);
@@ -2421,9 +2708,9 @@ void GraphicalSystem::renderSceneIntObjects(ShaderProgram& shader,
 			glm::value_ptr(glm::mat3(glm::transpose(glm::inverse(model)))));
 
 
-		for (int j = 0; j < intObjComp->model->mEntries.size(); ++j) //walk through all meshes of the model
+		for (int j = 0; j < mesh->mEntries.size(); ++j) //walk through all meshes of the model
 		{
-			const Material* material = &(intObjComp->model->mMaterial);
+			const Material* material = &(mesh->mMaterial);
 
 			myAssert(material);
 			shader.setFLOAT_TYPE("materialSpecular", material->Ns);
@@ -2488,13 +2775,13 @@ void GraphicalSystem::renderSceneIntObjects(ShaderProgram& shader,
 			else shader.setBool("useMetallicMap", false);
 
 			//Draw the mesh:
-			glBindVertexArray(intObjComp->model->VAO);
+			glBindVertexArray(mesh->VAO);
 
 			glDrawElementsBaseVertex(GL_TRIANGLES,
-				intObjComp->model->mEntries[j].numOfIndices,
+				mesh->mEntries[j].numOfIndices,
 				GL_UNSIGNED_INT,
-				(void*)(intObjComp->model->mEntries[j].baseIndex * sizeof(unsigned int)),
-				intObjComp->model->mEntries[j].baseVertex);
+				(void*)(mesh->mEntries[j].baseIndex * sizeof(unsigned int)),
+				mesh->mEntries[j].baseVertex);
 
 			glBindVertexArray(0);
 		}
@@ -2527,65 +2814,40 @@ void GraphicalSystem::renderSceneCharacterModels(ShaderProgram& shader,
 
 
 	glm::mat4 model(1.0f);
-	for (int i = 0; i < world->currentScene->characterComponents.getSize(); ++i)
+	for (const FramePacket::ModelDraw& draw : frame->characters)
 	{
-
-		
-
-		CharacterComponent* charComp = &(world->currentScene->characterComponents[i]);
-		myAssert(charComp);
-		//std::cout << "-> Size: " << modelComp->model->mEntries[0].materialIndex << '\n';
-
-		if (!charComp->isActived())
+		if (!draw.actived)
 			continue;
 
-		const Model* charModel = charComp->getModel();
+		const Model* charModel = draw.mesh;
 
 		//std::cout << charModel->mMaterial.animations << ',' << charModel->mMaterial.framesPerAnimation << ',' 
-		//	<< charComp->getCurrentRow() << ',' << charComp->getCurrentColumn() <<'\n';
+		//	<< draw.row << ',' << draw.column <<'\n';
 		
 		glUniform1i(glGetUniformLocation(shader.getId(), "modelSpriteSheet"), true);
 		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), charModel->mMaterial.animations);
 		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), charModel->mMaterial.framesPerAnimation);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), charComp->getCurrentRow());
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), charComp->getCurrentColumn());
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), draw.row);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), draw.column);
 
 		//-------------------------------------------------------
 		//bind the bones data
 		
-		if (charModel->mBoneData.size() > 0 && charModel->sceneData.animations.size() > 0)
+		if (draw.numOfBones > 0)
 		{
-			//std::cout << "Duration: " << modelComp->model->sceneData.animations[0].duration << '\t'
-			//	<< modelComp->model->sceneData.animations[0].channels.size() << '\n';
-
-			
 			shader.setBool("useBones", true);
 			myAssert(charModel->mBoneData.size() <= 50);
 
-			FLOAT_TYPE duration = FLOAT_TYPE(charModel->sceneData.animations[charComp->getCurrentAnimation()].duration) 
-				/ charModel->sceneData.animations[charComp->getCurrentAnimation()].ticksPerSecond;
-		
-			std::vector<glm::mat4> transforms;
-			
-			
-			//update the mBoneData vector with the bones transforms
-			//charComp->boneTransform(charComp->getCurrentAnimation(), charComp->getAnimationTime(), transforms);
-			charComp->boneTransform(charComp->getCurrentAnimation(), charComp->getAnimationTime() , transforms);
-
-			
+			//the bone palette captured by captureFrame():
 			glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "boneTransforms"),
-				charComp->mBoneTransforms.size(), GL_FALSE, glm::value_ptr(charComp->mBoneTransforms[0]));
+				draw.numOfBones, GL_FALSE, glm::value_ptr(frame->bones[draw.firstBone]));
 		}
 		else
 			shader.setBool("useBones", false);
 
 		
 
-		model = getScaledFullTransfom(charComp->getEntityId());
-		model[3] += glm::vec4(charComp->getModelPos(), 0.0f);
-
-		glm::mat4 rotMat = glm::rotate(glm::mat4(1.0), charComp->getDirection() * glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = model * rotMat;
+		model = draw.model; //already rotated according to the direction the character is facing
 
 		glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "model"), 1, GL_FALSE, glm::value_ptr(model));
 		glUniformMatrix3fv(glGetUniformLocation(shader.getId(), "modelInverse"), 1, GL_FALSE,
@@ -2741,22 +3003,18 @@ void GraphicalSystem::renderSceneImagesGeometry(ShaderProgram& shader, const glm
 
 	glm::mat4 pvm(1.0f);
 	glBindVertexArray(spriteVAO);
-	for (int i = 0; i < world->currentScene->imageComponents.getSize(); ++i)
+	for (const FramePacket::SpriteDraw& sprite : frame->images)
 	{
-		ImageComponent* imagComp = &(world->currentScene->imageComponents[i]);
 		//glUseProgram(programs[0].getId());
 
-		if (!imagComp->actived)
-			continue;
-
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, (*imagComp).spt.getTexture()->getGlId());
+		glBindTexture(GL_TEXTURE_2D, sprite.texture);
 		//shader.setInt("tex", 0);
 		glUniform1i(glGetUniformLocation(shader.getId(), "tex"), 0);
 
 		//get the transformation matrix:
 
-		glm::mat4 model = getScaledFullTransfom(imagComp->getEntityId());
+		const glm::mat4& model = sprite.model;
 		pvm = viewAndProj * model;
 
 		shader.setBool("useAlphaMap", false);
@@ -2767,10 +3025,10 @@ void GraphicalSystem::renderSceneImagesGeometry(ShaderProgram& shader, const glm
 			//glm::value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
 
 		glUniform1i(glGetUniformLocation(shader.getId(), "modelSpriteSheet"), false);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), imagComp->spt.rows);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), imagComp->spt.columns);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), imagComp->spt.currentRow);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), imagComp->spt.currentColumn);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), sprite.rows);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), sprite.columns);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), sprite.row);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), sprite.column);
 
 
 		glDrawArrays(GL_TRIANGLES, 0, 12);
@@ -2794,49 +3052,19 @@ void GraphicalSystem::renderSceneModelsGeometry(ShaderProgram& shader, const glm
 
 
 
-	for (int i = 0; i < world->currentScene->modelComponents.getSize(); ++i)
+	for (const FramePacket::ModelDraw& draw : frame->models)
 	{
-		ModelComponent* modelComp = &(world->currentScene->modelComponents[i]);
-		myAssert(modelComp);
+		const Model* mesh = draw.mesh;
+		myAssert(mesh);
 		
 		
-		if (modelComp->model->mBoneData.size() > 0 && modelComp->model->sceneData.animations.size() > 0)
+		if (draw.numOfBones > 0)
 		{
-		
-			
-			//std::cout << modelComp->getEntityId() << '\n';
 			shader.setBool("useBones", true);
-			myAssert(modelComp->model->mBoneData.size() <= 50);
-
-
-			FLOAT_TYPE duration = FLOAT_TYPE(modelComp->model->sceneData.animations[0].duration) / modelComp->model->sceneData.animations[0].ticksPerSecond;
-
-			std::vector<glm::mat4> transforms;
-
-			//update the mBoneData vector with the bones transforms
-			
-			//modelComp->boneTransform(0, std::fmod(glfwGetTime(), duration), transforms);
-			
-			
-			/*for (int i = 0; i < transforms.size(); ++i)
-			{
-
-				glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "boneTransforms"),
-					1, GL_FALSE, &(transforms[i])[0][0]);
-			}
-			*/
-			
+			myAssert(mesh->mBoneData.size() <= 50);
 
 			glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "boneTransforms"),
-				modelComp->mBoneTransforms.size(), GL_FALSE, glm::value_ptr(modelComp->mBoneTransforms[0]));
-			
-
-			
-			//for (int j = 0; j < modelComp->mBoneTransforms.size(); ++j)
-			//{
-				//glUniformMatrix4fv(glGetUniformLocation(shader.getId(), std::string("boneTransforms").c_str()),
-					//modelComp->mBoneTransforms.size(), GL_FALSE, glm::value_ptr(modelComp->mBoneTransforms[0]));
-			//}
+				draw.numOfBones, GL_FALSE, glm::value_ptr(frame->bones[draw.firstBone]));
 		}
 		else
 			shader.setBool("useBones", false);
@@ -2845,8 +3073,7 @@ void GraphicalSystem::renderSceneModelsGeometry(ShaderProgram& shader, const glm
 
 		//modelComp->bindForDraw();
 		
-		model = getScaledFullTransfom(modelComp->getEntityId());
-		model[3] += glm::vec4(modelComp->pos, 0.0f);
+		model = draw.model;
 		
 		
 		pvm = viewAndProj * model;
@@ -2856,30 +3083,30 @@ void GraphicalSystem::renderSceneModelsGeometry(ShaderProgram& shader, const glm
 
 
 		glUniform1i(glGetUniformLocation(shader.getId(), "modelSpriteSheet"), false);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), modelComp->model->mMaterial.animations);
-		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), modelComp->model->mMaterial.framesPerAnimation);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), modelComp->currentRow);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), modelComp->currentColumn);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), mesh->mMaterial.animations);
+		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), mesh->mMaterial.framesPerAnimation);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), draw.row);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), draw.column);
 
 		
 		
-		for (int j = 0; j < modelComp->model->mEntries.size(); ++j) //walk through all meshes of the model
+		for (int j = 0; j < mesh->mEntries.size(); ++j) //walk through all meshes of the model
 		{
 			
-			int materialId = modelComp->model->mEntries[j].materialIndex;
-			if (modelComp->model->mMaterial.hasTexture)
+			int materialId = mesh->mEntries[j].materialIndex;
+			if (mesh->mMaterial.hasTexture)
 			{
 				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, modelComp->model->mMaterial.albedoTexture.getGlId());
+				glBindTexture(GL_TEXTURE_2D, mesh->mMaterial.albedoTexture.getGlId());
 				glUniform1i(glGetUniformLocation(shader.getId(), "tex"), 0);
 			}
 			else
 				continue;
 			
-			if (modelComp->model->mMaterial.hasAlphaMap)
+			if (mesh->mMaterial.hasAlphaMap)
 			{
 				glActiveTexture(GL_TEXTURE1);
-				glBindTexture(GL_TEXTURE_2D, modelComp->model->mMaterial.alphaMapTexture.getGlId());
+				glBindTexture(GL_TEXTURE_2D, mesh->mMaterial.alphaMapTexture.getGlId());
 				glUniform1i(glGetUniformLocation(shader.getId(), "alphaMap"), 1);
 				shader.setBool("useAlphaMap", true);
 			}
@@ -2888,12 +3115,12 @@ void GraphicalSystem::renderSceneModelsGeometry(ShaderProgram& shader, const glm
 
 			//Draw the mesh:
 			
-			glBindVertexArray(modelComp->model->VAO);
+			glBindVertexArray(mesh->VAO);
 			glDrawElementsBaseVertex(GL_TRIANGLES,
-				modelComp->model->mEntries[j].numOfIndices,
+				mesh->mEntries[j].numOfIndices,
 				GL_UNSIGNED_INT,
-				(void*)(sizeof(unsigned int) * modelComp->model->mEntries[j].baseIndex),
-				modelComp->model->mEntries[j].baseVertex);
+				(void*)(sizeof(unsigned int) * mesh->mEntries[j].baseIndex),
+				mesh->mEntries[j].baseVertex);
 
 			
 			glBindVertexArray(0);
@@ -2923,34 +3150,12 @@ void GraphicalSystem::renderSceneIntObjectsGeometry(ShaderProgram& shader, const
 	glm::mat4 pvm(1.0f);
 
 	//Render InteractableObjectComponent's models
-	for (int i = 0; i < world->currentScene->interactableObjectComponents.getSize(); ++i)
+	for (const FramePacket::ModelDraw& draw : frame->interactableObjects)
 	{
-		InteractableObjectComponent* intObjComp = &(world->currentScene->interactableObjectComponents[i]);
-		myAssert(intObjComp);
+		const Model* mesh = draw.mesh;
+		myAssert(mesh);
 
-		if (intObjComp->model == nullptr)
-			continue;
-
-		const CharacterComponent* charComp = nullptr; 
-
-		//see if the object is holded by some character:
-		if (intObjComp->holder >= 0)
-		{
-			charComp = world->currentScene->getCharacterComponent(intObjComp->holder);
-
-			//use the character transform instead of the object
-			model = getScaledFullTransfom(intObjComp->holder);
-			model[3] += glm::vec4(charComp->getModelPos(), 0.0f);
-
-			//rotate according to the direction the character is facing
-			glm::mat4 rotMat = glm::rotate(glm::mat4(1.0), charComp->getDirection() * glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-			model = model * rotMat;
-		}
-		else //else, use the object transform
-		{
-			model = intObjComp->transform * getScaledFullTransfom(intObjComp->getEntityId());
-			model[3] += glm::vec4(intObjComp->pos, 0.0f);
-		}
+		model = draw.model;
 
 		//modelComp->bindForDraw();
 
@@ -2972,22 +3177,22 @@ void GraphicalSystem::renderSceneIntObjectsGeometry(ShaderProgram& shader, const
 
 
 
-		for (int j = 0; j < intObjComp->model->mEntries.size(); ++j) //walk through all meshes of the model
+		for (int j = 0; j < mesh->mEntries.size(); ++j) //walk through all meshes of the model
 		{
-			int materialId = intObjComp->model->mEntries[j].materialIndex;
-			if (intObjComp->model->mMaterial.hasTexture)
+			int materialId = mesh->mEntries[j].materialIndex;
+			if (mesh->mMaterial.hasTexture)
 			{
 				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, intObjComp->model->mMaterial.albedoTexture.getGlId());
+				glBindTexture(GL_TEXTURE_2D, mesh->mMaterial.albedoTexture.getGlId());
 				glUniform1i(glGetUniformLocation(shader.getId(), "tex"), 0);
 			}
 			else
 				continue;
 
-			if (intObjComp->model->mMaterial.hasAlphaMap)
+			if (mesh->mMaterial.hasAlphaMap)
 			{
 				glActiveTexture(GL_TEXTURE1);
-				glBindTexture(GL_TEXTURE_2D, intObjComp->model->mMaterial.alphaMapTexture.getGlId());
+				glBindTexture(GL_TEXTURE_2D, mesh->mMaterial.alphaMapTexture.getGlId());
 				glUniform1i(glGetUniformLocation(shader.getId(), "alphaMap"), 1);
 				shader.setBool("useAlphaMap", true);
 			}
@@ -2995,27 +3200,27 @@ void GraphicalSystem::renderSceneIntObjectsGeometry(ShaderProgram& shader, const
 				shader.setBool("useAlphaMap", false);
 
 			
-			if (intObjComp->model->mBoneData.size() > 0 && intObjComp->model->sceneData.animations.size() > 0)
+			if (draw.numOfBones > 0)
 			{
 				
 				shader.setBool("useBones", true);
-				myAssert(intObjComp->model->mBoneData.size() <= 50);
+				myAssert(mesh->mBoneData.size() <= 50);
 							
 				glUniformMatrix4fv(glGetUniformLocation(shader.getId(), std::string("boneTransforms").c_str()),
-						intObjComp->mBoneTransforms.size(), GL_FALSE, glm::value_ptr(intObjComp->mBoneTransforms[0]));
+						draw.numOfBones, GL_FALSE, glm::value_ptr(frame->bones[draw.firstBone]));
 			}
 			else
 				shader.setBool("useBones", false);
 
 
 			//Draw the mesh:
-			glBindVertexArray(intObjComp->model->VAO);
+			glBindVertexArray(mesh->VAO);
 
 			glDrawElementsBaseVertex(GL_TRIANGLES,
-				intObjComp->model->mEntries[j].numOfIndices,
+				mesh->mEntries[j].numOfIndices,
 				GL_UNSIGNED_INT,
-				(void*)(sizeof(unsigned int) * intObjComp->model->mEntries[j].baseIndex),
-				intObjComp->model->mEntries[j].baseVertex);
+				(void*)(sizeof(unsigned int) * mesh->mEntries[j].baseIndex),
+				mesh->mEntries[j].baseVertex);
 		}
 
 		glDisable(GL_CULL_FACE);
@@ -3035,18 +3240,12 @@ void GraphicalSystem::renderSceneCharacterModelsGeometry(ShaderProgram& shader,
 	glm::mat4 model(1.0f);
 	glm::mat4 pvm(1.0f);
 
-	for (int i = 0; i < world->currentScene->characterComponents.getSize(); ++i)
+	for (const FramePacket::ModelDraw& draw : frame->characters)
 	{
-		CharacterComponent* charComp = &(world->currentScene->characterComponents[i]);
-		myAssert(charComp);
-
-		const Model* charModel = charComp->getModel();
+		const Model* charModel = draw.mesh;
+		myAssert(charModel);
 			 
-		model = getScaledFullTransfom(charComp->getEntityId());
-		model[3] += glm::vec4(charComp->getModelPos(), 0.0f);
-
-		glm::mat4 rotMat = glm::rotate(glm::mat4(1.0), charComp->getDirection() * glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = model * rotMat;
+		model = draw.model;
 
 		pvm = viewAndProj * model;
 
@@ -3057,31 +3256,17 @@ void GraphicalSystem::renderSceneCharacterModelsGeometry(ShaderProgram& shader,
 		glUniform1i(glGetUniformLocation(shader.getId(), "modelSpriteSheet"), false); //!
 		glUniform1i(glGetUniformLocation(shader.getId(), "numOfRows"), charModel->mMaterial.animations);
 		glUniform1i(glGetUniformLocation(shader.getId(), "numOfColumns"), charModel->mMaterial.framesPerAnimation);
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), charComp->getCurrentRow());
-		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), charComp->getCurrentColumn());
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureRow"), draw.row);
+		glUniform1i(glGetUniformLocation(shader.getId(), "textureColumn"), draw.column);
 
 
-		if (charModel->mBoneData.size() > 0 && charModel->sceneData.animations.size() > 0)
+		if (draw.numOfBones > 0)
 		{
-			//std::cout << "Duration: " << modelComp->model->sceneData.animations[0].duration << '\t'
-			//	<< modelComp->model->sceneData.animations[0].channels.size() << '\n';
-
-
 			shader.setBool("useBones", true);
 			myAssert(charModel->mBoneData.size() <= 50);
 
-			//get the animation duration:
-			FLOAT_TYPE duration = FLOAT_TYPE(charModel->sceneData.animations[charComp->getCurrentAnimation()].duration) / 
-				charModel->sceneData.animations[charComp->getCurrentAnimation()].ticksPerSecond;
-
-			std::vector<glm::mat4> transforms;
-
-			//update the mBoneData vector with the bones transforms
-			//charComp->boneTransform(charComp->getCurrentAnimation(), charComp->getAnimationTime(), transforms);
-
-
 			glUniformMatrix4fv(glGetUniformLocation(shader.getId(), "boneTransforms"),
-				charComp->mBoneTransforms.size(), GL_FALSE, glm::value_ptr(charComp->mBoneTransforms[0]));
+				draw.numOfBones, GL_FALSE, glm::value_ptr(frame->bones[draw.firstBone]));
 		}
 		else
 			shader.setBool("useBones", false);
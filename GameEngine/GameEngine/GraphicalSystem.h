@@ -49,9 +49,15 @@ GraphicalSystem and the ShaderProgram classes.
 #include "TextureHandler.h"
 #include "ModelComponent.h"
 #include "InteractableObjectComponent.h"
+#include "MathKernels.h"
+#include "JobSystem.h"
+#include "FramePacket.h"
 
 #include "GlobalDefines.h"
 
+
+#define ANIMATION_GRAIN_SIZE 8 //number of models(or characters) animated by each job
+
 //#######################################################################################################
 //utility functions:
 
@@ -105,7 +111,37 @@ public:
 	void addDirLightComponent(Entity, glm::vec3, glm::vec3, bool);
 	void addPointLightComponent(Entity, glm::vec3, FLOAT_TYPE, FLOAT_TYPE);
 	void addModelComponent(Entity, const Model*);
-	void render(int, int, int); //this must be called once per frame
+	void render(int, int, int); //this must be called once per frame(or, if the frame is pipelined, the two functions below)
+
+	/*
+		captureFrame - copy everything needed to draw the current Scene to the packet. It's the last stage of a
+		simulation tick: it updates the world transforms, samples the animations and computes the light matrices.
+		The drawn transforms, the camera and the character animations are interpolated between the state stored
+		by recordTick() and the current one(alpha = 1 is the current state)
+	*/
+	void captureFrame(FramePacket&, FLOAT_TYPE alpha = 1.0f);
+
+	/*
+		reloadTransforms and sampleAnimations - the first two stages of captureFrame(), which can also be run alone
+		(e.g. to measure them). reloadTransforms() updates the world transforms and refills the draw transforms, and
+		sampleAnimations() computes the bone transforms of all the models and characters(in parallel)
+	*/
+	void reloadTransforms();
+	void sampleAnimations(FLOAT_TYPE alpha = 1.0f);
+
+	/*
+		recordTick - store the drawn transforms, the camera and the character animation times of the current
+		state. The game loop calls it before the last tick it simulates in a frame, so that the frame can be
+		drawn between the last two ticks, at any rate(see Game::gameLoop())
+	*/
+	void recordTick();
+
+	/*
+		render - draw a packet filled by captureFrame(). Only the packet is read, so the simulation can go
+		on(and change the Scene) in another thread while this runs. It must be called by the thread that owns the
+		OpenGL context
+	*/
+	void render(const FramePacket&, int, int, int);
 	void update();
 	
 	//----------------------------------------------------
@@ -120,6 +156,7 @@ public:
 	bool bloom = true;
 	bool blur = true;
 	bool lowQualityRendering = true;
+	bool physicsBoxes = false; //draw the boxes of the rigid bodies(used for debugging the physics engine)
 
 	//other data:
 	glm::vec3 camPosition;
@@ -129,7 +166,6 @@ public:
 
 private:
 
-
 	//-------------------------------------------------
 	//Private data:
 	World* world; //keep a pointer to the World, so that it's components can be accessed from here
@@ -137,6 +173,9 @@ private:
 	std::vector<ShaderProgram> programs;
 	int screenOffset, screenWidth, screenHeight;
 
+	const FramePacket* frame = nullptr; //the packet being rendered(only valid inside render())
+	FramePacket ownPacket; //used when the frame is captured and rendered at once
+
 	//Camera:
 
 	glm::mat4 cameraView;
@@ -195,8 +234,24 @@ private:
 
 	//optimization related data:
 	std::vector<std::pair<glm::mat4, int>> scaledFullTransforms;
+	std::vector<int> scaledFullTransformIndices; //position in scaledFullTransforms of each entityIndex(-1 if none)
 	glm::mat4 identityMatrix = glm::mat4(1.0f);
 
+	//fixed step interpolation(the state stored by recordTick()):
+	enum DrawKind { IMAGE_DRAW, MODEL_DRAW, INTERACTABLE_DRAW, CHARACTER_DRAW, NUM_OF_DRAW_KINDS };
+	struct TickState
+	{
+		Entity entity = -1;
+		unsigned int tick = 0; //the recordTick() call that stored it(the older ones aren't used)
+		glm::mat4 model;
+		int animation = -1; //only for the characters
+		FLOAT_TYPE animationTime = 0.0f;
+	};
+	std::vector<TickState> tickStates[NUM_OF_DRAW_KINDS]; //by entityIndex
+	unsigned int recordedTick = 0; //0 if recordTick() was never called
+	glm::vec3 tickCamPosition;
+	glm::vec3 tickCamDirection;
+
 	//Particles data:
 	unsigned int particleVBO;
 	unsigned int particleVAO;
@@ -205,10 +260,24 @@ private:
 	//Private functions:
 
 
-	void reloadTransforms(); //clear and refill scaledFullTransforms
+	static void captureBones(FramePacket&, FramePacket::ModelDraw&, const std::vector<glm::mat4>&); //append the bone palette
+																	//of an animated model to the packet
+	void addScaledFullTransform(Entity, const glm::mat4&);
 	glm::mat4 getScaledFullTransfom(Entity) const;
 	//the reloadTransforms and getScaledFullTransforms functions ensures that the full transform of each ImageComponent
-	//or modelComponent is computed only one time per frame
+	//or modelComponent is computed only one time per frame(the world transforms of the whole scene are updated first,
+	//in one pass, by the scene's TransformHierarchy)
+
+	//the transforms of the draws(after reloadTransforms()):
+	glm::mat4 getDrawTransform(const ImageComponent&) const;
+	glm::mat4 getDrawTransform(const ModelComponent&) const;
+	glm::mat4 getDrawTransform(const InteractableObjectComponent&) const;
+	glm::mat4 getDrawTransform(const CharacterComponent&) const;
+
+	void storeTickState(DrawKind, Entity, const glm::mat4&, int = -1, FLOAT_TYPE = 0.0f);
+	const TickState* getTickState(DrawKind, Entity) const noexcept; //nullptr if it wasn't stored by the last recordTick()
+	glm::mat4 interpolateDraw(DrawKind, Entity, const glm::mat4&, FLOAT_TYPE alpha) const;
+	FLOAT_TYPE getAnimationTime(const CharacterComponent&, FLOAT_TYPE alpha) const; //the interpolated animation time
 
 	std::vector<unsigned int> genSphereVertices(FLOAT_TYPE*, int); //generate vertices, normals, textures coordinates for a sphere.
 					//They are stored in the first argument. The second argumment is the size of the first and the return value
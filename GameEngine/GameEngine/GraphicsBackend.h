@@ -0,0 +1,59 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the GraphicsBackend class, that selects
+what the engine does with the GPU resources.
+	With the OpenGL backend(the default) the textures, models and shadow maps are uploaded to the GPU and
+the GraphicalSystem draws the frames. With the null backend there's no window nor OpenGL context(the
+headless mode, see Game::initializeHeadless()): the assets are still loaded to the memory(the simulation
+needs the texture sizes and the model animations), but every OpenGL call is skipped and the GPU ids
+stay 0. The backend must be chosen before any asset is loaded.
+*/
+//#################################################################################
+
+#ifndef GRAPHICS_BACKEND
+#define GRAPHICS_BACKEND
+
+
+#include "GlobalDefines.h"
+
+
+class GraphicsBackend
+{
+public:
+
+	enum class Type
+	{
+		OPENGL,
+		NONE //the null backend
+	};
+
+	static void set(Type) noexcept;
+	static Type get() noexcept;
+	static bool isNull() noexcept; //if true, nothing may call OpenGL
+
+private:
+	GraphicsBackend() = delete; //only static members
+
+	static Type type;
+};
+
+
+#endif // !GRAPHICS_BACKEND
@@ -0,0 +1,293 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "HeightField.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "SceneSerializer.h" //MappedFile
+#include "Profiler.h"
+
+
+//##################################################
+//file layout:
+
+
+struct HeightFieldFileHeader //followed by numOfColumns * numOfRows floats, row by row
+{
+	char magic[4]; //"GEHF"
+	uint32_t version; //HEIGHT_FIELD_FILE_VERSION
+	uint32_t numOfColumns;
+	uint32_t numOfRows;
+	float cellSize;
+	float originX;
+	float originZ;
+	float minHeight;
+	float maxHeight;
+	uint32_t sourceHash[2]; //low and high words(see HeightField::hashSource())
+	uint32_t reserved;
+};
+
+
+//=================================================
+
+
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) noexcept //FNV-1a
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+
+//##################################################
+//HeightField definitions:
+
+
+uint64_t HeightField::hashSource(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+	const glm::mat4& transform, FLOAT_TYPE cellSize) noexcept
+{
+	float size = float(cellSize);
+	uint64_t hash = 14695981039346656037ull;
+	hash = hashBytes(hash, positions.data(), positions.size() * sizeof(glm::vec3));
+	hash = hashBytes(hash, indices.data(), indices.size() * sizeof(unsigned int));
+	hash = hashBytes(hash, &transform[0][0], sizeof(glm::mat4));
+	hash = hashBytes(hash, &size, sizeof(size));
+	return hash;
+}
+
+
+//=================================================
+
+
+void HeightField::build(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+	const glm::mat4& transform, FLOAT_TYPE size)
+{
+	PROFILE_ZONE("HeightField::build");
+
+	myAssert(size > 0.0f && indices.size() % 3 == 0);
+	clear();
+	if (positions.empty() || indices.empty()) return;
+
+	//the mesh in world space, and its bounds:
+	std::vector<glm::vec3> vertices(positions.size());
+	glm::vec3 lower(FLT_MAX), upper(-FLT_MAX);
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		vertices[i] = glm::vec3(transform * glm::vec4(positions[i], 1.0f));
+		lower = glm::min(lower, vertices[i]);
+		upper = glm::max(upper, vertices[i]);
+	}
+
+	cellSize = size;
+	inverseCellSize = 1.0f / size;
+	originX = lower.x;
+	originZ = lower.z;
+	numOfColumns = std::max(int((upper.x - lower.x) / cellSize) + 1, 2); //the last sample is inside the mesh bounds
+	numOfRows = std::max(int((upper.z - lower.z) / cellSize) + 1, 2);
+	heights.assign(size_t(numOfColumns) * numOfRows, -FLT_MAX);
+
+	//each triangle sets the samples under it, keeping the highest one(the top surface):
+	const FLOAT_TYPE epsilon = 0.00001f; //so the samples on the shared edges aren't missed
+	for (size_t t = 0; t + 2 < indices.size(); t += 3)
+	{
+		const glm::vec3& a = vertices[indices[t]];
+		const glm::vec3& b = vertices[indices[t + 1]];
+		const glm::vec3& c = vertices[indices[t + 2]];
+
+		FLOAT_TYPE area = (b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z);
+		if (std::fabs(area) < epsilon) continue; //a vertical triangle(the ones around it cover its edges)
+
+		int firstColumn = std::max(int(std::ceil((std::min({ a.x, b.x, c.x }) - originX) / cellSize - epsilon)), 0);
+		int lastColumn = std::min(int(std::floor((std::max({ a.x, b.x, c.x }) - originX) / cellSize + epsilon)), numOfColumns - 1);
+		int firstRow = std::max(int(std::ceil((std::min({ a.z, b.z, c.z }) - originZ) / cellSize - epsilon)), 0);
+		int lastRow = std::min(int(std::floor((std::max({ a.z, b.z, c.z }) - originZ) / cellSize + epsilon)), numOfRows - 1);
+
+		for (int row = firstRow; row <= lastRow; ++row)
+			for (int column = firstColumn; column <= lastColumn; ++column)
+			{
+				FLOAT_TYPE x = originX + column * cellSize, z = originZ + row * cellSize;
+
+				//the barycentric coordinates of the sample, on the xz plane:
+				FLOAT_TYPE wa = ((b.x - x) * (c.z - z) - (c.x - x) * (b.z - z)) / area;
+				FLOAT_TYPE wb = ((x - a.x) * (c.z - a.z) - (c.x - a.x) * (z - a.z)) / area;
+				FLOAT_TYPE wc = 1.0f - wa - wb;
+				if (wa < -epsilon || wb < -epsilon || wc < -epsilon) continue;
+
+				float& height = heights[size_t(row) * numOfColumns + column];
+				height = std::max(height, float(wa * a.y + wb * b.y + wc * c.y));
+			}
+	}
+
+	//the holes get the lowest height:
+	minHeight = FLT_MAX;
+	maxHeight = -FLT_MAX;
+	for (float height : heights)
+		if (height != -FLT_MAX)
+		{
+			minHeight = std::min(minHeight, FLOAT_TYPE(height));
+			maxHeight = std::max(maxHeight, FLOAT_TYPE(height));
+		}
+
+	if (minHeight > maxHeight) //no sample was under a triangle
+	{
+		clear();
+		return;
+	}
+	for (float& height : heights)
+		if (height == -FLT_MAX) height = float(minHeight);
+
+	sourceHash = hashSource(positions, indices, transform, size);
+}
+
+
+//=================================================
+
+
+void HeightField::save(const std::string& path) const
+{
+	HeightFieldFileHeader header = {};
+	std::memcpy(header.magic, "GEHF", 4);
+	header.version = HEIGHT_FIELD_FILE_VERSION;
+	header.numOfColumns = uint32_t(numOfColumns);
+	header.numOfRows = uint32_t(numOfRows);
+	header.cellSize = float(cellSize);
+	header.originX = float(originX);
+	header.originZ = float(originZ);
+	header.minHeight = float(minHeight);
+	header.maxHeight = float(maxHeight);
+	header.sourceHash[0] = uint32_t(sourceHash);
+	header.sourceHash[1] = uint32_t(sourceHash >> 32);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("ERROR::HeightField::save() COULD NOT OPEN THE FILE: " + path + ";\n");
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(heights.data()), std::streamsize(heights.size() * sizeof(float)));
+	if (!file)
+		throw std::runtime_error("ERROR::HeightField::save() COULD NOT WRITE THE FILE: " + path + ";\n");
+}
+
+
+//=================================================
+
+
+void HeightField::load(const std::string& path, uint64_t expectedHash)
+{
+	PROFILE_ZONE("HeightField::load");
+
+	MappedFile file(path);
+	const unsigned char* data = file.getData();
+	size_t size = file.getSize();
+
+	//validate the header, so no height is read outside the file:
+	if (size < sizeof(HeightFieldFileHeader))
+		throw std::runtime_error("ERROR::HeightField::load() INVALID HEIGHTFIELD FILE: " + path + ";\n");
+
+	HeightFieldFileHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, "GEHF", 4) != 0)
+		throw std::runtime_error("ERROR::HeightField::load() INVALID HEIGHTFIELD FILE: " + path + ";\n");
+	if (header.version != HEIGHT_FIELD_FILE_VERSION)
+		throw std::runtime_error("ERROR::HeightField::load() UNSUPPORTED HEIGHTFIELD FILE VERSION: " + path + ";\n");
+
+	uint64_t numOfHeights = uint64_t(header.numOfColumns) * header.numOfRows;
+	if (header.numOfColumns < 2 || header.numOfRows < 2 || !(header.cellSize > 0.0f)
+		|| sizeof(header) + numOfHeights * sizeof(float) != size)
+		throw std::runtime_error("ERROR::HeightField::load() CORRUPTED HEIGHTFIELD FILE: " + path + ";\n");
+
+	uint64_t fileHash = uint64_t(header.sourceHash[0]) | (uint64_t(header.sourceHash[1]) << 32);
+	if (expectedHash != 0 && fileHash != expectedHash)
+		throw std::runtime_error("ERROR::HeightField::load() THE HEIGHTFIELD FILE WAS BUILT FROM ANOTHER SOURCE: " + path + ";\n");
+
+	numOfColumns = int(header.numOfColumns);
+	numOfRows = int(header.numOfRows);
+	cellSize = header.cellSize;
+	inverseCellSize = 1.0f / cellSize;
+	originX = header.originX;
+	originZ = header.originZ;
+	minHeight = header.minHeight;
+	maxHeight = header.maxHeight;
+	sourceHash = fileHash;
+	heights.resize(size_t(numOfHeights));
+	std::memcpy(heights.data(), data + sizeof(header), size_t(numOfHeights) * sizeof(float));
+}
+
+
+//=================================================
+
+
+void HeightField::clear() noexcept
+{
+	heights.clear();
+	numOfColumns = numOfRows = 0;
+	minHeight = maxHeight = 0.0f;
+	sourceHash = 0;
+}
+
+bool HeightField::isEmpty() const noexcept
+{
+	return heights.empty();
+}
+
+
+//=================================================
+
+
+FLOAT_TYPE HeightField::getMinHeight() const noexcept
+{
+	return minHeight;
+}
+
+FLOAT_TYPE HeightField::getMaxHeight() const noexcept
+{
+	return maxHeight;
+}
+
+uint64_t HeightField::getSourceHash() const noexcept
+{
+	return sourceHash;
+}
+
+FLOAT_TYPE HeightField::getCellSize() const noexcept
+{
+	return cellSize;
+}
+
+int HeightField::getNumOfColumns() const noexcept
+{
+	return numOfColumns;
+}
+
+int HeightField::getNumOfRows() const noexcept
+{
+	return numOfRows;
+}
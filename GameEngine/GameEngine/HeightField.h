@@ -0,0 +1,168 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the HeightField class, the ground collider
+of the PhysicsEngine.
+	A heightfield is a regular grid of heights over the xz plane(in world space), sampled from the top
+surface of a triangle mesh(the terrain model). Each cell is split in two triangles by its diagonal, so the
+height and the normal under any point are found by indexing the cell that holds it, with no search. The
+boxes are tested against it by the PhysicsEngine with a lookup under each vertex, so the ground doesn't take
+part in the broad phase or in the pairs of boxes.
+	Sampling a large mesh takes a while, so a heightfield can be saved to a file(cooked) and loaded back by
+mapping it(see MappedFile in SceneSerializer.h): the file has a header(a magic number, the format version,
+the size of the grid, its position and a hash of the mesh, transform and cell size it was built from) followed
+by the heights, row by row. A file saved with another HEIGHT_FIELD_FILE_VERSION is refused, and so is a file
+built from another source, if the hash of the current one is passed to load().
+*/
+//#################################################################################
+
+#ifndef HEIGHT_FIELD
+#define HEIGHT_FIELD
+
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "GlobalDefines.h"
+
+
+#define HEIGHT_FIELD_FILE_VERSION 1
+
+
+class HeightField
+{
+public:
+
+	/*
+		build - sample the top surface of a triangle mesh(3 indices for each triangle), with its positions
+		transformed by the matrix, at each cellSize units on the x and z axes, over the xz bounds of the mesh.
+		The samples under no triangle(the holes of the mesh) get its lowest height
+	*/
+	void build(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+		const glm::mat4& transform, FLOAT_TYPE cellSize);
+
+	/*
+		hashSource - a hash of the arguments of build(), so a cooked heightfield can be checked against the
+		mesh and the transform it should come from
+	*/
+	static uint64_t hashSource(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+		const glm::mat4& transform, FLOAT_TYPE cellSize) noexcept;
+
+	/*
+		save and load - write the heightfield to a file, and read it back. If a source hash is passed to load(),
+		the file must have been built from the same source(see hashSource()).
+		Note: both throw if the file cannot be written or read, and load() throws if it's not a valid
+		heightfield file or if it was built from another source
+	*/
+	void save(const std::string&) const;
+	void load(const std::string&, uint64_t sourceHash = 0);
+
+	void clear() noexcept;
+	bool isEmpty() const noexcept;
+
+	/*
+		getHeight and getNormal - the height of the surface under a point, and its normal(up). Both are O(1):
+		the point is converted to a cell, and one of the two triangles of the cell is interpolated. The points
+		outside the grid(see contains()) get the height and the normal of the nearest point of its border
+	*/
+	FLOAT_TYPE getHeight(FLOAT_TYPE x, FLOAT_TYPE z) const noexcept;
+	glm::vec3 getNormal(FLOAT_TYPE x, FLOAT_TYPE z) const noexcept;
+	bool contains(FLOAT_TYPE x, FLOAT_TYPE z) const noexcept;
+
+	FLOAT_TYPE getMinHeight() const noexcept;
+	FLOAT_TYPE getMaxHeight() const noexcept; //a box above this never touches the ground
+	FLOAT_TYPE getCellSize() const noexcept;
+	int getNumOfColumns() const noexcept; //of samples, on the x axis
+	int getNumOfRows() const noexcept; //on the z axis
+	uint64_t getSourceHash() const noexcept; //of the source it was built from(0 if it's empty)
+
+private:
+
+	//finds the cell under a point(clamped to the grid) and the position of the point in it, from 0 to 1:
+	void findCell(FLOAT_TYPE x, FLOAT_TYPE z, int& column, int& row, FLOAT_TYPE& u, FLOAT_TYPE& v) const noexcept;
+
+	//private data:
+	std::vector<float> heights; //row by row(numOfColumns heights for each z)
+	int numOfColumns = 0;
+	int numOfRows = 0;
+	FLOAT_TYPE cellSize = 1.0f;
+	FLOAT_TYPE inverseCellSize = 1.0f; //so the lookups don't divide
+	FLOAT_TYPE originX = 0.0f; //the position of the first sample
+	FLOAT_TYPE originZ = 0.0f;
+	FLOAT_TYPE minHeight = 0.0f;
+	FLOAT_TYPE maxHeight = 0.0f;
+	uint64_t sourceHash = 0;
+};
+
+
+//the lookups are inline, they are done for each vertex of each box near the ground in every step:
+
+inline FLOAT_TYPE HeightField::getHeight(FLOAT_TYPE x, FLOAT_TYPE z) const noexcept
+{
+	myAssert(!heights.empty());
+
+	int column, row;
+	FLOAT_TYPE u, v;
+	findCell(x, z, column, row, u, v);
+
+	const float* cell = &heights[size_t(row) * numOfColumns + column];
+	FLOAT_TYPE h00 = cell[0], h10 = cell[1], h01 = cell[numOfColumns], h11 = cell[numOfColumns + 1];
+	if (u >= v) return h00 + u * (h10 - h00) + v * (h11 - h10); //the triangle (0, 0), (1, 0), (1, 1)
+	return h00 + u * (h11 - h01) + v * (h01 - h00); //the triangle (0, 0), (0, 1), (1, 1)
+}
+
+inline glm::vec3 HeightField::getNormal(FLOAT_TYPE x, FLOAT_TYPE z) const noexcept
+{
+	myAssert(!heights.empty());
+
+	int column, row;
+	FLOAT_TYPE u, v;
+	findCell(x, z, column, row, u, v);
+
+	//the slopes of the triangle on the x and z axes:
+	const float* cell = &heights[size_t(row) * numOfColumns + column];
+	FLOAT_TYPE h00 = cell[0], h10 = cell[1], h01 = cell[numOfColumns], h11 = cell[numOfColumns + 1];
+	FLOAT_TYPE slopeX = u >= v ? h10 - h00 : h11 - h01;
+	FLOAT_TYPE slopeZ = u >= v ? h11 - h10 : h01 - h00;
+	return glm::normalize(glm::vec3(-slopeX, cellSize, -slopeZ));
+}
+
+inline bool HeightField::contains(FLOAT_TYPE x, FLOAT_TYPE z) const noexcept
+{
+	return !heights.empty() && x >= originX && z >= originZ
+		&& x <= originX + (numOfColumns - 1) * cellSize && z <= originZ + (numOfRows - 1) * cellSize;
+}
+
+inline void HeightField::findCell(FLOAT_TYPE x, FLOAT_TYPE z, int& column, int& row, FLOAT_TYPE& u, FLOAT_TYPE& v) const noexcept
+{
+	FLOAT_TYPE cellX = glm::clamp((x - originX) * inverseCellSize, FLOAT_TYPE(0.0f), FLOAT_TYPE(numOfColumns - 1));
+	FLOAT_TYPE cellZ = glm::clamp((z - originZ) * inverseCellSize, FLOAT_TYPE(0.0f), FLOAT_TYPE(numOfRows - 1));
+	column = std::min(int(cellX), numOfColumns - 2); //the last samples are the far corners of the last cells
+	row = std::min(int(cellZ), numOfRows - 2);
+	u = cellX - column;
+	v = cellZ - row;
+}
+
+
+#endif // !HEIGHT_FIELD
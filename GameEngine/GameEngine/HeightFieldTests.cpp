@@ -0,0 +1,248 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "HeightField.h"
+#include "BenchmarkHelpers.h"
+
+
+static FLOAT_TYPE terrainHeight(FLOAT_TYPE x, FLOAT_TYPE z) noexcept //the wavy terrain of the heightfield benchmark
+{
+	return 6.0f * std::sin(x * 0.05f) + 4.0f * std::cos(z * 0.07f);
+}
+
+//a grid mesh of (size / spacing + 1)^2 vertices from (0, 0) to (size, size), its cells split like the ones of a
+//HeightField(so the heightfield reproduces it exactly when its cell size divides the spacing):
+static void makeTerrainMesh(FLOAT_TYPE size, FLOAT_TYPE spacing, bool wavy, std::vector<glm::vec3>& positions,
+	std::vector<unsigned int>& indices)
+{
+	int numOfVertices = int(size / spacing) + 1;
+	positions.clear();
+	indices.clear();
+	for (int row = 0; row < numOfVertices; ++row)
+		for (int column = 0; column < numOfVertices; ++column)
+		{
+			FLOAT_TYPE x = column * spacing, z = row * spacing;
+			positions.push_back(glm::vec3(x, wavy ? terrainHeight(x, z) : 0.0f, z));
+		}
+
+	for (int row = 0; row + 1 < numOfVertices; ++row)
+		for (int column = 0; column + 1 < numOfVertices; ++column)
+		{
+			unsigned int v00 = row * numOfVertices + column, v10 = v00 + 1;
+			unsigned int v01 = v00 + numOfVertices, v11 = v01 + 1;
+			indices.insert(indices.end(), { v00, v10, v11, v00, v11, v01 });
+		}
+}
+
+
+void benchmarkHeightField()
+{
+	const int sizes[] = { 100, 1000 };
+	const int steps = 120;
+	const int numOfLookups = 1000000;
+	const std::string path = "benchmarkHeightField.heightfield";
+
+	std::cout << "Heightfield ground collider:\n";
+
+	//build(the mesh is scaled by 2, so it's 1024 units wide), then check the heights at the vertices, and
+	//the error of the interpolation between them against the surface the mesh approximates:
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+	makeTerrainMesh(512.0f, 4.0f, true, positions, indices);
+	glm::mat4 transform = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 1.0f, 2.0f));
+
+	HeightField field;
+	auto start = BenchClock::now();
+	field.build(positions, indices, transform, 4.0f);
+	double buildTime = nanosecondsSince(start) / 1000000.0;
+
+	FLOAT_TYPE vertexError = 0.0f, surfaceError = 0.0f;
+	for (const glm::vec3& position : positions)
+	{
+		glm::vec3 vertex = glm::vec3(transform * glm::vec4(position, 1.0f));
+		vertexError = std::max(vertexError, std::fabs(field.getHeight(vertex.x, vertex.z) - vertex.y));
+	}
+
+	std::mt19937 random(13);
+	std::uniform_real_distribution<FLOAT_TYPE> coordinate(0.0f, 1024.0f);
+	for (int i = 0; i < 10000; ++i)
+	{
+		FLOAT_TYPE x = coordinate(random), z = coordinate(random);
+		surfaceError = std::max(surfaceError, std::fabs(field.getHeight(x, z) - terrainHeight(x * 0.5f, z * 0.5f)));
+	}
+
+	//a tilted plane(y = x / 2) has the same normal everywhere:
+	std::vector<glm::vec3> planePositions = { { 0.0f, 0.0f, 0.0f }, { 64.0f, 32.0f, 0.0f }, { 64.0f, 32.0f, 64.0f }, { 0.0f, 0.0f, 64.0f } };
+	std::vector<unsigned int> planeIndices = { 0, 1, 2, 0, 2, 3 };
+	HeightField plane;
+	plane.build(planePositions, planeIndices, glm::mat4(1.0f), 2.0f);
+	FLOAT_TYPE normalError = 0.0f;
+	for (int i = 0; i < 1000; ++i)
+	{
+		FLOAT_TYPE x = coordinate(random) / 16.0f, z = coordinate(random) / 16.0f;
+		normalError = std::max(normalError, glm::length(plane.getNormal(x, z) - glm::normalize(glm::vec3(-0.5f, 1.0f, 0.0f))));
+		normalError = std::max(normalError, std::fabs(plane.getHeight(x, z) - x * 0.5f));
+	}
+
+	//the cooked file gives the same heightfield, and it's refused for another transform:
+	HeightField loaded;
+	field.save(path);
+	uint64_t sourceHash = HeightField::hashSource(positions, indices, transform, 4.0f);
+	start = BenchClock::now();
+	loaded.load(path, sourceHash);
+	double loadTime = nanosecondsSince(start) / 1000000.0;
+
+	bool staleRefused = false;
+	try
+	{
+		HeightField stale;
+		stale.load(path, HeightField::hashSource(positions, indices, glm::translate(transform, glm::vec3(0.0f, 1.0f, 0.0f)), 4.0f));
+	}
+	catch (const std::runtime_error&)
+	{
+		staleRefused = true;
+	}
+	std::remove(path.c_str());
+
+	bool identical = loaded.getNumOfColumns() == field.getNumOfColumns() && loaded.getNumOfRows() == field.getNumOfRows();
+	for (int i = 0; i < 10000 && identical; ++i)
+	{
+		FLOAT_TYPE x = coordinate(random), z = coordinate(random);
+		identical = loaded.getHeight(x, z) == field.getHeight(x, z) && loaded.getNormal(x, z) == field.getNormal(x, z);
+	}
+
+	//the lookups(a height and a normal under random points):
+	std::vector<glm::vec2> points(4096);
+	for (glm::vec2& point : points) point = glm::vec2(coordinate(random), coordinate(random));
+	FLOAT_TYPE sum = 0.0f;
+	start = BenchClock::now();
+	for (int i = 0; i < numOfLookups; ++i)
+	{
+		const glm::vec2& point = points[i & 4095];
+		sum += field.getHeight(point.x, point.y) + field.getNormal(point.x, point.y).y;
+	}
+	double lookupCost = nanosecondsSince(start) / numOfLookups;
+	benchmarkSink = sum;
+
+	std::cout << "  " << field.getNumOfColumns() << "x" << field.getNumOfRows() << " samples, built in " << buildTime
+		<< " ms, loaded in " << loadTime << " ms, " << lookupCost << " ns/lookup"
+		<< ", vertex error: " << vertexError << ", max error against the surface: " << surfaceError
+		<< ", plane: " << checkResult(normalError < 0.001f)
+		<< ", vertices: " << checkResult(vertexError < 0.001f)
+		<< ", round trip: " << checkResult(identical)
+		<< ", stale file: " << checkResult(staleRefused) << '\n';
+
+	recordResult("height_field_build", field.getNumOfColumns() * field.getNumOfRows(), buildTime, "ms");
+	recordResult("height_field_lookup", field.getNumOfColumns() * field.getNumOfRows(), lookupCost, "ns/op");
+
+	//-------------------------------
+	//drop the boxes on each ground:
+	for (int n : sizes)
+	{
+		int side = int(std::ceil(std::sqrt(FLOAT_TYPE(n))));
+		FLOAT_TYPE groundSize = side * 8.0f + 16.0f;
+		double stepTime[3] = {};
+		double numOfPairs[3] = {};
+		FLOAT_TYPE restError = 0.0f;
+		int fallen = 0;
+
+		for (int ground = 0; ground < 3; ++ground) //a static box, a flat heightfield and the wavy one
+		{
+			PhysicsFixture fixture;
+			Scene* scene = fixture.scene;
+			PhysicsEngine& physics = fixture.physics;
+
+			if (ground == 0)
+			{
+				fixture.addStaticBox(int(groundSize), 20, int(groundSize), glm::vec3(groundSize * 0.5f - 8.0f, -10.0f, groundSize * 0.5f - 8.0f));
+			}
+			else
+			{
+				makeTerrainMesh(groundSize, 8.0f, ground == 2, positions, indices);
+				HeightField terrain;
+				terrain.build(positions, indices, glm::translate(glm::mat4(1.0f), glm::vec3(-8.0f, 0.0f, -8.0f)), 4.0f);
+				physics.setHeightField(std::move(terrain));
+			}
+
+			//the boxes are apart, so they only touch the ground:
+			std::vector<Entity> boxes;
+			for (int i = 0; i < n; ++i)
+			{
+				Entity e = scene->createEntity();
+				FLOAT_TYPE x = (i % side) * 8.0f, z = (i / side) * 8.0f;
+				glm::vec3 pos(x, (ground == 2 ? 10.0f : 0.0f) + 6.0f, z);
+				scene->getTransformComponent(e)->setPosition(pos);
+				physics.addBoxPhysicalComponent(e, 4, 4, 4, pos);
+				boxes.push_back(e);
+			}
+
+			int awakeSteps = 0;
+			for (int s = 0; s < steps; ++s)
+			{
+				bool awake = physics.getDynamicTree().getNumOfProxies() > 0;
+				auto stepStart = BenchClock::now();
+				physics.update();
+				if (!awake) continue;
+				stepTime[ground] += nanosecondsSince(stepStart);
+				numOfPairs[ground] += double(physics.getNumOfBoxPairs());
+				++awakeSteps;
+			}
+			stepTime[ground] = awakeSteps > 0 ? stepTime[ground] / (1000000.0 * awakeSteps) : 0.0;
+			numOfPairs[ground] = awakeSteps > 0 ? numOfPairs[ground] / awakeSteps : 0.0;
+
+			//each box rests on the ground: its lowest vertex(above the surface) touches it, and none is below it
+			for (Entity e : boxes)
+			{
+				glm::vec3 pos = scene->getBoxRigidBodyComponent(e)->getPosition();
+				FLOAT_TYPE gap = FLT_MAX, depth = 0.0f;
+				for (int k = 0; k < 4; ++k) //the bottom vertices(the boxes don't rotate)
+				{
+					glm::vec3 vertex = pos + glm::vec3(k & 1 ? 2.0f : -2.0f, -2.0f, k & 2 ? 2.0f : -2.0f);
+					FLOAT_TYPE surface = ground == 0 ? 0.0f : physics.getHeightField().getHeight(vertex.x, vertex.z);
+					gap = std::min(gap, vertex.y - surface);
+					depth = std::max(depth, surface - vertex.y);
+				}
+				restError = std::max(restError, std::max(std::fabs(gap), depth));
+				fallen += std::fabs(gap) > 0.5f || depth > 0.5f;
+			}
+		}
+
+		std::cout << "  N = " << n << " boxes(awake), static box ground: " << stepTime[0] << " ms/step, " << numOfPairs[0]
+			<< " pairs/step; flat heightfield: " << stepTime[1] << " ms/step, " << numOfPairs[1]
+			<< " pairs/step; wavy heightfield: " << stepTime[2] << " ms/step, max rest error: " << restError
+			<< ", resting: " << checkResult(fallen == 0) << " (" << fallen << " boxes out of place)\n";
+
+		recordResult("ground_static_box_step", n, stepTime[0], "ms/step");
+		recordResult("ground_height_field_step", n, stepTime[1], "ms/step");
+		recordResult("ground_wavy_height_field_step", n, stepTime[2], "ms/step");
+	}
+}
@@ -44,14 +44,15 @@ public:
 private:
 
 	friend class GraphicalSystem;
+	friend class SceneSerializer;
 
 	ImageComponent(Entity);
 
 	
 	int playing = 0;
 	int frameCounter = 0;
-	const Texture* normalMap;
-	const Texture* emissionMap;
+	const Texture* normalMap = nullptr;
+	const Texture* emissionMap = nullptr;
 };
 
 
@@ -20,9 +20,16 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "InputHandling.h"
+#include "Profiler.h"
 
 
 
+//the keys and mouse buttons that are tested:
+static const int inputKeys[] = { GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_E,
+								GLFW_KEY_P, GLFW_KEY_SPACE, GLFW_KEY_LEFT_SHIFT };
+static const int inputMouseButtons[] = { GLFW_MOUSE_BUTTON_LEFT, GLFW_MOUSE_BUTTON_RIGHT };
+
+
 //InputHandler definitions:
 
 
@@ -37,9 +44,9 @@ void InputHandler::keyCallBack(GLFWwindow* win, int key, int scancode, int actio
 
 void InputHandler::Initialize(World* w, GLFWwindow* win)
 {
-	myAssert(w && win);
+	myAssert(w);
 	world = w;
-	window = win;
+	window = win; //nullptr in the headless mode(poll() does nothing, so no key is ever pressed)
 }
 
 
@@ -49,18 +56,47 @@ void InputHandler::Initialize(World* w, GLFWwindow* win)
 
 void InputHandler::testKey(int key)
 {
-	if (glfwGetKey(window, key) == GLFW_PRESS)
+	if (keyStates[key] == GLFW_PRESS)
 		instance().storeMessage(Message(MessageType::KEY_PRESSED, key));
-	else if (glfwGetKey(window, key) == GLFW_RELEASE)
+	else if (keyStates[key] == GLFW_RELEASE)
 		instance().storeMessage(Message(MessageType::KEY_RELEASED, key));
 }
 
 
+//-------------------------------------------------------------------------------------------
+
+
+void InputHandler::poll()
+{
+	PROFILE_ZONE("InputHandler::poll");
+	if (!window) return;
+
+	for (int key : inputKeys)
+		keyStates[key] = glfwGetKey(window, key);
+	for (int button : inputMouseButtons)
+		mouseButtonStates[button] = glfwGetMouseButton(window, button);
+
+	double x, y;
+	glfwGetCursorPos(window, &x, &y);
+	cursorPos = glm::vec2(x, y);
+}
+
+
+//-------------------------------------------------------------------------------------------
+
+
+glm::vec2 InputHandler::getCursorPos() const noexcept
+{
+	return cursorPos;
+}
+
+
 
 //-------------------------------------------------------------------------------------------
 
 void InputHandler::update()
 {
+	PROFILE_ZONE("InputHandler::update");
 
 	//get keyboard keys states:
 	//testKey(GLFW_KEY_UP);
@@ -68,27 +104,18 @@ void InputHandler::update()
 	//testKey(GLFW_KEY_LEFT);
 	//testKey(GLFW_KEY_RIGHT);
 
-	testKey(GLFW_KEY_W);
-	testKey(GLFW_KEY_S);
-	testKey(GLFW_KEY_A);
-	testKey(GLFW_KEY_D);
-	testKey(GLFW_KEY_E);
-
-	testKey(GLFW_KEY_P);
-	testKey(GLFW_KEY_SPACE);
-	testKey(GLFW_KEY_LEFT_SHIFT);
+	for (int key : inputKeys)
+		testKey(key);
 
 
 	//get mouse buttoms state:
-	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
-		instance().storeMessage(Message(MessageType::MOUSE_BUTTOM_PRESSED, GLFW_MOUSE_BUTTON_LEFT));
-	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_RELEASE)
-		instance().storeMessage(Message(MessageType::MOUSE_BUTTOM_RELEASED, GLFW_MOUSE_BUTTON_LEFT));
-
-	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
-		instance().storeMessage(Message(MessageType::MOUSE_BUTTOM_PRESSED, GLFW_MOUSE_BUTTON_RIGHT));
-	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_RELEASE)
-		instance().storeMessage(Message(MessageType::MOUSE_BUTTOM_RELEASED, GLFW_MOUSE_BUTTON_RIGHT));
+	for (int button : inputMouseButtons)
+	{
+		if (mouseButtonStates[button] == GLFW_PRESS)
+			instance().storeMessage(Message(MessageType::MOUSE_BUTTOM_PRESSED, button));
+		if (mouseButtonStates[button] == GLFW_RELEASE)
+			instance().storeMessage(Message(MessageType::MOUSE_BUTTOM_RELEASED, button));
+	}
 
 
 }
@@ -30,6 +30,7 @@ used to update and manage all the inputComponents in a scene.
 #include "Observer.h"
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
+#include <glm/glm.hpp>
 #include "Entity.h"
 #include "World.h"
 
@@ -47,7 +48,9 @@ public:
 
 	static void keyCallBack(GLFWwindow*, int, int, int, int);
 	void Initialize(World*, GLFWwindow*);
-	void update();
+	void poll(); //read the keyboard, mouse and cursor state. GLFW only allows it in the main thread
+	void update(); //store the messages of the state read by the last poll()(so it can run in any thread)
+	glm::vec2 getCursorPos() const noexcept; //the cursor position read by the last poll()
 	
 
 private:
@@ -57,6 +60,10 @@ private:
 
 	World* world = nullptr; //keep a ptr to the world to grant access to all the inputComponents in the scene
 	GLFWwindow* window = nullptr;
+
+	int keyStates[GLFW_KEY_LAST + 1] = {}; //GLFW_PRESS or GLFW_RELEASE
+	int mouseButtonStates[GLFW_MOUSE_BUTTON_LAST + 1] = {};
+	glm::vec2 cursorPos = glm::vec2(0.0f);
 };
 
 
@@ -95,12 +95,15 @@ public:
 	void setPosition(glm::vec3) noexcept;
 	glm::vec3 getPosition() const noexcept;
 
+	int layer = 0; //the collision layer of the hit box(see RigidBodyComponent::layer)
+
 
 private:
 
 	friend class GameplayHandler;
 	friend class PhysicsEngine;
 	friend class GraphicalSystem;
+	friend class SceneSerializer;
 
 	glm::mat4 transform = glm::mat4(1.0);
 	Box hitBox;
@@ -0,0 +1,327 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "JobSystem.h"
+#include "Profiler.h"
+
+
+static thread_local int currentQueue = 0; //the queue of the current thread(0 for the threads that are not workers)
+
+
+//JobCounter definitions:
+
+
+bool JobCounter::isDone() const noexcept
+{
+	return count.load(std::memory_order_acquire) == 0;
+}
+
+int JobCounter::getCount() const noexcept
+{
+	return count.load(std::memory_order_acquire);
+}
+
+
+//##################################################
+//JobSystem definitions:
+
+
+JobSystem::~JobSystem()
+{
+	shutdown();
+}
+
+
+//=================================================
+
+
+void JobSystem::initialize(int numOfWorkers)
+{
+	if (running) return;
+
+	if (numOfWorkers < 0)
+	{
+		int cores = int(std::thread::hardware_concurrency());
+		numOfWorkers = cores > 1 ? cores - 1 : 0;
+	}
+
+	queues.clear();
+	for (int i = 0; i <= numOfWorkers; ++i)
+		queues.emplace_back(new WorkerQueue());
+
+	running = true;
+	for (int i = 1; i <= numOfWorkers; ++i)
+		workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+
+//=================================================
+
+
+void JobSystem::shutdown()
+{
+	if (!running) return;
+
+	//the queued jobs are still executed(someone may be waiting for them):
+	Job job;
+	while (findJob(job))
+		execute(job);
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	sleepCondition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+
+//=================================================
+
+
+int JobSystem::getNumOfThreads() const noexcept
+{
+	return int(workers.size()) + 1;
+}
+
+
+//=================================================
+
+
+void JobSystem::run(JobFunction function, JobCounter* counter)
+{
+	if (counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+
+	Job job;
+	job.function = std::move(function);
+	job.counter = counter;
+	push(std::move(job));
+}
+
+
+//=================================================
+
+
+void JobSystem::runAfter(JobCounter& dependency, JobFunction function, JobCounter* counter)
+{
+	if (counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock(dependency.continuationsMutex);
+		if (!dependency.isDone()) //it's queued when the dependency ends(see finish())
+		{
+			dependency.continuations.push_back({ std::move(function), counter });
+			return;
+		}
+	}
+
+	Job job;
+	job.function = std::move(function);
+	job.counter = counter;
+	push(std::move(job));
+}
+
+
+//=================================================
+
+
+void JobSystem::wait(JobCounter& counter)
+{
+	Job job;
+	while (!counter.isDone())
+	{
+		if (findJob(job))
+			execute(job);
+		else
+			std::this_thread::yield(); //the remaining jobs are running in other threads
+	}
+
+	//the thread that finished the last job may still hold the mutex(see finish()), and the counter
+	//can be destroyed as soon as this function returns:
+	std::lock_guard<std::mutex> lock(counter.continuationsMutex);
+}
+
+
+//=================================================
+
+
+void JobSystem::parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& function)
+{
+	if (grainSize < 1) grainSize = 1;
+	if (end - begin <= grainSize || queues.empty())
+	{
+		if (end > begin) function(begin, end);
+		return;
+	}
+
+	//an exception can't leave a job(it would end the program), so the first one is kept and thrown here:
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	auto chunk = [&function, &errorMutex, &error](int first, int last) {
+		try
+		{
+			function(first, last);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error) error = std::current_exception();
+		}
+	};
+
+	//queue all the chunks but the first, which is run by this thread:
+	JobCounter counter;
+	for (int first = begin + grainSize; first < end; first += grainSize)
+	{
+		int last = first + grainSize < end ? first + grainSize : end;
+		run([&chunk, first, last]() { chunk(first, last); }, &counter);
+	}
+
+	chunk(begin, begin + grainSize);
+	wait(counter); //the other chunks use this frame, so they must end even if one of them threw
+
+	if (error) std::rethrow_exception(error);
+}
+
+
+//=================================================
+
+
+void JobSystem::workerLoop(int queueIndex)
+{
+	currentQueue = queueIndex;
+	Profiler::instance().setThreadName("Job worker");
+
+	Job job;
+	while (true)
+	{
+		if (findJob(job))
+		{
+			execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this]() { return !running || pendingJobs.load() > 0; });
+		if (!running) return;
+	}
+}
+
+
+//=================================================
+
+
+void JobSystem::push(Job job)
+{
+	if (queues.empty()) //not initialized, the job is just run
+	{
+		execute(job);
+		return;
+	}
+
+	WorkerQueue& queue = *queues[currentQueue];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	pendingJobs.fetch_add(1);
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex); //so a worker going to sleep can't miss the notification
+	}
+	sleepCondition.notify_one();
+}
+
+
+//=================================================
+
+
+bool JobSystem::findJob(Job& job)
+//pop a job from the back of this thread's queue, or steal one from the front of another queue
+{
+	if (pendingJobs.load() == 0) return false;
+
+	int numOfQueues = int(queues.size());
+	for (int i = 0; i < numOfQueues; ++i)
+	{
+		int index = (currentQueue + i) % numOfQueues;
+		WorkerQueue& queue = *queues[index];
+
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty()) continue;
+
+		if (i == 0) //its own queue
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+		else
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+		pendingJobs.fetch_sub(1);
+		return true;
+	}
+
+	return false;
+}
+
+
+//=================================================
+
+
+void JobSystem::execute(Job& job)
+{
+	job.function();
+	job.function = nullptr;
+	finish(job.counter);
+}
+
+
+//=================================================
+
+
+void JobSystem::finish(JobCounter* counter)
+{
+	if (!counter) return;
+
+	//the continuations are taken and the count decremented under the lock, so runAfter() never adds a
+	//continuation that would be missed:
+	std::vector<JobCounter::Continuation> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter->continuationsMutex);
+		if (counter->count.load(std::memory_order_relaxed) == 1)
+			continuations.swap(counter->continuations);
+		counter->count.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	for (JobCounter::Continuation& continuation : continuations)
+	{
+		Job job;
+		job.function = std::move(continuation.function);
+		job.counter = continuation.counter;
+		push(std::move(job));
+	}
+}
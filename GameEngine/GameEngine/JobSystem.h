@@ -0,0 +1,182 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the JobSystem class, a work stealing
+scheduler shared by all the game systems, and the JobCounter class, used to wait for jobs and to make
+jobs depend on other jobs.
+	Each worker thread has its own deque of jobs: it pushes and pops jobs at the back(so the most
+recent, and cache hot, job runs first) and, when its deque is empty, steals jobs from the front of the
+other deques. The threads that are not workers(like the main thread) share one extra deque. A thread
+that waits for a JobCounter doesn't block: it runs jobs until the counter reaches zero, so waiting
+inside a job is fine.
+	parallelFor() splits a range(usually the components of a pool) in chunks and waits for all of them,
+so the systems can fan out their loops without dealing with threads at all.
+*/
+//#################################################################################
+
+#ifndef JOB_SYSTEM
+#define JOB_SYSTEM
+
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ObjectPool.h"
+
+#include "GlobalDefines.h"
+
+
+using JobFunction = std::function<void()>;
+
+
+//##################################################
+//JobCounter class declaration:
+
+
+/*
+	JobCounter - the number of unfinished jobs that were started with it. It must outlive these jobs
+*/
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool isDone() const noexcept;
+	int getCount() const noexcept;
+
+private:
+	friend class JobSystem;
+
+	struct Continuation //a job that waits for this counter(see JobSystem::runAfter())
+	{
+		JobFunction function;
+		JobCounter* counter;
+	};
+
+	std::atomic<int> count{ 0 };
+	std::mutex continuationsMutex;
+	std::vector<Continuation> continuations;
+};
+
+
+//##################################################
+//JobSystem class declaration:
+
+
+class JobSystem
+{
+public:
+
+	static JobSystem& instance()
+	{
+		static JobSystem jobSystemInstance;
+		return jobSystemInstance;
+	}
+
+	~JobSystem();
+
+	/*
+		initialize - start the worker threads. A negative number uses one worker for each core but one(the
+		main thread also runs jobs while it waits). With 0 workers, the jobs only run inside wait()
+	*/
+	void initialize(int numOfWorkers = -1);
+	void shutdown(); //finish the queued jobs and stop the workers
+
+	int getNumOfThreads() const noexcept; //the workers + the thread that waits
+
+	/*
+		run - queue a job. If a counter is passed, it's incremented now and decremented when the job ends
+	*/
+	void run(JobFunction, JobCounter* = nullptr);
+
+	/*
+		runAfter - queue a job only when the first counter reaches zero(a dependency). The second counter, if
+		passed, is incremented now, so waiting for it also waits for the dependency
+	*/
+	void runAfter(JobCounter&, JobFunction, JobCounter* = nullptr);
+
+	void wait(JobCounter&); //run jobs until the counter reaches zero
+
+	/*
+		parallelFor - call function(first, last) for chunks of at most grainSize elements of [begin, end),
+		in parallel, and wait for all of them. Small ranges are run directly by the calling thread.
+		Note: if the function throws, the first exception is thrown again here, after all the chunks end
+	*/
+	void parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>&);
+
+	template<typename Pool, typename F>
+	void parallelForEach(Pool&, int grainSize, const F&); //call function(T&) for each object of an ObjectPool or a ComponentPool
+
+private:
+
+	JobSystem() = default; //this class is a singleton
+	JobSystem(const JobSystem&) = delete;
+
+	struct Job
+	{
+		JobFunction function;
+		JobCounter* counter = nullptr;
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues; //queues[0] is shared by the threads that are not workers
+	std::vector<std::thread> workers;
+
+	std::atomic<int> pendingJobs{ 0 }; //jobs in all the queues
+	std::atomic<bool> running{ false };
+	std::mutex sleepMutex; //the idle workers sleep on sleepCondition
+	std::condition_variable sleepCondition;
+
+	void workerLoop(int);
+	void push(Job);
+	bool findJob(Job&);
+	void execute(Job&);
+	void finish(JobCounter*);
+};
+
+
+//=================================================
+
+
+template<typename Pool, typename F>
+void JobSystem::parallelForEach(Pool& pool, int grainSize, const F& function)
+{
+	parallelFor(0, pool.getSize(), grainSize, [&pool, &function](int first, int last) {
+		for (int i = first; i < last; ++i)
+			function(pool[i]);
+	});
+}
+
+
+#endif // !JOB_SYSTEM
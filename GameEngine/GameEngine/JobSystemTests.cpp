@@ -0,0 +1,105 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "JobSystem.h"
+#include "BenchmarkHelpers.h"
+
+
+void benchmarkJobSystem()
+{
+	JobSystem& jobs = JobSystem::instance();
+	std::cout << "JobSystem(" << jobs.getNumOfThreads() << " threads):\n";
+
+	//--------------------------------------
+	//the cost of a job(queue, run and wait):
+	const int numOfJobs = 100000;
+	std::atomic<int> executed{ 0 };
+	JobCounter counter;
+	auto start = BenchClock::now();
+	for (int i = 0; i < numOfJobs; ++i)
+		jobs.run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+	jobs.wait(counter);
+	double jobCost = nanosecondsSince(start) / numOfJobs;
+
+	//--------------------------------------
+	//dependencies: each stage reads what the previous one wrote
+	const int numOfStages = 64;
+	const int jobsPerStage = 16;
+	std::vector<int> values(jobsPerStage, 0);
+	std::vector<std::unique_ptr<JobCounter>> stages;
+	bool ordered = true;
+	for (int stage = 0; stage < numOfStages; ++stage)
+	{
+		stages.emplace_back(new JobCounter());
+		for (int j = 0; j < jobsPerStage; ++j)
+		{
+			auto job = [&values, &ordered, stage, j]() {
+				if (values[j] != stage) ordered = false;
+				values[j] = stage + 1;
+			};
+			if (stage == 0) jobs.run(job, stages.back().get());
+			else jobs.runAfter(*stages[stage - 1], job, stages.back().get());
+		}
+	}
+	jobs.wait(*stages.back());
+	for (int j = 0; j < jobsPerStage; ++j)
+		ordered = ordered && values[j] == numOfStages;
+
+	std::cout << "  run + wait: " << jobCost << " ns/job"
+		<< ", jobs executed: " << checkResult(executed == numOfJobs)
+		<< ", dependencies: " << checkResult(ordered) << '\n';
+
+	//--------------------------------------
+	//serial loop against parallelFor:
+	const int sizes[] = { 1000, 10000, 100000, 1000000 };
+	for (int n : sizes)
+	{
+		std::vector<float> data(n, 1.0f);
+		auto work = [&data](int first, int last) {
+			for (int i = first; i < last; ++i)
+				data[i] = std::sqrt(data[i] * 1.5f + float(i)) + std::sin(data[i]);
+		};
+
+		int rounds = 10000000 / n + 1;
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			work(0, n);
+		double serialCost = nanosecondsSince(start) / (double(rounds) * n);
+
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			jobs.parallelFor(0, n, 1024, work);
+		double parallelCost = nanosecondsSince(start) / (double(rounds) * n);
+		benchmarkSink = data[n - 1];
+
+		std::cout << "  N = " << n
+			<< ", serial: " << serialCost << " ns/elem"
+			<< ", parallelFor: " << parallelCost << " ns/elem"
+			<< ", speedup: " << serialCost / parallelCost << "x\n";
+	}
+}
@@ -20,6 +20,7 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "LightComponent.h"
+#include "GraphicsBackend.h"
 
 
 //dirLightComponent definitions:
@@ -40,22 +41,27 @@ DirLightComponent::DirLightComponent(Entity id, int shadowRes, bool sc)
 	height = shadowRes;
 	shadowCaster = sc;
 
-	if (sc)
-	{
-		//intialize the depth buffer:
-		glGenTextures(1, &depthTexture);
-		glBindTexture(GL_TEXTURE_2D, depthTexture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, shadowRes, shadowRes, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-		FLOAT_TYPE borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-		glBindTexture(GL_TEXTURE_2D, 0);
-	}
+	if (sc) createDepthTexture();
+}
 
+//####################################################################################################
+
+void DirLightComponent::createDepthTexture()
+//intialize the depth buffer(must be called from the thread that owns the OpenGL context)
+{
+	if (GraphicsBackend::isNull()) return;
+
+	glGenTextures(1, &depthTexture);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, widht, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	FLOAT_TYPE borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 //####################################################################################################
@@ -76,8 +82,9 @@ void DirLightComponent::updateMatrix(glm::vec3 newPos) noexcept
 
 void DirLightComponent::clearMemory() //clear the depthTexture memory
 {
-	if (shadowCaster && depthTexture);
+	if (shadowCaster && depthTexture)
 		glDeleteTextures(1, &depthTexture);
+	depthTexture = 0;
 }
 
 //####################################################################################################
@@ -103,6 +110,7 @@ void PointLightComponent::clearMemory()
 {
 	if (depthCubeMap)
 		glDeleteTextures(1, &depthCubeMap);
+	depthCubeMap = 0;
 }
 
 //####################################################################################################
@@ -129,11 +137,21 @@ PointLightComponent::PointLightComponent(Entity id, int shadowRes, FLOAT_TYPE li
 {
 	width = shadowRes;
 	height = shadowRes;
+	createDepthCubeMap();
+}
+
+//####################################################################################################
+
+void PointLightComponent::createDepthCubeMap()
+//must be called from the thread that owns the OpenGL context
+{
+	if (GraphicsBackend::isNull()) return;
+
 	glGenTextures(1, &depthCubeMap);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMap);
 	for (int i = 0; i < 6; ++i) //initialize each side of the cube map:
 	{
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT, shadowRes, shadowRes, 0,
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT, width, height, 0,
 			GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
 	}
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
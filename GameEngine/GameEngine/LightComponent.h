@@ -50,12 +50,14 @@ public:
 private:
 
 	friend class GraphicalSystem;
+	friend class SceneSerializer;
 
 	//constructor:
 	DirLightComponent(Entity, int, bool = true);
 
 	//functions:
 	void updateMatrix(glm::vec3) noexcept;
+	void createDepthTexture(); //allocate the depthTexture on the GPU
 
 	//Light data:
 	glm::vec3 lightAmbient = glm::vec3(0.1f);
@@ -65,7 +67,7 @@ private:
 	glm::mat4 lightMatrix = glm::mat4(1.0f);
 
 	//depth buffer data:
-	unsigned int depthTexture;
+	unsigned int depthTexture = 0;
 	int widht;
 	int height;
 	bool shadowCaster = true; //this light will only produce shadows if this is set to true
@@ -89,6 +91,7 @@ public:
 private:
 
 	friend class GraphicalSystem;
+	friend class SceneSerializer;
 
 	//Constructor:
 	PointLightComponent(Entity, int, FLOAT_TYPE, FLOAT_TYPE);
@@ -96,6 +99,7 @@ private:
 
 	//functions:
 	void updateMatrices(glm::vec3) noexcept;
+	void createDepthCubeMap(); //allocate the depthCubeMap on the GPU
 
 
 	//Light data:
@@ -116,7 +120,7 @@ private:
 
 
 	//depth buffer data
-	unsigned int depthCubeMap;
+	unsigned int depthCubeMap = 0;
 	int width;
 	int height;
 };
@@ -0,0 +1,158 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It defines small SIMD kernels for the matrix
+operations done for every object in every frame. Each kernel has a SSE version, an AVX version(when
+the engine is compiled with AVX enabled) and a scalar fallback, and all of them give the same results
+as the glm code they replace(glm matrices are column major, so each column is one SSE register).
+*/
+//#################################################################################
+
+#ifndef MATH_KERNELS
+#define MATH_KERNELS
+
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+#if defined(__AVX__)
+#define ENGINE_AVX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_SSE
+#endif
+
+#if defined(ENGINE_AVX)
+#include <immintrin.h>
+#elif defined(ENGINE_SSE)
+#include <emmintrin.h>
+#endif
+
+#include "GlobalDefines.h"
+
+
+//##################################################
+
+
+/*
+	multiplyMat4 - out = a * b. out can be the same matrix as a or b
+*/
+inline void multiplyMat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) noexcept
+{
+#if defined(ENGINE_AVX)
+	//each 256 bit register holds two columns, so the result is computed in two steps:
+	const float* pa = &a[0][0];
+	const float* pb = &b[0][0];
+	__m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa));
+	__m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa + 4));
+	__m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa + 8));
+	__m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(pa + 12));
+	__m256 b01 = _mm256_loadu_ps(pb);
+	__m256 b23 = _mm256_loadu_ps(pb + 8);
+
+	__m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xFF)));
+
+	__m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xAA)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF)));
+
+	_mm256_storeu_ps(&out[0][0], r01);
+	_mm256_storeu_ps(&out[2][0], r23);
+
+#elif defined(ENGINE_SSE)
+	//the j'th column of the result is a combination of the columns of a, weighted by the j'th column of b:
+	__m128 a0 = _mm_loadu_ps(&a[0][0]);
+	__m128 a1 = _mm_loadu_ps(&a[1][0]);
+	__m128 a2 = _mm_loadu_ps(&a[2][0]);
+	__m128 a3 = _mm_loadu_ps(&a[3][0]);
+	__m128 bCols[4] = { _mm_loadu_ps(&b[0][0]), _mm_loadu_ps(&b[1][0]), _mm_loadu_ps(&b[2][0]), _mm_loadu_ps(&b[3][0]) };
+
+	for (int j = 0; j < 4; ++j)
+	{
+		__m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(bCols[j], bCols[j], _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(bCols[j], bCols[j], _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(bCols[j], bCols[j], _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(bCols[j], bCols[j], _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_storeu_ps(&out[j][0], r);
+	}
+
+#else
+	out = a * b;
+#endif
+}
+
+
+//=================================================
+
+
+/*
+	normalizeRows3 - normalize the x, y and z of the first three columns of m(glm's m[0], m[1]
+	and m[2]), which removes the scale from a rotation * scale matrix. The same as the normalizeRows(3, m)
+	of the GraphicalSystem and the PhysicsEngine
+*/
+inline void normalizeRows3(glm::mat4& m) noexcept
+{
+#if defined(ENGINE_SSE) || defined(ENGINE_AVX)
+	__m128 c0 = _mm_loadu_ps(&m[0][0]);
+	__m128 c1 = _mm_loadu_ps(&m[1][0]);
+	__m128 c2 = _mm_loadu_ps(&m[2][0]);
+
+	//the squared lengths of the three columns, computed together by transposing the squares:
+	__m128 s0 = _mm_mul_ps(c0, c0);
+	__m128 s1 = _mm_mul_ps(c1, c1);
+	__m128 s2 = _mm_mul_ps(c2, c2);
+	__m128 s3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+	__m128 lenght = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(s0, s1), s2));
+
+	//if (lenght <= 0.0001f) lenght = 0.001f;
+	__m128 tooSmall = _mm_cmple_ps(lenght, _mm_set1_ps(0.0001f));
+	lenght = _mm_or_ps(_mm_and_ps(tooSmall, _mm_set1_ps(0.001f)), _mm_andnot_ps(tooSmall, lenght));
+
+	//divide x, y and z, but keep w:
+	const __m128 wMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	const __m128 one = _mm_set1_ps(1.0f);
+	__m128 d0 = _mm_or_ps(_mm_andnot_ps(wMask, _mm_shuffle_ps(lenght, lenght, _MM_SHUFFLE(0, 0, 0, 0))), _mm_and_ps(wMask, one));
+	__m128 d1 = _mm_or_ps(_mm_andnot_ps(wMask, _mm_shuffle_ps(lenght, lenght, _MM_SHUFFLE(1, 1, 1, 1))), _mm_and_ps(wMask, one));
+	__m128 d2 = _mm_or_ps(_mm_andnot_ps(wMask, _mm_shuffle_ps(lenght, lenght, _MM_SHUFFLE(2, 2, 2, 2))), _mm_and_ps(wMask, one));
+
+	_mm_storeu_ps(&m[0][0], _mm_div_ps(c0, d0));
+	_mm_storeu_ps(&m[1][0], _mm_div_ps(c1, d1));
+	_mm_storeu_ps(&m[2][0], _mm_div_ps(c2, d2));
+
+#else
+	for (int i = 0; i < 3; ++i)
+	{
+		float lenght = std::sqrt((m[i][0] * m[i][0]) + (m[i][1] * m[i][1]) + (m[i][2] * m[i][2]));
+		if (lenght <= 0.0001f) lenght = 0.001f;
+		m[i][0] /= lenght;
+		m[i][1] /= lenght;
+		m[i][2] /= lenght;
+	}
+#endif
+}
+
+
+#endif // !MATH_KERNELS
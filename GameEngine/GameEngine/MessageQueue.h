@@ -0,0 +1,215 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares and defines the MessageQueue class template,
+the unbounded queue used by the Subject class(see Observer.h) to store the messages of one MessageType
+until they are sent.
+	The messages are stored in a linked list of fixed size chunks. Any number of threads can push messages
+at once without locking: each one reserves a slot of the last chunk with an atomic increment, and the
+thread that finds the chunk full links a new one(with a compare and swap). The chunks are never freed
+while the queue exists, they are reused after the messages are consumed, so after the first frames no
+memory is allocated.
+	The messages are consumed by one thread at a time, when no thread is pushing to the queue(the Subject
+sends them at the frame end).
+*/
+//#################################################################################
+
+#ifndef MESSAGE_QUEUE
+#define MESSAGE_QUEUE
+
+
+#include <atomic>
+
+#include "GlobalDefines.h"
+
+
+#define MESSAGE_CHUNK_SIZE 64 //number of messages in each chunk of a MessageQueue
+
+
+//##################################################
+//MessageQueue class declaration:
+
+
+template<typename T>
+class MessageQueue
+{
+public:
+	MessageQueue() = default;
+	~MessageQueue();
+
+	MessageQueue(const MessageQueue&) = delete;
+	MessageQueue& operator=(const MessageQueue&) = delete;
+
+	void push(const T&); //lock free, it can be called by many threads at once
+	bool isEmpty() const noexcept;
+	int getSize() const noexcept; //note: it's only exact if no thread is pushing
+
+	/*
+		consume - call function(const T&) for each message, in the order they were pushed, and empty the
+		queue. It must not be called while other threads push to this queue(including the function itself)
+	*/
+	template<typename F>
+	void consume(const F&);
+
+private:
+
+	struct Chunk
+	{
+		T messages[MESSAGE_CHUNK_SIZE];
+		std::atomic<int> reserved{ 0 }; //number of slots taken(it can go past MESSAGE_CHUNK_SIZE when full)
+		std::atomic<Chunk*> next{ nullptr };
+	};
+
+	std::atomic<Chunk*> head{ nullptr }; //the first chunk(allocated by the first push)
+	std::atomic<Chunk*> tail{ nullptr }; //the chunk being filled
+
+	Chunk* getFirstChunk();
+};
+
+
+//=================================================
+//MessageQueue definitions:
+
+
+template<typename T>
+MessageQueue<T>::~MessageQueue()
+{
+	Chunk* chunk = head.load(std::memory_order_relaxed);
+	while (chunk)
+	{
+		Chunk* next = chunk->next.load(std::memory_order_relaxed);
+		delete chunk;
+		chunk = next;
+	}
+}
+
+
+//=================================================
+
+
+template<typename T>
+void MessageQueue<T>::push(const T& message)
+{
+	Chunk* chunk = tail.load(std::memory_order_acquire);
+	if (!chunk) chunk = getFirstChunk();
+
+	while (true)
+	{
+		int slot = chunk->reserved.fetch_add(1, std::memory_order_relaxed);
+		if (slot < MESSAGE_CHUNK_SIZE)
+		{
+			chunk->messages[slot] = message;
+			return;
+		}
+
+		//the chunk is full, so go to the next one(linking a new one if this is the last):
+		Chunk* next = chunk->next.load(std::memory_order_acquire);
+		if (!next)
+		{
+			Chunk* newChunk = new Chunk();
+			if (chunk->next.compare_exchange_strong(next, newChunk, std::memory_order_acq_rel))
+				next = newChunk;
+			else
+				delete newChunk; //another thread linked one first(and next is now that chunk)
+		}
+
+		Chunk* expected = chunk;
+		tail.compare_exchange_strong(expected, next, std::memory_order_acq_rel); //fails if another thread moved it
+		chunk = next;
+	}
+}
+
+
+//=================================================
+
+
+template<typename T>
+bool MessageQueue<T>::isEmpty() const noexcept
+{
+	const Chunk* first = head.load(std::memory_order_acquire);
+	return !first || first->reserved.load(std::memory_order_acquire) == 0;
+}
+
+
+//=================================================
+
+
+template<typename T>
+int MessageQueue<T>::getSize() const noexcept
+{
+	int size = 0;
+	for (const Chunk* chunk = head.load(std::memory_order_acquire); chunk; chunk = chunk->next.load(std::memory_order_acquire))
+	{
+		int reserved = chunk->reserved.load(std::memory_order_acquire);
+		size += reserved < MESSAGE_CHUNK_SIZE ? reserved : MESSAGE_CHUNK_SIZE;
+		if (reserved < MESSAGE_CHUNK_SIZE) break; //the chunks are filled in order
+	}
+	return size;
+}
+
+
+//=================================================
+
+
+template<typename T>
+template<typename F>
+void MessageQueue<T>::consume(const F& function)
+{
+	Chunk* first = head.load(std::memory_order_acquire);
+
+	//the chunks are filled in order, so the first one that isn't full is the last with messages:
+	for (Chunk* chunk = first; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+	{
+		int reserved = chunk->reserved.load(std::memory_order_acquire);
+		int count = reserved < MESSAGE_CHUNK_SIZE ? reserved : MESSAGE_CHUNK_SIZE;
+		for (int i = 0; i < count; ++i)
+			function(chunk->messages[i]);
+
+		chunk->reserved.store(0, std::memory_order_relaxed); //it will be reused
+		if (reserved < MESSAGE_CHUNK_SIZE) break;
+	}
+
+	tail.store(first, std::memory_order_release);
+}
+
+
+//=================================================
+
+
+template<typename T>
+typename MessageQueue<T>::Chunk* MessageQueue<T>::getFirstChunk()
+{
+	Chunk* first = head.load(std::memory_order_acquire);
+	if (!first)
+	{
+		Chunk* newChunk = new Chunk();
+		if (head.compare_exchange_strong(first, newChunk, std::memory_order_acq_rel))
+			first = newChunk;
+		else
+			delete newChunk;
+	}
+
+	Chunk* expected = nullptr;
+	tail.compare_exchange_strong(expected, first, std::memory_order_acq_rel);
+	return first;
+}
+
+
+#endif // !MESSAGE_QUEUE
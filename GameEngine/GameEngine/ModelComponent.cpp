@@ -20,6 +20,7 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "ModelComponent.h"
+#include "GraphicsBackend.h"
 
 
 
@@ -303,8 +304,10 @@ void SceneData::initialize(const aiScene* scene, bool glbFileType)
 //Model definitions:
 
 
-void Model::loadFromFile(const std::string& filename, int nRows, int nColumns, bool glbFileType)
+void Model::loadFromFile(const std::string& filename, int nRows, int nColumns, bool glbFileType, bool keep)
 {
+	keepMesh = keep;
+
 	Assimp::Importer m_importer;
 
 	int importFlags = aiProcess_Triangulate |
@@ -414,6 +417,23 @@ void Model::initFromScene(const aiScene* scene, const std::string& filename)
 
 	numOfIndices = indices.size(); //!
 
+	if (keepMesh) //the indices of each mesh start at 0, so its base vertex is added
+	{
+		meshPositions.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+			meshPositions[i] = glm::vec3(vertices[i].position.x, vertices[i].position.y, vertices[i].position.z);
+
+		meshIndices.resize(indices.size());
+		for (const MeshEntry& entry : mEntries)
+			for (unsigned int i = entry.baseIndex; i < entry.baseIndex + entry.numOfIndices; ++i)
+				meshIndices[i] = indices[i] + entry.baseVertex;
+	}
+
+	if (GraphicsBackend::isNull()) //keep the CPU data only(the VAO, VBO and EBO stay 0)
+	{
+		initMaterials(scene, filename);
+		return;
+	}
 
 	glGenVertexArrays(1, &VAO);
 	glBindVertexArray(VAO);
@@ -533,6 +553,16 @@ const Material* Model::getMaterial() const noexcept
 	return &mMaterial;
 }
 
+const std::vector<glm::vec3>& Model::getMeshPositions() const noexcept
+{
+	return meshPositions;
+}
+
+const std::vector<unsigned int>& Model::getMeshIndices() const noexcept
+{
+	return meshIndices;
+}
+
 
 //#########################################################
 
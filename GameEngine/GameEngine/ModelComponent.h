@@ -162,9 +162,14 @@ public:
 	~Model() {};
 
 
-	void loadFromFile(const std::string& filename, int nRows, int nColumns, bool glbFileType);
+	void loadFromFile(const std::string& filename, int nRows, int nColumns, bool glbFileType, bool keepMesh = false);
 	void clearMemory();
 	const Material* getMaterial() const noexcept;
+
+	//the positions and the triangles(3 indices each) of all the meshes, in model space. They are only kept
+	//in memory if the model was loaded with keepMesh(to build a collider from it, like a HeightField):
+	const std::vector<glm::vec3>& getMeshPositions() const noexcept;
+	const std::vector<unsigned int>& getMeshIndices() const noexcept;
 	
 
 
@@ -253,6 +258,10 @@ private:
 	
 	SceneData sceneData;
 	glm::mat4 m_globalInverseTransform;
+
+	bool keepMesh = false;
+	std::vector<glm::vec3> meshPositions; //see getMeshPositions()
+	std::vector<unsigned int> meshIndices;
 };
 
 
@@ -279,6 +288,7 @@ public:
 private:
 
 	friend class GraphicalSystem;
+	friend class SceneSerializer;
 
 	//constructor:
 	ModelComponent(Entity);
@@ -21,6 +21,7 @@ gabrielgf6000@gmail.com
 
 
 #include "ModelHandler.h"
+#include "Profiler.h"
 
 
 
@@ -29,8 +30,10 @@ gabrielgf6000@gmail.com
 
 
 void ModelHandler::loadModel(std::string path, std::string name, bool useMaterial, 
-	int nRows, int nCollums, bool glbFileType)
+	int nRows, int nCollums, bool glbFileType, bool keepMesh)
 {
+	PROFILE_ZONE("ModelHandler::loadModel");
+
 	//path must contain the address of the folder that contains the .fbx defining the model. The
 	//textures also must be on a .fbm folder within this same folder. The name string contain the name of the .obj
 
@@ -40,9 +43,10 @@ void ModelHandler::loadModel(std::string path, std::string name, bool useMateria
 	//create a model using the Model::init() function
 
 	models.push_back(Model()); //create a model
+	paths.push_back(path + name);
 	
 	//and initialize it
-	models[models.size() - 1].loadFromFile(path + name, nRows, nCollums, glbFileType);
+	models[models.size() - 1].loadFromFile(path + name, nRows, nCollums, glbFileType, keepMesh);
 
 	//---------------------------------------------------------------
 	std::cout << "Successfully loaded " << name << ";\n\n";
@@ -58,3 +62,39 @@ const Model* ModelHandler::getModel(int id) const
 
 	return &(models[id]);
 }
+
+
+
+int ModelHandler::getModelId(const Model* m) const noexcept
+{
+	if (!m || models.empty()) return -1;
+
+	if (m < models.data() || m >= models.data() + models.size()) return -1;
+	return int(m - models.data());
+}
+
+
+
+int ModelHandler::getNumOfModels() const noexcept
+{
+	return int(models.size());
+}
+
+
+
+const std::string& ModelHandler::getModelPath(int id) const
+{
+	if (!(id >= 0 && id < int(paths.size())))
+		throw std::logic_error("ERROR::INVALID ARGUMENT PASSED TO ModelHandler::getModelPath();\n");
+
+	return paths[id];
+}
+
+
+
+int ModelHandler::findModelId(const std::string& path) const noexcept
+{
+	for (size_t i = 0; i < paths.size(); ++i)
+		if (paths[i] == path) return int(i);
+	return -1;
+}
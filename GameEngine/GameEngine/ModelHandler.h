@@ -88,15 +88,20 @@ public:
 							load textures?,
 							number of rows of the textures(they will be used like a spritesheet to make animations)
 							number of collums of the textures,
-							if the model type is glfb(it requires some tweaks)
+							if the model type is glfb(it requires some tweaks),
+							keep the mesh in memory?(see Model::getMeshPositions())
 	*/
 	void loadModel(std::string path, std::string name, bool useMaterial = true, int nRows = 1, 
-							int nCollums = 1, bool glbFileType = false);
+							int nCollums = 1, bool glbFileType = false, bool keepMesh = false);
 
 	
 
 	const Model* getModel(int id) const; //the model id is the same as it's index in the models vector, so 
 									//the first loaded model will have id 0, the second id 1, and so forth.
+	int getModelId(const Model*) const noexcept; //the inverse of getModel(): returns -1 for nullptr or models not stored here
+	int getNumOfModels() const noexcept;
+	const std::string& getModelPath(int id) const; //path + name, as passed to loadModel()
+	int findModelId(const std::string&) const noexcept; //the id of the model loaded from path + name(-1 if there's none)
 
 private:
 
@@ -105,6 +110,7 @@ private:
 
 	//private data:
 	std::vector<Model> models;
+	std::vector<std::string> paths; //paths[id] is the file models[id] was loaded from
 };
 
 
@@ -0,0 +1,415 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "NarrowPhase.h"
+
+#include <cmath>
+
+#include "MathKernels.h" //defines ENGINE_SSE and ENGINE_AVX, and includes the intrinsics
+
+
+//the SIMD operations used by NarrowPhase::solveLanes(), on 8 floats with AVX or 4 with SSE(the loads and
+//stores are aligned, the blocks are aligned to 32 bytes):
+#if defined(ENGINE_AVX)
+
+#define NARROW_PHASE_LANES 8
+typedef __m256 Lanes;
+
+static inline Lanes lanesLoad(const float* p) noexcept { return _mm256_load_ps(p); }
+static inline void lanesStore(float* p, Lanes a) noexcept { _mm256_store_ps(p, a); }
+static inline Lanes lanesSet(float f) noexcept { return _mm256_set1_ps(f); }
+static inline Lanes lanesAdd(Lanes a, Lanes b) noexcept { return _mm256_add_ps(a, b); }
+static inline Lanes lanesSub(Lanes a, Lanes b) noexcept { return _mm256_sub_ps(a, b); }
+static inline Lanes lanesMul(Lanes a, Lanes b) noexcept { return _mm256_mul_ps(a, b); }
+static inline Lanes lanesAbs(Lanes a) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline Lanes lanesGreater(Lanes a, Lanes b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline Lanes lanesLessEqual(Lanes a, Lanes b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline Lanes lanesOr(Lanes a, Lanes b) noexcept { return _mm256_or_ps(a, b); }
+static inline Lanes lanesAndNot(Lanes a, Lanes b) noexcept { return _mm256_andnot_ps(a, b); } //!a & b
+static inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) noexcept //not blendv: GCC splits it without AVX2
+{
+	return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b));
+}
+static inline int lanesMask(Lanes a) noexcept { return _mm256_movemask_ps(a); }
+
+#elif defined(ENGINE_SSE)
+
+#define NARROW_PHASE_LANES 4
+typedef __m128 Lanes;
+
+static inline Lanes lanesLoad(const float* p) noexcept { return _mm_load_ps(p); }
+static inline void lanesStore(float* p, Lanes a) noexcept { _mm_store_ps(p, a); }
+static inline Lanes lanesSet(float f) noexcept { return _mm_set1_ps(f); }
+static inline Lanes lanesAdd(Lanes a, Lanes b) noexcept { return _mm_add_ps(a, b); }
+static inline Lanes lanesSub(Lanes a, Lanes b) noexcept { return _mm_sub_ps(a, b); }
+static inline Lanes lanesMul(Lanes a, Lanes b) noexcept { return _mm_mul_ps(a, b); }
+static inline Lanes lanesAbs(Lanes a) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline Lanes lanesGreater(Lanes a, Lanes b) noexcept { return _mm_cmpgt_ps(a, b); }
+static inline Lanes lanesLessEqual(Lanes a, Lanes b) noexcept { return _mm_cmple_ps(a, b); }
+static inline Lanes lanesOr(Lanes a, Lanes b) noexcept { return _mm_or_ps(a, b); }
+static inline Lanes lanesAndNot(Lanes a, Lanes b) noexcept { return _mm_andnot_ps(a, b); } //!a & b
+static inline Lanes lanesSelect(Lanes mask, Lanes a, Lanes b) noexcept { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline int lanesMask(Lanes a) noexcept { return _mm_movemask_ps(a); }
+
+#else
+
+#define NARROW_PHASE_LANES 1 //the pairs are tested one by one, by testValues()
+
+#endif
+
+#define NARROW_PHASE_PARALLEL_AXES 0.99f //the same threshold of detectBoxToBox2()
+
+
+//NarrowPhase definitions:
+
+
+int NarrowPhase::addPair(const Box& b1, const Box& b2, const glm::mat4& model1, const glm::mat4& model2)
+{
+	int block = numOfPairs / NARROW_PHASE_BLOCK_SIZE, lane = numOfPairs % NARROW_PHASE_BLOCK_SIZE;
+	if (block == int(blocks.size())) blocks.emplace_back();
+
+	setFields(b1, b2, model1, model2, blocks[block].values + lane, NARROW_PHASE_BLOCK_SIZE);
+	return numOfPairs++;
+}
+
+
+//=================================================
+
+
+void NarrowPhase::clear() noexcept
+{
+	numOfPairs = 0;
+}
+
+int NarrowPhase::getNumOfPairs() const noexcept
+{
+	return numOfPairs;
+}
+
+int NarrowPhase::getNumOfLanes() noexcept
+{
+	return NARROW_PHASE_LANES;
+}
+
+
+//=================================================
+
+
+void NarrowPhase::setNumOfPairs(int n)
+{
+	numOfPairs = n;
+	int numOfBlocks = (n + NARROW_PHASE_BLOCK_SIZE - 1) / NARROW_PHASE_BLOCK_SIZE;
+	if (numOfBlocks > int(blocks.size())) blocks.resize(numOfBlocks);
+}
+
+
+//=================================================
+
+
+void NarrowPhase::setPair(int pair, const Box& b1, const Box& b2, const glm::mat4& model1, const glm::mat4& model2) noexcept
+{
+	myAssert(pair >= 0 && pair < numOfPairs);
+	setFields(b1, b2, model1, model2, blocks[pair / NARROW_PHASE_BLOCK_SIZE].values + pair % NARROW_PHASE_BLOCK_SIZE,
+		NARROW_PHASE_BLOCK_SIZE);
+}
+
+
+//=================================================
+
+
+void NarrowPhase::solve() noexcept
+{
+	solve(0, numOfPairs);
+}
+
+
+//=================================================
+
+
+void NarrowPhase::solve(int firstPair, int lastPair) noexcept
+{
+	myAssert(firstPair % NARROW_PHASE_BLOCK_SIZE == 0);
+	myAssert(lastPair % NARROW_PHASE_BLOCK_SIZE == 0 || lastPair == numOfPairs);
+
+#if NARROW_PHASE_LANES > 1
+	//the last group may have lanes after lastPair(they hold old values, and their results are ignored):
+	for (int first = firstPair; first < lastPair; first += NARROW_PHASE_LANES)
+		solveLanes(first);
+#else
+	for (int i = firstPair; i < lastPair; ++i)
+	{
+		Block& block = blocks[i / NARROW_PHASE_BLOCK_SIZE];
+		int lane = i % NARROW_PHASE_BLOCK_SIZE;
+		glm::vec3 separ(0.0f);
+		block.collided[lane] = testValues(block.values + lane, NARROW_PHASE_BLOCK_SIZE, separ);
+		block.results[lane] = separ.x;
+		block.results[NARROW_PHASE_BLOCK_SIZE + lane] = separ.y;
+		block.results[2 * NARROW_PHASE_BLOCK_SIZE + lane] = separ.z;
+	}
+#endif
+}
+
+
+//=================================================
+
+
+bool NarrowPhase::getResult(int pair, glm::vec3& separ) const noexcept
+{
+	myAssert(pair >= 0 && pair < numOfPairs);
+
+	const Block& block = blocks[pair / NARROW_PHASE_BLOCK_SIZE];
+	int lane = pair % NARROW_PHASE_BLOCK_SIZE;
+	separ = glm::vec3(block.results[lane], block.results[NARROW_PHASE_BLOCK_SIZE + lane],
+		block.results[2 * NARROW_PHASE_BLOCK_SIZE + lane]);
+	return block.collided[lane] != 0;
+}
+
+
+//=================================================
+
+
+bool NarrowPhase::testPair(const Box& b1, const Box& b2, const glm::mat4& model1, const glm::mat4& model2,
+	glm::vec3& separ) noexcept
+{
+	float pairValues[NUM_OF_FIELDS];
+	setFields(b1, b2, model1, model2, pairValues, 1);
+	return testValues(pairValues, 1, separ);
+}
+
+
+//=================================================
+
+
+void NarrowPhase::setFields(const Box& b1, const Box& b2, const glm::mat4& model1, const glm::mat4& model2,
+	float* pairValues, int stride) noexcept
+{
+	auto set = [pairValues, stride](int field, const glm::vec3& value)
+	{
+		pairValues[field * stride] = value.x;
+		pairValues[(field + 1) * stride] = value.y;
+		pairValues[(field + 2) * stride] = value.z;
+	};
+
+	set(CENTER_TO_CENTER, b2.pos - b1.pos);
+
+	//the vertices of a box are symmetric, so the first one gives the half size:
+	glm::vec3 half1 = glm::abs(b1.getVertex(0));
+	glm::vec3 half2 = glm::abs(b2.getVertex(0));
+	for (int k = 0; k < 3; ++k)
+	{
+		set(AXES_1 + 3 * k, glm::normalize(glm::vec3(model1[k])));
+		set(AXES_2 + 3 * k, glm::normalize(glm::vec3(model2[k])));
+		set(HALF_AXES_1 + 3 * k, glm::vec3(model1[k]) * half1[k]);
+		set(HALF_AXES_2 + 3 * k, glm::vec3(model2[k]) * half2[k]);
+	}
+	set(HALF_AXES_1 + 9, glm::vec3(model1[3]) - b1.pos); //zero if the model translation is the box center
+	set(HALF_AXES_2 + 9, glm::vec3(model2[3]) - b2.pos);
+}
+
+
+//=================================================
+
+
+bool NarrowPhase::testValues(const float* pairValues, int stride, glm::vec3& separ) noexcept
+{
+	auto get = [pairValues, stride](int field)
+	{
+		return glm::vec3(pairValues[field * stride], pairValues[(field + 1) * stride], pairValues[(field + 2) * stride]);
+	};
+
+	glm::vec3 centerToCenter = get(CENTER_TO_CENTER);
+	glm::vec3 axes1[3], axes2[3], halfAxes1[4], halfAxes2[4];
+	for (int k = 0; k < 3; ++k)
+	{
+		axes1[k] = get(AXES_1 + 3 * k);
+		axes2[k] = get(AXES_2 + 3 * k);
+	}
+	for (int k = 0; k < 4; ++k)
+	{
+		halfAxes1[k] = get(HALF_AXES_1 + 3 * k);
+		halfAxes2[k] = get(HALF_AXES_2 + 3 * k);
+	}
+
+	//the distance between the projections of the boxes on an axis(negative if they overlap):
+	auto overlapOn = [&](const glm::vec3& axis)
+	{
+		FLOAT_TYPE radius1 = 0.0f, radius2 = 0.0f;
+		for (int k = 0; k < 4; ++k)
+		{
+			radius1 += std::fabs(glm::dot(halfAxes1[k], axis));
+			radius2 += std::fabs(glm::dot(halfAxes2[k], axis));
+		}
+		return std::fabs(glm::dot(centerToCenter, axis)) - (radius1 + radius2);
+	};
+
+	//--------------------------------------
+	//the axes of the boxes(the smallest overlap, in absolute value, is kept):
+	FLOAT_TYPE mtvLength = overlapOn(axes1[0]);
+	if (mtvLength > 0.0f) return false; //no intersection in this axis
+	separ = axes1[0] * mtvLength;
+
+	for (int i = 1; i < 6; ++i)
+	{
+		const glm::vec3& axis = i < 3 ? axes1[i] : axes2[i - 3];
+		FLOAT_TYPE overlap = overlapOn(axis);
+		if (overlap > 0.0f) return false;
+		if (std::fabs(overlap) <= std::fabs(mtvLength))
+		{
+			mtvLength = overlap;
+			separ = axis * mtvLength;
+		}
+	}
+
+	//if any axes are parallel, the remaining axes aren't tested:
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			if (std::fabs(glm::dot(axes1[i], axes2[j])) > NARROW_PHASE_PARALLEL_AXES) return true;
+
+	//--------------------------------------
+	//the cross products of the axes(not normalized), in the order of detectBoxToBox2():
+	for (int j = 0; j < 3; ++j)
+		for (int i = 0; i < 3; ++i)
+		{
+			glm::vec3 axis = glm::cross(axes1[i], axes2[j]);
+			FLOAT_TYPE overlap = overlapOn(axis);
+			if (overlap > 0.0f) return false;
+			if (overlap > mtvLength)
+			{
+				mtvLength = overlap;
+				separ = axis * mtvLength;
+			}
+		}
+
+	return true;
+}
+
+
+//=================================================
+
+
+#if NARROW_PHASE_LANES > 1 //solveLanes() is only used with SIMD
+
+void NarrowPhase::solveLanes(int first) noexcept
+//the same as testValues(), for NARROW_PHASE_LANES pairs at once. The lanes never return early: the lanes
+//that were already separated(or that had parallel axes) are masked out of the next updates
+{
+	Block& block = blocks[first / NARROW_PHASE_BLOCK_SIZE];
+	int lane = first % NARROW_PHASE_BLOCK_SIZE; //the first lane(all the lanes are in the same block)
+	const float* pairValues = block.values + lane;
+	auto load = [pairValues](int field, Lanes* vec)
+	{
+		vec[0] = lanesLoad(pairValues + field * NARROW_PHASE_BLOCK_SIZE);
+		vec[1] = lanesLoad(pairValues + (field + 1) * NARROW_PHASE_BLOCK_SIZE);
+		vec[2] = lanesLoad(pairValues + (field + 2) * NARROW_PHASE_BLOCK_SIZE);
+	};
+
+	Lanes centerToCenter[3], axes1[3][3], axes2[3][3], halfAxes1[4][3], halfAxes2[4][3];
+	load(CENTER_TO_CENTER, centerToCenter);
+	for (int k = 0; k < 3; ++k)
+	{
+		load(AXES_1 + 3 * k, axes1[k]);
+		load(AXES_2 + 3 * k, axes2[k]);
+	}
+	for (int k = 0; k < 4; ++k)
+	{
+		load(HALF_AXES_1 + 3 * k, halfAxes1[k]);
+		load(HALF_AXES_2 + 3 * k, halfAxes2[k]);
+	}
+
+	auto dot = [](const Lanes* a, const Lanes* b)
+	{
+		return lanesAdd(lanesAdd(lanesMul(a[0], b[0]), lanesMul(a[1], b[1])), lanesMul(a[2], b[2]));
+	};
+
+	auto overlapOn = [&](const Lanes* axis)
+	{
+		Lanes radius1 = lanesAbs(dot(halfAxes1[0], axis));
+		Lanes radius2 = lanesAbs(dot(halfAxes2[0], axis));
+		for (int k = 1; k < 4; ++k)
+		{
+			radius1 = lanesAdd(radius1, lanesAbs(dot(halfAxes1[k], axis)));
+			radius2 = lanesAdd(radius2, lanesAbs(dot(halfAxes2[k], axis)));
+		}
+		return lanesSub(lanesAbs(dot(centerToCenter, axis)), lanesAdd(radius1, radius2));
+	};
+
+	const Lanes zero = lanesSet(0.0f);
+
+	//--------------------------------------
+	//the axes of the boxes:
+	Lanes mtvLength = overlapOn(axes1[0]);
+	Lanes separated = lanesGreater(mtvLength, zero);
+	Lanes separ[3] = { lanesMul(axes1[0][0], mtvLength), lanesMul(axes1[0][1], mtvLength), lanesMul(axes1[0][2], mtvLength) };
+
+	for (int i = 1; i < 6; ++i)
+	{
+		const Lanes* axis = i < 3 ? axes1[i] : axes2[i - 3];
+		Lanes overlap = overlapOn(axis);
+		separated = lanesOr(separated, lanesGreater(overlap, zero));
+
+		Lanes smaller = lanesLessEqual(lanesAbs(overlap), lanesAbs(mtvLength));
+		mtvLength = lanesSelect(smaller, overlap, mtvLength);
+		for (int c = 0; c < 3; ++c)
+			separ[c] = lanesSelect(smaller, lanesMul(axis[c], overlap), separ[c]);
+	}
+
+	Lanes parallel = zero;
+	const Lanes threshold = lanesSet(NARROW_PHASE_PARALLEL_AXES);
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			parallel = lanesOr(parallel, lanesGreater(lanesAbs(dot(axes1[i], axes2[j])), threshold));
+
+	//--------------------------------------
+	//the cross products of the axes, only if some lane still needs them:
+	const int allLanes = (1 << NARROW_PHASE_LANES) - 1;
+	if (lanesMask(lanesOr(separated, parallel)) != allLanes)
+	{
+		for (int j = 0; j < 3; ++j)
+			for (int i = 0; i < 3; ++i)
+			{
+				const Lanes* a = axes1[i];
+				const Lanes* b = axes2[j];
+				Lanes axis[3] = {
+					lanesSub(lanesMul(a[1], b[2]), lanesMul(b[1], a[2])),
+					lanesSub(lanesMul(a[2], b[0]), lanesMul(b[2], a[0])),
+					lanesSub(lanesMul(a[0], b[1]), lanesMul(b[0], a[1])) };
+
+				Lanes overlap = overlapOn(axis);
+				separated = lanesOr(separated, lanesAndNot(parallel, lanesGreater(overlap, zero)));
+
+				Lanes smaller = lanesAndNot(parallel, lanesGreater(overlap, mtvLength));
+				mtvLength = lanesSelect(smaller, overlap, mtvLength);
+				for (int c = 0; c < 3; ++c)
+					separ[c] = lanesSelect(smaller, lanesMul(axis[c], overlap), separ[c]);
+			}
+	}
+
+	//--------------------------------------
+	lanesStore(block.results + lane, separ[0]);
+	lanesStore(block.results + NARROW_PHASE_BLOCK_SIZE + lane, separ[1]);
+	lanesStore(block.results + 2 * NARROW_PHASE_BLOCK_SIZE + lane, separ[2]);
+
+	int mask = lanesMask(separated);
+	for (int i = 0; i < NARROW_PHASE_LANES; ++i)
+		block.collided[lane + i] = (mask >> i) & 1 ? 0 : 1;
+}
+
+#endif
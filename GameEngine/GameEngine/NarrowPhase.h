@@ -0,0 +1,117 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the NarrowPhase class, the SAT test of the
+box rigid bodies found by the broad phase(see SweepAndPrune.h and AABBTree.h).
+	It finds the same result as detectBoxToBox2()(see CollisionHandling.h), testing the same 15 axes in
+the same order, but a box is described by its center, its axes and its half extents instead of its 8
+vertices: the projection of a box on an axis n is the sum of |dot(halfAxis, n)| for its three half axes,
+so the vertices are never transformed.
+	The pairs are added first, and stored in blocks of NARROW_PHASE_BLOCK_SIZE pairs, in SoA layout inside
+each block(an array with that value of each pair of the block, for each value). Then solve() tests them 4
+at a time with SSE(or 8 with AVX, when the engine is compiled with it), each lane being one pair: no lane
+stops early, a mask keeps which pairs were already separated. The blocks are kept between the steps, so no
+memory is allocated once they have grown to the number of pairs of a step.
+	The blocks are independent, so ranges of them can be filled and solved by different threads(the
+PhysicsEngine does it with the JobSystem).
+*/
+//#################################################################################
+
+#ifndef NARROW_PHASE
+#define NARROW_PHASE
+
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "PhysicalComponents.h"
+
+#include "GlobalDefines.h"
+
+
+#define NARROW_PHASE_BLOCK_SIZE 8 //pairs in each block of values(a multiple of the number of SIMD lanes)
+
+
+class NarrowPhase
+{
+public:
+
+	/*
+		addPair - add a pair to be tested by solve(), with the same arguments of detectBoxToBox2(). Returns
+		the index of the pair(they are numbered from 0 since the last clear())
+	*/
+	int addPair(const Box& b1, const Box& b2, const glm::mat4& model1, const glm::mat4& model2);
+	void clear() noexcept; //remove the pairs(the memory is kept)
+	void solve() noexcept; //test all the pairs added since the last clear()
+
+	/*
+		setNumOfPairs, setPair and solve(first, last) - fill and test the pairs by their indices, so that many
+		threads can do it at once: each thread must use its own blocks(ranges that begin and end at multiples
+		of NARROW_PHASE_BLOCK_SIZE, or at the last pair). The pairs that aren't set hold old values, so their
+		results must be ignored
+	*/
+	void setNumOfPairs(int);
+	void setPair(int pair, const Box& b1, const Box& b2, const glm::mat4& model1, const glm::mat4& model2) noexcept;
+	void solve(int first, int last) noexcept;
+
+	int getNumOfPairs() const noexcept;
+	static int getNumOfLanes() noexcept; //the number of pairs tested at once(1 without SIMD)
+
+	/*
+		getResult - after solve(), returns true if the boxes of the pair collide, and sets the separation
+		vector the same way detectBoxToBox2() does
+	*/
+	bool getResult(int pair, glm::vec3& separ) const noexcept;
+
+	//test one pair now, without SIMD(the same as adding it alone and solving it):
+	static bool testPair(const Box& b1, const Box& b2, const glm::mat4& model1, const glm::mat4& model2,
+		glm::vec3& separ) noexcept;
+
+private:
+
+	//the values of each pair(each is an array of floats):
+	enum Field
+	{
+		CENTER_TO_CENTER = 0, //b2.pos - b1.pos(x, y and z)
+		AXES_1 = 3, //the three normalized axes of b1(3 x 3 values)
+		AXES_2 = 12,
+		HALF_AXES_1 = 21, //the axes of b1 scaled by its half size, and the offset of its model translation from
+		HALF_AXES_2 = 33, //its center(4 x 3 values, the vertices are this offset plus or minus the half axes)
+		NUM_OF_FIELDS = 45
+	};
+
+	struct alignas(32) Block //the SIMD loads and stores are aligned
+	{
+		float values[NUM_OF_FIELDS * NARROW_PHASE_BLOCK_SIZE]; //NUM_OF_FIELDS arrays of NARROW_PHASE_BLOCK_SIZE floats
+		float results[3 * NARROW_PHASE_BLOCK_SIZE]; //the separation vectors(x, y and z arrays)
+		unsigned char collided[NARROW_PHASE_BLOCK_SIZE];
+	};
+
+	static void setFields(const Box&, const Box&, const glm::mat4&, const glm::mat4&, float* values, int stride) noexcept;
+	static bool testValues(const float* values, int stride, glm::vec3& separ) noexcept;
+	void solveLanes(int first) noexcept; //the SIMD test of the pairs from first
+
+	std::vector<Block> blocks; //never shrinks
+	int numOfPairs = 0;
+};
+
+
+#endif // !NARROW_PHASE
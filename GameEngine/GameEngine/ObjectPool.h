@@ -19,7 +19,11 @@ gabrielgf6000@gmail.com
 
 
 This header is part of a self made game engine. It declares the
-ObjectPool class, used to allocate large chunks of memory
+ObjectPool class, used to allocate large chunks of memory.
+	The pool is a slot map: the active Ts are kept packed in a dense array(so iterating
+over them with operator[] is just a walk through contiguous memory), the free slots are kept
+in a free list(so push_back never searches) and each slot has a generation counter, so that a
+PoolHandle that refers to an erased T can be detected instead of silently reading another object.
 */
 //#################################################################################
 
@@ -28,12 +32,36 @@ ObjectPool class, used to allocate large chunks of memory
 
 
 #include <cassert>
+#include <cstdint>
 #include <utility>
 #include <iostream>
 #include <vector>
 
 #include "GlobalDefines.h"
 
+
+//##################################################
+//PoolHandle struct declaration:
+
+
+#define NULL_POOL_SLOT 0xFFFFFFFFu
+
+/*
+	PoolHandle - identifies one T in an ObjectPool. Unlike the indices used by operator[], a handle
+	keeps pointing to the same T after other elements are erased, and becomes invalid(instead of
+	pointing to some other T) when its own T is erased
+*/
+struct PoolHandle
+{
+	uint32_t index = NULL_POOL_SLOT;
+	uint32_t generation = 0;
+
+	bool isNull() const noexcept { return index == NULL_POOL_SLOT; }
+	bool operator==(const PoolHandle& h) const noexcept { return index == h.index && generation == h.generation; }
+	bool operator!=(const PoolHandle& h) const noexcept { return !(*this == h); }
+};
+
+
 //##################################################
 //ObjectPool class declaration:
 
@@ -43,7 +71,7 @@ class ObjectPool
 {
 public:
 
-	/* 
+	/*
 		constructor
 				params: initial size
 						default value for all pool elements
@@ -51,21 +79,48 @@ public:
 	ObjectPool(int, const T&);
 
 
-	T& operator[](int) noexcept;
+	T& operator[](int) noexcept; //returns the i'th active T, in O(1)
+	const T& operator[](int) const noexcept;
 
-	void push_back(const T&) noexcept; 
-	void erase(int) noexcept;  
+	void push_back(const T&) noexcept;
+	void erase(int) noexcept;  //erase the i'th active T. Note: the last T is moved to the i'th position
 	int getReseved() const noexcept;
+	void reserve(int); //reserve memory for at least n Ts(useful before adding many Ts at once)
 	int getSize() const noexcept;
-	std::pair<T, bool>& front() noexcept;
-	std::pair<T, bool>& back() noexcept;
+	T& front() noexcept;
+	T& back() noexcept;
+
+	//handle based access:
+	PoolHandle insert(const T&) noexcept; //the same as push_back, but returns a handle to the new T
+	void erase(PoolHandle) noexcept;
+	T* get(PoolHandle) noexcept; //returns nullptr if the handle is no longer valid
+	const T* get(PoolHandle) const noexcept;
+	bool isValid(PoolHandle) const noexcept;
+	PoolHandle getHandle(int) const noexcept; //returns the handle of the i'th active T
+
+	//iteration over the active Ts:
+	typename std::vector<T>::iterator begin() noexcept { return dense.begin(); }
+	typename std::vector<T>::iterator end() noexcept { return dense.end(); }
+	typename std::vector<T>::const_iterator begin() const noexcept { return dense.begin(); }
+	typename std::vector<T>::const_iterator end() const noexcept { return dense.end(); }
 
 private:
 
-	int size; //number of active Ts in the pool
+	struct Slot
+	{
+		uint32_t generation = 0; //incremented each time the slot's T is erased
+		uint32_t denseIndex = NULL_POOL_SLOT; //position of the T in the dense array(NULL_POOL_SLOT if the slot is free)
+		uint32_t nextFree = NULL_POOL_SLOT; //next slot in the free list
+	};
+
 	T errorElem;
 
-	std::vector<std::pair<T, bool>> pool;
+	std::vector<T> dense; //the active Ts, packed
+	std::vector<uint32_t> denseToSlot; //denseToSlot[i] is the slot that owns dense[i]
+	std::vector<Slot> slots;
+	uint32_t freeHead = NULL_POOL_SLOT; //first slot of the free list
+
+	void eraseDense(uint32_t) noexcept;
 };
 
 //=================================================
@@ -76,10 +131,13 @@ private:
 
 template<typename T>
 ObjectPool<T>::ObjectPool(int n, const T& defaultVal)
-	:size{ 0 }, errorElem{ defaultVal }
+	:errorElem{ defaultVal }
 {
 	myAssert(n != 0);
-	pool = std::vector<std::pair<T, bool>>(n, std::pair<T, bool>(defaultVal, false)); //initialize the pool
+	//reserve memory for the pool(nothing is actived yet):
+	dense.reserve(n);
+	denseToSlot.reserve(n);
+	slots.reserve(n);
 }
 
 
@@ -89,114 +147,193 @@ ObjectPool<T>::ObjectPool(int n, const T& defaultVal)
 template<typename T>
 T& ObjectPool<T>::operator[](int i) noexcept
 {
-	if (!(i >= 0 && i < pool.size() && i < size))
+	if (!(i >= 0 && i < int(dense.size())))
 	{
 		std::cout << "WARNING::ObjectPool::operator[] WAS CALLED WITH INVALID ARGUMENTS. "
 			"FUNCTION HAS EXITED TO AVOID EXCEPTIONS;\n";
-		return errorElem; 
+		return errorElem;
 	}
-	
-	int k = 0;
-	for(int j = 0; j <= pool.size(); ++j) //returns the i'th active T in the pool
-	{
-		if (pool[j].second == true)
-		{
-			if (k == i)
-				return pool[j].first;
 
-			++k;
-		}
+	return dense[i]; //the active Ts are packed, so the i'th active T is just dense[i]
+}
+
+template<typename T>
+const T& ObjectPool<T>::operator[](int i) const noexcept
+{
+	if (!(i >= 0 && i < int(dense.size())))
+	{
+		std::cout << "WARNING::ObjectPool::operator[] WAS CALLED WITH INVALID ARGUMENTS. "
+			"FUNCTION HAS EXITED TO AVOID EXCEPTIONS;\n";
+		return errorElem;
 	}
-	myAssert(false);
+
+	return dense[i];
 }
 
 
 //=================================================
 
-/*
 template<typename T>
-const T& ObjectPool<T>::operator[](int i) const
+void ObjectPool<T>::push_back(const T& t) noexcept
 {
-	myAssert(i >= 0 && i < pool.size() && i < size);
-
-	int k = 0;
-	for (int j = 0; j <= pool.size(); ++j) //returns the i'th active T in the pool
-	{
-		if (pool[j].second == true)
-		{
-			if (k == i)
-				return pool[j].first;
-			++k;
-		}
-	}
-	myAssert(false);
+	insert(t);
 }
-*/
 
 
 //=================================================
 
 template<typename T>
-void ObjectPool<T>::push_back(const T& t) noexcept
+PoolHandle ObjectPool<T>::insert(const T& t) noexcept
 {
 	//std::cout << "Pool Size: "<< size << '\n';
-	if (size == pool.size()) //all Ts are actived
-	{
+	if (dense.size() == dense.capacity()) //all the reserved memory is in use
 		std::cout << "!WARNING: POOL OBJECTS BEING REALOCATED;\n";
-		pool.resize(pool.size() + 100, std::pair<T, bool>(T(), false));
-	}
-	
-	for (int i = 0; i < pool.size(); ++i) //try to find a inactive T in the pool
+
+	uint32_t slotIndex = freeHead;
+	if (slotIndex != NULL_POOL_SLOT) //reuse a free slot
+		freeHead = slots[slotIndex].nextFree;
+	else //no free slot, so create a new one
 	{
-		if(pool[i].second == false) 
-		{
-			pool[i].first = t;
-			pool[i].second = true; //now it is active
-			++size;
-			return;
-		}
+		slotIndex = uint32_t(slots.size());
+		slots.push_back(Slot());
 	}
 
-	myAssert(false);
+	Slot& slot = slots[slotIndex];
+	slot.denseIndex = uint32_t(dense.size());
+	slot.nextFree = NULL_POOL_SLOT;
+
+	dense.push_back(t);
+	denseToSlot.push_back(slotIndex);
+
+	PoolHandle h;
+	h.index = slotIndex;
+	h.generation = slot.generation;
+	return h;
 }
 
+
+//=================================================
+
 template<typename T>
 void ObjectPool<T>::erase(int i) noexcept //erase the i'th T in the pool
 {
-	if (!(i >= 0 && i < pool.size() && i < size))
+	if (!(i >= 0 && i < int(dense.size())))
 	{
 		std::cout << "!WARNING: ObjectPool::erase() WAS CALLED WITH INVALID ARGUMENTS."
 			"FUNCTION HAS BEEN RETURNED TO AVOID EXCEPTIONS;\n";
 		return;
 	}
 
-	int k = 0;
-	for (int j = 0; j < pool.size(); ++j) //find the i'th active T in the pool
+	eraseDense(uint32_t(i));
+}
+
+
+//=================================================
+
+template<typename T>
+void ObjectPool<T>::erase(PoolHandle h) noexcept
+{
+	if (!isValid(h))
+	{
+		std::cout << "!WARNING: ObjectPool::erase() WAS CALLED WITH AN INVALID HANDLE."
+			"FUNCTION HAS BEEN RETURNED TO AVOID EXCEPTIONS;\n";
+		return;
+	}
+
+	eraseDense(slots[h.index].denseIndex);
+}
+
+
+//=================================================
+
+template<typename T>
+void ObjectPool<T>::eraseDense(uint32_t i) noexcept
+//move the last active T to the i'th position, so the dense array stays packed
+{
+	uint32_t slotIndex = denseToSlot[i];
+	uint32_t last = uint32_t(dense.size() - 1);
+
+	if (i != last)
 	{
-		if (pool[j].second == true)
-		{
-			if (k == i) 
-			{
-				pool[j].second = false; //just disable the object
-				--size; //decrease the number of activated Ts
-				return;
-			}
-
-			++k;
-		}
+		dense[i] = std::move(dense[last]);
+		denseToSlot[i] = denseToSlot[last];
+		slots[denseToSlot[i]].denseIndex = i;
 	}
+	dense.pop_back();
+	denseToSlot.pop_back();
+
+	//release the slot(increasing the generation invalidates every handle to the erased T):
+	Slot& slot = slots[slotIndex];
+	++slot.generation;
+	slot.denseIndex = NULL_POOL_SLOT;
+	slot.nextFree = freeHead;
+	freeHead = slotIndex;
+}
+
+
+//=================================================
+
+template<typename T>
+T* ObjectPool<T>::get(PoolHandle h) noexcept
+{
+	if (!isValid(h)) return nullptr;
+	return &dense[slots[h.index].denseIndex];
+}
+
+template<typename T>
+const T* ObjectPool<T>::get(PoolHandle h) const noexcept
+{
+	if (!isValid(h)) return nullptr;
+	return &dense[slots[h.index].denseIndex];
+}
+
+
+//=================================================
+
+template<typename T>
+bool ObjectPool<T>::isValid(PoolHandle h) const noexcept
+{
+	return h.index < slots.size()
+		&& slots[h.index].generation == h.generation
+		&& slots[h.index].denseIndex != NULL_POOL_SLOT;
+}
+
 
-	std::cout << "!WARNING: ObjectPool::erase() DID NOT FOUND ANY ELEMENT TO DELETE;\n";
+//=================================================
+
+template<typename T>
+PoolHandle ObjectPool<T>::getHandle(int i) const noexcept
+{
+	PoolHandle h;
+	if (!(i >= 0 && i < int(dense.size()))) return h; //null handle
 
+	h.index = denseToSlot[i];
+	h.generation = slots[h.index].generation;
+	return h;
 }
 
+
 //=================================================
 
 
 template<typename T>
 int ObjectPool<T>::getReseved() const noexcept
 {
-	return pool.size();
+	return int(dense.capacity());
+}
+
+
+//=================================================
+
+
+template<typename T>
+void ObjectPool<T>::reserve(int n)
+{
+	if (n <= int(dense.capacity())) return;
+
+	dense.reserve(n);
+	denseToSlot.reserve(n);
+	slots.reserve(n);
 }
 
 
@@ -206,7 +343,7 @@ int ObjectPool<T>::getReseved() const noexcept
 template<typename T>
 int ObjectPool<T>::getSize() const noexcept
 {
-	return size;
+	return int(dense.size());
 }
 
 
@@ -214,31 +351,31 @@ int ObjectPool<T>::getSize() const noexcept
 //=================================================
 
 template<typename T>
-std::pair<T, bool>& ObjectPool<T>::front() noexcept
+T& ObjectPool<T>::front() noexcept
 {
-	if (pool.size() == 0)
+	if (dense.size() == 0)
 	{
 		std::cout << "WARNING: ObjectPool::front() called on a pool with 0 elements. errorElem returned "
 			"to avoid exceptions;\n";
 		return errorElem;
 	}
-	return pool[0];
+	return dense.front();
 }
 
 
 //=================================================
 
 template<typename T>
-std::pair<T, bool>& ObjectPool<T>::back() noexcept
+T& ObjectPool<T>::back() noexcept
 {
-	if (pool.size() == 0)
+	if (dense.size() == 0)
 	{
-		std::cout << "WARNING: ObjectPool::front() called on a pool with 0 elements. errorElem returned "
+		std::cout << "WARNING: ObjectPool::back() called on a pool with 0 elements. errorElem returned "
 			"to avoid exceptions;\n";
 		return errorElem;
 	}
 
-	return pool[pool.size() - 1];
+	return dense.back();
 }
 
 
@@ -44,34 +44,46 @@ int Subject::getNumOfObservers() const noexcept
 
 void Subject::addObserver(Observer& ob) //add a observer to the list
 {
-	if (numOfObservers >= MAX_OBSERVERS) myAssert(false);
-	observers[numOfObservers] = &ob;
-	numOfObservers += 1;
+	for (int type = 0; type < int(MessageType::NUM_OF_MESSAGE_TYPES); ++type)
+		addObserver(ob, MessageType(type));
 }
 
-/*
-void Subject::storeMessage(Message msg)
+void Subject::addObserver(Observer& ob, MessageType type) //subscribe a observer to one message type
 {
-	if (numOfMessages >= MAX_MESSAGES) { myAssert(false);  return; }
-	messages[numOfMessages] = msg;
-	numOfMessages += 1;
+	int i = 0;
+	while (i < numOfObservers && observers[i] != &ob) ++i;
+	if (i == numOfObservers)
+	{
+		if (numOfObservers >= MAX_OBSERVERS) { myAssert(false); return; }
+		observers[numOfObservers] = &ob;
+		numOfObservers += 1;
+	}
+
+	std::vector<Observer*>& typeSubscribers = subscribers[int(type)];
+	for (Observer* subscriber : typeSubscribers)
+		if (subscriber == &ob) return;
+	typeSubscribers.push_back(&ob);
 }
-*/
 
-void Subject::storeMessage(Message msg)
+
+void Subject::storeMessage(const Message& msg)
 {
-	//if (numOfMessages >= MAX_MESSAGES) { myAssert(false);  return; }
-	if (numOfMessages >= MAX_MESSAGES) myAssert(false); //don't store if the message storage is full
-	messages[numOfMessages] = msg;
-	numOfMessages += 1;
+	myAssert(msg.type < MessageType::NUM_OF_MESSAGE_TYPES);
+	if (subscribers[int(msg.type)].empty()) return; //nobody would receive it
+	messages[int(msg.type)].push(msg);
 }
 
 
-void Subject::notify() //send all messages to all observers
+void Subject::notify() //send all messages to their observers
 {
-	for (int i = 0; i < numOfMessages; ++i)
-		for (int j = 0; j < numOfObservers; ++j)
-			observers[j]->onNotify(messages[i]);
-	numOfMessages = 0;
-	
+	for (int type = 0; type < int(MessageType::NUM_OF_MESSAGE_TYPES); ++type)
+	{
+		if (messages[type].isEmpty()) continue;
+
+		const std::vector<Observer*>& typeSubscribers = subscribers[type];
+		messages[type].consume([&typeSubscribers](const Message& msg) {
+			for (Observer* observer : typeSubscribers)
+				observer->onNotify(msg);
+		});
+	}
 }
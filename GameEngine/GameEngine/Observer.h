@@ -21,6 +21,10 @@ gabrielgf6000@gmail.com
 
 This header implents the classes needed to use the Observer pattern,
 used to allow communication between the game's systems
+	Each Subject keeps one MessageQueue(see MessageQueue.h) for each MessageType, so any number of messages
+can be stored in a frame, from any thread. The observers subscribe to the types they want to receive, and
+notify() only sends each message to the observers of its type. The messages of a type are sent in the
+order they were stored, and the types are sent in the order they are declared in MessageType.
 */
 //#################################################################################
 
@@ -31,7 +35,9 @@ used to allow communication between the game's systems
 #include <stdexcept>
 #include <cassert>
 #include <iostream>
+#include <vector>
 
+#include "MessageQueue.h"
 #include "GlobalDefines.h"
 
 enum class MessageType
@@ -56,6 +62,7 @@ enum class MessageType
 	APPLY_VERTICAL_FORCE,
 	CHANGE_SPEED,
 	COLLISION_OCCURRED,
+	TRIGGER_OVERLAP, //two bodies overlap and one of them is on a trigger layer(the collision isn't solved)
 
 	//animation related messages:
 	PLAY,
@@ -64,7 +71,9 @@ enum class MessageType
 	//mouse input:
 	MOUSE_BUTTOM_PRESSED,
 	MOUSE_BUTTOM_RELEASED,
-	MOUSE_POSITION_NOTIFICATION
+	MOUSE_POSITION_NOTIFICATION,
+
+	NUM_OF_MESSAGE_TYPES //not a message type, keep it the last one
 };
 
 
@@ -75,7 +84,7 @@ struct Message
 
 	MessageType type = MessageType::DEFAULT_MESSAGE;
 	uint16_t data = 0;
-	int idata[3] = { 0, 0, 0 };
+	int idata[3] = { 0, 0, 0 }; //entity ids are sent here(they don't fit in data)
 	FLOAT_TYPE fdata[3] = {0.0f, 0.0f, 0.0f};
 };
 
@@ -84,7 +93,6 @@ struct Message
 //The Observer and Subject classes:
 
 
-#define MAX_MESSAGES 60
 #define MAX_OBSERVERS 6
 
 class Observer
@@ -107,10 +115,11 @@ public:
 
 	//Functions:
 	int getNumOfObservers() const noexcept;
-	void addObserver(Observer&); //add a observer to the list
-	void notify(); //send all messages to all observers. This function is meant to be called only in the frame end.
+	void addObserver(Observer&); //add a observer to the list(it receives all the message types)
+	void addObserver(Observer&, MessageType); //subscribe a observer to one message type
+	void notify(); //send all messages to their observers. This function is meant to be called only in the frame end.
 			//Messages need to be stored (using the storeMessage method) before each frame's end to be all sent by
-			//the notify method
+			//the notify method(which must not run while other threads store messages)
 
 protected:
 
@@ -118,14 +127,14 @@ protected:
 	~Subject(); //don't allow deletion through a ptr to Subject 
 
 	//protected Functions:
-	void storeMessage(Message);
+	void storeMessage(const Message&); //thread safe(and lock free)
 
 	//Data:
-	Observer* observers[MAX_OBSERVERS];
+	Observer* observers[MAX_OBSERVERS]; //the distinct observers
 	int numOfObservers = 0;
 
-	Message messages[MAX_MESSAGES];
-	int numOfMessages;
+	std::vector<Observer*> subscribers[int(MessageType::NUM_OF_MESSAGE_TYPES)]; //the observers of each type
+	MessageQueue<Message> messages[int(MessageType::NUM_OF_MESSAGE_TYPES)]; //the messages of each type
 };
 
 inline Subject::Subject() {};
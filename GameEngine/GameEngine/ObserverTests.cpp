@@ -0,0 +1,102 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <vector>
+
+#include "Observer.h"
+#include "JobSystem.h"
+#include "BenchmarkHelpers.h"
+
+
+namespace
+{
+	class BenchmarkSubject : public Subject
+	{
+	public:
+		void post(const Message& msg) { storeMessage(msg); }
+	};
+
+	class BenchmarkObserver : public Observer
+	{
+	public:
+		void onNotify(Message msg) override
+		//idata[0] is the producer and idata[1] the message number of that producer
+		{
+			++received;
+			int& expected = nextOfProducer[msg.idata[0]];
+			if (msg.idata[1] != expected) ordered = false;
+			expected = msg.idata[1] + 1;
+		}
+
+		std::vector<int> nextOfProducer;
+		int received = 0;
+		bool ordered = true;
+	};
+}
+
+
+void benchmarkMessageQueue()
+{
+	std::cout << "MessageQueue:\n";
+
+	const int numOfProducers = 4;
+	BenchmarkSubject subject;
+	BenchmarkObserver observer;
+	subject.addObserver(observer, MessageType::COLLISION_OCCURRED);
+
+	const int sizes[] = { 1000, 10000, 100000, 1000000 };
+	for (int n : sizes)
+	{
+		int perProducer = n / numOfProducers;
+		observer.nextOfProducer.assign(numOfProducers, 0);
+		observer.received = 0;
+		observer.ordered = true;
+
+		//store them from several jobs:
+		auto start = BenchClock::now();
+		JobCounter counter;
+		for (int p = 0; p < numOfProducers; ++p)
+			JobSystem::instance().run([&subject, p, perProducer]() {
+				Message msg(MessageType::COLLISION_OCCURRED, 0);
+				msg.idata[0] = p;
+				for (int i = 0; i < perProducer; ++i)
+				{
+					msg.idata[1] = i;
+					subject.post(msg);
+				}
+			}, &counter);
+		JobSystem::instance().wait(counter);
+		double storeCost = nanosecondsSince(start) / (double(perProducer) * numOfProducers);
+
+		//and send them:
+		start = BenchClock::now();
+		subject.notify();
+		double notifyCost = nanosecondsSince(start) / (double(perProducer) * numOfProducers);
+
+		std::cout << "  N = " << n
+			<< ", store: " << storeCost << " ns/msg"
+			<< ", notify: " << notifyCost << " ns/msg"
+			<< ", messages: " << checkResult(observer.received == perProducer * numOfProducers)
+			<< ", order: " << checkResult(observer.ordered) << '\n';
+	}
+}
@@ -20,6 +20,8 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "ParticleSystem.h"
+#include "Profiler.h"
+#include "GameClock.h"
 
 
 
@@ -61,7 +63,7 @@ void ParticlePool::addParticle(const Particle& p) noexcept
 
 ParticleSystem::ParticleSystem() noexcept
 {
-	generator = std::default_random_engine(std::chrono::system_clock::now().time_since_epoch().count());
+	generator = std::default_random_engine(GameClock::instance().getRandomSeed()); //fixed in deterministic mode
 	distribuition = std::uniform_real_distribution<double>(-1.0, 1.0);
 
 }
@@ -72,10 +74,13 @@ ParticleSystem::ParticleSystem() noexcept
 
 void ParticleSystem::update(FLOAT_TYPE dt) noexcept
 {
+	PROFILE_ZONE("ParticleSystem::update");
 
-	for(int i = 0; i < PARTICLE_POOL_SIZE; ++i)
+	//the whole pool is updated in about a microsecond, less than the cost of queueing a job, so it
+	//stays in this thread(the JobSystem would only make it slower until the pool is much bigger):
+	for (int i = 0; i < PARTICLE_POOL_SIZE; ++i)
 	{
-		if(particlePool.particles[i].life > 0.0)
+		if (particlePool.particles[i].life > 0.0)
 			particlePool.particles[i].update(dt);
 	}
 
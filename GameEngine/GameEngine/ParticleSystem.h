@@ -24,7 +24,7 @@ update all particles in the game.
 	The other game systems can request the generation of particles by accessing the ParticleSystem that is 
 contained in the Scene class.
 The particles being stored in just one big container instead of in indiviual components makes it possible to
-update(this is the job of the PhysicsEngine) them in a multithreaded way(not implemented yet) and allows a better use 
+update(this is the job of the PhysicsEngine) them in a multithreaded way(not needed yet, see update()) and allows a better use 
 of the cpu cache. These particles does not interact with other game objects, they are just graphical elements.
 */
 //#############################################################################################
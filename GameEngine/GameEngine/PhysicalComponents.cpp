@@ -125,6 +125,7 @@ template<typename T>
 void RigidBodyComponent<T>::addForce(glm::vec3 force) noexcept
 {
 	forces += force;
+	logChange();
 }
 
 //--------------------------------------------------------------------------------------------
@@ -133,6 +134,7 @@ template<typename T>
 void RigidBodyComponent<T>::addLinearVelocity(glm::vec3 vel) noexcept
 {
 	linearVelocity += vel;
+	logChange();
 }
 
 
@@ -143,6 +145,7 @@ void RigidBodyComponent<T>::move(glm::vec3 m) noexcept
 {
 	if(mass >= 0.0)
 		shape.pos += m;
+	logChange();
 }
 
 //--------------------------------------------------------------------------------------------
@@ -152,6 +155,7 @@ void RigidBodyComponent<T>::setMass(FLOAT_TYPE m) noexcept
 {
 	mass = m; 
 	//infinite mass
+	logChange();
 }
 
 //--------------------------------------------------------------------------------------------
@@ -180,6 +184,7 @@ template<typename T>
 void RigidBodyComponent<T>::setPosition(glm::vec3 newPos) noexcept
 {
 	shape.pos = newPos;
+	logChange();
 }
 
 
@@ -189,12 +194,41 @@ template<typename T>
 void RigidBodyComponent<T>::setSize(glm::vec3 newSize) noexcept
 {
 	shape.setSize(newSize.x, newSize.y, newSize.z);
+	logChange();
 }
 
 
 
 //--------------------------------------------------------------------------------------------
 
+template<typename T>
+bool RigidBodyComponent<T>::isSleeping() const noexcept
+{
+	return sleeping;
+}
+
+//--------------------------------------------------------------------------------------------
+
+template<typename T>
+void RigidBodyComponent<T>::wakeUp() noexcept
+{
+	sleeping = false; //the PhysicsEngine wakes the rest of the island when it sees it
+	sleepTime = 0.0f;
+	logChange();
+}
+
+
+//--------------------------------------------------------------------------------------------
+
+template<typename T>
+void RigidBodyComponent<T>::logChange() noexcept
+{
+	if (logged || !changeLog) return;
+
+	logged = true;
+	changeLog->push_back(getEntityId());
+}
+
 
 //--------------------------------------------------------------------------------------------
 
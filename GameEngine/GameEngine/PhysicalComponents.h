@@ -40,6 +40,11 @@ gabrielgf6000@gmail.com
 #include "GlobalDefines.h"
 
 
+#define PHYSICS_MAX_LAYERS 32 //collision layers of the bodies(see PhysicsEngine::setLayersCollide())
+#define PHYSICS_FRICTION 0.8f //the default friction coefficient of the boxes
+#define PHYSICS_RESTITUTION 0.2f //the default bounce of the boxes
+
+
 //######################################################################################################
 //helper classes and functions:
 
@@ -78,12 +83,30 @@ struct Box
 	glm::vec3 pos = glm::vec3(0.0f); //the same as the center of the box
 
 private:
+	friend class SceneSerializer;
+
 	//Private data:
 	glm::vec3 vertices[8];
 	glm::vec3 size;
 };
 
 
+
+struct AABB //an axis aligned box in world space, used to find the pairs of bodies that may collide
+{
+	bool overlaps(const AABB& other) const noexcept //boxes that only touch also overlap
+	{
+		return min.x <= other.max.x && other.min.x <= max.x
+			&& min.y <= other.max.y && other.min.y <= max.y
+			&& min.z <= other.max.z && other.min.z <= max.z;
+	}
+
+	//Data:
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+};
+
+
 //######################################################################################################
 //RigidBodyComponent:
 
@@ -107,11 +130,33 @@ public:
 	void setPosition(glm::vec3) noexcept;
 	void setSize(glm::vec3) noexcept;
 
+	//a box at rest for a while falls asleep(with the boxes touching it), and isn't simulated until something
+	//touches it or changes it. wakeUp() wakes it(and its island) in the next step. The static and sleeping boxes
+	//are only seen changed through these functions(or their transform), so call wakeUp() after writing the
+	//mass or the velocity of one of them directly:
+	bool isSleeping() const noexcept;
+	void wakeUp() noexcept;
+
 	FLOAT_TYPE mass = 1.0;
 	glm::vec3 linearVelocity = glm::vec3(0.0f);
+
+	//continuous collision detection, for the bodies that can move more than their half size in a step(thrown
+	//weapons, projectiles, jumping characters). They stop at the first body on their way instead of passing it:
+	bool fast = false;
+
+	//the collision layer(0 to PHYSICS_MAX_LAYERS - 1): the PhysicsEngine only tests the pairs of bodies whose
+	//layers collide, and the pairs with a trigger layer are only notified, never solved:
+	int layer = 0;
+
+	//the material(only used by the boxes): a contact uses the geometric mean of the frictions of its two bodies
+	//and the biggest restitution(a contact with the heightfield uses the material of the box). It only bounces
+	//if the bodies collide faster than PHYSICS_RESTITUTION_THRESHOLD:
+	FLOAT_TYPE friction = PHYSICS_FRICTION;
+	FLOAT_TYPE restitution = PHYSICS_RESTITUTION;
 private:
 
 	friend class PhysicsEngine; //allow the physics engine to access the private data
+	friend class SceneSerializer;
 
 	//constructor:
 	RigidBodyComponent(Entity, T);
@@ -126,6 +171,22 @@ private:
 	//angular constraints:
 	bool xRot = true, yRot = true, zRot = true; //used to enable or disable rotation on each axis
 
+	//broad phase(only used by the boxes):
+	int proxy = -1; //the proxy of this body in one of the AABBTrees of the PhysicsEngine
+	bool staticProxy = false; //if the proxy is in the static tree
+
+	//sleeping(only used by the boxes):
+	FLOAT_TYPE sleepTime = 0.0f; //how long the body has been resting, in seconds
+	bool sleeping = false;
+	int island = -1; //the sleeping island of the body in the PhysicsEngine(-1 if it's awake)
+
+	//change log(only used by the boxes): the functions that change the body add it to the list of the
+	//PhysicsEngine once, so the static and sleeping boxes that weren't changed are never visited:
+	std::vector<Entity>* changeLog = nullptr;
+	bool logged = false;
+
+	void logChange() noexcept;
+
 };
 
 
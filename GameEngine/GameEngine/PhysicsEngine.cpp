@@ -20,6 +20,10 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "PhysicsEngine.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
 
 
 //PhysicsEngine definitions:
@@ -42,6 +46,8 @@ void PhysicsEngine::initialize(World* w)
 
 void PhysicsEngine::update() //integrate by timeStep seconds
 {
+	PROFILE_ZONE("PhysicsEngine::update");
+
 	solveForSpheres();
 	solveForBoxes();
 
@@ -105,20 +111,19 @@ void PhysicsEngine::addBoxPhysicalComponent(Entity id, int x, int y, int z, glm:
 void PhysicsEngine::onNotify(Message msg)
 {
 	//std::cout << "HEEE" << int(msg.type) << '\n';
-	//std::cout << "Physics: " << numOfMessages << '\n';
 	switch (msg.type)
 	{
 	case MessageType::APPLY_FORCE:
 	{
 		
-		RigidBodyComponent<Box>* boxComp = world->currentScene->getBoxRigidBodyComponent(msg.data);
+		RigidBodyComponent<Box>* boxComp = world->currentScene->getBoxRigidBodyComponent(msg.idata[0]);
 		myAssert(boxComp);
 		boxComp->addLinearVelocity(glm::vec3(msg.fdata[0], msg.fdata[1], msg.fdata[2]) / boxComp->mass);
 		break;
 	}
 	case MessageType::APPLY_VERTICAL_FORCE:
 	{
-		RigidBodyComponent<Box>* boxComp = world->currentScene->getBoxRigidBodyComponent(msg.data);
+		RigidBodyComponent<Box>* boxComp = world->currentScene->getBoxRigidBodyComponent(msg.idata[0]);
 		myAssert(boxComp);
 		//std::cout << fabs(boxComp->linearVelocity.y) << '\n';
 		//if(fabs(boxComp->deltaSpace.z) < 0.1f)
@@ -135,6 +140,97 @@ void PhysicsEngine::onNotify(Message msg)
 
 
 
+//-------------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::setMultithreaded(bool value) noexcept
+{
+	multithreaded = value;
+}
+
+bool PhysicsEngine::isMultithreaded() const noexcept
+{
+	return multithreaded;
+}
+
+void PhysicsEngine::setSolverIterations(int iterations) noexcept
+{
+	myAssert(iterations >= 0);
+	solverIterations = iterations;
+}
+
+int PhysicsEngine::getSolverIterations() const noexcept
+{
+	return solverIterations;
+}
+
+
+//-------------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::setHeightField(HeightField ground)
+{
+	heightField = std::move(ground);
+
+	//the contacts with the old ground aren't kept:
+	manifolds.erase(std::remove_if(manifolds.begin(), manifolds.end(), [](const Manifold& manifold)
+	{
+		return manifold.first == NULL_ENTITY;
+	}), manifolds.end());
+}
+
+const HeightField& PhysicsEngine::getHeightField() const noexcept
+{
+	return heightField;
+}
+
+void PhysicsEngine::clearHeightField() noexcept
+{
+	setHeightField(HeightField());
+}
+
+
+//-------------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::setLayersCollide(int layer1, int layer2, bool value) noexcept
+{
+	myAssert(layer1 >= 0 && layer1 < PHYSICS_MAX_LAYERS && layer2 >= 0 && layer2 < PHYSICS_MAX_LAYERS);
+
+	if (value)
+	{
+		filteredLayers[layer1] &= ~(1u << layer2);
+		filteredLayers[layer2] &= ~(1u << layer1);
+	}
+	else
+	{
+		filteredLayers[layer1] |= 1u << layer2;
+		filteredLayers[layer2] |= 1u << layer1;
+	}
+}
+
+bool PhysicsEngine::doLayersCollide(int layer1, int layer2) const noexcept
+{
+	return !isFiltered(layer1, layer2);
+}
+
+void PhysicsEngine::setTriggerLayer(int layer, bool value) noexcept
+{
+	myAssert(layer >= 0 && layer < PHYSICS_MAX_LAYERS);
+
+	if (value)
+		triggerLayers |= 1u << layer;
+	else
+		triggerLayers &= ~(1u << layer);
+}
+
+bool PhysicsEngine::isTriggerLayer(int layer) const noexcept
+{
+	myAssert(layer >= 0 && layer < PHYSICS_MAX_LAYERS);
+	return (triggerLayers >> layer) & 1u;
+}
+
+
 //-------------------------------------------------------------------------------------------------------------
 
 
@@ -159,30 +255,10 @@ glm::mat4 PhysicsEngine::normalizeRows(int nRows, glm::mat4 mat) const noexcept
 glm::mat4 PhysicsEngine::getFullTransform(Entity id) const
 {
 	myAssert(world->currentScene->getEntity(id));
-	glm::mat4 fullTransform = glm::mat4(1.0f);
-
 
-	//iterate over all TransformComponents 
-	for (int i = 0; i < world->currentScene->transformComponents.getSize(); ++i)
-	{
-		if (world->currentScene->transformComponents[i].getEntityId() == id)
-		{
-			fullTransform = 
-				normalizeRows(3, world->currentScene->transformComponents[i].getTransform());
-
-			const TransformComponent* current = &(world->currentScene->transformComponents[i]);
-			while (current->getParent() >= 0)
-			{
-				//set current to the TransformComponent of it's parent
-				current = world->currentScene->getTransformComponent(current->getParent());
-				//combine the parent and child transform: (note that the parent's scale will not affect
-				//it childs, this is done normalizing the collums of the 3x3 uper matrix)
-				fullTransform = normalizeRows(3, current->getTransform()) * fullTransform;
-			}
-			break;
-		}
-	}
-	return fullTransform;
+	//the TransformComponent caches the combination with its parents(note that the parent's scale will not
+	//affect it childs, and that the scale of the object itself is removed too):
+	return world->currentScene->getTransformComponent(id)->getRigidWorldTransform();
 }
 
 
@@ -193,30 +269,8 @@ glm::mat4 PhysicsEngine::getFullTransform(Entity id) const
 glm::quat PhysicsEngine::getFullRotationQuaternion(Entity id) const
 {
 	myAssert(world->currentScene->getEntity(id));
-	glm::quat fullQuaternion;
-
 
-	//iterate over all TransformComponents 
-	for (int i = 0; i < world->currentScene->transformComponents.getSize(); ++i)
-	{
-		if (world->currentScene->transformComponents[i].getEntityId() == id)
-		{
-			fullQuaternion = 
-				world->currentScene->transformComponents[i].getOrientation();
-
-			const TransformComponent* current = &(world->currentScene->transformComponents[i]);
-			while (current->getParent() >= 0)
-			{
-				//set current to the TransformComponent of it's parent
-				current = world->currentScene->getTransformComponent(current->getParent());
-				//combine the parent and child transform: (note that the parent's scale will not affect
-				//it childs, this is done normalizing the collums of the 3x3 uper matrix)
-				fullQuaternion = current->getOrientation() * fullQuaternion;
-			}
-			break;
-		}
-	}
-	return fullQuaternion;
+	return world->currentScene->getTransformComponent(id)->getWorldOrientation();
 }
 
 
@@ -227,39 +281,77 @@ glm::quat PhysicsEngine::getFullRotationQuaternion(Entity id) const
 void PhysicsEngine::solveForSpheres() 
 //update and solve collision for all sphere rigid bodies in the scene
 {
+	PROFILE_ZONE("PhysicsEngine::solveForSpheres");
+
+	ComponentPool<RigidBodyComponent<Sphere>>& spheres = world->currentScene->sphereRigidBodyComponents;
+	int numOfSpheres = spheres.getSize();
+	if (numOfSpheres == 0) return;
 
-	//for each sphere rigid body in the scene
-	for (int i = 0; i < world->currentScene->sphereRigidBodyComponents.getSize(); ++i)
+	//update the data of each sphere(each job only changes its own spheres):
+	sphereSteps.resize(numOfSpheres);
+	runJobs(numOfSpheres, PHYSICS_SPHERES_GRAIN_SIZE, [&spheres, this](int first, int last)
 	{
-		RigidBodyComponent<Sphere>* sphereComp = &(world->currentScene->sphereRigidBodyComponents[i]);
-		//update it's data:
-		sphereComp->linearVelocity += (sphereComp->forces * timeStep) / sphereComp->mass;
-		glm::vec3 deltaS = sphereComp->linearVelocity;
+		for (int i = first; i < last; ++i)
+		{
+			RigidBodyComponent<Sphere>* sphereComp = &spheres[i];
+			sphereComp->linearVelocity += (sphereComp->forces * timeStep) / sphereComp->mass;
+			glm::vec3 deltaS = sphereComp->linearVelocity;
+
+			//reset forces:
+			sphereComp->forces *= 0.0f;
 
-		//reset forces:
-		sphereComp->forces *= 0.0f;
+			//update position(the fast spheres are moved after the others, see below):
+			sphereSteps[i] = deltaS;
+			if (!sphereComp->fast) sphereComp->shape.pos += deltaS;
 
-		//update position:
-		sphereComp->shape.pos += deltaS;
-		world->currentScene->getTransformComponent(sphereComp->getEntityId())->setPosition(sphereComp->shape.pos);
+			//apply air resistance
+			sphereComp->linearVelocity *= 0.8f;
+			if (glm::length(sphereComp->linearVelocity) <= 0.1) sphereComp->linearVelocity = glm::vec3(0.0f);
+		}
+	});
 
-		//apply air resistance
-		sphereComp->linearVelocity *= 0.8f;
-		if (glm::length(sphereComp->linearVelocity) <= 0.1) sphereComp->linearVelocity = glm::vec3(0.0f);
+	//the fast spheres stop at the first sphere on their way(in the order of the pool, so the result doesn't
+	//depend on the jobs):
+	for (int i = 0; i < numOfSpheres; ++i)
+		if (spheres[i].fast) spheres[i].shape.pos += sweepSphere(i, sphereSteps[i]);
 
-		//handle collisions:
-		//auto iter2 = iter;
-		int i2 = i + 1;
+	//test collision bettween each sphere and the next spheres in the scene:
+	runJobs(numOfSpheres, PHYSICS_SPHERES_GRAIN_SIZE, [&spheres, numOfSpheres, this](int first, int last)
+	{
+		std::vector<Contact>& buffer = contactBuffers[first / PHYSICS_SPHERES_GRAIN_SIZE];
 		glm::vec3 separVec;
-		//test collision bettween this sphere and the other spheres in the scene
-		for (; i2 < world->currentScene->sphereRigidBodyComponents.getSize(); ++i2)
+		for (int i = first; i < last; ++i)
+			for (int i2 = i + 1; i2 < numOfSpheres; ++i2)
+				if (!isFiltered(spheres[i].layer, spheres[i2].layer)
+					&& detectSphereToSphere(spheres[i].shape, spheres[i2].shape, separVec))
+					buffer.push_back({ i, i2, separVec });
+	});
+	mergeContacts(numOfSpheres, PHYSICS_SPHERES_GRAIN_SIZE);
+
+	//handle collisions, in the order of the pairs(a pair is tested again if an earlier one moved its spheres):
+	spheresMoved.assign(numOfSpheres, 0);
+	for (const Contact& contact : contacts)
+	{
+		RigidBodyComponent<Sphere>* sphereComp = &spheres[contact.first];
+		RigidBodyComponent<Sphere>* sphereComp2 = &spheres[contact.second];
+
+		glm::vec3 separVec = contact.separ;
+		if ((spheresMoved[contact.first] || spheresMoved[contact.second])
+			&& !detectSphereToSphere(sphereComp->shape, sphereComp2->shape, separVec))
+			continue;
+
+		if (isTrigger(sphereComp->layer, sphereComp2->layer))
 		{
-			RigidBodyComponent<Sphere>* sphereComp2 = &(world->currentScene->sphereRigidBodyComponents[i2]);
-			if (detectSphereToSphere(sphereComp->shape, sphereComp2->shape, separVec))
-				resolveSphereToSphere(*sphereComp, *sphereComp2, separVec);
+			sendTrigger(sphereComp->getEntityId(), sphereComp2->getEntityId());
+			continue;
 		}
+
+		resolveSphereToSphere(*sphereComp, *sphereComp2, separVec);
+		spheresMoved[contact.first] = spheresMoved[contact.second] = 1;
 	}
 
+	for (int i = 0; i < numOfSpheres; ++i)
+		world->currentScene->getTransformComponent(spheres[i].getEntityId())->setPosition(spheres[i].shape.pos);
 }
 
 
@@ -269,129 +361,1369 @@ void PhysicsEngine::solveForSpheres()
 
 void PhysicsEngine::solveForBoxes()
 {
-	//std::cout << "-------------------------\n";
-	//for each box rigid body in the scene
-	for (int i = 0; i < world->currentScene->boxRigidBodyComponents.getSize(); ++i)
+	PROFILE_ZONE("PhysicsEngine::solveForBoxes");
+
+	syncBoxProxies();
+
+	ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	int numOfBoxes = boxes.getSize();
+
+	//the boxes that are integrated in this step are copied to the store. Only the boxes in the dynamic tree and
+	//the changed ones are visited, in the order of the pool:
+	findVisitedBoxes();
+	dynamicBoxes.clear();
+	dynamicBounds.clear();
+	integratedBoxes.clear();
+	for (size_t k = 0; k < visitedBoxes.size(); ++k)
 	{
-		RigidBodyComponent<Box>* boxComp = &(world->currentScene->boxRigidBodyComponents[i]);
-		//update it's data:
-		boxComp->linearVelocity += (boxComp->forces * timeStep) / (boxComp->mass > 0.0f ? boxComp->mass : 1.0f);
-		if (boxComp->mass > 0.0f) boxComp->linearVelocity.y += -10.0f * timeStep;
-		glm::vec3 deltaS = boxComp->linearVelocity;
-		
-		//reset forces:
-		boxComp->forces *= 0.0f;
+		int i = visitedBoxes[k];
+		RigidBodyComponent<Box>* boxComp = &boxes[i];
+
+		//the static boxes and the sleeping boxes that weren't changed cost nothing(integrating them wouldn't
+		//change them). A changed one is integrated, so its data is recomputed and its leaf is moved below:
+		if (boxComp->staticProxy && (isStaticBox(*boxComp) || isSleepingBox(*boxComp)) && !isBoxChanged(i)) continue;
+		if (boxComp->island >= 0) //it was changed(or woken) while sleeping, so its island wakes
+		{
+			size_t woken = wokenBoxes.size();
+			wakeBox(i);
+
+			//and its boxes after this one are visited too(the ones before it are added by addWokenBoxes()):
+			for (size_t w = woken; w < wokenBoxes.size(); ++w)
+				if (wokenBoxes[w] > i) visitedBoxes.push_back(wokenBoxes[w]);
+			std::sort(visitedBoxes.begin() + k + 1, visitedBoxes.end());
+			visitedBoxes.erase(std::unique(visitedBoxes.begin() + k + 1, visitedBoxes.end()), visitedBoxes.end());
+		}
+		stepPositions[i] = boxComp->shape.pos;
+		integratedBoxes.push_back(i);
+	}
 
-		//update position:
-		//iter->deltaSpace = -iter->shape.pos;
-		boxComp->shape.pos += deltaS;
-		//iter->deltaSpace += iter->shape.pos;
-		world->currentScene->getTransformComponent(boxComp->getEntityId())->setPosition(boxComp->shape.pos);
+	bodyStore.setNumOfBodies(int(integratedBoxes.size()));
+	storeIndices.assign(numOfBoxes, -1);
+	for (int k = 0; k < int(integratedBoxes.size()); ++k)
+	{
+		const RigidBodyComponent<Box>& boxComp = boxes[integratedBoxes[k]];
+		bodyStore.setBody(k, boxComp.shape.pos, boxComp.linearVelocity, boxComp.forces, boxComp.mass, boxComp.fast);
+		storeIndices[integratedBoxes[k]] = k;
+	}
 
-		//apply(fake) air resistance forces:
-		boxComp->linearVelocity *= 0.90f;
+	//update their data(forces and gravity, the contacts of the last step, then the position and the air
+	//resistance), all at once:
+	bodyStore.integrateVelocities(timeStep);
+	solveContacts();
+	bodyStore.integratePositions();
 
-		if (std::fabs(boxComp->linearVelocity.x) <= 0.025) boxComp->linearVelocity.x = 0.0f;
-		if (std::fabs(boxComp->linearVelocity.y) <= 0.04) boxComp->linearVelocity.y = 0.0f;
-		if (std::fabs(boxComp->linearVelocity.z) <= 0.025) boxComp->linearVelocity.z = 0.0f;
-		
+	//and copy the results back, in the order of the pool(a fast box is only moved here, so the boxes it
+	//sweeps are the ones before it at their new positions, and the ones after it at their old positions):
+	for (int k = 0; k < int(integratedBoxes.size()); ++k)
+	{
+		int i = integratedBoxes[k];
+		RigidBodyComponent<Box>* boxComp = &boxes[i];
+
+		glm::vec3 deltaS = bodyStore.getStep(k) + pushes[k];
+		if (boxComp->fast)
+		{
+			deltaS = sweepBox(i, deltaS); //it stops at the first box on its way
+			boxComp->shape.pos += deltaS;
+		}
+		else
+			boxComp->shape.pos = bodyStore.getPosition(k) + pushes[k];
+		boxComp->linearVelocity = bodyStore.getVelocity(k);
+		boxComp->forces = glm::vec3(0.0f);
 
 		//-------------------------------
-		//handle collisions:
-		//auto iter2 = iter;
-		int i2 = i + 1;
-		glm::vec3 separVec; //used to correct penetration
+		updateBoxData(i);
+
+		bool isStatic = isStaticBox(*boxComp);
+		bool reinserted = true;
+		if (isStatic != boxComp->staticProxy)
+			setBoxProxy(i, isStatic);
+		else
+			reinserted = (isStatic ? staticTree : dynamicTree).moveProxy(boxComp->proxy, boxBounds[i], deltaS);
 
-		glm::mat4 model = getFullTransform(boxComp->getEntityId()); //used to convert the box vertices to world space
+		if (reinserted && isStatic) ++staticVersion;
+		if (reinserted) neighboursVersion[i] = 0; //its fat AABB changed
 
-		//test collision bettween this box and the other boxes in the scene
-		for (; i2 < world->currentScene->boxRigidBodyComponents.getSize(); ++i2)
+		if (!isStatic)
 		{
-			RigidBodyComponent<Box>* boxComp2 = &(world->currentScene->boxRigidBodyComponents[i2]);
+			dynamicBoxes.push_back(i);
+			dynamicBounds.push_back(boxBounds[i]);
+		}
+	}
 
-			if (boxComp->mass <= 0 && boxComp2->mass <= 0) continue; //don't solve for objects with infinite mass
+	addWokenBoxes(); //the boxes of the islands woken above that were already passed
 
-			//first do a simple bounding sphere test:
-			if (!boundSphereTest(boxComp->shape.pos, boxComp2->shape.pos,
-				glm::length(boxComp->shape.getVertex(0)),
-				glm::length(boxComp2->shape.getVertex(0))))
-				//glm::max(boxComp->shape.getSize().x, glm::max(boxComp->shape.getSize().y, boxComp->shape.getSize().z)), //!
-				//glm::max(boxComp2->shape.getSize().x, glm::max(boxComp2->shape.getSize().y, boxComp2->shape.getSize().z)))) 
-				continue;
-	
-			//----------------------------
-			//collision might have happened, do a more complex test:
-			glm::vec3 mtv;
-			glm::mat4 model2 = getFullTransform(boxComp2->getEntityId());
-	
-			bool a2 = (boxComp->getEntityId() == 0 && boxComp2->getEntityId() == 2) ? true : false;
-			if (!detectBoxToBox2(boxComp2->shape, boxComp->shape, model2, model, mtv, a2)) continue; //collision detection failed
-
-			resolveBoxToBox(*boxComp2, *boxComp, mtv);
-
-			//----------------------------
-			Message msg; //a message notifiyng the collision
-			msg.type = MessageType::COLLISION_OCCURRED;
-			msg.fdata[0] = boxComp->getEntityId();  //the id of the first body
-			msg.fdata[1] = boxComp2->getEntityId(); //and the id of the second
-			msg.fdata[2] = boxComp->shape.pos.y - boxComp2->shape.pos.y; //if this is positve, then box1 is above box2
-
-			storeMessage(msg); //store the message(it will be sent in the frame's end)
+	//-------------------------------
+	//find the pairs of boxes whose bounds overlap(the static boxes are never tested against each other):
+	boxPairs.clear();
+	broadPhase.update(dynamicBounds.data(), int(dynamicBounds.size()));
+	for (const SweepAndPrune::Pair& pair : broadPhase.getPairs())
+	{
+		int first = dynamicBoxes[pair.first], second = dynamicBoxes[pair.second];
+		if (isFiltered(boxes[first].layer, boxes[second].layer)) continue; //their layers don't collide
+		boxPairs.push_back({ std::min(first, second), std::max(first, second) });
+	}
+
+	//the static boxes near each dynamic box are only searched again when one of their fat AABBs changes(so
+	//the static boxes cost nothing while the dynamic boxes move inside their fat AABBs):
+	for (int k = 0; k < int(dynamicBoxes.size()); ++k)
+	{
+		int i = dynamicBoxes[k];
+		std::vector<int>& neighbours = staticNeighbours[i];
+		if (neighboursVersion[i] != staticVersion)
+		{
+			neighbours.clear();
+			staticTree.query(dynamicTree.getFatAABB(boxes[i].proxy), [&](int proxy)
+			{
+				neighbours.push_back(staticTree.getData(proxy));
+				return true;
+			});
+			neighboursVersion[i] = staticVersion;
 		}
 
-		//test collision between this box and each interactable object component's boxes in the scene
-		for (int j = 0; j < world->currentScene->interactableObjectComponents.getSize(); ++j)
+		for (int j : neighbours)
+			if (boxBounds[j].overlaps(dynamicBounds[k]) && !isFiltered(boxes[i].layer, boxes[j].layer))
+				boxPairs.push_back({ std::min(i, j), std::max(i, j) });
+	}
+
+	//the pairs are solved in the same order whatever the broad phase found them:
+	std::sort(boxPairs.begin(), boxPairs.end(), [](const SweepAndPrune::Pair& a, const SweepAndPrune::Pair& b)
+	{
+		return a.first != b.first ? a.first < b.first : a.second < b.second;
+	});
+
+	//-------------------------------
+	//test all the pairs at once, with the positions before any collision is solved(the transforms were
+	//computed with these positions). Each job fills and solves its own blocks of the NarrowPhase, and keeps
+	//the pairs that collide in its own buffer:
+	int numOfPairs = int(boxPairs.size());
+	narrowPhase.setNumOfPairs(numOfPairs);
+	pairTests.resize(numOfPairs);
+	runJobs(numOfPairs, PHYSICS_PAIRS_GRAIN_SIZE, [&boxes, this](int first, int last)
+	{
+		for (int p = first; p < last; ++p)
 		{
-			const InteractableObjectComponent* intObjComp = &(world->currentScene->interactableObjectComponents[j]);
-			
-			if (!intObjComp->actived || 
-				!intObjComp->isEffectActive ||
-				 intObjComp->getEntityId() == boxComp->getEntityId() ||
-				 intObjComp->holder == boxComp->getEntityId())
+			const SweepAndPrune::Pair& pair = boxPairs[p];
+			const RigidBodyComponent<Box>* boxComp = &boxes[pair.first];
+			const RigidBodyComponent<Box>* boxComp2 = &boxes[pair.second];
+			pairTests[p] = 0;
+
+			//don't solve for objects with infinite mass(but the triggers are notified):
+			if (boxComp->mass <= 0 && boxComp2->mass <= 0 && !isTrigger(boxComp->layer, boxComp2->layer)) continue;
+			if (!boundSphereTest(boxComp->shape.pos, boxComp2->shape.pos, boxRadii[pair.first], boxRadii[pair.second]))
 				continue;
 
-			//do a bounding sphere test
-			if (!boundSphereTest(boxComp->shape.pos, intObjComp->hitBox.pos,
-				glm::length(boxComp->shape.getVertex(0)),
-				glm::length(intObjComp->hitBox.getVertex(0))))
-				//glm::max(boxComp->shape.getSize().x, glm::max(boxComp->shape.getSize().y, boxComp->shape.getSize().z)), //!
-				//glm::max(intObjComp->hitBox.getSize().x, glm::max(intObjComp->hitBox.getSize().y, intObjComp->hitBox.getSize().z))))
+			narrowPhase.setPair(p, boxComp2->shape, boxComp->shape, boxTransforms[pair.second], boxTransforms[pair.first]);
+			pairTests[p] = 1;
+		}
+		narrowPhase.solve(first, last);
+
+		std::vector<Contact>& buffer = contactBuffers[first / PHYSICS_PAIRS_GRAIN_SIZE];
+		glm::vec3 mtv;
+		for (int p = first; p < last; ++p)
+			if (pairTests[p] && narrowPhase.getResult(p, mtv)) buffer.push_back({ boxPairs[p].first, boxPairs[p].second, mtv });
+	});
+	mergeContacts(numOfPairs, PHYSICS_PAIRS_GRAIN_SIZE);
+
+	//-------------------------------
+	//handle collisions(only the deep penetrations are corrected here, the contacts are kept for the solver of
+	//the next step):
+	newManifolds.clear();
+	boxMoved.assign(numOfBoxes, 0);
+	islandParents.resize(numOfBoxes);
+	for (int i : dynamicBoxes) islandParents[i] = i;
+	size_t next = 0; //the next contact(they are in the order of the pairs)
+	for (int p = 0; p < numOfPairs; ++p)
+	{
+		const SweepAndPrune::Pair& pair = boxPairs[p];
+		RigidBodyComponent<Box>* boxComp = &boxes[pair.first];
+		RigidBodyComponent<Box>* boxComp2 = &boxes[pair.second];
+
+		bool trigger = isTrigger(boxComp->layer, boxComp2->layer);
+		if (boxComp->mass <= 0 && boxComp2->mass <= 0 && !trigger) continue; //don't solve for objects with infinite mass
+
+		glm::vec3 mtv;
+		bool found = next < contacts.size() && contacts[next].first == pair.first && contacts[next].second == pair.second;
+		if (found) mtv = contacts[next++].separ;
+
+		if (!boxMoved[pair.first] && !boxMoved[pair.second]) //the result of the narrow phase is still valid
+		{
+			if (!found) continue;
+		}
+		else //an earlier pair moved one of the boxes, so it's tested again
+		{
+			if (!boundSphereTest(boxComp->shape.pos, boxComp2->shape.pos, boxRadii[pair.first], boxRadii[pair.second]))
 				continue;
 
-			//----------------------------
-			//collision might have happened, do a more complex test:
-			glm::vec3 mtv;
-			
-			glm::mat4 model2 = intObjComp->transform;
-			 
-			//bool a2 = (boxComp->getEntityId() == 0 && boxComp2->getEntityId() == 2) ? true : false;
-			if (!detectBoxToBox2(intObjComp->hitBox, boxComp->shape, model2, model, mtv, false)) continue; //collision detection failed
+			glm::mat4 model = boxTransforms[pair.first];
+			glm::mat4 model2 = boxTransforms[pair.second];
+			model[3] = glm::vec4(boxComp->shape.pos, 1.0f);
+			model2[3] = glm::vec4(boxComp2->shape.pos, 1.0f);
+
+			if (!NarrowPhase::testPair(boxComp2->shape, boxComp->shape, model2, model, mtv)) continue; //collision detection failed
+		}
+
+		if (trigger) //only notified(the boxes aren't moved, and don't wake or join an island)
+		{
+			sendTrigger(boxComp->getEntityId(), boxComp2->getEntityId());
+			continue;
+		}
+
+		//a sleeping box touched by an awake one wakes(with its island), and the boxes in contact join an island:
+		if (boxComp->sleeping || boxComp->island >= 0) wakeBox(pair.first);
+		if (boxComp2->sleeping || boxComp2->island >= 0) wakeBox(pair.second);
+		if (boxComp->mass > 0.0f && boxComp2->mass > 0.0f)
+			islandParents[findIsland(pair.first)] = findIsland(pair.second);
+
+		glm::vec3 pos = boxComp->shape.pos, pos2 = boxComp2->shape.pos;
+		separateBoxes(*boxComp2, *boxComp, mtv, PHYSICS_MAX_PENETRATION);
+		addManifold(pair.first, pair.second, mtv);
+		boxMoved[pair.first] |= boxComp->shape.pos != pos;
+		boxMoved[pair.second] |= boxComp2->shape.pos != pos2;
+
+		//----------------------------
+		Message msg; //a message notifiyng the collision
+		msg.type = MessageType::COLLISION_OCCURRED;
+		msg.idata[0] = boxComp->getEntityId();  //the id of the first body
+		msg.idata[1] = boxComp2->getEntityId(); //and the id of the second
+		msg.fdata[2] = boxComp->shape.pos.y - boxComp2->shape.pos.y; //if this is positve, then box1 is above box2
+
+		storeMessage(msg); //store the message(it will be sent in the frame's end)
+	}
+
+	//the ground is tested after the pairs, so it sees the boxes where they were separated(the lookups are done
+	//by the jobs, and the contacts are solved in the order of the boxes):
+	if (!heightField.isEmpty())
+	{
+		groundContacts.resize(dynamicBoxes.size());
+		runJobs(int(dynamicBoxes.size()), PHYSICS_GROUND_GRAIN_SIZE, [this](int first, int last)
+		{
+			for (int k = first; k < last; ++k) groundContacts[k] = findGroundContact(dynamicBoxes[k]);
+		});
+		for (size_t k = 0; k < groundContacts.size(); ++k)
+			if (groundContacts[k].depth > 0.0f) solveGroundContact(dynamicBoxes[k], groundContacts[k]);
+	}
+
+	addWokenBoxes();
+	updateManifolds();
+
+	//-------------------------------
+	//find the pairs of boxes and interactable objects that may collide(the dynamic boxes are tested against all
+	//the objects, and the static ones are found by their hit boxes):
+	ComponentPool<InteractableObjectComponent>& objects = world->currentScene->interactableObjectComponents;
+	objectPairs.clear();
+	for (int j = 0; j < objects.getSize(); ++j)
+	{
+		const InteractableObjectComponent* intObjComp = &objects[j];
+		if (!intObjComp->actived || !intObjComp->isEffectActive) continue;
+
+		for (int i : dynamicBoxes)
+			if (!isFiltered(boxes[i].layer, intObjComp->layer)) objectPairs.push_back({ i, j });
+
+		FLOAT_TYPE radius = glm::length(intObjComp->hitBox.getVertex(0));
+		AABB hitBounds;
+		hitBounds.min = intObjComp->hitBox.pos - glm::vec3(radius);
+		hitBounds.max = intObjComp->hitBox.pos + glm::vec3(radius);
+		staticTree.query(hitBounds, [&](int proxy)
+		{
+			int i = staticTree.getData(proxy);
+			if (!isFiltered(boxes[i].layer, intObjComp->layer)) objectPairs.push_back({ i, j });
+			return true;
+		});
+	}
+
+	std::sort(objectPairs.begin(), objectPairs.end(), [](const SweepAndPrune::Pair& a, const SweepAndPrune::Pair& b)
+	{
+		return a.first != b.first ? a.first < b.first : a.second < b.second;
+	});
+
+	for (const SweepAndPrune::Pair& pair : objectPairs)
+	{
+		RigidBodyComponent<Box>* boxComp = &boxes[pair.first];
+		const InteractableObjectComponent* intObjComp = &objects[pair.second];
+
+		if (intObjComp->getEntityId() == boxComp->getEntityId() || intObjComp->holder == boxComp->getEntityId())
+			continue;
+
+		//do a bounding sphere test
+		if (!boundSphereTest(boxComp->shape.pos, intObjComp->hitBox.pos, boxRadii[pair.first],
+			glm::length(intObjComp->hitBox.getVertex(0))))
+			continue;
+
+		//----------------------------
+		//collision might have happened, do a more complex test:
+		glm::vec3 mtv;
+		glm::mat4 model = boxTransforms[pair.first];
+		model[3] = glm::vec4(boxComp->shape.pos, 1.0f);
+		glm::mat4 model2 = intObjComp->transform;
+
+		if (!detectBoxToBox2(intObjComp->hitBox, boxComp->shape, model2, model, mtv, false)) continue; //collision detection failed
+
+		if (isTrigger(boxComp->layer, intObjComp->layer))
+		{
+			sendTrigger(boxComp->getEntityId(), intObjComp->getEntityId());
+			continue;
+		}
+
+		if (boxComp->sleeping || boxComp->island >= 0) wakeBox(pair.first);
+
+		glm::vec3 holderInpulse;
+		resolveBoxToObjBox(intObjComp->hitBox, 10.0f, 8.0f, *boxComp, mtv, holderInpulse);
+
+		holderInpulse = glm::normalize(holderInpulse) * glm::min(glm::length(holderInpulse), 1.0f);
+
+		if (intObjComp->holder >= 0)
+			world->currentScene->getBoxRigidBodyComponent(intObjComp->holder)->addLinearVelocity(
+				(holderInpulse));
+
+		//----------------------------
+		Message msg; //a message notifiyng the collision
+		msg.type = MessageType::COLLISION_OCCURRED;
+		msg.idata[0] = boxComp->getEntityId();  //the id of the first body
+		msg.idata[1] = intObjComp->getEntityId(); //and the id of the second
+		msg.fdata[0] = mtv.x;
+		msg.fdata[1] = mtv.y;
+		msg.fdata[2] = mtv.z;
+
+		storeMessage(msg); //store the message(it will be sent in the frame's end)
+	}
+
+	addWokenBoxes();
+	updateIslands();
+
+	//-------------------------------
+	//the final positions of the boxes simulated in this step, written to their transforms in one pass:
+	for (int i : integratedBoxes)
+		world->currentScene->getTransformComponent(boxes[i].getEntityId())->setPosition(boxes[i].shape.pos);
+
+	//those writes don't change the data of their boxes, so they aren't seen as changes in the next step(but the
+	//boxes changed by them, like the children of these boxes, are):
+	world->currentScene->collectChangedTransforms(changedEntities);
+	changedEntities.erase(std::remove_if(changedEntities.begin(), changedEntities.end(), [&](Entity id)
+	{
+		const RigidBodyComponent<Box>* boxComp = boxes.getByEntity(id);
+		return !boxComp || !isBoxChanged(int(boxComp - &boxes[0]));
+	}), changedEntities.end());
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+bool PhysicsEngine::isFiltered(int layer1, int layer2) const noexcept
+{
+	myAssert(layer1 >= 0 && layer1 < PHYSICS_MAX_LAYERS && layer2 >= 0 && layer2 < PHYSICS_MAX_LAYERS);
+	return (filteredLayers[layer1] >> layer2) & 1u;
+}
+
+bool PhysicsEngine::isTrigger(int layer1, int layer2) const noexcept
+{
+	return ((triggerLayers >> layer1) | (triggerLayers >> layer2)) & 1u;
+}
+
+void PhysicsEngine::sendTrigger(Entity first, Entity second)
+{
+	Message msg; //a message notifiyng the overlap
+	msg.type = MessageType::TRIGGER_OVERLAP;
+	msg.idata[0] = first;
+	msg.idata[1] = second;
+
+	storeMessage(msg); //store the message(it will be sent in the frame's end)
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::runJobs(int n, int grainSize, const std::function<void(int, int)>& function)
+{
+	int numOfBuffers = (n + grainSize - 1) / grainSize;
+	if (numOfBuffers > int(contactBuffers.size())) contactBuffers.resize(numOfBuffers);
+
+	if (multithreaded)
+		JobSystem::instance().parallelFor(0, n, grainSize, function);
+	else if (n > 0)
+		function(0, n);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::mergeContacts(int n, int grainSize)
+//each job used the buffer of its first element, and the jobs have consecutive elements, so joining the buffers
+//in their order sorts the contacts(the serial run has all the contacts in the first buffer)
+{
+	contacts.clear();
+	int numOfBuffers = (n + grainSize - 1) / grainSize;
+	for (int b = 0; b < numOfBuffers; ++b)
+	{
+		contacts.insert(contacts.end(), contactBuffers[b].begin(), contactBuffers[b].end());
+		contactBuffers[b].clear();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
 
-			glm::vec3 holderInpulse;
-			resolveBoxToObjBox(intObjComp->hitBox, 10.0f, 8.0f, *boxComp, mtv, holderInpulse);
+void PhysicsEngine::syncBoxProxies()
+{
+	Scene* scene = world->currentScene;
+	ComponentPool<RigidBodyComponent<Box>>& boxes = scene->boxRigidBodyComponents;
+	if (scene == boxesScene && boxes.getVersion() == boxesVersion) return;
 
-			holderInpulse = glm::normalize(holderInpulse) * glm::min(glm::length(holderInpulse), 1.0f);
+	PROFILE_ZONE("PhysicsEngine::syncBoxProxies");
 
-			if (intObjComp->holder >= 0)
-				world->currentScene->getBoxRigidBodyComponent(intObjComp->holder)->addLinearVelocity(
-					(holderInpulse));
+	if (scene != boxesScene) //the proxies of the last scene are forgotten
+	{
+		staticTree.clear();
+		dynamicTree.clear();
+		staticOwners.clear();
+		dynamicOwners.clear();
+		islands.clear();
+		freeIslands.clear();
+		manifolds.clear();
+		for (int i = 0; i < boxes.getSize(); ++i) //and its boxes wake
+		{
+			boxes[i].proxy = -1;
+			boxes[i].wakeUp();
+			boxes[i].island = -1;
+		}
+	}
+	boxesScene = scene;
+	boxesVersion = boxes.getVersion();
 
-			//std::cout << boxComp->getEntityId() << " Collided with " << intObjComp->getEntityId() << '\n';
+	//destroy the proxies of the boxes that were removed:
+	for (int isStatic = 0; isStatic < 2; ++isStatic)
+	{
+		AABBTree& tree = isStatic ? staticTree : dynamicTree;
+		std::vector<Entity>& owners = isStatic ? staticOwners : dynamicOwners;
+		for (int proxy = 0; proxy < int(owners.size()); ++proxy)
+		{
+			if (owners[proxy] < 0) continue;
+			const RigidBodyComponent<Box>* boxComp = boxes.getByEntity(owners[proxy]);
+			if (boxComp && boxComp->proxy == proxy && boxComp->staticProxy == bool(isStatic)) continue;
 
-			//----------------------------
-			Message msg; //a message notifiyng the collision
-			msg.type = MessageType::COLLISION_OCCURRED;
-			msg.idata[0] = boxComp->getEntityId();  //the id of the first body
-			msg.idata[1] = intObjComp->getEntityId(); //and the id of the second
-			msg.fdata[0] = mtv.x;
-			msg.fdata[1] = mtv.y;
-			msg.fdata[2] = mtv.z;
+			tree.destroyProxy(proxy);
+			owners[proxy] = -1;
+		}
+	}
 
-			storeMessage(msg); //store the message(it will be sent in the frame's end)
+	//the indices of the boxes may have changed, so all their data is recomputed:
+	int numOfBoxes = boxes.getSize();
+	boxBounds.resize(numOfBoxes);
+	boxTransforms.resize(numOfBoxes);
+	boxRadii.resize(numOfBoxes);
+	boxPositions.resize(numOfBoxes);
+	boxSizes.resize(numOfBoxes);
+	stepPositions.resize(numOfBoxes);
+	staticNeighbours.resize(numOfBoxes);
+	neighboursVersion.assign(numOfBoxes, 0);
+	++staticVersion; //the neighbours are indices too
+	dynamicBoxes.clear();
+
+	for (int i = 0; i < numOfBoxes; ++i)
+	{
+		RigidBodyComponent<Box>& boxComp = boxes[i];
+		updateBoxData(i);
 
+		bool isStatic = isStaticBox(boxComp) || isSleepingBox(boxComp);
+		if (boxComp.proxy < 0 || isStatic != boxComp.staticProxy)
+			setBoxProxy(i, isStatic);
+		else
+		{
+			AABBTree& tree = isStatic ? staticTree : dynamicTree;
+			tree.moveProxy(boxComp.proxy, boxBounds[i], glm::vec3(0.0f));
+			tree.setData(boxComp.proxy, i);
 		}
 
+		if (isStatic) scene->getTransformComponent(boxComp.getEntityId())->setPosition(boxComp.shape.pos);
+		else dynamicBoxes.push_back(i);
+		boxComp.changeLog = &changedBodies; //the changes of the data computed here are logged from now on
+		boxComp.logged = false;
+	}
+	changedBodies.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::updateBoxData(int i)
+{
+	const RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+
+	//the box in world space(used to convert its vertices to world space), and its bounds:
+	glm::mat4& model = boxTransforms[i];
+	model = getFullTransform(boxComp.getEntityId());
+	model[3] = glm::vec4(boxComp.shape.pos, 1.0f);
+
+	glm::vec3 halfSize = 0.5f * boxComp.shape.getSize();
+	glm::vec3 extents = glm::abs(glm::vec3(model[0])) * halfSize.x + glm::abs(glm::vec3(model[1])) * halfSize.y
+		+ glm::abs(glm::vec3(model[2])) * halfSize.z; //of the rotated box, on the world axes
+	boxBounds[i].min = boxComp.shape.pos - extents;
+	boxBounds[i].max = boxComp.shape.pos + extents;
+	boxRadii[i] = glm::length(halfSize); //the radius of the bounding sphere
+	boxPositions[i] = boxComp.shape.pos;
+	boxSizes[i] = boxComp.shape.getSize();
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+bool PhysicsEngine::isBoxChanged(int i) const
+{
+	const RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+	if (boxComp.shape.pos != boxPositions[i] || boxComp.shape.getSize() != boxSizes[i]) return true;
+
+	//a rotation or a parent change only shows in the world transform(its translation is the shape position):
+	const TransformComponent* transform = world->currentScene->getTransformComponent(boxComp.getEntityId());
+	glm::mat4 model = transform->getRigidWorldTransform();
+	const glm::mat4& saved = boxTransforms[i];
+	return model[0] != saved[0] || model[1] != saved[1] || model[2] != saved[2];
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
 
+void PhysicsEngine::findVisitedBoxes()
+{
+	Scene* scene = world->currentScene;
+	ComponentPool<RigidBodyComponent<Box>>& boxes = scene->boxRigidBodyComponents;
+	visitedBoxes.clear();
+
+	//the boxes left in the dynamic tree by the last step(or by syncBoxProxies()) are always visited:
+	for (int i : dynamicBoxes)
+		if (!boxes[i].staticProxy) visitedBoxes.push_back(i);
+
+	//and the static and sleeping ones only if they(or their transforms) were changed since the last step:
+	scene->collectChangedTransforms(changedEntities);
+	for (Entity id : changedBodies)
+	{
+		RigidBodyComponent<Box>* boxComp = boxes.getByEntity(id);
+		if (boxComp) boxComp->logged = false; //it's logged again when it changes
+		changedEntities.push_back(id);
+	}
+	changedBodies.clear();
+
+	for (Entity id : changedEntities)
+	{
+		const RigidBodyComponent<Box>* boxComp = boxes.getByEntity(id);
+		if (boxComp && boxComp->staticProxy) visitedBoxes.push_back(int(boxComp - &boxes[0])); //the pool is packed
+	}
+	changedEntities.clear();
+
+	std::sort(visitedBoxes.begin(), visitedBoxes.end());
+	visitedBoxes.erase(std::unique(visitedBoxes.begin(), visitedBoxes.end()), visitedBoxes.end());
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::setBoxProxy(int i, bool isStatic)
+{
+	RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+
+	if (isStatic || (boxComp.proxy >= 0 && boxComp.staticProxy)) ++staticVersion;
+
+	if (boxComp.proxy >= 0) //remove it from the tree it was
+	{
+		(boxComp.staticProxy ? staticTree : dynamicTree).destroyProxy(boxComp.proxy);
+		(boxComp.staticProxy ? staticOwners : dynamicOwners)[boxComp.proxy] = -1;
 	}
 
-}
\ No newline at end of file
+	std::vector<Entity>& owners = isStatic ? staticOwners : dynamicOwners;
+	boxComp.proxy = (isStatic ? staticTree : dynamicTree).createProxy(boxBounds[i], i);
+	boxComp.staticProxy = isStatic;
+	if (boxComp.proxy >= int(owners.size())) owners.resize(boxComp.proxy + 1, -1);
+	owners[boxComp.proxy] = boxComp.getEntityId();
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+bool PhysicsEngine::isStaticBox(const RigidBodyComponent<Box>& boxComp) const noexcept
+//the boxes with infinite mass that aren't moving(the integration doesn't change them)
+{
+	return boxComp.mass <= 0.0f && boxComp.linearVelocity == glm::vec3(0.0f) && boxComp.forces == glm::vec3(0.0f);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+glm::vec3 PhysicsEngine::sweepBox(int i, glm::vec3 deltaS)
+//the motion of a fast box until it touches another box(the rest of the step is lost, but not the velocity, so
+//the collision is solved by the discrete test of this step)
+{
+	ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	const RigidBodyComponent<Box>& boxComp = boxes[i];
+
+	glm::vec3 halfSize = 0.5f * boxComp.shape.getSize();
+	FLOAT_TYPE minHalfSize = glm::max(glm::min(glm::min(halfSize.x, halfSize.y), halfSize.z), 0.001f);
+	FLOAT_TYPE distance = glm::length(deltaS);
+	if (distance <= minHalfSize) return deltaS; //the discrete test can't miss anything
+
+	//the bounds of the box where it is now(a collision may have moved it after its data was computed):
+	AABB bounds = boxBounds[i];
+	bounds.min += boxComp.shape.pos - boxPositions[i];
+	bounds.max += boxComp.shape.pos - boxPositions[i];
+
+	//the boxes whose bounds are touched by the bounds of this box along the way, with the time they are touched
+	//(the ones it already overlaps are left to the discrete test):
+	sweepHits.clear();
+	auto findHits = [&](const AABBTree& tree)
+	{
+		tree.shapeCast(bounds, deltaS, [&](int proxy, FLOAT_TYPE maxFraction)
+		{
+			int j = tree.getData(proxy);
+			FLOAT_TYPE toi;
+			if (j != i && (boxComp.mass > 0.0f || boxes[j].mass > 0.0f) && !isFiltered(boxComp.layer, boxes[j].layer)
+				&& !isTrigger(boxComp.layer, boxes[j].layer) && sweptAABBTest(bounds, deltaS, boxBounds[j], toi))
+				sweepHits.push_back({ toi, j });
+			return maxFraction;
+		});
+	};
+	findHits(staticTree);
+	findHits(dynamicTree);
+	if (sweepHits.empty()) return deltaS;
+	std::sort(sweepHits.begin(), sweepHits.end());
+
+	//the bounds are larger than the box, so from the first time they touch, the box is moved in sub steps
+	//shorter than its half size(so it can't pass through anything) until it touches one of the boxes whose
+	//bounds were touched by then:
+	int numOfSteps = glm::min(int(std::ceil(distance / minHalfSize)), PHYSICS_MAX_SUB_STEPS);
+	FLOAT_TYPE stepFraction = 1.0f / FLOAT_TYPE(numOfSteps);
+	FLOAT_TYPE t = sweepHits[0].first;
+	Box moved = boxComp.shape;
+	glm::mat4 model = boxTransforms[i];
+	size_t numOfHits = 0;
+	while (true)
+	{
+		moved.pos = boxComp.shape.pos + deltaS * t;
+		model[3] = glm::vec4(moved.pos, 1.0f);
+		while (numOfHits < sweepHits.size() && sweepHits[numOfHits].first <= t) ++numOfHits;
+
+		glm::vec3 mtv;
+		for (size_t h = 0; h < numOfHits; ++h)
+		{
+			int j = sweepHits[h].second;
+			if (NarrowPhase::testPair(boxes[j].shape, moved, boxTransforms[j], model, mtv) && glm::length(mtv) > 0.001f)
+				return deltaS * t; //separateBoxes() ignores the smaller separations
+		}
+
+		if (t >= 1.0f) return deltaS;
+		t = glm::min(t + stepFraction, 1.0f);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+glm::vec3 PhysicsEngine::sweepSphere(int i, glm::vec3 deltaS)
+{
+	ComponentPool<RigidBodyComponent<Sphere>>& spheres = world->currentScene->sphereRigidBodyComponents;
+	const RigidBodyComponent<Sphere>& sphereComp = spheres[i];
+	if (glm::length(deltaS) <= sphereComp.shape.radius) return deltaS; //the discrete test can't miss anything
+
+	//the time of impact is exact for the spheres, so the sphere is moved until it touches the first one:
+	FLOAT_TYPE first = 1.0f;
+	for (int j = 0; j < spheres.getSize(); ++j)
+	{
+		FLOAT_TYPE toi;
+		if (j == i || isFiltered(sphereComp.layer, spheres[j].layer) || isTrigger(sphereComp.layer, spheres[j].layer)) continue;
+		if (sweptSphereTest(sphereComp.shape, deltaS, spheres[j].shape, toi) && toi < first) first = toi;
+	}
+
+	//and a little into it(half of its radius), so that the discrete test solves the collision:
+	if (first < 1.0f) first = glm::min(first + 0.5f * sphereComp.shape.radius / glm::length(deltaS), 1.0f);
+	return deltaS * first;
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+bool PhysicsEngine::isSleepingBox(const RigidBodyComponent<Box>& boxComp) const noexcept
+//the sleeping boxes whose velocity and forces weren't changed since they fell asleep
+{
+	return boxComp.sleeping && boxComp.linearVelocity == glm::vec3(0.0f) && boxComp.forces == glm::vec3(0.0f);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::wakeBox(int i)
+{
+	ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	auto wake = [&](int index)
+	{
+		boxes[index].wakeUp();
+		boxes[index].island = -1;
+		if (boxes[index].staticProxy) wokenBoxes.push_back(index);
+		if (index < int(islandParents.size())) islandParents[index] = index; //it may join an island in this step
+	};
+
+	int id = boxes[i].island;
+	if (id < 0) //it wasn't sleeping in an island
+	{
+		wake(i);
+		return;
+	}
+
+	for (Entity e : islands[id])
+	{
+		RigidBodyComponent<Box>* member = boxes.getByEntity(e);
+		if (member && member->island == id) wake(int(member - &boxes[0])); //the pool is packed
+	}
+	islands[id].clear();
+	freeIslands.push_back(id);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::addWokenBoxes()
+{
+	ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	for (int i : wokenBoxes)
+	{
+		RigidBodyComponent<Box>& boxComp = boxes[i];
+		if (!boxComp.staticProxy || boxComp.sleeping) continue; //already integrated in this step
+
+		updateBoxData(i); //a collision may have moved it
+		setBoxProxy(i, false);
+		neighboursVersion[i] = 0;
+		stepPositions[i] = boxComp.shape.pos;
+
+		integratedBoxes.push_back(i); //its transform is written at the end of the step
+		dynamicBoxes.push_back(i);
+		dynamicBounds.push_back(boxBounds[i]);
+	}
+	wokenBoxes.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::addManifold(int i, int j, glm::vec3 separVec)
+{
+	const ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	glm::vec3 direction = boxes[j].shape.pos - boxes[i].shape.pos;
+	FLOAT_TYPE penetration = glm::length(separVec);
+	glm::vec3 normal = penetration >= 0.0001f ? separVec / penetration : glm::normalize(direction);
+	if (glm::dot(normal, direction) < 0.0f) normal *= -1.0f;
+	if (boxes[i].getEntityId() > boxes[j].getEntityId())
+	{
+		std::swap(i, j);
+		normal *= -1.0f;
+	}
+
+	pushManifold(boxes[i].getEntityId(), boxes[j].getEntityId(), normal, penetration);
+}
+
+void PhysicsEngine::pushManifold(Entity first, Entity second, glm::vec3 normal, FLOAT_TYPE penetration)
+{
+	Manifold manifold;
+	manifold.first = first;
+	manifold.second = second;
+	manifold.normal = normal;
+	manifold.penetration = glm::min(penetration, PHYSICS_MAX_PENETRATION); //the rest was corrected when it was found
+
+	//a tangent basis that only depends on the normal(the friction impulses are kept in it between the steps):
+	manifold.tangents[0] = std::fabs(normal.x) >= 0.57735f
+		? glm::normalize(glm::vec3(normal.y, -normal.x, 0.0f)) : glm::normalize(glm::vec3(0.0f, normal.z, -normal.y));
+	manifold.tangents[1] = glm::cross(normal, manifold.tangents[0]);
+	newManifolds.push_back(manifold);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+PhysicsEngine::GroundContact PhysicsEngine::findGroundContact(int i) const noexcept
+//the vertices of the box are tested against the height under them, and the deepest one gives the contact(its
+//normal is the one of the surface there). The terrain bumps smaller than the box, between its vertices, aren't
+//felt, which is fine for the characters and props that stand on it
+{
+	const RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+	GroundContact contact = { 0.0f, glm::vec3(0.0f) };
+	if (boxComp.mass <= 0.0f) return contact; //a box with infinite mass isn't moved by the ground
+	if (boxBounds[i].min.y + (boxComp.shape.pos.y - boxPositions[i].y) > heightField.getMaxHeight()) return contact; //above all of it
+
+	//the vertices are the center plus or minus each of the half axes of the box(in world space):
+	const glm::mat4& model = boxTransforms[i];
+	glm::vec3 halfSize = boxComp.shape.getSize() * 0.5f;
+	glm::vec3 axes[3] = { glm::vec3(model[0]) * halfSize.x, glm::vec3(model[1]) * halfSize.y, glm::vec3(model[2]) * halfSize.z };
+
+	//the vertices above all of the ground aren't looked up, and neither are the ones over a vertex already
+	//looked up(the top vertices of a box that isn't rotated are over the bottom ones):
+	glm::vec2 points[8]; //the xz of the vertices looked up
+	FLOAT_TYPE heights[8];
+	int numOfPoints = 0;
+	for (int k = 0; k < 8; ++k)
+	{
+		glm::vec3 vertex = boxComp.shape.pos + (k & 1 ? axes[0] : -axes[0]) + (k & 2 ? axes[1] : -axes[1]) + (k & 4 ? axes[2] : -axes[2]);
+		if (vertex.y >= heightField.getMaxHeight()) continue;
+
+		glm::vec2 point(vertex.x, vertex.z);
+		int p = 0;
+		while (p < numOfPoints && points[p] != point) ++p;
+		if (p == numOfPoints)
+		{
+			if (!heightField.contains(point.x, point.y)) continue; //the ground ends at the border of the grid
+			points[numOfPoints] = point;
+			heights[numOfPoints++] = heightField.getHeight(point.x, point.y);
+		}
+
+		if (heights[p] - vertex.y > contact.depth)
+		{
+			contact.depth = heights[p] - vertex.y;
+			contact.vertex = vertex;
+		}
+	}
+	return contact;
+}
+
+void PhysicsEngine::solveGroundContact(int i, const GroundContact& contact)
+{
+	RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+	if (boxComp.sleeping || boxComp.island >= 0) wakeBox(i);
+
+	//the penetration along the normal, and the deep ones are corrected at once(like separateBoxes() does):
+	glm::vec3 normal = heightField.getNormal(contact.vertex.x, contact.vertex.z);
+	FLOAT_TYPE penetration = contact.depth * normal.y;
+	if (penetration > PHYSICS_MAX_PENETRATION)
+		boxComp.shape.pos += normal * (penetration - PHYSICS_MAX_PENETRATION);
+	pushManifold(NULL_ENTITY, boxComp.getEntityId(), normal, penetration); //from the ground to the box
+
+	//----------------------------
+	Message msg; //a message notifiyng the collision
+	msg.type = MessageType::COLLISION_OCCURRED;
+	msg.idata[0] = boxComp.getEntityId(); //the id of the box
+	msg.idata[1] = NULL_ENTITY; //the ground
+	msg.fdata[2] = boxComp.shape.pos.y - heightField.getHeight(boxComp.shape.pos.x, boxComp.shape.pos.z); //the box is above it
+
+	storeMessage(msg); //store the message(it will be sent in the frame's end)
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::updateManifolds()
+{
+	auto isBefore = [](const Manifold& a, const Manifold& b)
+	{
+		return a.first != b.first ? a.first < b.first : a.second < b.second;
+	};
+	std::sort(newManifolds.begin(), newManifolds.end(), isBefore);
+
+	//the contacts that persisted keep the impulses of the last step(both lists are sorted, so they're merged):
+	size_t old = 0;
+	for (Manifold& manifold : newManifolds)
+	{
+		while (old < manifolds.size() && isBefore(manifolds[old], manifold)) ++old;
+		if (old == manifolds.size()) break;
+
+		const Manifold& last = manifolds[old];
+		if (last.first != manifold.first || last.second != manifold.second) continue;
+		if (glm::dot(last.normal, manifold.normal) < PHYSICS_WARM_START_COSINE) continue; //it's another contact now
+
+		manifold.normalImpulse = last.normalImpulse;
+		glm::vec3 friction = last.tangentImpulses[0] * last.tangents[0] + last.tangentImpulses[1] * last.tangents[1];
+		manifold.tangentImpulses[0] = glm::dot(friction, manifold.tangents[0]);
+		manifold.tangentImpulses[1] = glm::dot(friction, manifold.tangents[1]);
+	}
+	manifolds.swap(newManifolds);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::solveContacts()
+//a sequential impulse solver: each manifold applies the impulse that makes the normal velocity of its boxes reach
+//the target(but never pulls them together) and the friction impulses, limited by the normal one. As each one
+//changes the velocities the others see, they're solved solverIterations times, starting from the total impulses
+//of the last step(the warm start).
+//	The penetrations are corrected by other impulses, on the pushes of the boxes instead of their velocities(split
+//impulses): a push only moves its box in this step, so correcting the penetrations of a stack doesn't throw its
+//top boxes up
+{
+	PROFILE_ZONE("PhysicsEngine::solveContacts");
+
+	ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	pushes.assign(integratedBoxes.size(), glm::vec3(0.0f));
+
+	//find the boxes of each manifold(the ones that were removed, or that aren't integrated in this step, don't
+	//move, as if they had infinite mass), its material and the bounce of the ones that are closing fast:
+	size_t numOfManifolds = 0;
+	for (Manifold& manifold : manifolds)
+	{
+		Entity entities[2] = { manifold.first, manifold.second };
+		const RigidBodyComponent<Box>* boxComps[2];
+		for (int b = 0; b < 2; ++b)
+		{
+			const RigidBodyComponent<Box>* boxComp = boxComps[b] = boxes.getByEntity(entities[b]);
+			int index = boxComp ? int(boxComp - &boxes[0]) : -1; //the pool is packed
+			manifold.bodies[b] = index >= 0 ? storeIndices[index] : -1;
+			manifold.inverseMasses[b] = manifold.bodies[b] >= 0 && boxComp->mass > 0.0f ? 1.0f / boxComp->mass : 0.0f;
+		}
+		if (manifold.inverseMasses[0] + manifold.inverseMasses[1] <= 0.0f) continue;
+
+		//the ground(and a removed box) takes the material of the other box:
+		if (!boxComps[0]) boxComps[0] = boxComps[1];
+		if (!boxComps[1]) boxComps[1] = boxComps[0];
+		FLOAT_TYPE friction1 = boxComps[0]->friction, friction2 = boxComps[1]->friction;
+		FLOAT_TYPE restitution = glm::max(boxComps[0]->restitution, boxComps[1]->restitution);
+		manifold.friction = friction1 == friction2 ? friction1 : std::sqrt(friction1 * friction2);
+
+		FLOAT_TYPE normalVelocity = glm::dot(getStoreVelocity(manifold.bodies[1]) - getStoreVelocity(manifold.bodies[0]), manifold.normal);
+		manifold.targetVelocity = normalVelocity < -PHYSICS_RESTITUTION_THRESHOLD ? -restitution * normalVelocity : 0.0f;
+		manifold.pushImpulse = 0.0f;
+
+		manifolds[numOfManifolds++] = manifold; //only the ones with a box that moves are solved
+	}
+	manifolds.resize(numOfManifolds);
+
+	//then apply the impulses of the last step(after all the bounces were found, they're found from the
+	//velocities before the contacts):
+	for (const Manifold& manifold : manifolds)
+		applyImpulse(manifold, manifold.normalImpulse * manifold.normal + manifold.tangentImpulses[0] * manifold.tangents[0]
+			+ manifold.tangentImpulses[1] * manifold.tangents[1]);
+
+	for (int iteration = 0; iteration < solverIterations; ++iteration)
+		for (Manifold& manifold : manifolds)
+		{
+			glm::vec3 relativeVelocity = getStoreVelocity(manifold.bodies[1]) - getStoreVelocity(manifold.bodies[0]);
+			FLOAT_TYPE inverseMass = manifold.inverseMasses[0] + manifold.inverseMasses[1];
+
+			//the normal impulse(the total is never negative, so the boxes are never pulled together):
+			FLOAT_TYPE normalVelocity = glm::dot(relativeVelocity, manifold.normal);
+			FLOAT_TYPE total = glm::max(manifold.normalImpulse + (manifold.targetVelocity - normalVelocity) / inverseMass, 0.0f);
+			glm::vec3 impulse = (total - manifold.normalImpulse) * manifold.normal;
+			manifold.normalImpulse = total;
+
+			//the friction(the total is limited by the normal impulse):
+			FLOAT_TYPE maxFriction = manifold.friction * manifold.normalImpulse;
+			relativeVelocity += impulse * inverseMass;
+			for (int t = 0; t < 2; ++t)
+			{
+				FLOAT_TYPE tangentVelocity = glm::dot(relativeVelocity, manifold.tangents[t]);
+				total = glm::clamp(manifold.tangentImpulses[t] - tangentVelocity / inverseMass, -maxFriction, maxFriction);
+				impulse += (total - manifold.tangentImpulses[t]) * manifold.tangents[t];
+				manifold.tangentImpulses[t] = total;
+			}
+			applyImpulse(manifold, impulse);
+
+			//the push(a part of the penetration above the slop in each step, as the velocity is the displacement
+			//in a step):
+			glm::vec3 push1 = manifold.bodies[0] >= 0 ? pushes[manifold.bodies[0]] : glm::vec3(0.0f);
+			glm::vec3 push2 = manifold.bodies[1] >= 0 ? pushes[manifold.bodies[1]] : glm::vec3(0.0f);
+			FLOAT_TYPE targetPush = PHYSICS_CONTACT_BIAS * glm::max(manifold.penetration - PHYSICS_CONTACT_SLOP, 0.0f);
+			total = glm::max(manifold.pushImpulse + (targetPush - glm::dot(push2 - push1, manifold.normal)) / inverseMass, 0.0f);
+			glm::vec3 pushImpulse = (total - manifold.pushImpulse) * manifold.normal;
+			manifold.pushImpulse = total;
+			if (manifold.bodies[0] >= 0) pushes[manifold.bodies[0]] = push1 - pushImpulse * manifold.inverseMasses[0];
+			if (manifold.bodies[1] >= 0) pushes[manifold.bodies[1]] = push2 + pushImpulse * manifold.inverseMasses[1];
+		}
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+glm::vec3 PhysicsEngine::getStoreVelocity(int body) const noexcept
+{
+	return body >= 0 ? bodyStore.getVelocity(body) : glm::vec3(0.0f); //the boxes out of the store don't move
+}
+
+void PhysicsEngine::applyImpulse(const Manifold& manifold, const glm::vec3& impulse) noexcept
+{
+	if (manifold.bodies[0] >= 0)
+		bodyStore.setVelocity(manifold.bodies[0], bodyStore.getVelocity(manifold.bodies[0]) - impulse * manifold.inverseMasses[0]);
+	if (manifold.bodies[1] >= 0)
+		bodyStore.setVelocity(manifold.bodies[1], bodyStore.getVelocity(manifold.bodies[1]) + impulse * manifold.inverseMasses[1]);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::updateIslands()
+{
+	ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	islandIds.resize(boxes.getSize());
+	islandAwake.resize(boxes.getSize());
+
+	//the boxes that moved less than PHYSICS_SLEEP_VELOCITY in this step are resting(their velocity isn't
+	//used, since the gravity of each step is only cancelled by the collisions):
+	for (int i : dynamicBoxes)
+	{
+		RigidBodyComponent<Box>& boxComp = boxes[i];
+		if (boxComp.mass <= 0.0f) continue; //the boxes with infinite mass never sleep
+
+		bool resting = glm::length(boxComp.shape.pos - stepPositions[i]) < PHYSICS_SLEEP_VELOCITY;
+		boxComp.sleepTime = resting ? boxComp.sleepTime + timeStep : 0.0f;
+
+		int root = findIsland(i);
+		islandIds[root] = -1;
+		islandAwake[root] = 0;
+	}
+
+	//an island with a box that isn't resting stays awake. So do the ones with characters, since the gameplay
+	//code needs the collisions of a character in every step(to know if it's on the ground):
+	for (int i : dynamicBoxes)
+	{
+		const RigidBodyComponent<Box>& boxComp = boxes[i];
+		if (boxComp.mass <= 0.0f) continue;
+
+		int root = findIsland(i);
+		if (islandAwake[root]) continue;
+		if (boxComp.sleepTime < PHYSICS_SLEEP_TIME || world->currentScene->characterComponents.has(boxComp.getEntityId()))
+			islandAwake[root] = 1;
+	}
+
+	//the other islands fall asleep(they are moved to the static tree):
+	for (int i : dynamicBoxes)
+	{
+		RigidBodyComponent<Box>& boxComp = boxes[i];
+		if (boxComp.mass <= 0.0f) continue;
+
+		int root = findIsland(i);
+		if (islandAwake[root]) continue;
+
+		if (islandIds[root] < 0)
+		{
+			if (freeIslands.empty())
+			{
+				islandIds[root] = int(islands.size());
+				islands.emplace_back();
+			}
+			else
+			{
+				islandIds[root] = freeIslands.back();
+				freeIslands.pop_back();
+			}
+		}
+
+		islands[islandIds[root]].push_back(boxComp.getEntityId());
+		boxComp.island = islandIds[root];
+		boxComp.sleeping = true;
+		boxComp.linearVelocity = glm::vec3(0.0f);
+		boxComp.forces = glm::vec3(0.0f);
+		updateBoxData(i); //its final position
+		setBoxProxy(i, true);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+int PhysicsEngine::findIsland(int i)
+{
+	while (islandParents[i] != i)
+	{
+		islandParents[i] = islandParents[islandParents[i]]; //path halving
+		i = islandParents[i];
+	}
+	return i;
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+const AABBTree& PhysicsEngine::getStaticTree() const noexcept
+{
+	return staticTree;
+}
+
+const AABBTree& PhysicsEngine::getDynamicTree() const noexcept
+{
+	return dynamicTree;
+}
+
+Entity PhysicsEngine::getProxyEntity(const AABBTree& tree, int proxy) const noexcept
+{
+	const std::vector<Entity>& owners = &tree == &staticTree ? staticOwners : dynamicOwners;
+	return proxy >= 0 && proxy < int(owners.size()) ? owners[proxy] : -1;
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+int PhysicsEngine::getNumOfBoxPairs() const noexcept
+{
+	return int(boxPairs.size());
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+bool PhysicsEngine::raycast(const Ray& ray, QueryHit& hit) const
+{
+	hit = QueryHit();
+	if (world->currentScene != boxesScene || world->currentScene->boxRigidBodyComponents.getVersion() != boxesVersion)
+		return false; //the proxies don't match the boxes until the next update()
+
+	const ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	FLOAT_TYPE fraction = 1.0f; //of the nearest hit, the same for both trees
+	for (const AABBTree* tree : { &staticTree, &dynamicTree })
+	{
+		tree->raycast(ray.origin, ray.displacement, [&](int proxy, FLOAT_TYPE)
+		{
+			int i = tree->getData(proxy);
+			if (boxes[i].getEntityId() != ray.ignored && rayToBox(i, ray, fraction, hit))
+				fraction = hit.fraction;
+			return fraction;
+		});
+	}
+
+	return hit.entity >= 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::raycast(const std::vector<Ray>& rays, std::vector<QueryHit>& hits) const
+{
+	PROFILE_ZONE("PhysicsEngine::raycast");
+
+	int numOfRays = int(rays.size());
+	hits.assign(numOfRays, QueryHit());
+	if (world->currentScene != boxesScene || world->currentScene->boxRigidBodyComponents.getVersion() != boxesVersion)
+		return;
+
+	//each packet only writes the hits of its own rays, so the result doesn't depend on the threads:
+	int numOfPackets = (numOfRays + PHYSICS_RAY_PACKET_SIZE - 1) / PHYSICS_RAY_PACKET_SIZE;
+	auto testPackets = [&](int first, int last)
+	{
+		for (int p = first; p < last; ++p)
+		{
+			int firstRay = p * PHYSICS_RAY_PACKET_SIZE;
+			raycastPacket(&rays[firstRay], std::min(PHYSICS_RAY_PACKET_SIZE, numOfRays - firstRay), &hits[firstRay]);
+		}
+	};
+
+	if (multithreaded)
+		JobSystem::instance().parallelFor(0, numOfPackets, PHYSICS_RAY_PACKETS_GRAIN_SIZE, testPackets);
+	else if (numOfPackets > 0)
+		testPackets(0, numOfPackets);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+int PhysicsEngine::sphereOverlap(const glm::vec3& center, FLOAT_TYPE radius, std::vector<QueryHit>& hits,
+	Entity ignored) const
+{
+	hits.clear();
+
+	AABB bounds;
+	bounds.min = center - glm::vec3(radius);
+	bounds.max = center + glm::vec3(radius);
+	queryBoxes(bounds, ignored, [&](int i)
+	{
+		QueryHit hit;
+		bool inside = nearestBoxPoint(i, center, hit.point, hit.normal);
+		glm::vec3 toCenter = center - hit.point;
+		if (!inside && glm::dot(toCenter, toCenter) > radius * radius) return;
+
+		hit.entity = world->currentScene->boxRigidBodyComponents[i].getEntityId();
+		hits.push_back(hit);
+	});
+
+	std::sort(hits.begin(), hits.end(), [](const QueryHit& a, const QueryHit& b) { return a.entity < b.entity; });
+	return int(hits.size());
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+int PhysicsEngine::boxOverlap(const Box& box, const glm::mat4& model, std::vector<QueryHit>& hits, Entity ignored) const
+{
+	hits.clear();
+
+	//the narrow phase uses the vertices relative to the box position, so the bounds are made of them too:
+	glm::vec3 extents(0.0f);
+	for (int k = 0; k < 8; ++k)
+		extents = glm::max(extents, glm::abs(glm::vec3(model * glm::vec4(box.getVertex(k), 1.0f)) - box.pos));
+	AABB bounds;
+	bounds.min = box.pos - extents;
+	bounds.max = box.pos + extents;
+
+	queryBoxes(bounds, ignored, [&](int i)
+	{
+		const RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+		glm::mat4 boxModel = boxTransforms[i];
+		boxModel[3] = glm::vec4(boxComp.shape.pos, 1.0f);
+
+		glm::vec3 mtv;
+		if (!NarrowPhase::testPair(box, boxComp.shape, model, boxModel, mtv)) return;
+
+		QueryHit hit;
+		hit.entity = boxComp.getEntityId();
+		nearestBoxPoint(i, box.pos, hit.point, hit.normal);
+		if (glm::length(mtv) > 0.0001f) //the separation vector is a better normal, when there is one
+			hit.normal = glm::normalize(glm::dot(mtv, box.pos - boxComp.shape.pos) >= 0.0f ? mtv : -mtv);
+		hits.push_back(hit);
+	});
+
+	std::sort(hits.begin(), hits.end(), [](const QueryHit& a, const QueryHit& b) { return a.entity < b.entity; });
+	return int(hits.size());
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+template<typename F>
+void PhysicsEngine::queryBoxes(const AABB& bounds, Entity ignored, const F& callback) const
+{
+	if (world->currentScene != boxesScene || world->currentScene->boxRigidBodyComponents.getVersion() != boxesVersion)
+		return;
+
+	const ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	for (const AABBTree* tree : { &staticTree, &dynamicTree })
+	{
+		tree->query(bounds, [&](int proxy)
+		{
+			int i = tree->getData(proxy);
+			if (boxes[i].getEntityId() != ignored) callback(i);
+			return true;
+		});
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+void PhysicsEngine::raycastPacket(const Ray* rays, int numOfRays, QueryHit* hits) const
+{
+	glm::vec3 origins[PHYSICS_RAY_PACKET_SIZE];
+	glm::vec3 displacements[PHYSICS_RAY_PACKET_SIZE];
+	FLOAT_TYPE fractions[PHYSICS_RAY_PACKET_SIZE];
+	for (int r = 0; r < numOfRays; ++r)
+	{
+		origins[r] = rays[r].origin;
+		displacements[r] = rays[r].displacement;
+		fractions[r] = 1.0f;
+	}
+
+	//the fractions of the hits in the static tree clip the rays in the dynamic one:
+	const ComponentPool<RigidBodyComponent<Box>>& boxes = world->currentScene->boxRigidBodyComponents;
+	for (const AABBTree* tree : { &staticTree, &dynamicTree })
+	{
+		tree->raycastPacket(origins, displacements, numOfRays, fractions, [&](int proxy, int r, FLOAT_TYPE fraction)
+		{
+			int i = tree->getData(proxy);
+			if (boxes[i].getEntityId() != rays[r].ignored && rayToBox(i, rays[r], fraction, hits[r]))
+				return hits[r].fraction;
+			return fraction;
+		});
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+bool PhysicsEngine::rayToBox(int i, const Ray& ray, FLOAT_TYPE maxFraction, QueryHit& hit) const
+//the slab test in the space of the box, keeping the face the ray enters by
+{
+	const RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+	glm::vec3 halfSize = 0.5f * boxComp.shape.getSize();
+	glm::vec3 toOrigin = ray.origin - boxComp.shape.pos;
+
+	FLOAT_TYPE enter = 0.0f, exit = maxFraction;
+	glm::vec3 normal(0.0f);
+	for (int k = 0; k < 3; ++k)
+	{
+		glm::vec3 axis = glm::normalize(glm::vec3(boxTransforms[i][k]));
+		FLOAT_TYPE origin = glm::dot(toOrigin, axis);
+		FLOAT_TYPE displacement = glm::dot(ray.displacement, axis);
+		if (displacement == 0.0f)
+		{
+			if (std::fabs(origin) > halfSize[k]) return false;
+			continue;
+		}
+
+		FLOAT_TYPE t1 = (-halfSize[k] - origin) / displacement; //the fractions of the negative and positive faces
+		FLOAT_TYPE t2 = (halfSize[k] - origin) / displacement;
+		FLOAT_TYPE side = -1.0f;
+		if (t1 > t2)
+		{
+			std::swap(t1, t2);
+			side = 1.0f;
+		}
+		if (t1 > enter)
+		{
+			enter = t1;
+			normal = axis * side;
+		}
+		if (t2 < exit) exit = t2;
+		if (enter > exit) return false;
+	}
+	if (enter >= maxFraction) return false; //the same fraction as the last hit doesn't replace it
+
+	//a ray that starts inside the box hits it at its origin:
+	if (normal == glm::vec3(0.0f) && glm::length(ray.displacement) > 0.0f) normal = -glm::normalize(ray.displacement);
+
+	hit.entity = boxComp.getEntityId();
+	hit.point = ray.origin + ray.displacement * enter;
+	hit.normal = normal;
+	hit.fraction = enter;
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------------------
+
+
+bool PhysicsEngine::nearestBoxPoint(int i, const glm::vec3& p, glm::vec3& point, glm::vec3& normal) const
+//the point p is clamped to the box in its space. A point inside the box is moved to the nearest face
+{
+	const RigidBodyComponent<Box>& boxComp = world->currentScene->boxRigidBodyComponents[i];
+	glm::vec3 halfSize = 0.5f * boxComp.shape.getSize();
+	glm::vec3 axes[3], local, clamped;
+	for (int k = 0; k < 3; ++k)
+	{
+		axes[k] = glm::normalize(glm::vec3(boxTransforms[i][k]));
+		local[k] = glm::dot(p - boxComp.shape.pos, axes[k]);
+		clamped[k] = glm::clamp(local[k], -halfSize[k], halfSize[k]);
+	}
+
+	bool inside = clamped == local;
+	if (inside)
+	{
+		int face = 0; //the axis with the nearest face
+		for (int k = 1; k < 3; ++k)
+		{
+			if (halfSize[k] - std::fabs(local[k]) < halfSize[face] - std::fabs(local[face])) face = k;
+		}
+		FLOAT_TYPE side = local[face] >= 0.0f ? 1.0f : -1.0f;
+		clamped[face] = halfSize[face] * side;
+		normal = axes[face] * side;
+	}
+
+	point = boxComp.shape.pos + axes[0] * clamped.x + axes[1] * clamped.y + axes[2] * clamped.z;
+	if (!inside) normal = glm::normalize(p - point);
+	return inside;
+}
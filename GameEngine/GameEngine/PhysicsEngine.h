@@ -24,7 +24,9 @@ gabrielgf6000@gmail.com
 
 
 #include <cassert>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -41,10 +43,31 @@ gabrielgf6000@gmail.com
 #include "PhysicalComponents.h"
 #include "CollisionHandling.h"
 #include "Observer.h"
+#include "SweepAndPrune.h"
+#include "AABBTree.h"
+#include "NarrowPhase.h"
+#include "RigidBodyStore.h"
+#include "HeightField.h"
 
 #include "GlobalDefines.h"
 
 
+#define PHYSICS_SLEEP_VELOCITY 0.01f //the boxes that move less than this in a step(units per step) are resting
+#define PHYSICS_SLEEP_TIME 0.5f //an island falls asleep when all its boxes have been resting for this long(seconds)
+#define PHYSICS_PAIRS_GRAIN_SIZE 256 //box pairs tested by each narrow phase job(a multiple of NARROW_PHASE_BLOCK_SIZE)
+#define PHYSICS_SPHERES_GRAIN_SIZE 64 //spheres integrated, or tested against the next spheres, by each job
+#define PHYSICS_GROUND_GRAIN_SIZE 256 //boxes tested against the heightfield by each job
+#define PHYSICS_MAX_SUB_STEPS 32 //of the motion of a fast box in a step(see sweepBox())
+#define PHYSICS_SOLVER_ITERATIONS 4 //of the contact solver in each step(see setSolverIterations())
+#define PHYSICS_CONTACT_SLOP 0.01f //the penetration left between the boxes in contact(so their contacts persist)
+#define PHYSICS_CONTACT_BIAS 0.8f //the part of the penetration(above the slop) pushed out by the contact solver in a step
+#define PHYSICS_MAX_PENETRATION 0.5f //the deeper penetrations are also corrected by moving the boxes at once
+#define PHYSICS_RESTITUTION_THRESHOLD 0.5f //units per step(the slower contacts don't bounce, so the resting boxes don't jitter)
+#define PHYSICS_WARM_START_COSINE 0.9f //a contact keeps the impulses of the last step if its normal turned less than this
+#define PHYSICS_RAY_PACKET_SIZE 16 //rays of a batch raycast traversing the trees together(see AABBTree::raycastPacket())
+#define PHYSICS_RAY_PACKETS_GRAIN_SIZE 8 //ray packets tested by each job of a batch raycast
+
+
 class PhysicsEngine : public Observer, public Subject
 {
 public:
@@ -60,19 +83,240 @@ public:
 
 	void onNotify(Message) override;
 
+	/*
+		setMultithreaded - run the narrow phases(and the integration of the spheres) in the JobSystem, or only
+		in the calling thread. The results are the same, bit by bit: each job keeps the contacts it finds in its
+		own buffer, and the buffers are merged in the order of the pairs before any collision is solved, so the
+		collisions are solved and notified in the same order whatever the number of threads
+	*/
+	void setMultithreaded(bool) noexcept;
+	bool isMultithreaded() const noexcept;
+
+	/*
+		setSolverIterations - the iterations of the contact solver. The contacts between boxes are kept between
+		the steps(by their entities), with the impulses the solver accumulated in them, and each step starts from
+		those impulses. So the stacks and piles of boxes come to rest with a few iterations(and a low tick rate),
+		as the solver only has to correct what changed since the last step
+	*/
+	void setSolverIterations(int) noexcept;
+	int getSolverIterations() const noexcept;
+
+	/*
+		collision layers - each body(and each interactable object) has a layer, and a pair of bodies is only
+		tested if their layers collide(all of them do by default), so the filtered pairs are dropped by the
+		broad phase, before any narrow phase work. The pairs where one of the bodies is on a trigger layer are
+		tested but not solved: a TRIGGER_OVERLAP message is sent instead(with the two entities), and the fast
+		bodies don't stop at them
+	*/
+	void setLayersCollide(int layer1, int layer2, bool) noexcept;
+	bool doLayersCollide(int layer1, int layer2) const noexcept;
+	void setTriggerLayer(int, bool) noexcept;
+	bool isTriggerLayer(int) const noexcept;
+
+	/*
+		the box rigid bodies of the current scene, in two trees: the static one has the boxes with mass <= 0
+		that aren't moving and the sleeping boxes, and the dynamic one has all the others. They can be
+		queried by gameplay and AI code(see AABBTree.h), and getProxyEntity() gives the entity of a proxy
+		found by a query. The trees are updated by update()
+	*/
+	const AABBTree& getStaticTree() const noexcept;
+	const AABBTree& getDynamicTree() const noexcept;
+	Entity getProxyEntity(const AABBTree&, int proxy) const noexcept;
+
+	/* getNumOfBoxPairs - the number of pairs of boxes found by the broad phase of the last update() */
+	int getNumOfBoxPairs() const noexcept;
+
+	/*
+		spatial queries against the box rigid bodies(through the trees, so they see the boxes as the last
+		update() left them, and find nothing if boxes were added or removed since then). The candidates found
+		by the trees are tested against the rotated boxes
+	*/
+	struct QueryHit
+	{
+		Entity entity = -1; //the entity of the box, -1 if nothing was hit
+		glm::vec3 point = glm::vec3(0.0f); //where the ray hit the box, or the point of the box nearest to the query shape
+		glm::vec3 normal = glm::vec3(0.0f); //the normal of the box surface there, pointing out of the box
+		FLOAT_TYPE fraction = 0.0f; //of the ray at the hit(0 at its origin and 1 at its end), 0 for the overlaps
+	};
+
+	struct Ray
+	{
+		glm::vec3 origin = glm::vec3(0.0f);
+		glm::vec3 displacement = glm::vec3(0.0f); //the ray is the segment from origin to origin + displacement
+		Entity ignored = -1; //an entity the ray goes through(like the one casting it)
+	};
+
+	bool raycast(const Ray&, QueryHit&) const; //finds the first box hit by the ray, returns false if none
+	
+	/*
+		raycast - the first hit of each ray(hits is resized to the number of rays). The rays are tested in
+		packets of PHYSICS_RAY_PACKET_SIZE, each traversing the trees only once, and the packets are tested
+		by the JobSystem if the engine is multithreaded. Rays that start near each other(like the line of sight
+		tests of a group of enemies) should be next to each other in the vector
+	*/
+	void raycast(const std::vector<Ray>&, std::vector<QueryHit>&) const;
+
+	/*
+		sphereOverlap and boxOverlap - find all the boxes that overlap a sphere or a box(given like the boxes
+		of the narrow phase, see NarrowPhase::testPair()), except the ignored entity. The hits are sorted by
+		their entities, and their normals point from the boxes toward the center of the query shape. Return the
+		number of hits
+	*/
+	int sphereOverlap(const glm::vec3& center, FLOAT_TYPE radius, std::vector<QueryHit>& hits, Entity ignored = -1) const;
+	int boxOverlap(const Box&, const glm::mat4& model, std::vector<QueryHit>& hits, Entity ignored = -1) const;
+
+	/*
+		setHeightField - the ground collider(see HeightField.h). Each dynamic box is tested against it after
+		the pairs of boxes, with a height lookup under each of its vertices, so the ground isn't a body and takes
+		no part in the broad phase. Its contacts are kept and solved like the ones between boxes(with the ground
+		as a body of infinite mass), and notified with a COLLISION_OCCURRED message whose second entity is
+		NULL_ENTITY. An empty heightfield(the default) disables it
+	*/
+	void setHeightField(HeightField);
+	const HeightField& getHeightField() const noexcept;
+	void clearHeightField() noexcept;
+
 private:
 
+	struct Contact //two bodies that collide(by their indices), found by a narrow phase
+	{
+		int first, second;
+		glm::vec3 separ; //the separation vector found by the test
+	};
+
+	struct GroundContact //the deepest vertex of a box under the heightfield
+	{
+		FLOAT_TYPE depth; //0 if the box doesn't touch it
+		glm::vec3 vertex;
+	};
+
+	struct Manifold //the contact of two boxes, kept between the steps to warm start the solver
+	{
+		Entity first, second; //first < second(the manifolds are sorted by them), first is NULL_ENTITY for the ground
+		glm::vec3 normal; //from the first box to the second
+		glm::vec3 tangents[2];
+		FLOAT_TYPE normalImpulse = 0.0f; //accumulated by the solver(the total impulse of the step)
+		FLOAT_TYPE tangentImpulses[2] = { 0.0f, 0.0f };
+		FLOAT_TYPE penetration; //up to PHYSICS_MAX_PENETRATION(the rest was corrected when it was found)
+
+		//set by solveContacts() in each step:
+		int bodies[2]; //the indices of the boxes in the bodyStore(-1 if not integrated, then it doesn't move)
+		FLOAT_TYPE inverseMasses[2];
+		FLOAT_TYPE friction; //of the materials of the two boxes
+		FLOAT_TYPE targetVelocity; //the normal velocity the solver reaches(the bounce)
+		FLOAT_TYPE pushImpulse; //the impulse of the push that corrects the penetration(it isn't kept)
+	};
+
 	//private data
 	World* world; //hold a ptr to the world to get access to all scenes
 	FLOAT_TYPE timeStep = 0.016f; //the delta time of each integration, measured in seconds
+	bool multithreaded = true;
+	unsigned int filteredLayers[PHYSICS_MAX_LAYERS] = {}; //bit j of filteredLayers[i] is set if the layers i and j don't collide
+	unsigned int triggerLayers = 0; //bit i is set if the layer i is a trigger layer
+	int solverIterations = PHYSICS_SOLVER_ITERATIONS;
+
+	//narrow phase contacts:
+	std::vector<std::vector<Contact>> contactBuffers; //the contacts found by each job(by its first element / grain size)
+	std::vector<Contact> contacts; //the contacts of all the jobs, sorted by their bodies
+	std::vector<unsigned char> spheresMoved; //if each sphere was moved by a collision in this step
+
+	//continuous collision detection:
+	std::vector<std::pair<FLOAT_TYPE, int>> sweepHits; //the time of impact and the index of the boxes a fast box may hit
+	std::vector<glm::vec3> sphereSteps; //the displacement of each sphere in this step
+
+	//box rigid bodies broad phase:
+	AABBTree staticTree; //the static boxes are only tested against the dynamic boxes that are near them
+	AABBTree dynamicTree;
+	std::vector<Entity> staticOwners; //the entity of each proxy(by the proxy id, -1 for the free ones)
+	std::vector<Entity> dynamicOwners;
+	const Scene* boxesScene = nullptr; //the scene and pool version the proxies were made for
+	unsigned int boxesVersion = 0;
+	SweepAndPrune broadPhase; //finds the pairs of dynamic boxes that may collide
+	std::vector<int> integratedBoxes; //the indices of the boxes that were integrated(or woken) in this step
+	RigidBodyStore bodyStore; //their data while they are integrated(by their index in integratedBoxes)
+	std::vector<int> dynamicBoxes; //the integrated boxes that are in the dynamic tree(visited again in the next step)
+	std::vector<AABB> dynamicBounds;
+	std::vector<SweepAndPrune::Pair> boxPairs; //the pairs of boxes that may collide, by their indices
+	NarrowPhase narrowPhase; //tests all the pairs of a step at once
+	std::vector<unsigned char> pairTests; //if each box pair was set in the NarrowPhase(it has the index of the pair)
+	std::vector<unsigned char> boxMoved; //if each box was moved by a collision in this step
+	std::vector<std::vector<int>> staticNeighbours; //the static boxes whose fat AABBs overlap the one of each dynamic box
+	std::vector<unsigned int> neighboursVersion; //the staticVersion when the neighbours of each box were found(0 if never)
+	unsigned int staticVersion = 1; //changed when a proxy is inserted in the static tree or removed from it
+	std::vector<SweepAndPrune::Pair> objectPairs; //a box and an interactable object that may collide
+
+	//contact solver:
+	std::vector<Manifold> manifolds; //the contacts found in the last step, sorted by their entities
+	std::vector<Manifold> newManifolds; //the ones found in this step
+	std::vector<int> storeIndices; //the index of each box in the bodyStore(-1 if it isn't integrated in this step)
+	std::vector<glm::vec3> pushes; //the displacement of each box of the bodyStore that corrects its penetrations
+	HeightField heightField; //the ground
+	std::vector<GroundContact> groundContacts; //of each dynamic box(by its index in dynamicBoxes)
+
+	/*
+		sleeping boxes: the boxes in contact in a step form an island(the boxes with mass <= 0 don't join
+		them), and when all the boxes of an island have been resting for PHYSICS_SLEEP_TIME seconds the
+		island falls asleep. The sleeping boxes are kept in the static tree, so they cost nothing until an
+		awake box touches one of them, or until one of them is changed, and then the whole island wakes
+	*/
+	std::vector<std::vector<Entity>> islands; //the boxes of each sleeping island(by the island id)
+	std::vector<int> freeIslands; //the ids of the islands that woke
+	std::vector<int> islandParents; //union-find of the boxes in contact in this step
+	std::vector<int> islandIds; //the sleeping island made for each union-find root
+	std::vector<unsigned char> islandAwake; //if each union-find root has a box that isn't resting
+	std::vector<int> wokenBoxes; //the boxes woken in this step that are still in the static tree
+	std::vector<Entity> changedBodies; //logged by the boxes of the scene(see RigidBodyComponent::logChange())
+	std::vector<Entity> changedEntities; //the boxes and the transforms changed since the last step(or kept by it)
+	std::vector<int> visitedBoxes; //the boxes in the dynamic tree and the changed ones, sorted
+	std::vector<glm::vec3> stepPositions; //the position of each awake box before this step
+
+	//box rigid bodies data(by their index in the pool, only recomputed for the static boxes when they move):
+	std::vector<AABB> boxBounds;
+	std::vector<glm::mat4> boxTransforms; //the rigid world transform of each box
+	std::vector<FLOAT_TYPE> boxRadii; //the radius of the bounding sphere of each box
+	std::vector<glm::vec3> boxPositions; //the position of each box when its data was computed
+	std::vector<glm::vec3> boxSizes; //and its size
 
 	//private functions:
 	glm::mat4 normalizeRows(int, glm::mat4) const noexcept;
 	glm::mat4 getFullTransform(Entity) const;
 	glm::quat getFullRotationQuaternion(Entity) const;
 
+	bool isFiltered(int layer1, int layer2) const noexcept; //the layers don't collide
+	bool isTrigger(int layer1, int layer2) const noexcept; //one of the layers is a trigger layer
+	void sendTrigger(Entity, Entity);
+
+	void runJobs(int n, int grainSize, const std::function<void(int, int)>&); //parallelFor(), if multithreaded
+	void mergeContacts(int numOfElements, int grainSize); //join the contactBuffers used by runJobs() in contacts
+
 	void solveForSpheres();
 	void solveForBoxes();
+	void syncBoxProxies(); //make the proxies match the boxes, if the scene or the pool changed
+	void updateBoxData(int); //recompute the transform, bounds and radius of a box
+	bool isBoxChanged(int) const; //the position, size or world transform of the box changed since updateBoxData()
+	void findVisitedBoxes(); //the boxes that may change in this step(the others cost nothing)
+	void setBoxProxy(int, bool isStatic); //put the box in the static or in the dynamic tree
+	bool isStaticBox(const RigidBodyComponent<Box>&) const noexcept;
+	glm::vec3 sweepBox(int, glm::vec3 displacement); //the part of the displacement of a fast box before its first hit
+	glm::vec3 sweepSphere(int, glm::vec3 displacement); //the same for a fast sphere
+	bool isSleepingBox(const RigidBodyComponent<Box>&) const noexcept; //sleeping, and nothing changed it
+	void solveContacts(); //solve the velocities of the boxes in the bodyStore for the manifolds
+	void addManifold(int, int, glm::vec3 separVec); //a contact of two boxes found in this step
+	void pushManifold(Entity first, Entity second, glm::vec3 normal, FLOAT_TYPE penetration); //to newManifolds
+	GroundContact findGroundContact(int) const noexcept; //a box against the heightfield
+	void solveGroundContact(int, const GroundContact&);
+	void updateManifolds(); //keep the contacts found in this step, with the impulses of the ones that persisted
+	glm::vec3 getStoreVelocity(int) const noexcept; //of a box in the bodyStore(or 0, for -1)
+	void applyImpulse(const Manifold&, const glm::vec3&) noexcept; //to the boxes of the manifold(from the first to the second)
+	void wakeBox(int); //wake a box and its island(they are moved to the dynamic tree by addWokenBoxes())
+	void addWokenBoxes(); //move the boxes woken in this step to the dynamic tree
+	void updateIslands(); //put to sleep the islands that have been resting for PHYSICS_SLEEP_TIME
+	int findIsland(int); //the union-find root of a box
+	bool rayToBox(int, const Ray&, FLOAT_TYPE maxFraction, QueryHit&) const; //a hit before maxFraction, on the rotated box
+	bool nearestBoxPoint(int, const glm::vec3&, glm::vec3& point, glm::vec3& normal) const; //returns true if it is inside
+	void raycastPacket(const Ray*, int numOfRays, QueryHit*) const;
+	template<typename F>
+	void queryBoxes(const AABB&, Entity ignored, const F& callback) const; //callback(int box) for the candidates
 };
 
 
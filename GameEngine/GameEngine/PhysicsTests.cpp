@@ -0,0 +1,851 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RigidBodyStore.h"
+#include "JobSystem.h"
+#include "Observer.h"
+#include "NarrowPhase.h"
+#include "BenchmarkHelpers.h"
+
+
+void benchmarkRigidBodyStore()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const int rounds = 20;
+	const FLOAT_TYPE timeStep = 1.0f / 60.0f;
+
+	//the data of a body as the PhysicsEngine read it from the components(interleaved, with the data the
+	//integration doesn't use between the bodies):
+	struct Body
+	{
+		glm::vec3 position, velocity, forces;
+		FLOAT_TYPE mass;
+		bool fast;
+		glm::vec3 unused[16]; //the vertices, the size and the inertia of the components
+	};
+
+	for (int n : sizes)
+	{
+		std::default_random_engine generator(7);
+		std::uniform_real_distribution<FLOAT_TYPE> random11(-1.0f, 1.0f);
+		std::vector<Body> bodies(n);
+		for (int i = 0; i < n; ++i)
+		{
+			Body& body = bodies[i];
+			body.position = 100.0f * glm::vec3(random11(generator), random11(generator), random11(generator));
+			body.velocity = glm::vec3(random11(generator), random11(generator), random11(generator));
+			body.forces = i % 3 == 0 ? 50.0f * glm::vec3(random11(generator), random11(generator), random11(generator)) : glm::vec3(0.0f);
+			body.mass = i % 10 == 0 ? 0.0f : 1.0f + 4.0f * std::fabs(random11(generator)); //a tenth of infinite mass
+			body.fast = i % 50 == 0;
+		}
+		std::vector<Body> reference = bodies;
+		std::vector<glm::vec3> referenceSteps(n);
+
+		//--------------------------------------
+		//the scalar loop(the forces are kept between the rounds, so that every round uses them):
+		auto start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			for (int i = 0; i < n; ++i)
+			{
+				Body& body = reference[i];
+				body.velocity += body.forces * (timeStep * (body.mass > 0.0f ? 1.0f / body.mass : 1.0f));
+				if (body.mass > 0.0f) body.velocity.y += RIGID_BODY_STORE_GRAVITY * timeStep;
+				referenceSteps[i] = body.velocity;
+				if (!body.fast) body.position += body.velocity;
+
+				body.velocity *= RIGID_BODY_STORE_DRAG;
+				if (std::fabs(body.velocity.x) <= RIGID_BODY_STORE_REST_VELOCITY_XZ) body.velocity.x = 0.0f;
+				if (std::fabs(body.velocity.y) <= RIGID_BODY_STORE_REST_VELOCITY_Y) body.velocity.y = 0.0f;
+				if (std::fabs(body.velocity.z) <= RIGID_BODY_STORE_REST_VELOCITY_XZ) body.velocity.z = 0.0f;
+			}
+		double scalarTime = nanosecondsSince(start) / 1000000000.0;
+
+		//the store, with the copies to it and back(like in PhysicsEngine::solveForBoxes()):
+		RigidBodyStore store;
+		double copyTime = 0.0, integrateTime = 0.0;
+		for (int r = 0; r < rounds; ++r)
+		{
+			start = BenchClock::now();
+			store.setNumOfBodies(n);
+			for (int i = 0; i < n; ++i)
+				store.setBody(i, bodies[i].position, bodies[i].velocity, bodies[i].forces, bodies[i].mass, bodies[i].fast);
+			copyTime += nanosecondsSince(start) / 1000000000.0;
+
+			start = BenchClock::now();
+			store.integrate(timeStep);
+			integrateTime += nanosecondsSince(start) / 1000000000.0;
+
+			start = BenchClock::now();
+			for (int i = 0; i < n; ++i)
+			{
+				bodies[i].position = store.getPosition(i);
+				bodies[i].velocity = store.getVelocity(i);
+			}
+			copyTime += nanosecondsSince(start) / 1000000000.0;
+		}
+
+		//--------------------------------------
+		//the results must be the ones of the scalar loop:
+		int different = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			FLOAT_TYPE error = glm::length(bodies[i].position - reference[i].position)
+				+ glm::length(bodies[i].velocity - reference[i].velocity) + glm::length(store.getStep(i) - referenceSteps[i]);
+			different += error > 0.0001f;
+		}
+
+		double integrated = double(n) * rounds;
+		std::cout << "RigidBodyStore(" << n << " bodies, " << rounds << " steps):\n"
+			<< "  results: " << checkResult(different == 0, "DIFFERENT") << " (" << different << " different)\n"
+			<< "  scalar: " << integrated / scalarTime / 1000000.0 << " M bodies/s"
+			<< ", integrate(): " << integrated / integrateTime / 1000000.0 << " M bodies/s"
+			<< "(" << integrated / (copyTime + integrateTime) / 1000000.0 << " with the copies)\n";
+
+		recordResult("rigid_body_store_scalar", n, integrated / scalarTime, "bodies/s");
+		recordResult("rigid_body_store_integrate", n, integrated / integrateTime, "bodies/s");
+		recordResult("rigid_body_store_with_copies", n, integrated / (copyTime + integrateTime), "bodies/s");
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkSleepingBodies()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const int steps = 20;
+
+	std::cout << "PhysicsEngine::update() with boxes resting on the ground(awake and sleeping):\n";
+
+	for (int n : sizes)
+	{
+		PhysicsFixture fixture;
+		Scene* scene = fixture.scene;
+		PhysicsEngine& physics = fixture.physics;
+
+		//a grid of boxes of 4 units, each one touching the ground(and not touching the others):
+		int side = int(std::ceil(std::sqrt(FLOAT_TYPE(n))));
+		fixture.addStaticBox(side * 6 + 10, 2, side * 6 + 10, glm::vec3(side * 3.0f, -1.0f, side * 3.0f));
+
+		std::vector<Entity> boxes;
+		for (int i = 0; i < n; ++i)
+		{
+			Entity e = scene->createEntity();
+			glm::vec3 pos((i % side) * 6.0f, 2.0f, (i / side) * 6.0f);
+			scene->getTransformComponent(e)->setPosition(pos);
+			physics.addBoxPhysicalComponent(e, 4, 4, 4, pos);
+			boxes.push_back(e);
+		}
+
+		//awake(the boxes need PHYSICS_SLEEP_TIME seconds of rest to fall asleep):
+		physics.update();
+		auto start = BenchClock::now();
+		for (int s = 0; s < steps; ++s)
+			physics.update();
+		double awakeTime = nanosecondsSince(start) / (1000000.0 * steps);
+
+		int settleSteps = 0;
+		while (physics.getDynamicTree().getNumOfProxies() > 0 && settleSteps < 1000)
+		{
+			physics.update();
+			++settleSteps;
+		}
+
+		//asleep:
+		start = BenchClock::now();
+		for (int s = 0; s < steps; ++s)
+			physics.update();
+		double sleepingTime = nanosecondsSince(start) / (1000000.0 * steps);
+
+		//a pushed box wakes and moves(and the others keep sleeping):
+		RigidBodyComponent<Box>* pushed = scene->getBoxRigidBodyComponent(boxes[n / 2]);
+		glm::vec3 before = pushed->getPosition();
+		bool wasSleeping = pushed->isSleeping();
+		pushed->addLinearVelocity(glm::vec3(0.5f, 0.0f, 0.0f));
+		physics.update();
+		bool woke = wasSleeping && !pushed->isSleeping() && pushed->getPosition().x > before.x
+			&& scene->getBoxRigidBodyComponent(boxes[0])->isSleeping();
+
+		//and so does a box rotated by its transform(its position doesn't change):
+		RigidBodyComponent<Box>* rotated = scene->getBoxRigidBodyComponent(boxes[n / 4]);
+		wasSleeping = rotated->isSleeping();
+		scene->getTransformComponent(boxes[n / 4])->rotate(45.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+		physics.update();
+		bool rotationWoke = wasSleeping && !rotated->isSleeping();
+
+		std::cout << "  N = " << n
+			<< ", awake: " << awakeTime << " ms/step"
+			<< ", asleep after " << settleSteps + steps + 1 << " steps"
+			<< ", sleeping: " << sleepingTime << " ms/step"
+			<< ", wake on push: " << checkResult(woke)
+			<< ", wake on rotation: " << checkResult(rotationWoke) << '\n';
+
+		recordResult("solve_for_boxes_resting_awake", n, awakeTime, "ms/step");
+		recordResult("solve_for_boxes_resting_sleeping", n, sleepingTime, "ms/step");
+	}
+}
+
+
+//=============================================================================================
+
+
+namespace
+{
+	class CollisionRecorder : public Observer
+	{
+	public:
+		void onNotify(Message msg) override
+		{
+			messages.push_back(msg);
+		}
+
+		std::vector<Message> messages;
+	};
+
+	bool sameMessages(const std::vector<Message>& a, const std::vector<Message>& b) noexcept
+	{
+		if (a.size() != b.size()) return false;
+		for (size_t i = 0; i < a.size(); ++i)
+			for (int k = 0; k < 3; ++k)
+				if (a[i].idata[k] != b[i].idata[k] || a[i].fdata[k] != b[i].fdata[k]) return false;
+		return true;
+	}
+}
+
+
+void benchmarkParallelPhysics()
+{
+	const int sizes[] = { 1000, 10000 };
+	const int numOfSpheres = 1000;
+	const int steps = 60;
+
+	std::cout << "PhysicsEngine narrow phases(" << JobSystem::instance().getNumOfThreads() << " threads against 1):\n";
+
+	for (int n : sizes)
+	{
+		std::vector<glm::vec3> positions[2];
+		std::vector<Message> messages[2];
+		double stepTime[2];
+		int numOfPairs = 0;
+
+		for (int run = 0; run < 2; ++run)
+		{
+			PhysicsFixture fixture;
+			Scene* scene = fixture.scene;
+			PhysicsEngine& physics = fixture.physics;
+			physics.setMultithreaded(run == 1);
+			CollisionRecorder recorder;
+			physics.addObserver(recorder, MessageType::COLLISION_OCCURRED);
+
+			//columns of boxes that overlap a little(so they push each other while they fall), over the ground:
+			int side = int(std::ceil(std::sqrt(n / 8.0)));
+			fixture.addStaticBox(side * 5 + 20, 2, side * 5 + 20, glm::vec3(side * 2.5f, -1.0f, side * 2.5f));
+
+			std::vector<Entity> entities;
+			for (int i = 0; i < n; ++i)
+			{
+				Entity e = scene->createEntity();
+				int column = i / 8;
+				glm::vec3 pos((column % side) * 3.5f, 2.0f + (i % 8) * 3.5f, (column / side) * 3.5f + 0.1f * (i % 3));
+				scene->getTransformComponent(e)->setPosition(pos);
+				physics.addBoxPhysicalComponent(e, 4, 4, 4, pos);
+				entities.push_back(e);
+			}
+
+			//and a cluster of spheres:
+			std::default_random_engine generator(7);
+			std::uniform_real_distribution<FLOAT_TYPE> random01(0.0f, 1.0f);
+			for (int i = 0; i < numOfSpheres; ++i)
+			{
+				Entity e = scene->createEntity();
+				glm::vec3 pos(random01(generator), random01(generator), random01(generator));
+				physics.addSpherePhysicalComponent(e, 1.0f, pos * 60.0f + glm::vec3(0.0f, 200.0f, 0.0f));
+				scene->sphereRigidBodyComponents.getByEntity(e)->setMass(1.0f);
+				entities.push_back(e);
+			}
+
+			auto start = BenchClock::now();
+			for (int s = 0; s < steps; ++s)
+			{
+				physics.update();
+				physics.notify();
+			}
+			stepTime[run] = nanosecondsSince(start) / (1000000.0 * steps);
+			numOfPairs = physics.getNumOfBoxPairs();
+
+			for (Entity e : entities)
+				positions[run].push_back(scene->getTransformComponent(e)->getPosition());
+			messages[run] = std::move(recorder.messages);
+		}
+
+		bool identical = positions[0] == positions[1] && sameMessages(messages[0], messages[1]);
+		std::cout << "  N = " << n << " boxes + " << numOfSpheres << " spheres"
+			<< ", box pairs: " << numOfPairs
+			<< ", collisions: " << messages[0].size()
+			<< ", 1 thread: " << stepTime[0] << " ms/step"
+			<< ", parallel: " << stepTime[1] << " ms/step"
+			<< ", speedup: " << stepTime[0] / stepTime[1] << "x"
+			<< ", identical: " << checkResult(identical) << '\n';
+
+		recordResult("physics_step_single_thread", n, stepTime[0], "ms/step");
+		recordResult("physics_step_parallel", n, stepTime[1], "ms/step");
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkContinuousCollision()
+{
+	const int sizes[] = { 100, 1000, 10000 };
+	const int steps = 10;
+	const FLOAT_TYPE speed = 40.0f; //units per step(the wall is 2 units thick, the boxes have 4 units)
+
+	std::cout << "Continuous collision detection(bodies at " << speed << " units per step):\n";
+
+	for (int n : sizes)
+	{
+		int passed[2] = { 0, 0 };
+		double stepTime[2];
+
+		for (int fast = 0; fast < 2; ++fast)
+		{
+			PhysicsFixture fixture;
+			Scene* scene = fixture.scene;
+			PhysicsEngine& physics = fixture.physics;
+
+			//a thin wall on the plane z = 0, and the boxes flying to it(in a grid, so they don't touch each other):
+			int side = int(std::ceil(std::sqrt(FLOAT_TYPE(n))));
+			fixture.addStaticBox(side * 8 + 40, side * 8 + 40, 2, glm::vec3(side * 4.0f, side * 4.0f, 0.0f));
+
+			std::vector<Entity> boxes;
+			for (int i = 0; i < n; ++i)
+			{
+				Entity e = scene->createEntity();
+				glm::vec3 pos((i % side) * 8.0f, (i / side) * 8.0f + 20.0f, -30.0f - FLOAT_TYPE(i % 7));
+				scene->getTransformComponent(e)->setPosition(pos);
+				physics.addBoxPhysicalComponent(e, 4, 4, 4, pos);
+				RigidBodyComponent<Box>* body = scene->getBoxRigidBodyComponent(e);
+				body->linearVelocity = glm::vec3(0.0f, 0.0f, speed);
+				body->fast = fast == 1;
+				boxes.push_back(e);
+			}
+
+			//and spheres flying to a large sphere:
+			Entity target = scene->createEntity();
+			physics.addSpherePhysicalComponent(target, 8.0f, glm::vec3(0.0f, -500.0f, 0.0f));
+			scene->sphereRigidBodyComponents.getByEntity(target)->setMass(1000000.0f);
+			std::vector<Entity> spheres;
+			for (int i = 0; i < 20; ++i)
+			{
+				Entity e = scene->createEntity();
+				FLOAT_TYPE angle = 6.2831853f * i / 20.0f;
+				glm::vec3 direction(std::cos(angle), 0.0f, std::sin(angle));
+				physics.addSpherePhysicalComponent(e, 1.0f, glm::vec3(0.0f, -500.0f, 0.0f) + direction * 30.0f);
+				RigidBodyComponent<Sphere>* body = scene->sphereRigidBodyComponents.getByEntity(e);
+				body->linearVelocity = -direction * speed;
+				body->fast = fast == 1;
+				spheres.push_back(e);
+			}
+
+			auto start = BenchClock::now();
+			for (int s = 0; s < steps; ++s)
+			{
+				physics.update();
+			}
+			stepTime[fast] = nanosecondsSince(start) / (1000000.0 * steps);
+
+			for (Entity e : boxes)
+				if (scene->getBoxRigidBodyComponent(e)->getPosition().z > 0.0f) ++passed[fast];
+
+			//the spheres that got to the other side of the target(nothing else moves them):
+			for (int i = 0; i < int(spheres.size()); ++i)
+			{
+				FLOAT_TYPE angle = 6.2831853f * i / 20.0f;
+				glm::vec3 direction(std::cos(angle), 0.0f, std::sin(angle));
+				glm::vec3 pos = scene->sphereRigidBodyComponents.getByEntity(spheres[i])->getPosition();
+				if (glm::dot(pos - glm::vec3(0.0f, -500.0f, 0.0f), direction) < 0.0f) ++passed[fast];
+			}
+		}
+
+		std::cout << "  N = " << n << " boxes + 20 spheres"
+			<< ", passed through(discrete): " << passed[0]
+			<< ", passed through(fast): " << passed[1]
+			<< ", discrete: " << stepTime[0] << " ms/step"
+			<< ", fast: " << stepTime[1] << " ms/step"
+			<< ", tunneling: " << checkResult(passed[1] == 0) << '\n';
+
+		recordResult("ccd_discrete_step", n, stepTime[0], "ms/step");
+		recordResult("ccd_fast_step", n, stepTime[1], "ms/step");
+	}
+}
+
+
+//=============================================================================================
+
+
+static glm::mat3 boxAxes(Scene& scene, const RigidBodyComponent<Box>& box)
+//the normalized axes of a box in world space(its rotation, like the PhysicsEngine finds it)
+{
+	glm::mat4 transform = scene.getTransformComponent(box.getEntityId())->getRigidWorldTransform();
+	return glm::mat3(glm::normalize(glm::vec3(transform[0])), glm::normalize(glm::vec3(transform[1])),
+		glm::normalize(glm::vec3(transform[2])));
+}
+
+
+static bool rayHitsBox(const glm::mat3& axes, const RigidBodyComponent<Box>& box, const PhysicsEngine::Ray& ray,
+	FLOAT_TYPE maxFraction, FLOAT_TYPE& fraction) noexcept
+//the slab test in the space of the box, to check the raycasts of the PhysicsEngine
+{
+	glm::vec3 halfSize = 0.5f * box.getSize();
+	glm::vec3 toOrigin = ray.origin - box.getPosition();
+	FLOAT_TYPE enter = 0.0f, exit = maxFraction;
+	for (int k = 0; k < 3; ++k)
+	{
+		FLOAT_TYPE origin = glm::dot(toOrigin, axes[k]);
+		FLOAT_TYPE displacement = glm::dot(ray.displacement, axes[k]);
+		if (displacement == 0.0f)
+		{
+			if (std::fabs(origin) > halfSize[k]) return false;
+			continue;
+		}
+		FLOAT_TYPE t1 = (-halfSize[k] - origin) / displacement;
+		FLOAT_TYPE t2 = (halfSize[k] - origin) / displacement;
+		enter = std::max(enter, std::min(t1, t2));
+		exit = std::min(exit, std::max(t1, t2));
+		if (enter > exit) return false;
+	}
+	if (enter >= maxFraction) return false;
+	fraction = enter;
+	return true;
+}
+
+
+static FLOAT_TYPE distanceToBox(const glm::mat3& axes, const RigidBodyComponent<Box>& box, const glm::vec3& p) noexcept
+//0 if the point is inside the box, to check the sphere overlaps of the PhysicsEngine
+{
+	glm::vec3 halfSize = 0.5f * box.getSize();
+	glm::vec3 local, clamped;
+	for (int k = 0; k < 3; ++k)
+	{
+		local[k] = glm::dot(p - box.getPosition(), axes[k]);
+		clamped[k] = glm::clamp(local[k], -halfSize[k], halfSize[k]);
+	}
+	if (clamped == local) return 0.0f;
+	return glm::length(p - (box.getPosition() + axes[0] * clamped.x + axes[1] * clamped.y + axes[2] * clamped.z));
+}
+
+
+void benchmarkPhysicsQueries()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const int numOfRays = 10000;
+	const int numOfOverlaps = 1000;
+
+	std::cout << "Physics queries(" << numOfRays << " rays, " << numOfOverlaps << " sphere and box overlaps):\n";
+
+	for (int n : sizes)
+	{
+		PhysicsFixture fixture;
+		Scene* scene = fixture.scene;
+		PhysicsEngine& physics = fixture.physics;
+
+		//rotated boxes in a cube of the same density for all the sizes(half of them static):
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<FLOAT_TYPE> random01(0.0f, 1.0f);
+		FLOAT_TYPE side = 20.0f * std::cbrt(FLOAT_TYPE(n));
+		auto randomPoint = [&]() { return glm::vec3(random01(random), random01(random), random01(random)) * side; };
+		for (int i = 0; i < n; ++i)
+		{
+			Entity e = scene->createEntity();
+			glm::vec3 pos = randomPoint();
+			TransformComponent* transform = scene->getTransformComponent(e);
+			transform->setPosition(pos);
+			transform->setOrientation(random01(random) * 360.0f, glm::normalize(randomPoint() - glm::vec3(side * 0.5f)));
+			physics.addBoxPhysicalComponent(e, 1 + i % 4, 1 + (i / 4) % 4, 1 + (i / 16) % 4, pos);
+			if (i % 2) scene->getBoxRigidBodyComponent(e)->setMass(-1.0f);
+		}
+		physics.update(); //makes the proxies
+
+		//the rays go from near one of 16 points to near one of 4 points(like a group of enemies looking at the
+		//players), and only some of them are checked against testing every box:
+		std::vector<PhysicsEngine::Ray> rays(numOfRays);
+		glm::vec3 eyes[16], targets[4];
+		for (glm::vec3& eye : eyes) eye = randomPoint();
+		for (glm::vec3& target : targets) target = randomPoint();
+		for (int r = 0; r < numOfRays; ++r)
+		{
+			rays[r].origin = eyes[r * 16 / numOfRays] + glm::vec3(random01(random), random01(random), random01(random));
+			rays[r].displacement = targets[r % 4] + 4.0f * glm::vec3(random01(random), random01(random), random01(random))
+				- rays[r].origin;
+		}
+		int checkStride = std::max(1, n / 1000);
+
+		ComponentPool<RigidBodyComponent<Box>>& boxes = scene->boxRigidBodyComponents;
+		std::vector<glm::mat3> axes(boxes.getSize());
+		for (int i = 0; i < boxes.getSize(); ++i)
+			axes[i] = boxAxes(*scene, boxes[i]);
+
+		auto start = BenchClock::now();
+		std::vector<PhysicsEngine::QueryHit> bruteHits(numOfRays);
+		for (int r = 0; r < numOfRays; r += checkStride)
+		{
+			FLOAT_TYPE fraction = 1.0f;
+			for (int i = 0; i < boxes.getSize(); ++i)
+			{
+				if (!rayHitsBox(axes[i], boxes[i], rays[r], fraction, fraction)) continue;
+				bruteHits[r].entity = boxes[i].getEntityId();
+				bruteHits[r].fraction = fraction;
+			}
+		}
+		double bruteTime = nanosecondsSince(start) * checkStride / 1000000.0;
+
+		start = BenchClock::now();
+		std::vector<PhysicsEngine::QueryHit> singleHits(numOfRays);
+		for (int r = 0; r < numOfRays; ++r)
+			physics.raycast(rays[r], singleHits[r]);
+		double singleTime = nanosecondsSince(start) / 1000000.0;
+
+		start = BenchClock::now();
+		std::vector<PhysicsEngine::QueryHit> batchHits;
+		physics.raycast(rays, batchHits);
+		double batchTime = nanosecondsSince(start) / 1000000.0;
+
+		//the same first hits, on the surface of the boxes:
+		bool raysOk = true;
+		int numOfHits = 0;
+		for (int r = 0; r < numOfRays; ++r)
+		{
+			const PhysicsEngine::QueryHit& hit = singleHits[r];
+			raysOk &= batchHits[r].entity == hit.entity && batchHits[r].fraction == hit.fraction;
+			if (r % checkStride == 0)
+				raysOk &= hit.entity == bruteHits[r].entity && hit.fraction == bruteHits[r].fraction;
+			if (hit.entity < 0) continue;
+
+			++numOfHits;
+			const RigidBodyComponent<Box>* box = boxes.getByEntity(hit.entity);
+			glm::mat3 rotation(scene->getTransformComponent(hit.entity)->getRigidWorldTransform());
+			glm::vec3 local = glm::transpose(rotation) * (hit.point - box->getPosition()) / (0.5f * box->getSize());
+			FLOAT_TYPE distance = std::max(std::fabs(local.x), std::max(std::fabs(local.y), std::fabs(local.z)));
+			raysOk &= (hit.fraction == 0.0f || std::fabs(distance - 1.0f) < 0.001f)
+				&& std::fabs(glm::length(hit.normal) - 1.0f) < 0.001f;
+		}
+
+		//the overlaps(the same random shapes for the queries and for testing every box):
+		std::vector<std::pair<glm::vec3, FLOAT_TYPE>> spheres(numOfOverlaps);
+		std::vector<std::pair<Box, glm::mat4>> queryBoxes(numOfOverlaps);
+		for (int q = 0; q < numOfOverlaps; ++q)
+		{
+			spheres[q] = { randomPoint(), 2.0f + 8.0f * random01(random) };
+			Box& box = queryBoxes[q].first;
+			box.setSize(4, 2, 6);
+			box.pos = randomPoint();
+			queryBoxes[q].second = glm::toMat4(glm::angleAxis(random01(random) * 6.2831853f, glm::vec3(0.0f, 1.0f, 0.0f)));
+			queryBoxes[q].second[3] = glm::vec4(box.pos, 1.0f);
+		}
+
+		std::vector<std::vector<PhysicsEngine::QueryHit>> hits(2 * numOfOverlaps);
+		int numOfOverlapHits = 0;
+		start = BenchClock::now();
+		for (int q = 0; q < numOfOverlaps; ++q)
+		{
+			numOfOverlapHits += physics.sphereOverlap(spheres[q].first, spheres[q].second, hits[q]);
+			numOfOverlapHits += physics.boxOverlap(queryBoxes[q].first, queryBoxes[q].second, hits[numOfOverlaps + q]);
+		}
+		double overlapTime = nanosecondsSince(start) / 1000000.0;
+
+		bool overlapsOk = true;
+		for (int q = 0; q < 2 * numOfOverlaps; q += checkStride)
+		{
+			std::vector<Entity> expected;
+			for (int i = 0; i < boxes.getSize(); ++i)
+			{
+				if (q < numOfOverlaps)
+				{
+					if (distanceToBox(axes[i], boxes[i], spheres[q].first) > spheres[q].second) continue;
+				}
+				else
+				{
+					Box box;
+					glm::vec3 size = boxes[i].getSize();
+					box.setSize(int(size.x), int(size.y), int(size.z));
+					box.pos = boxes[i].getPosition();
+					glm::mat4 boxModel = scene->getTransformComponent(boxes[i].getEntityId())->getRigidWorldTransform();
+					boxModel[3] = glm::vec4(box.pos, 1.0f);
+					glm::vec3 mtv;
+					const std::pair<Box, glm::mat4>& query = queryBoxes[q - numOfOverlaps];
+					if (!NarrowPhase::testPair(query.first, box, query.second, boxModel, mtv)) continue;
+				}
+				expected.push_back(boxes[i].getEntityId());
+			}
+
+			std::sort(expected.begin(), expected.end());
+			overlapsOk &= expected.size() == hits[q].size();
+			for (size_t k = 0; k < expected.size() && overlapsOk; ++k)
+				overlapsOk &= hits[q][k].entity == expected[k];
+		}
+
+		std::cout << "  N = " << n
+			<< ", rays hit: " << numOfHits
+			<< ", every box(estimated): " << bruteTime << " ms"
+			<< ", raycast: " << singleTime << " ms"
+			<< ", batch: " << batchTime << " ms"
+			<< ", rays: " << checkResult(raysOk)
+			<< ", overlaps(" << numOfOverlapHits << " hits): " << checkResult(overlapsOk)
+			<< " in " << overlapTime << " ms\n";
+
+		recordResult("raycast_single", n, singleTime * 1000000.0 / numOfRays, "ns/ray");
+		recordResult("raycast_batch", n, batchTime * 1000000.0 / numOfRays, "ns/ray");
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkCollisionLayers()
+{
+	const int sizes[] = { 1000, 10000 };
+	const int steps = 60;
+	const char* runNames[] = { "all colliding", "filtered", "with trigger" };
+
+	std::cout << "Collision layers(half of the boxes on a layer that doesn't collide with itself, and a trigger):\n";
+
+	for (int n : sizes)
+	{
+		std::vector<glm::vec3> positions[3];
+		std::vector<Message> collisions[3];
+		double stepTime[3];
+		long long numOfPairs[3] = { 0, 0, 0 };
+		size_t numOfTriggers = 0;
+		bool filteredOk = true;
+
+		for (int run = 0; run < 3; ++run)
+		{
+			PhysicsFixture fixture;
+			Scene* scene = fixture.scene;
+			PhysicsEngine& physics = fixture.physics;
+			physics.setLayersCollide(1, 1, run != 1);
+			physics.setTriggerLayer(2, true);
+			CollisionRecorder recorder, triggers;
+			physics.addObserver(recorder, MessageType::COLLISION_OCCURRED);
+			physics.addObserver(triggers, MessageType::TRIGGER_OVERLAP);
+
+			//the same pile of benchmarkParallelPhysics(), the odd boxes on the layer 1:
+			int side = int(std::ceil(std::sqrt(n / 8.0)));
+			fixture.addStaticBox(side * 5 + 20, 2, side * 5 + 20, glm::vec3(side * 2.5f, -1.0f, side * 2.5f));
+
+			std::vector<Entity> entities;
+			for (int i = 0; i < n; ++i)
+			{
+				Entity e = scene->createEntity();
+				int column = i / 8;
+				glm::vec3 pos((column % side) * 3.5f, 2.0f + (i % 8) * 3.5f, (column / side) * 3.5f + 0.1f * (i % 3));
+				scene->getTransformComponent(e)->setPosition(pos);
+				physics.addBoxPhysicalComponent(e, 4, 4, 4, pos);
+				scene->getBoxRigidBodyComponent(e)->layer = run == 0 ? 0 : i % 2;
+				entities.push_back(e);
+			}
+
+			if (run == 2) //a static trigger around the lower half of the pile
+			{
+				Entity trigger = scene->createEntity();
+				glm::vec3 pos(side * 2.5f, 8.0f, side * 2.5f);
+				scene->getTransformComponent(trigger)->setPosition(pos);
+				physics.addBoxPhysicalComponent(trigger, side * 5 + 10, 12, side * 5 + 10, pos);
+				RigidBodyComponent<Box>* body = scene->getBoxRigidBodyComponent(trigger);
+				body->setMass(-1.0f);
+				body->layer = 2;
+			}
+
+			auto start = BenchClock::now();
+			for (int s = 0; s < steps; ++s)
+			{
+				physics.update();
+				physics.notify();
+				numOfPairs[run] += physics.getNumOfBoxPairs();
+			}
+			stepTime[run] = nanosecondsSince(start) / (1000000.0 * steps);
+
+			for (Entity e : entities)
+				positions[run].push_back(scene->getTransformComponent(e)->getPosition());
+			collisions[run] = std::move(recorder.messages);
+			if (run == 2) numOfTriggers = triggers.messages.size();
+
+			//no collision between two boxes of the layer 1 when it is filtered:
+			for (const Message& msg : collisions[run])
+			{
+				const RigidBodyComponent<Box>* first = scene->getBoxRigidBodyComponent(msg.idata[0]);
+				const RigidBodyComponent<Box>* second = scene->getBoxRigidBodyComponent(msg.idata[1]);
+				if (run == 1 && first && second && first->layer == 1 && second->layer == 1) filteredOk = false;
+			}
+		}
+
+		//the trigger is notified, but the boxes move and collide as if it wasn't there:
+		bool triggerOk = numOfTriggers > 0 && positions[2] == positions[0] && sameMessages(collisions[2], collisions[0]);
+
+		std::cout << "  N = " << n;
+		for (int run = 0; run < 3; ++run)
+			std::cout << ", " << runNames[run] << ": " << numOfPairs[run] / steps << " pairs, " << stepTime[run] << " ms/step";
+		std::cout << ", filtered pairs: " << checkResult(filteredOk)
+			<< ", trigger(" << numOfTriggers << " overlaps): " << checkResult(triggerOk) << '\n';
+
+		recordResult("layers_all_colliding_step", n, stepTime[0], "ms/step");
+		recordResult("layers_filtered_step", n, stepTime[1], "ms/step");
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkContactSolver()
+{
+	const int sizes[] = { 10, 100, 1000 };
+	const int height = 8;
+	const int settleSteps = 60; //the stacks should be resting after a second
+	const int steps = 120;
+
+	std::cout << "Contact solver(stacks of " << height << " boxes of 4 units):\n";
+
+	for (int n : sizes)
+	{
+		PhysicsFixture fixture;
+		Scene* scene = fixture.scene;
+		PhysicsEngine& physics = fixture.physics;
+
+		int side = int(std::ceil(std::sqrt(FLOAT_TYPE(n))));
+		fixture.addStaticBox(side * 8 + 10, 20, side * 8 + 10, glm::vec3(side * 4.0f, -10.0f, side * 4.0f));
+
+		//the boxes start a little apart, so each one falls on the one below:
+		std::vector<Entity> boxes;
+		for (int i = 0; i < n; ++i)
+			for (int k = 0; k < height; ++k)
+			{
+				Entity e = scene->createEntity();
+				glm::vec3 pos((i % side) * 8.0f, 2.05f + k * 4.1f, (i / side) * 8.0f);
+				scene->getTransformComponent(e)->setPosition(pos);
+				physics.addBoxPhysicalComponent(e, 4, 4, 4, pos);
+				boxes.push_back(e);
+			}
+
+		for (int s = 0; s < settleSteps; ++s)
+			physics.update();
+
+		//the jitter is the mean distance moved by a box in a step, while they should be resting(or sleeping):
+		double jitter = 0.0, stepTime = 0.0;
+		int awakeSteps = 0, asleepAfter = -1;
+		std::vector<glm::vec3> last(boxes.size());
+		for (size_t b = 0; b < boxes.size(); ++b)
+			last[b] = scene->getBoxRigidBodyComponent(boxes[b])->getPosition();
+		for (int s = 0; s < steps; ++s)
+		{
+			bool awake = physics.getDynamicTree().getNumOfProxies() > 0;
+			auto start = BenchClock::now();
+			physics.update();
+			if (awake) { stepTime += nanosecondsSince(start); ++awakeSteps; }
+			else if (asleepAfter < 0) asleepAfter = settleSteps + s;
+
+			for (size_t b = 0; b < boxes.size(); ++b)
+			{
+				glm::vec3 pos = scene->getBoxRigidBodyComponent(boxes[b])->getPosition();
+				jitter += glm::length(pos - last[b]);
+				last[b] = pos;
+			}
+		}
+		jitter /= double(steps) * boxes.size();
+		stepTime = awakeSteps > 0 ? stepTime / (1000000.0 * awakeSteps) : 0.0;
+
+		//every box must be on the one below it(4 units above the ground for each box under it):
+		FLOAT_TYPE heightError = 0.0f;
+		int fallen = 0;
+		for (int i = 0; i < n; ++i)
+			for (int k = 0; k < height; ++k)
+			{
+				glm::vec3 pos = scene->getBoxRigidBodyComponent(boxes[i * height + k])->getPosition();
+				glm::vec3 expected((i % side) * 8.0f, 2.0f + k * 4.0f, (i / side) * 8.0f);
+				heightError = std::max(heightError, std::fabs(pos.y - expected.y));
+				fallen += glm::length(glm::vec2(pos.x - expected.x, pos.z - expected.z)) > 1.0f || std::fabs(pos.y - expected.y) > 1.0f;
+			}
+
+		std::cout << "  N = " << n << " stacks, " << stepTime << " ms/step(awake)"
+			<< ", jitter: " << jitter << " units/step"
+			<< ", max height error: " << heightError
+			<< ", asleep after " << (asleepAfter >= 0 ? std::to_string(asleepAfter) : std::string("(never)")) << " steps"
+			<< ", standing: " << checkResult(fallen == 0) << " (" << fallen << " boxes out of place)\n";
+
+		recordResult("contact_solver_step", n, stepTime, "ms/step");
+		recordResult("contact_solver_jitter", n, jitter, "units/step");
+	}
+
+	//the materials: two boxes dropped on the ground(one doesn't bounce, the other bounces fully), and two thrown
+	//along it(one without friction, the other with the default friction):
+	PhysicsFixture fixture;
+	Scene* scene = fixture.scene;
+	PhysicsEngine& physics = fixture.physics;
+
+	fixture.addStaticBox(200, 20, 200, glm::vec3(0.0f, -10.0f, 0.0f));
+
+	Entity boxes[4];
+	const glm::vec3 positions[4] = { glm::vec3(-20.0f, 20.0f, 0.0f), glm::vec3(20.0f, 20.0f, 0.0f),
+		glm::vec3(-50.0f, 2.0f, 40.0f), glm::vec3(-50.0f, 2.0f, -40.0f) };
+	for (int b = 0; b < 4; ++b)
+	{
+		boxes[b] = scene->createEntity();
+		scene->getTransformComponent(boxes[b])->setPosition(positions[b]);
+		physics.addBoxPhysicalComponent(boxes[b], 4, 4, 4, positions[b]);
+	}
+	scene->getBoxRigidBodyComponent(boxes[0])->restitution = 0.0f;
+	scene->getBoxRigidBodyComponent(boxes[1])->restitution = 1.0f;
+	scene->getBoxRigidBodyComponent(boxes[2])->friction = 0.0f;
+	for (int b = 2; b < 4; ++b)
+		scene->getBoxRigidBodyComponent(boxes[b])->addLinearVelocity(glm::vec3(1.0f, 0.0f, 0.0f));
+
+	FLOAT_TYPE reboundHeights[2] = { 0.0f, 0.0f }; //the highest each dropped box went after touching the ground
+	bool landed[2] = { false, false };
+	for (int s = 0; s < 120; ++s)
+	{
+		physics.update();
+		for (int b = 0; b < 2; ++b)
+		{
+			FLOAT_TYPE y = scene->getBoxRigidBodyComponent(boxes[b])->getPosition().y;
+			if (y < 2.5f) landed[b] = true;
+			else if (landed[b]) reboundHeights[b] = std::max(reboundHeights[b], y - 2.0f);
+		}
+	}
+	FLOAT_TYPE slid = scene->getBoxRigidBodyComponent(boxes[2])->getPosition().x - positions[2].x;
+	FLOAT_TYPE stopped = scene->getBoxRigidBodyComponent(boxes[3])->getPosition().x - positions[3].x;
+	bool materials = landed[0] && landed[1] && reboundHeights[0] < 0.5f && reboundHeights[1] > 2.0f && slid > 2.0f * stopped;
+
+	std::cout << "  materials: rebound(restitution 0): " << reboundHeights[0] << ", rebound(restitution 1): " << reboundHeights[1]
+		<< ", slid(friction 0): " << slid << ", slid(friction " << PHYSICS_FRICTION << "): " << stopped
+		<< ", " << checkResult(materials) << '\n';
+}
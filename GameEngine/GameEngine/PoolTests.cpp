@@ -0,0 +1,200 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <random>
+#include <vector>
+
+#include "ObjectPool.h"
+#include "ComponentPool.h"
+#include "Entity.h"
+#include "BenchmarkHelpers.h"
+
+
+void benchmarkObjectPool()
+{
+	const int sizes[] = { 50, 500, 5000, 50000, 100000 };
+	std::default_random_engine generator(42);
+
+	std::cout << "ObjectPool<TransformComponent>:\n";
+
+	for (int n : sizes)
+	{
+		ObjectPool<TransformComponent> pool(50, TransformComponent());
+		std::vector<PoolHandle> handles;
+		handles.reserve(n);
+
+		for (int i = 0; i < n; ++i)
+			handles.push_back(pool.insert(TransformComponent(i)));
+
+		//--------------------------------------
+		//iteration(the same loop used by the game systems):
+		int rounds = 2000000 / n + 1;
+		FLOAT_TYPE sum = 0.0f;
+		auto start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			for (int i = 0; i < pool.getSize(); ++i)
+				sum += pool[i].getPosition().x + FLOAT_TYPE(pool[i].getEntityId());
+		double iterationCost = nanosecondsSince(start) / (double(rounds) * n);
+		benchmarkSink = sum;
+
+		//--------------------------------------
+		//insert and erase of random elements:
+		const int operations = 20000;
+		std::uniform_int_distribution<int> randomIndex(0, n - 1);
+		start = BenchClock::now();
+		for (int i = 0; i < operations; ++i)
+		{
+			pool.erase(randomIndex(generator));
+			pool.push_back(TransformComponent(i));
+		}
+		double insertEraseCost = nanosecondsSince(start) / operations;
+
+		//--------------------------------------
+		//random access through handles(the handles erased above are just skipped):
+		sum = 0.0f;
+		start = BenchClock::now();
+		for (int i = 0; i < operations; ++i)
+		{
+			const TransformComponent* t = pool.get(handles[randomIndex(generator)]);
+			if (t) sum += FLOAT_TYPE(t->getEntityId());
+		}
+		double handleCost = nanosecondsSince(start) / operations;
+		benchmarkSink = sum;
+
+		std::cout << "  N = " << n
+			<< ", iterate: " << iterationCost << " ns/elem"
+			<< ", erase + push_back: " << insertEraseCost << " ns/op"
+			<< ", get(handle): " << handleCost << " ns/op\n";
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkComponentPool()
+{
+	const int sizes[] = { 50, 500, 5000, 50000, 100000 };
+	std::default_random_engine generator(42);
+
+	std::cout << "ComponentPool<TransformComponent>:\n";
+
+	for (int n : sizes)
+	{
+		ComponentPool<TransformComponent> pool(n, TransformComponent());
+		for (int i = 0; i < n; ++i)
+			pool.push_back(TransformComponent(i));
+
+		std::uniform_int_distribution<int> randomEntity(0, n - 1);
+
+		//--------------------------------------
+		//lookup through the sparse set:
+		const int operations = 20000;
+		FLOAT_TYPE sum = 0.0f;
+		auto start = BenchClock::now();
+		for (int i = 0; i < operations; ++i)
+			sum += pool.getByEntity(randomEntity(generator))->getPosition().x;
+		double sparseCost = nanosecondsSince(start) / operations;
+		benchmarkSink = sum;
+
+		//--------------------------------------
+		//lookup through a linear scan(how the Scene used to find components):
+		const int scanOperations = n > 5000 ? 200 : 2000;
+		sum = 0.0f;
+		start = BenchClock::now();
+		for (int i = 0; i < scanOperations; ++i)
+		{
+			Entity id = randomEntity(generator);
+			for (int j = 0; j < pool.getSize(); ++j)
+				if (pool[j].getEntityId() == id) { sum += pool[j].getPosition().x; break; }
+		}
+		double scanCost = nanosecondsSince(start) / scanOperations;
+		benchmarkSink = sum;
+
+		//--------------------------------------
+		//remove and add back the component of random entities:
+		start = BenchClock::now();
+		for (int i = 0; i < operations; ++i)
+		{
+			Entity id = randomEntity(generator);
+			pool.eraseEntity(id);
+			pool.push_back(TransformComponent(id));
+		}
+		double eraseCost = nanosecondsSince(start) / operations;
+
+		std::cout << "  N = " << n
+			<< ", getByEntity: " << sparseCost << " ns/op"
+			<< ", linear scan: " << scanCost << " ns/op"
+			<< ", eraseEntity + push_back: " << eraseCost << " ns/op\n";
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkEntityAllocator()
+{
+	const int sizes[] = { 50, 500, 5000, 50000, 100000 };
+	std::default_random_engine generator(42);
+
+	std::cout << "EntityAllocator:\n";
+
+	for (int n : sizes)
+	{
+		EntityAllocator allocator;
+		std::vector<Entity> alive;
+		alive.reserve(n);
+		for (int i = 0; i < n; ++i)
+			alive.push_back(allocator.create());
+
+		//--------------------------------------
+		//delete a random entity and spawn a new one:
+		const int operations = 200000;
+		std::uniform_int_distribution<int> randomEntity(0, n - 1);
+		std::vector<Entity> stale;
+		stale.reserve(operations);
+		auto start = BenchClock::now();
+		for (int i = 0; i < operations; ++i)
+		{
+			int j = randomEntity(generator);
+			stale.push_back(alive[j]);
+			allocator.destroy(alive[j]);
+			alive[j] = allocator.create();
+		}
+		double churnCost = nanosecondsSince(start) / operations;
+
+		//--------------------------------------
+		//validation of alive and stale handles:
+		int aliveCount = 0;
+		start = BenchClock::now();
+		for (int i = 0; i < operations; ++i)
+			aliveCount += int(allocator.isAlive(alive[i % n])) + int(allocator.isAlive(stale[i]));
+		double validationCost = nanosecondsSince(start) / (2.0 * operations);
+		benchmarkSink = FLOAT_TYPE(aliveCount);
+
+		std::cout << "  N = " << n
+			<< ", destroy + create: " << churnCost << " ns/op"
+			<< ", isAlive: " << validationCost << " ns/op\n";
+	}
+}
@@ -0,0 +1,305 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+
+
+static thread_local int zoneDepth = 0; //the number of open zones of the current thread
+static thread_local const char* currentThreadName = nullptr;
+
+
+//Profiler definitions:
+
+
+Profiler::Profiler()
+	:epoch{ std::chrono::steady_clock::now() }
+{
+	for (std::atomic<ThreadBuffer*>& buffer : buffers)
+		buffer.store(nullptr, std::memory_order_relaxed);
+}
+
+
+//=================================================
+
+
+void Profiler::setEnabled(bool value) noexcept
+{
+	enabled.store(value, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() const noexcept
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const char* name) noexcept
+{
+	currentThreadName = name; //it's given to the buffer when the thread records its first zone
+}
+
+
+//=================================================
+
+
+int64_t Profiler::now() const noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+
+//=================================================
+
+
+void Profiler::record(const char* name, int64_t begin, int64_t end, int depth)
+{
+	ThreadBuffer* buffer = getThreadBuffer();
+	if (!buffer) return;
+
+	//only this thread writes to the buffer, the readers use written to know which events are complete:
+	uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	buffer->events[index % PROFILER_EVENTS_PER_THREAD] = { name, begin, end, depth };
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+
+//=================================================
+
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer()
+{
+	static thread_local ThreadBuffer* threadBuffer = nullptr;
+	static thread_local bool unprofiled = false; //there were already PROFILER_MAX_THREADS buffers
+	if (threadBuffer || unprofiled) return threadBuffer;
+
+	int index = numOfBuffers.fetch_add(1);
+	if (index >= PROFILER_MAX_THREADS)
+	{
+		std::cout << "!WARNING: too many threads to profile, the zones of this one are not recorded;\n";
+		unprofiled = true;
+		return nullptr;
+	}
+
+	threadBuffer = new ThreadBuffer();
+	threadBuffer->threadName = currentThreadName;
+	buffers[index].store(threadBuffer, std::memory_order_release);
+	return threadBuffer;
+}
+
+
+//=================================================
+
+
+void Profiler::collect(std::vector<std::vector<Event>>& threadEvents) const
+{
+	int n = std::min(numOfBuffers.load(), PROFILER_MAX_THREADS);
+	threadEvents.assign(n, std::vector<Event>());
+
+	for (int i = 0; i < n; ++i)
+	{
+		const ThreadBuffer* buffer = buffers[i].load(std::memory_order_acquire);
+		if (!buffer) continue; //its thread is still creating it
+
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t first = buffer->readFrom.load(std::memory_order_relaxed);
+		if (written - first > PROFILER_EVENTS_PER_THREAD) first = written - PROFILER_EVENTS_PER_THREAD;
+
+		std::vector<Event>& events = threadEvents[i];
+		for (uint64_t e = first; e < written; ++e)
+			events.push_back(buffer->events[e % PROFILER_EVENTS_PER_THREAD]);
+
+		//the thread may have kept recording while the events were copied, so the oldest ones could have been
+		//overwritten(they are discarded):
+		uint64_t writtenAfter = buffer->written.load(std::memory_order_acquire);
+		if (writtenAfter - first > PROFILER_EVENTS_PER_THREAD)
+		{
+			uint64_t overwritten = writtenAfter - first - PROFILER_EVENTS_PER_THREAD;
+			if (overwritten > events.size()) overwritten = events.size();
+			events.erase(events.begin(), events.begin() + overwritten);
+		}
+	}
+}
+
+
+//=================================================
+
+
+std::vector<Profiler::ZoneStats> Profiler::getStats() const
+{
+	std::vector<std::vector<Event>> threadEvents;
+	collect(threadEvents);
+
+	//group the durations by name(the same literal can have different addresses in different files):
+	std::unordered_map<std::string, std::vector<double>> durations;
+	for (const std::vector<Event>& events : threadEvents)
+		for (const Event& event : events)
+			durations[event.name].push_back(double(event.end - event.begin) / 1000.0);
+
+	std::vector<ZoneStats> stats;
+	for (auto& zone : durations)
+	{
+		std::vector<double>& times = zone.second;
+		std::sort(times.begin(), times.end());
+
+		ZoneStats zoneStats;
+		zoneStats.name = zone.first;
+		zoneStats.count = int(times.size());
+		zoneStats.min = times.front();
+		zoneStats.max = times.back();
+		zoneStats.total = 0.0;
+		for (double time : times) zoneStats.total += time;
+		zoneStats.average = zoneStats.total / times.size();
+		int p99 = int(std::ceil(0.99 * times.size())) - 1; //nearest rank
+		zoneStats.p99 = times[p99 > 0 ? p99 : 0];
+		stats.push_back(zoneStats);
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.total > b.total; });
+	return stats;
+}
+
+
+//=================================================
+
+
+void Profiler::printStats(std::ostream& out) const
+{
+	std::vector<ZoneStats> stats = getStats();
+
+	out << "Profiler zones(in microseconds):\n";
+	char line[256];
+	std::snprintf(line, sizeof(line), "  %-40s %8s %10s %10s %10s %10s\n", "zone", "count", "min", "avg", "p99", "max");
+	out << line;
+	for (const ZoneStats& zone : stats)
+	{
+		std::snprintf(line, sizeof(line), "  %-40s %8d %10.1f %10.1f %10.1f %10.1f\n", zone.name.c_str(), zone.count,
+			zone.min, zone.average, zone.p99, zone.max);
+		out << line;
+	}
+}
+
+
+//=================================================
+
+
+void Profiler::clear()
+{
+	int n = std::min(numOfBuffers.load(), PROFILER_MAX_THREADS);
+	for (int i = 0; i < n; ++i)
+	{
+		ThreadBuffer* buffer = buffers[i].load(std::memory_order_acquire);
+		if (buffer) buffer->readFrom.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+
+//=================================================
+
+
+static void writeJsonString(std::ofstream& file, const char* text)
+{
+	file << '"';
+	for (const char* c = text; *c; ++c)
+	{
+		if (*c == '"' || *c == '\\') file << '\\';
+		file << *c;
+	}
+	file << '"';
+}
+
+
+bool Profiler::exportChromeTrace(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "!WARNING: couldn't create the trace file " << path << ";\n";
+		return false;
+	}
+
+	std::vector<std::vector<Event>> threadEvents;
+	collect(threadEvents);
+
+	//complete("X") events, with the times in microseconds. The viewer nests them by their times:
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	char number[64];
+	for (int thread = 0; thread < int(threadEvents.size()); ++thread)
+	{
+		const ThreadBuffer* buffer = buffers[thread].load(std::memory_order_acquire);
+		if (buffer && buffer->threadName)
+		{
+			file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread
+				<< ",\"args\":{\"name\":";
+			writeJsonString(file, buffer->threadName);
+			file << "}}";
+			first = false;
+		}
+
+		for (const Event& event : threadEvents[thread])
+		{
+			file << (first ? "" : ",\n") << "{\"name\":";
+			writeJsonString(file, event.name);
+			std::snprintf(number, sizeof(number), "%.3f", double(event.begin) / 1000.0);
+			file << ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread << ",\"ts\":" << number;
+			std::snprintf(number, sizeof(number), "%.3f", double(event.end - event.begin) / 1000.0);
+			file << ",\"dur\":" << number << ",\"args\":{\"depth\":" << event.depth << "}}";
+			first = false;
+		}
+	}
+	file << "\n]}\n";
+
+	return bool(file);
+}
+
+
+//##################################################
+//ProfileZone definitions:
+
+
+ProfileZone::ProfileZone(const char* n) noexcept
+	:name{ nullptr }
+{
+	Profiler& profiler = Profiler::instance();
+	if (!profiler.isEnabled()) return;
+
+	name = n;
+	depth = zoneDepth++;
+	begin = profiler.now();
+}
+
+
+//=================================================
+
+
+ProfileZone::~ProfileZone()
+{
+	if (!name) return;
+
+	--zoneDepth;
+	Profiler& profiler = Profiler::instance();
+	profiler.record(name, begin, profiler.now(), depth);
+}
@@ -0,0 +1,165 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the Profiler class, the frame profiler
+used by all the game systems, and the ProfileZone class, used through the PROFILE_ZONE macro.
+	A zone measures the time between its construction and the end of its scope:
+
+		void PhysicsEngine::update()
+		{
+			PROFILE_ZONE("PhysicsEngine::update");
+			...
+		}
+
+	Each thread records its zones in its own ring buffer(only the last PROFILER_EVENTS_PER_THREAD zones
+are kept), so recording takes no lock and threads never wait for each other. The zones of a thread are
+nested by their scopes, and each one keeps its depth, so the hierarchy of a frame can be rebuilt from
+the events(and it's shown by the Chrome trace viewer).
+	The buffers can be read at any moment: getStats() computes the min, average, p99 and max duration of
+each zone, and exportChromeTrace() writes the events in the Chrome trace_event format(open it in
+chrome://tracing or ui.perfetto.dev). The profiler is disabled by default, and until setEnabled(true) is
+called(the game does it with the "-profile" argument) the zones only check a flag.
+*/
+//#################################################################################
+
+#ifndef PROFILER
+#define PROFILER
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "GlobalDefines.h"
+
+
+#define PROFILER_EVENTS_PER_THREAD 65536 //size of each thread's ring buffer(a power of 2)
+#define PROFILER_MAX_THREADS 64 //threads after this one are not profiled
+
+
+//##################################################
+//Profiler class declaration:
+
+
+class Profiler
+{
+public:
+
+	struct Event //one finished zone
+	{
+		const char* name; //the zone names must be string literals(only the pointer is stored)
+		int64_t begin; //in nanoseconds, since the profiler creation
+		int64_t end;
+		int depth; //the number of zones of the same thread that contain this one
+	};
+
+	struct ZoneStats
+	{
+		std::string name;
+		int count;
+		double min; //in microseconds
+		double average;
+		double p99;
+		double max;
+		double total;
+	};
+
+	static Profiler& instance()
+	{
+		static Profiler profilerInstance;
+		return profilerInstance;
+	}
+
+	void setEnabled(bool) noexcept;
+	bool isEnabled() const noexcept;
+	void setThreadName(const char*) noexcept; //the name of the calling thread in the trace(a string literal)
+
+	int64_t now() const noexcept; //nanoseconds since the profiler creation
+	void record(const char* name, int64_t begin, int64_t end, int depth); //lock free, called by ProfileZone
+
+	/*
+		getStats - compute the statistics of each zone(by name) over the events in the buffers, sorted by
+		the total time. clear() discards the events recorded until now
+	*/
+	std::vector<ZoneStats> getStats() const;
+	void printStats(std::ostream&) const;
+	void clear();
+
+	/*
+		exportChromeTrace - write the events in the buffers to a JSON file, in the Chrome trace_event format.
+		Returns false if the file couldn't be created
+	*/
+	bool exportChromeTrace(const std::string& path) const;
+
+private:
+
+	Profiler(); //this class is a singleton
+	Profiler(const Profiler&) = delete;
+
+	struct ThreadBuffer
+	{
+		Event events[PROFILER_EVENTS_PER_THREAD];
+		std::atomic<uint64_t> written{ 0 }; //the number of events ever written(the next slot is written % size)
+		std::atomic<uint64_t> readFrom{ 0 }; //the events before this one were discarded by clear()
+		const char* threadName = nullptr;
+	};
+
+	ThreadBuffer* getThreadBuffer(); //the buffer of the calling thread(created by its first zone)
+	void collect(std::vector<std::vector<Event>>&) const; //copy the events of each thread(in the order they ended)
+
+	std::atomic<bool> enabled{ false };
+	std::chrono::steady_clock::time_point epoch;
+
+	std::atomic<ThreadBuffer*> buffers[PROFILER_MAX_THREADS]; //never freed(worker threads may record zones until the program ends)
+	std::atomic<int> numOfBuffers{ 0 };
+};
+
+
+//##################################################
+//ProfileZone class declaration:
+
+
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name) noexcept;
+	~ProfileZone();
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* name; //nullptr if the profiler was disabled when the zone began
+	int64_t begin = 0;
+	int depth = 0;
+};
+
+
+#define PROFILE_ZONE_CONCAT_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_INNER(a, b)
+
+//measure the rest of the current scope:
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
+
+
+#endif // !PROFILER
@@ -0,0 +1,75 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <cmath>
+
+#include "Profiler.h"
+#include "JobSystem.h"
+#include "BenchmarkHelpers.h"
+
+
+void benchmarkProfiler()
+{
+	std::cout << "Profiler:\n";
+	Profiler& profiler = Profiler::instance();
+	bool wasEnabled = profiler.isEnabled();
+
+	//the cost of a zone:
+	const int numOfZones = 1000000;
+	double zoneCost[2];
+	for (int enabled = 0; enabled < 2; ++enabled)
+	{
+		profiler.setEnabled(enabled == 1);
+		auto start = BenchClock::now();
+		for (int i = 0; i < numOfZones; ++i)
+		{
+			PROFILE_ZONE("benchmark zone");
+			benchmarkSink = benchmarkSink + 1.0f;
+		}
+		zoneCost[enabled] = nanosecondsSince(start) / numOfZones;
+	}
+	std::cout << "  zone cost, disabled: " << zoneCost[0] << " ns, enabled: " << zoneCost[1] << " ns\n";
+
+	//nested zones from several threads:
+	profiler.clear();
+	profiler.setEnabled(true);
+	JobCounter counter;
+	for (int job = 0; job < 8; ++job)
+		JobSystem::instance().run([]() {
+			PROFILE_ZONE("benchmark job");
+			for (int i = 0; i < 100; ++i)
+			{
+				PROFILE_ZONE("benchmark inner zone");
+				FLOAT_TYPE sum = 0.0f;
+				for (int j = 0; j < 1000; ++j) sum += std::sqrt(FLOAT_TYPE(j));
+				benchmarkSink = sum;
+			}
+		}, &counter);
+	JobSystem::instance().wait(counter);
+
+	profiler.printStats(std::cout);
+	std::cout << "  trace export: " << checkResult(profiler.exportChromeTrace("benchmark_trace.json")) << '\n';
+
+	profiler.clear();
+	profiler.setEnabled(wasEnabled);
+}
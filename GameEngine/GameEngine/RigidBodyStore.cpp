@@ -0,0 +1,157 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "RigidBodyStore.h"
+
+#include <cmath>
+
+#include "MathKernels.h" //defines ENGINE_SSE, and includes the intrinsics
+
+
+//RigidBodyStore definitions:
+
+
+void RigidBodyStore::setNumOfBodies(int n)
+{
+	numOfBodies = n;
+	int numOfBlocks = (n + RIGID_BODY_STORE_BLOCK_SIZE - 1) / RIGID_BODY_STORE_BLOCK_SIZE;
+	if (numOfBlocks > int(blocks.size())) blocks.resize(numOfBlocks, Block{});
+}
+
+int RigidBodyStore::getNumOfBodies() const noexcept
+{
+	return numOfBodies;
+}
+
+
+//=================================================
+
+
+void RigidBodyStore::integrate(FLOAT_TYPE timeStep) noexcept
+{
+	integrateVelocities(timeStep);
+	integratePositions();
+}
+
+
+//=================================================
+
+
+void RigidBodyStore::integrateVelocities(FLOAT_TYPE timeStep) noexcept
+{
+	const float dt = float(timeStep);
+	const float gravityStep = RIGID_BODY_STORE_GRAVITY * dt;
+	int numOfBlocks = (numOfBodies + RIGID_BODY_STORE_BLOCK_SIZE - 1) / RIGID_BODY_STORE_BLOCK_SIZE;
+
+#if defined(ENGINE_SSE)
+	//the lanes after the last body hold old values, they are integrated too but never read:
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (int b = 0; b < numOfBlocks; ++b)
+	{
+		float* values = blocks[b].values;
+		for (int lane = 0; lane < RIGID_BODY_STORE_BLOCK_SIZE; lane += 4)
+		{
+			auto field = [values, lane](int f) { return values + f * RIGID_BODY_STORE_BLOCK_SIZE + lane; };
+
+			__m128 forceScale = _mm_mul_ps(_mm_set1_ps(dt), _mm_load_ps(field(INVERSE_MASS)));
+			__m128 pulled = _mm_cmpeq_ps(_mm_load_ps(field(GRAVITY)), one);
+			for (int k = 0; k < 3; ++k)
+			{
+				__m128 velocity = _mm_add_ps(_mm_load_ps(field(VELOCITY + k)), _mm_mul_ps(_mm_load_ps(field(FORCES + k)), forceScale));
+				if (k == 1) //the gravity(selected, so the bodies without it keep their velocity bit by bit)
+				{
+					__m128 pulledVelocity = _mm_add_ps(velocity, _mm_set1_ps(gravityStep));
+					velocity = _mm_or_ps(_mm_and_ps(pulled, pulledVelocity), _mm_andnot_ps(pulled, velocity));
+				}
+				_mm_store_ps(field(VELOCITY + k), velocity);
+			}
+		}
+	}
+#else
+	for (int body = 0; body < numOfBodies; ++body)
+	{
+		float* values = getValues(body);
+		auto field = [values](int f) -> float& { return values[f * RIGID_BODY_STORE_BLOCK_SIZE]; };
+
+		float forceScale = dt * field(INVERSE_MASS);
+		for (int k = 0; k < 3; ++k)
+		{
+			field(VELOCITY + k) += field(FORCES + k) * forceScale;
+			if (k == 1 && field(GRAVITY) == 1.0f) field(VELOCITY + k) += gravityStep;
+		}
+	}
+#endif
+}
+
+
+//=================================================
+
+
+void RigidBodyStore::integratePositions() noexcept
+{
+	const float restVelocities[3] = { RIGID_BODY_STORE_REST_VELOCITY_XZ, RIGID_BODY_STORE_REST_VELOCITY_Y,
+		RIGID_BODY_STORE_REST_VELOCITY_XZ };
+	int numOfBlocks = (numOfBodies + RIGID_BODY_STORE_BLOCK_SIZE - 1) / RIGID_BODY_STORE_BLOCK_SIZE;
+
+#if defined(ENGINE_SSE)
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	for (int b = 0; b < numOfBlocks; ++b)
+	{
+		float* values = blocks[b].values;
+		for (int lane = 0; lane < RIGID_BODY_STORE_BLOCK_SIZE; lane += 4)
+		{
+			auto field = [values, lane](int f) { return values + f * RIGID_BODY_STORE_BLOCK_SIZE + lane; };
+
+			__m128 fast = _mm_cmpeq_ps(_mm_load_ps(field(FAST)), one);
+			for (int k = 0; k < 3; ++k)
+			{
+				__m128 velocity = _mm_load_ps(field(VELOCITY + k));
+				_mm_store_ps(field(STEP + k), velocity);
+
+				__m128 position = _mm_load_ps(field(POSITION + k));
+				__m128 moved = _mm_add_ps(position, velocity);
+				_mm_store_ps(field(POSITION + k), _mm_or_ps(_mm_and_ps(fast, position), _mm_andnot_ps(fast, moved)));
+
+				velocity = _mm_mul_ps(velocity, _mm_set1_ps(RIGID_BODY_STORE_DRAG));
+				__m128 resting = _mm_cmple_ps(_mm_andnot_ps(signBit, velocity), _mm_set1_ps(restVelocities[k]));
+				_mm_store_ps(field(VELOCITY + k), _mm_andnot_ps(resting, velocity));
+			}
+		}
+	}
+#else
+	for (int body = 0; body < numOfBodies; ++body)
+	{
+		float* values = getValues(body);
+		auto field = [values](int f) -> float& { return values[f * RIGID_BODY_STORE_BLOCK_SIZE]; };
+
+		for (int k = 0; k < 3; ++k)
+		{
+			float velocity = field(VELOCITY + k);
+			field(STEP + k) = velocity;
+			if (field(FAST) != 1.0f) field(POSITION + k) += velocity;
+
+			velocity *= RIGID_BODY_STORE_DRAG;
+			field(VELOCITY + k) = std::fabs(velocity) <= restVelocities[k] ? 0.0f : velocity;
+		}
+	}
+#endif
+}
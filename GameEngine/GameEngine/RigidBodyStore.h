@@ -0,0 +1,175 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the RigidBodyStore class, the data of the box
+rigid bodies integrated in a step of the PhysicsEngine, in SoA layout.
+	The RigidBodyComponents interleave the shape, its vertices, the inertia tensor, the forces and the flags
+of each body, so integrating them one at a time touches a lot of memory that isn't used. The store keeps
+only what the integration needs(positions, velocities, forces, inverse masses and flags), in blocks of
+RIGID_BODY_STORE_BLOCK_SIZE bodies(an array with that value of each body of the block, for each value, like
+the blocks of the NarrowPhase), and integrate() updates 4 bodies at a time with SSE: the forces, the
+gravity, the drag and the clamping of the small velocities, without a branch.
+	The components are still the data the rest of the engine uses(the gameplay code, the collision
+response and the SceneSerializer change them), so the PhysicsEngine copies the bodies it integrates into
+the store, and the results back to the components, in two passes over them.
+*/
+//#################################################################################
+
+#ifndef RIGID_BODY_STORE
+#define RIGID_BODY_STORE
+
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "GlobalDefines.h"
+
+
+#define RIGID_BODY_STORE_BLOCK_SIZE 8 //bodies in each block of values(a multiple of the number of SIMD lanes)
+#define RIGID_BODY_STORE_GRAVITY -10.0f //the acceleration of the bodies with mass > 0(units per second per step)
+#define RIGID_BODY_STORE_DRAG 0.90f //the(fake) air resistance: the velocity is multiplied by this in each step
+#define RIGID_BODY_STORE_REST_VELOCITY_XZ 0.025f //the x and z velocities up to this are set to 0
+#define RIGID_BODY_STORE_REST_VELOCITY_Y 0.04f //the same for the y velocity
+
+
+class RigidBodyStore
+{
+public:
+
+	void setNumOfBodies(int); //the bodies that aren't set after this hold old values
+	int getNumOfBodies() const noexcept;
+
+	/*
+		setBody - copy the data of a body. A body with mass <= 0 isn't pulled by the gravity, and its forces
+		are applied as if it had a mass of 1. The position of a fast body isn't changed by integrate()(see
+		PhysicsEngine::sweepBox(), it is moved by the PhysicsEngine)
+	*/
+	void setBody(int, const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& forces, FLOAT_TYPE mass,
+		bool fast) noexcept;
+
+	/*
+		integrate - integrate all the bodies by one step. It's done in two parts, so that the velocities can be
+		changed between them(by the contact solver of the PhysicsEngine): integrateVelocities() applies the forces
+		and the gravity, and integratePositions() moves the bodies, then applies the drag and the clamping
+	*/
+	void integrate(FLOAT_TYPE timeStep) noexcept;
+	void integrateVelocities(FLOAT_TYPE timeStep) noexcept;
+	void integratePositions() noexcept;
+
+	//the results:
+	glm::vec3 getPosition(int) const noexcept;
+	glm::vec3 getVelocity(int) const noexcept; //after the drag, once the positions are integrated
+	void setVelocity(int, const glm::vec3&) noexcept;
+	glm::vec3 getStep(int) const noexcept; //the displacement of the body in this step(the velocity before the drag)
+
+private:
+
+	//the values of each body(each is an array of floats):
+	enum Field
+	{
+		POSITION = 0, //x, y and z
+		VELOCITY = 3,
+		FORCES = 6,
+		STEP = 9,
+		INVERSE_MASS = 12,
+		GRAVITY = 13, //1 for the bodies pulled by the gravity, 0 for the others
+		FAST = 14, //1 for the fast bodies, 0 for the others
+		NUM_OF_FIELDS = 15
+	};
+
+	struct alignas(32) Block //the SIMD loads and stores are aligned
+	{
+		float values[NUM_OF_FIELDS * RIGID_BODY_STORE_BLOCK_SIZE]; //NUM_OF_FIELDS arrays of RIGID_BODY_STORE_BLOCK_SIZE floats
+	};
+
+	float* getValues(int body) noexcept; //the first value of a body(the values of a field are RIGID_BODY_STORE_BLOCK_SIZE apart)
+	const float* getValues(int body) const noexcept;
+	glm::vec3 getVec3(int body, Field) const noexcept;
+
+	std::vector<Block> blocks; //never shrinks
+	int numOfBodies = 0;
+};
+
+
+//the accessors are inline, they are called for each body in the copies to the store and back:
+
+inline void RigidBodyStore::setBody(int body, const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& forces,
+	FLOAT_TYPE mass, bool fast) noexcept
+{
+	myAssert(body >= 0 && body < numOfBodies);
+
+	float* values = getValues(body);
+	for (int k = 0; k < 3; ++k)
+	{
+		values[(POSITION + k) * RIGID_BODY_STORE_BLOCK_SIZE] = position[k];
+		values[(VELOCITY + k) * RIGID_BODY_STORE_BLOCK_SIZE] = velocity[k];
+		values[(FORCES + k) * RIGID_BODY_STORE_BLOCK_SIZE] = forces[k];
+	}
+	values[INVERSE_MASS * RIGID_BODY_STORE_BLOCK_SIZE] = mass > 0.0f ? float(1.0f / mass) : 1.0f;
+	values[GRAVITY * RIGID_BODY_STORE_BLOCK_SIZE] = mass > 0.0f ? 1.0f : 0.0f;
+	values[FAST * RIGID_BODY_STORE_BLOCK_SIZE] = fast ? 1.0f : 0.0f;
+}
+
+inline glm::vec3 RigidBodyStore::getPosition(int body) const noexcept
+{
+	return getVec3(body, POSITION);
+}
+
+inline glm::vec3 RigidBodyStore::getVelocity(int body) const noexcept
+{
+	return getVec3(body, VELOCITY);
+}
+
+inline void RigidBodyStore::setVelocity(int body, const glm::vec3& velocity) noexcept
+{
+	myAssert(body >= 0 && body < numOfBodies);
+
+	float* values = getValues(body);
+	for (int k = 0; k < 3; ++k)
+		values[(VELOCITY + k) * RIGID_BODY_STORE_BLOCK_SIZE] = velocity[k];
+}
+
+inline glm::vec3 RigidBodyStore::getStep(int body) const noexcept
+{
+	return getVec3(body, STEP);
+}
+
+inline float* RigidBodyStore::getValues(int body) noexcept
+{
+	return blocks[body / RIGID_BODY_STORE_BLOCK_SIZE].values + body % RIGID_BODY_STORE_BLOCK_SIZE;
+}
+
+inline const float* RigidBodyStore::getValues(int body) const noexcept
+{
+	return blocks[body / RIGID_BODY_STORE_BLOCK_SIZE].values + body % RIGID_BODY_STORE_BLOCK_SIZE;
+}
+
+inline glm::vec3 RigidBodyStore::getVec3(int body, Field field) const noexcept
+{
+	myAssert(body >= 0 && body < numOfBodies);
+
+	const float* values = getValues(body);
+	return glm::vec3(values[field * RIGID_BODY_STORE_BLOCK_SIZE], values[(field + 1) * RIGID_BODY_STORE_BLOCK_SIZE],
+		values[(field + 2) * RIGID_BODY_STORE_BLOCK_SIZE]);
+}
+
+
+#endif // !RIGID_BODY_STORE
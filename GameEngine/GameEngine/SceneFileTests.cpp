@@ -0,0 +1,203 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "World.h"
+#include "SceneSerializer.h"
+#include "BenchmarkHelpers.h"
+
+
+static bool sameTransform(const TransformComponent& a, const TransformComponent& b) noexcept
+{
+	const FLOAT_TYPE epsilon = 0.00001f;
+	glm::vec3 dp = a.getPosition() - b.getPosition();
+	glm::vec3 ds = a.getScale() - b.getScale();
+	glm::quat dq = a.getOrientation() - b.getOrientation();
+	glm::mat4 ta = a.getTransform(), tb = b.getTransform();
+
+	bool same = glm::dot(dp, dp) < epsilon && glm::dot(ds, ds) < epsilon && glm::dot(dq, dq) < epsilon
+		&& a.isActived() == b.isActived();
+	for (int c = 0; c < 4; ++c)
+		for (int r = 0; r < 4; ++r)
+			same = same && glm::abs(ta[c][r] - tb[c][r]) < epsilon;
+	return same;
+}
+
+
+//=============================================================================================
+
+
+void benchmarkSceneFile()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const int chainLenght = 8;
+	const std::string path = "benchmarkScene.scene";
+	std::default_random_engine generator(42);
+	std::uniform_real_distribution<float> randomFloat(-100.0f, 100.0f);
+
+	std::cout << "SceneSerializer(chains of " << chainLenght << " objects):\n";
+
+	for (int n : sizes)
+	{
+		//build the scene(one in every 16 entities is deleted, so the saved ids have gaps and generations):
+		Scene scene(0);
+		scene.transformComponents.reserve(n);
+		std::vector<Entity> deleted;
+		for (int i = 0; i < n; ++i)
+		{
+			Entity id = scene.createEntity();
+			TransformComponent* comp = scene.getTransformComponent(id);
+			comp->setPosition(glm::vec3(randomFloat(generator), randomFloat(generator), randomFloat(generator)));
+			comp->rotate(randomFloat(generator), glm::vec3(0.0f, 1.0f, 0.0f));
+			comp->setScale(glm::vec3(1.0f + i % 3));
+			if (i % chainLenght != 0) comp->setParent(id - 1);
+			if (i % 7 == 0) comp->disable();
+			if (i % 16 == 5) deleted.push_back(id);
+		}
+		for (Entity id : deleted)
+			scene.deleteEntity(id);
+
+		std::vector<Entity> savedEntities;
+		scene.getEntities(savedEntities);
+
+		//--------------------------------------
+		//save and load:
+		auto start = BenchClock::now();
+		SceneSerializer::save(path, scene);
+		double saveTime = nanosecondsSince(start) / 1000000.0;
+
+		Scene loadedScene(1);
+		std::vector<Entity> loadedEntities;
+		start = BenchClock::now();
+		SceneSerializer::load(path, loadedScene, &loadedEntities);
+		double loadTime = nanosecondsSince(start) / 1000000.0;
+
+		std::remove(path.c_str());
+
+		//--------------------------------------
+		//round trip test(the entities are loaded in the order they were saved):
+		std::vector<int> savedPosition(n, -1); //the position of each saved entity in savedEntities
+		for (size_t i = 0; i < savedEntities.size(); ++i)
+			savedPosition[entityIndex(savedEntities[i])] = int(i);
+
+		bool ok = loadedEntities.size() == savedEntities.size()
+			&& loadedScene.getNumOfEntities() == scene.getNumOfEntities();
+		for (size_t i = 0; ok && i < savedEntities.size(); ++i)
+		{
+			const TransformComponent* saved = scene.getTransformComponent(savedEntities[i]);
+			const TransformComponent* loaded = loadedScene.getTransformComponent(loadedEntities[i]);
+			ok = sameTransform(*saved, *loaded);
+
+			//the parent must be the loaded copy of the saved parent:
+			Entity parent = saved->getParent();
+			if (ok && parent >= 0)
+				ok = loaded->getParent() == loadedEntities[savedPosition[entityIndex(parent)]];
+			else ok = ok && loaded->getParent() < 0;
+
+			ok = ok && saved->getChildren().size() == loaded->getChildren().size();
+			ok = ok && saved->getWorldTransform() == loaded->getWorldTransform();
+		}
+
+		std::cout << "  N = " << n
+			<< ", round trip: " << checkResult(ok)
+			<< ", save: " << saveTime << " ms"
+			<< ", load: " << loadTime << " ms\n";
+	}
+}
+
+
+//=============================================================================================
+
+
+void benchmarkSceneStreaming()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const std::string path = "benchmarkScene.scene";
+
+	std::cout << "World scene streaming(release budget of " << SCENE_RELEASE_BUDGET << " components per frame):\n";
+
+	for (int n : sizes)
+	{
+		//the scene file:
+		{
+			Scene scene(0);
+			scene.transformComponents.reserve(n);
+			for (int i = 0; i < n; ++i)
+			{
+				Entity id = scene.createEntity();
+				scene.getTransformComponent(id)->setPosition(glm::vec3(FLOAT_TYPE(i), 0.0f, 0.0f));
+				if (i % 8 != 0) scene.getTransformComponent(id)->setParent(id - 1);
+			}
+			SceneSerializer::save(path, scene);
+		}
+
+		//--------------------------------------
+		//synchronous load and delete(the stall a scene change used to have):
+		World world;
+		world.initalize();
+		world.setCurrentScene(0);
+
+		auto start = BenchClock::now();
+		world.loadScene(path, 1);
+		double syncLoadTime = nanosecondsSince(start) / 1000000.0;
+
+		std::unique_ptr<Scene> copy(new Scene(2));
+		SceneSerializer::load(path, *copy);
+		start = BenchClock::now();
+		copy.reset();
+		double syncDeleteTime = nanosecondsSince(start) / 1000000.0;
+
+		//--------------------------------------
+		//streamed: load scene 2 while scene 1 is the current one, then change to it and unload scene 1:
+		world.setCurrentScene(1);
+		world.loadSceneAsync(path, 2);
+		world.requestCurrentScene(2, true);
+
+		double longestUpdate = 0.0;
+		int frames = 0;
+		while (world.currentScene->getId() != 2 || world.isReleasingScenes())
+		{
+			start = BenchClock::now();
+			world.update();
+			double updateTime = nanosecondsSince(start) / 1000000.0;
+			if (updateTime > longestUpdate) longestUpdate = updateTime;
+			++frames;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1)); //the rest of the frame
+		}
+
+		std::remove(path.c_str());
+
+		std::cout << "  N = " << n
+			<< ", sync load: " << syncLoadTime << " ms"
+			<< ", sync delete: " << syncDeleteTime << " ms"
+			<< ", streamed change: " << frames << " frames"
+			<< ", longest update(): " << longestUpdate << " ms\n";
+	}
+}
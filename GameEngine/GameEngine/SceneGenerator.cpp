@@ -0,0 +1,111 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "SceneGenerator.h"
+
+#include <cmath>
+#include <random>
+
+#include "World.h"
+#include "PhysicsEngine.h"
+#include "GraphicalSystem.h"
+#include "GameplayHandler.h"
+
+
+//SceneGenerator definitions:
+
+
+void SceneGenerator::generate(World& world, PhysicsEngine& physics, GraphicalSystem& graphics, GameplayHandler& gameplay,
+	const Settings& settings)
+{
+	Scene& scene = *world.currentScene;
+	std::default_random_engine generator(settings.seed);
+	std::uniform_real_distribution<FLOAT_TYPE> random01(0.0f, 1.0f);
+
+	const int n = settings.numOfEntities;
+	const int depth = settings.parentDepth > 0 ? settings.parentDepth : 1;
+	const FLOAT_TYPE area = settings.spacing * std::sqrt(FLOAT_TYPE(n)); //the side of the square
+	std::uniform_real_distribution<FLOAT_TYPE> randomCoord(-0.5f * area, 0.5f * area);
+	std::uniform_real_distribution<FLOAT_TYPE> randomOffset(-settings.spacing, settings.spacing);
+
+	//reserve the expected number of components(with some margin), so the pools are allocated only once:
+	int roots = n / depth + 1;
+	auto reserve = [](auto& pool, FLOAT_TYPE expected) { pool.reserve(pool.getSize() + int(1.1f * expected) + 64); };
+	reserve(scene.transformComponents, FLOAT_TYPE(n));
+	reserve(scene.boxRigidBodyComponents, roots * settings.boxRigidBodies);
+	if (settings.model)
+	{
+		reserve(scene.characterComponents, roots * settings.characters);
+		reserve(scene.modelComponents, n * settings.models);
+	}
+	if (settings.texture) reserve(scene.imageComponents, n * settings.images);
+	reserve(scene.pointLightComponents, n * settings.pointLights);
+
+	Entity parent = NULL_ENTITY;
+	for (int i = 0; i < n; ++i)
+	{
+		Entity id = scene.createEntity();
+		TransformComponent* tComp = scene.getTransformComponent(id);
+		bool root = i % depth == 0;
+
+		//the roots are placed in the area, and the children near their parents(in their parent's space):
+		if (root)
+			tComp->setPosition(glm::vec3(randomCoord(generator), 0.5f * settings.spacing * random01(generator),
+				randomCoord(generator)));
+		else
+		{
+			tComp->setPosition(glm::vec3(randomOffset(generator), 0.0f, randomOffset(generator)));
+			tComp->setParent(parent);
+		}
+		tComp->rotate(360.0f * random01(generator), glm::vec3(0.0f, 1.0f, 0.0f));
+		parent = id;
+
+		//--------------------------------------
+		//the components:
+		if (root && random01(generator) < settings.boxRigidBodies)
+		{
+			int size = 10 + int(20.0f * random01(generator));
+			physics.addBoxPhysicalComponent(id, size, size, size, tComp->getPosition());
+			if (random01(generator) < settings.staticBodies) scene.boxRigidBodyComponents.getByEntity(id)->setMass(0.0f);
+		}
+
+		if (root && settings.model && random01(generator) < settings.characters)
+		{
+			gameplay.createCharacterComponent(id, int(CharacterType::Enemy));
+			scene.getCharacterComponent(id)->setModel(settings.model); //also creates the bone transforms
+		}
+		else if (settings.model && random01(generator) < settings.models)
+			graphics.addModelComponent(id, settings.model);
+
+		if (settings.texture && random01(generator) < settings.images)
+			graphics.addImageComponent(id, settings.texture, 1, 1);
+
+		if (random01(generator) < settings.pointLights) //no depth cube map is created by the null backend
+			graphics.addPointLightComponent(id, glm::vec3(random01(generator), random01(generator), random01(generator)),
+				0.027f, 0.0028f);
+	}
+
+	//--------------------------------------
+	//particles around the origin:
+	if (settings.particles > 0)
+		scene.particleSystem.generateParticles(settings.particles, scene.particleSystem.FIRE_PARTICLE,
+			glm::vec3(settings.spacing), glm::vec3(1.0f), 0.5f);
+}
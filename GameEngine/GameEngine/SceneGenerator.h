@@ -0,0 +1,85 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+
+This header is part of a self made game engine. It declares the SceneGenerator class, which fills the
+current Scene of a World with a procedural set of entities, used to measure how the game systems scale(see Benchmark.h).
+	The entities are spread over a square area of the xz plane with the same density for any number of
+entities(so the number of nearby objects doesn't grow with the Scene), and they are linked in chains of
+parentDepth objects. Each entity gets a random mix of components, in the proportions of the Settings.
+The rigid bodies and the characters are only added to the roots of the chains, as the game does(the
+PhysicsEngine writes their positions directly to the TransformComponents). The components are added through the
+game systems(their add* functions).
+	The same Settings always generate the same Scene.
+*/
+//#################################################################################
+
+#ifndef SCENE_GENERATOR
+#define SCENE_GENERATOR
+
+
+#include "Entity.h"
+
+#include "GlobalDefines.h"
+
+
+class World;
+class PhysicsEngine;
+class GraphicalSystem;
+class GameplayHandler;
+class Model;
+class Texture;
+
+
+class SceneGenerator
+{
+public:
+
+	struct Settings
+	{
+		int numOfEntities = 1000;
+		int parentDepth = 4; //the number of objects of each chain(1 makes every entity a root)
+		FLOAT_TYPE spacing = 40.0f; //the average distance between two entities
+
+		//the fraction of the entities that get each component:
+		FLOAT_TYPE boxRigidBodies = 0.2f; //of the roots
+		FLOAT_TYPE staticBodies = 0.1f; //of the rigid bodies(they have infinite mass)
+		FLOAT_TYPE characters = 0.05f; //of the roots
+		FLOAT_TYPE models = 0.2f;
+		FLOAT_TYPE images = 0.3f;
+		FLOAT_TYPE pointLights = 0.01f;
+		int particles = 0; //the number of particles generated in the Scene's ParticleSystem
+
+		const Model* model = nullptr; //used by the models and characters(they aren't created without it)
+		const Texture* texture = nullptr; //used by the images(they aren't created without it)
+		unsigned int seed = 42;
+	};
+
+	/*
+		generate - add the entities to the current Scene of the World(it doesn't need to be empty). The PhysicsEngine
+		must be initialized with the World, and the GraphicalSystem and the GameplayHandler too if the Settings have
+		images, models, characters or lights(they aren't used otherwise). The GPU resources of the lights aren't created if the
+		graphics backend is the null one
+	*/
+	static void generate(World&, PhysicsEngine&, GraphicalSystem&, GameplayHandler&, const Settings&);
+};
+
+
+#endif // !SCENE_GENERATOR
@@ -0,0 +1,244 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include <exception>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "World.h"
+#include "SceneGenerator.h"
+#include "PhysicsEngine.h"
+#include "GraphicalSystem.h"
+#include "GameplayHandler.h"
+#include "GraphicsBackend.h"
+#include "GameClock.h"
+#include "BenchmarkHelpers.h"
+
+
+void benchmarkSyntheticScenes()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	const FLOAT_TYPE timeStep = 0.016f;
+	std::default_random_engine generator(42);
+
+	SceneGenerator::Settings settings;
+	settings.particles = PARTICLE_POOL_SIZE;
+	std::cout << "Synthetic scenes(chains of " << settings.parentDepth << " objects, null graphics backend):\n";
+
+	//the assets are loaded without the GPU, and the animations are sampled at fixed times:
+	GraphicsBackend::Type previousBackend = GraphicsBackend::get();
+	GraphicsBackend::set(GraphicsBackend::Type::NONE);
+	GameClock& clock = GameClock::instance();
+	bool wasDeterministic = clock.isDeterministic();
+	clock.setDeterministic(true);
+
+	std::unique_ptr<Texture> texture;
+	try {
+		texture.reset(new Texture("Assets/images/grass_15.png"));
+	}
+	catch (std::exception& e) {
+		std::cout << "!WARNING: couldn't load the benchmark texture, the scenes won't have images;\n" << e.what();
+	}
+
+	std::unique_ptr<Model> model(new Model());
+	try {
+		model->loadFromFile("Assets/Models/mage/player.glb", 4, 4, true);
+	}
+	catch (std::exception& e) {
+		std::cout << "!WARNING: couldn't load the benchmark model, the scenes won't have models nor characters;\n" << e.what();
+		model.reset();
+	}
+
+	settings.texture = texture.get();
+	settings.model = model.get();
+
+	for (int n : sizes)
+	{
+		World world;
+		world.initalize();
+		world.setCurrentScene(0);
+		Scene& scene = *world.currentScene;
+
+		PhysicsEngine physics;
+		physics.initialize(&world);
+		GraphicalSystem graphics;
+		graphics.initialize(&world, nullptr); //there's no window with the null backend
+		GameplayHandler gameplay;
+		gameplay.initialize(&world, nullptr);
+
+		settings.numOfEntities = n;
+		auto start = BenchClock::now();
+		SceneGenerator::generate(world, physics, graphics, gameplay, settings);
+		double generateTime = nanosecondsSince(start) / 1000000.0;
+
+		std::vector<Entity> entities;
+		scene.getEntities(entities);
+		std::uniform_int_distribution<int> randomEntity(0, int(entities.size()) - 1);
+
+		graphics.reloadTransforms(); //the first pass builds the hierarchy arrays
+
+		//--------------------------------------
+		//component lookups of random entities(most of them don't have all the components, so the pools are used,
+		//since the get*Component functions of the Scene assert that the component exists):
+		const int lookups = 200000;
+		int found = 0;
+		start = BenchClock::now();
+		for (int i = 0; i < lookups; ++i)
+		{
+			Entity id = entities[randomEntity(generator)];
+			found += scene.getTransformComponent(id)->getParent() >= 0;
+			found += scene.boxRigidBodyComponents.getByEntity(id) != nullptr;
+			found += scene.modelComponents.getByEntity(id) != nullptr;
+			found += scene.imageComponents.getByEntity(id) != nullptr;
+		}
+		double lookupCost = nanosecondsSince(start) / (4.0 * lookups);
+		benchmarkSink = FLOAT_TYPE(found);
+
+		//--------------------------------------
+		//pool iteration(the loop of the game systems) and entity churn(spawning and destroying objects):
+		int rounds = 2000000 / n + 1;
+		FLOAT_TYPE sum = 0.0f;
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			for (int i = 0; i < scene.transformComponents.getSize(); ++i)
+				sum += scene.transformComponents[i].getPosition().x;
+		double iterationCost = nanosecondsSince(start) / (double(rounds) * scene.transformComponents.getSize());
+		benchmarkSink = sum;
+
+		const int churn = 10000;
+		start = BenchClock::now();
+		for (int i = 0; i < churn; ++i)
+			scene.deleteEntity(scene.createEntity());
+		double churnCost = nanosecondsSince(start) / churn;
+
+		//--------------------------------------
+		//the update of the PhysicsEngine(mostly the box pass: integration, broad phase and collisions):
+		rounds = 20000 / n + 1;
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			physics.update();
+		double boxesTime = nanosecondsSince(start) / (1000000.0 * rounds);
+
+		//--------------------------------------
+		//the GraphicalSystem transform pass, after the physics moved the bodies:
+		rounds = 200000 / n + 1;
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (int i = 0; i < scene.transformComponents.getSize(); i += settings.parentDepth)
+				scene.transformComponents[i].move(glm::vec3(0.0f)); //marks the whole chain dirty
+			graphics.reloadTransforms();
+		}
+		double transformsCost = nanosecondsSince(start) / (double(rounds) * scene.transformComponents.getSize());
+
+		//--------------------------------------
+		//the animation sampling(boneTransform() of every model and character):
+		int animated = scene.modelComponents.getSize() + scene.characterComponents.getSize();
+		double animationCost = 0.0;
+		if (model && animated > 0)
+		{
+			rounds = 20000 / animated + 1;
+			start = BenchClock::now();
+			for (int r = 0; r < rounds; ++r)
+			{
+				clock.advance(timeStep);
+				graphics.sampleAnimations();
+			}
+			animationCost = nanosecondsSince(start) / (1000.0 * rounds * animated);
+		}
+
+		//--------------------------------------
+		//the state stored for the interpolation of the fixed step loop(recordTick()), and a tick that moves every
+		//chain: the draws interpolated halfway must be halfway between the two states:
+		rounds = 200000 / n + 1;
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			graphics.recordTick();
+		double recordCost = nanosecondsSince(start) / (double(rounds) * scene.transformComponents.getSize());
+
+		FramePacket packet;
+		auto drawTransforms = [&](FLOAT_TYPE alpha)
+		{
+			graphics.captureFrame(packet, alpha);
+			std::vector<glm::vec3> positions;
+			for (const FramePacket::SpriteDraw& draw : packet.images) positions.push_back(glm::vec3(draw.model[3]));
+			for (const FramePacket::ModelDraw& draw : packet.models) positions.push_back(glm::vec3(draw.model[3]));
+			for (const FramePacket::ModelDraw& draw : packet.characters) positions.push_back(glm::vec3(draw.model[3]));
+			return positions;
+		};
+		std::vector<glm::vec3> before = drawTransforms(1.0f);
+		graphics.recordTick();
+		for (int i = 0; i < scene.transformComponents.getSize(); ++i)
+			if (scene.transformComponents[i].getParent() < 0)
+				scene.transformComponents[i].move(glm::vec3(2.0f, 0.0f, -1.0f));
+		std::vector<glm::vec3> after = drawTransforms(1.0f);
+		std::vector<glm::vec3> halfway = drawTransforms(0.5f);
+
+		int wrong = 0;
+		for (int i = 0; i < int(halfway.size()); ++i)
+			wrong += glm::length(halfway[i] - 0.5f * (before[i] + after[i])) > 0.001f * (1.0f + glm::length(after[i]))
+				|| glm::length(after[i] - before[i]) < 1.0f; //every draw moved
+
+		//--------------------------------------
+		//the particle update(the pool has a fixed size, so it's refilled before each update):
+		rounds = 100;
+		double particlesTime = 0.0;
+		for (int r = 0; r < rounds; ++r)
+		{
+			scene.particleSystem.generateParticles(PARTICLE_POOL_SIZE, scene.particleSystem.FIRE_PARTICLE,
+				glm::vec3(settings.spacing), glm::vec3(1.0f), 0.5f);
+			start = BenchClock::now();
+			scene.particleSystem.update(timeStep);
+			particlesTime += nanosecondsSince(start);
+		}
+		double particleCost = particlesTime / (double(rounds) * PARTICLE_POOL_SIZE);
+
+		std::cout << "  N = " << n
+			<< ", generate: " << generateTime << " ms"
+			<< ", lookup: " << lookupCost << " ns/op"
+			<< ", iterate: " << iterationCost << " ns/elem"
+			<< ", create + delete entity: " << churnCost << " ns/op\n"
+			<< "    physics update(" << scene.boxRigidBodyComponents.getSize() << " bodies): " << boxesTime << " ms/step"
+			<< ", reloadTransforms: " << transformsCost << " ns/obj"
+			<< ", particles: " << particleCost << " ns/particle";
+		if (model && animated > 0)
+			std::cout << ", boneTransform(" << animated << " models): " << animationCost << " us/model";
+		std::cout << "\n    recordTick: " << recordCost << " ns/obj, interpolation(" << halfway.size() << " draws): "
+			<< checkResult(wrong == 0, "WRONG") << '\n';
+
+		recordResult("scene_generate", n, generateTime, "ms");
+		recordResult("scene_lookup", n, lookupCost, "ns/op");
+		recordResult("pool_iterate", n, iterationCost, "ns/elem");
+		recordResult("entity_create_delete", n, churnCost, "ns/op");
+		recordResult("solve_for_boxes", n, boxesTime, "ms/step");
+		recordResult("reload_transforms", n, transformsCost, "ns/obj");
+		recordResult("particle_update", n, particleCost, "ns/particle");
+		recordResult("record_tick", n, recordCost, "ns/obj");
+		if (model && animated > 0)
+			recordResult("bone_transform", n, animationCost, "us/model");
+	}
+
+	clock.setDeterministic(wasDeterministic);
+	GraphicsBackend::set(previousBackend);
+}
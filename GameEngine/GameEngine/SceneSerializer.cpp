@@ -0,0 +1,1247 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "SceneSerializer.h"
+#include "Profiler.h"
+#include "World.h"
+#include "TextureHandler.h"
+#include "ModelHandler.h"
+
+
+//##################################################
+//file layout:
+
+
+/*
+	All the blocks start at multiples of SCENE_FILE_ALIGNMENT, so the records can be read directly
+	from the mapped memory. All the numbers are little endian, like in every platform the engine runs on
+*/
+#define SCENE_FILE_ALIGNMENT 16
+
+enum ScenePoolType
+{
+	transformPool = 0,
+	imagePool,
+	dirLightPool,
+	pointLightPool,
+	sphereRigidBodyPool,
+	boxRigidBodyPool,
+	characterPool,
+	modelPool,
+	interactableObjectPool,
+	numOfScenePools
+};
+
+struct ScenePoolEntry
+{
+	uint32_t count; //number of records
+	uint32_t recordSize; //sizeof the record type when the file was saved
+	uint32_t offset; //position of the first record in the file
+	uint32_t reserved;
+};
+
+struct SceneAssetTable
+{
+	uint32_t count; //number of paths
+	uint32_t offset; //position of the first ScenePathRecord in the file
+};
+
+struct ScenePathRecord
+{
+	uint32_t offset; //position of the first character in the file(the path is not null terminated)
+	uint32_t length;
+};
+
+struct SceneFileHeader
+{
+	char magic[4]; //"GESC"
+	uint32_t version; //SCENE_FILE_VERSION
+	uint32_t numOfEntities;
+	uint32_t entityTableOffset; //numOfEntities int32_t's, the ids the entities had when the scene was saved
+	SceneAssetTable textures; //the paths of the textures(path i is the texture saved as index i)
+	SceneAssetTable models; //the same for the models
+	ScenePoolEntry pools[numOfScenePools];
+};
+
+
+//the records(one for each component). Entities are saved as int32_t, Textures and Models as indices in the path tables:
+
+struct TransformRecord
+{
+	int32_t entity;
+	int32_t parent;
+	int32_t actived;
+	float orientation[4]; //w, x, y, z
+	float translation[3];
+	float scale[3];
+	float transform[16];
+};
+
+struct ImageRecord
+{
+	int32_t entity;
+	int32_t actived;
+	int32_t instanced;
+	int32_t texture;
+	int32_t normalMap;
+	int32_t emissionMap;
+	float position[3];
+	int32_t width, height;
+	int32_t rows, columns;
+	int32_t currentRow, currentColumn;
+	int32_t playing, frameCounter;
+};
+
+struct DirLightRecord
+{
+	int32_t entity;
+	int32_t actived;
+	int32_t resolution;
+	int32_t shadowCaster;
+	float ambient[3];
+	float color[3];
+	float direction[3];
+	float position[3];
+};
+
+struct PointLightRecord
+{
+	int32_t entity;
+	int32_t actived;
+	int32_t resolution;
+	float ambient[3];
+	float color[3];
+	float position[3];
+	float constantAttenuation, linearAttenuation, quadraticAttenuation;
+	float radius;
+};
+
+struct RigidBodyRecord //the data shared by all the rigid bodies
+{
+	int32_t entity;
+	int32_t actived;
+	int32_t rotations; //bit 0 = xRot, bit 1 = yRot, bit 2 = zRot
+	int32_t fast;
+	int32_t layer;
+	float friction;
+	float restitution;
+	float mass;
+	float linearVelocity[3];
+	float forces[3];
+	float deltaSpace[3];
+	float inertia[9];
+};
+
+struct SphereBodyRecord
+{
+	RigidBodyRecord body;
+	float radius;
+	float pos[3];
+};
+
+struct BoxBodyRecord
+{
+	RigidBodyRecord body;
+	float pos[3];
+	float size[3];
+	float vertices[24];
+};
+
+struct CharacterRecord
+{
+	int32_t entity;
+	int32_t actived;
+	float movingSpeed, runSpeedMultiplier, jumpForce;
+	int32_t jumpCooldown;
+	float maxHealth, health;
+	int32_t maxMana, mana;
+	float maxEnergy, energy, enegyCostMultiplier, energyRegenBoost;
+	int32_t xp, lvl;
+	int32_t charType, charState, charPreviouseState;
+	int32_t flags; //walkUp, walkDown, walkLeft, walkRight, running and mustJump, from bit 0 to 5
+	int32_t casting, onGround;
+	float direction[2];
+	float speed;
+	int32_t model;
+	int32_t modelDirection;
+	float pos[3];
+	int32_t currentAnimation;
+	float animationTime;
+	int32_t currentRow, currentColumn;
+	int32_t playing, frameCounter;
+	int32_t childrenObjects[MAX_NUM_OF_INTERACTABLE_OBJECTS];
+};
+
+struct ModelRecord
+{
+	int32_t entity;
+	int32_t actived;
+	int32_t model;
+	int32_t cullFace;
+	float pos[3];
+	int32_t currentRow, currentColumn;
+	int32_t playing, frameCounter;
+};
+
+struct InteractableRecord
+{
+	int32_t entity;
+	int32_t actived;
+	int32_t model;
+	int32_t holder, caster;
+	float transform[16];
+	float hitBoxPos[3];
+	float hitBoxSize[3];
+	float hitBoxVertices[24];
+	float pos[3];
+	int32_t currentAnimation;
+	float animationTime;
+	int32_t playing, frameCounter;
+	int32_t currentRow, currentColumn;
+	int32_t currentEffect;
+	int32_t isEffectActive;
+	float currentState;
+	int32_t layer;
+};
+
+
+//##################################################
+//helper functions:
+
+
+static void writeVec(float* dst, const glm::vec2& v) noexcept { dst[0] = v.x; dst[1] = v.y; }
+static void writeVec(float* dst, const glm::vec3& v) noexcept { dst[0] = v.x; dst[1] = v.y; dst[2] = v.z; }
+static void writeQuat(float* dst, const glm::quat& q) noexcept { dst[0] = q.w; dst[1] = q.x; dst[2] = q.y; dst[3] = q.z; }
+static void writeMat(float* dst, const glm::mat3& m) noexcept { std::memcpy(dst, &m[0][0], sizeof(float) * 9); }
+static void writeMat(float* dst, const glm::mat4& m) noexcept { std::memcpy(dst, &m[0][0], sizeof(float) * 16); }
+
+static glm::vec2 readVec2(const float* src) noexcept { return glm::vec2(src[0], src[1]); }
+static glm::vec3 readVec3(const float* src) noexcept { return glm::vec3(src[0], src[1], src[2]); }
+static glm::quat readQuat(const float* src) noexcept { return glm::quat(src[0], src[1], src[2], src[3]); }
+static glm::mat3 readMat3(const float* src) noexcept { glm::mat3 m; std::memcpy(&m[0][0], src, sizeof(float) * 9); return m; }
+static glm::mat4 readMat4(const float* src) noexcept { glm::mat4 m; std::memcpy(&m[0][0], src, sizeof(float) * 16); return m; }
+
+
+//=================================================
+
+
+template<typename Record>
+static Record* appendRecords(std::vector<unsigned char>& blob, int n)
+//add space for n zeroed records at the end of the blob and return the first one
+{
+	size_t offset = blob.size();
+	blob.resize(offset + sizeof(Record) * n, 0);
+	return reinterpret_cast<Record*>(blob.data() + offset);
+}
+
+
+//=================================================
+
+
+static void alignBlob(std::vector<unsigned char>& blob)
+{
+	while (blob.size() % SCENE_FILE_ALIGNMENT != 0)
+		blob.push_back(0);
+}
+
+
+//=================================================
+
+
+static SceneAssetTable appendPaths(std::vector<unsigned char>& blob, const std::vector<std::string>& paths)
+//add a table of ScenePathRecords followed by the characters of all the paths
+{
+	alignBlob(blob);
+	SceneAssetTable table;
+	table.count = uint32_t(paths.size());
+	table.offset = uint32_t(blob.size());
+	appendRecords<ScenePathRecord>(blob, int(paths.size()));
+
+	for (size_t i = 0; i < paths.size(); ++i)
+	{
+		ScenePathRecord* records = reinterpret_cast<ScenePathRecord*>(blob.data() + table.offset);
+		records[i].offset = uint32_t(blob.size());
+		records[i].length = uint32_t(paths[i].size());
+		blob.insert(blob.end(), paths[i].begin(), paths[i].end());
+	}
+	return table;
+}
+
+
+//##################################################
+//MappedFile class definitions:
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("ERROR::MappedFile::MappedFile() COULD NOT OPEN THE FILE: " + path + ";\n");
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		throw std::runtime_error("ERROR::MappedFile::MappedFile() THE FILE IS EMPTY: " + path + ";\n");
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view)
+	{
+		if (mapping) CloseHandle(mapping);
+		CloseHandle(file);
+		throw std::runtime_error("ERROR::MappedFile::MappedFile() COULD NOT MAP THE FILE: " + path + ";\n");
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = static_cast<const unsigned char*>(view);
+	size = size_t(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	UnmapViewOfFile(data);
+	CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("ERROR::MappedFile::MappedFile() COULD NOT OPEN THE FILE: " + path + ";\n");
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0 || fileInfo.st_size == 0)
+	{
+		close(file);
+		throw std::runtime_error("ERROR::MappedFile::MappedFile() THE FILE IS EMPTY: " + path + ";\n");
+	}
+
+	void* view = mmap(nullptr, size_t(fileInfo.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); //the mapping keeps the file alive
+	if (view == MAP_FAILED)
+		throw std::runtime_error("ERROR::MappedFile::MappedFile() COULD NOT MAP THE FILE: " + path + ";\n");
+
+	data = static_cast<const unsigned char*>(view);
+	size = size_t(fileInfo.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+	munmap(const_cast<unsigned char*>(data), size);
+}
+
+#endif
+
+
+//=================================================
+
+
+const unsigned char* MappedFile::getData() const noexcept
+{
+	return data;
+}
+
+size_t MappedFile::getSize() const noexcept
+{
+	return size;
+}
+
+
+//##################################################
+//SceneSerializer::Relocator class definition:
+
+
+class SceneSerializer::Relocator
+{
+public:
+
+	Relocator(const int32_t* savedIds, int n, const std::vector<Entity>& newIds, const std::string& path)
+		: path(path)
+	{
+		for (int i = 0; i < n; ++i)
+		{
+			if (savedIds[i] < 0) continue;
+			int index = entityIndex(savedIds[i]);
+			if (index >= int(savedIdOf.size()))
+			{
+				savedIdOf.resize(index + 1, NULL_ENTITY);
+				newIdOf.resize(index + 1, NULL_ENTITY);
+			}
+			savedIdOf[index] = savedIds[i];
+			newIdOf[index] = newIds[i];
+		}
+	}
+
+	Entity getEntity(int32_t saved) const noexcept
+	//the new id of a saved entity(NULL_ENTITY for negative ids and entities that are not in the file)
+	{
+		if (saved < 0) return NULL_ENTITY;
+		int index = entityIndex(saved);
+		if (index >= int(savedIdOf.size()) || savedIdOf[index] != saved) return NULL_ENTITY;
+		return newIdOf[index];
+	}
+
+	void setAssets(const std::vector<int>& textures, const std::vector<int>& models)
+	//the index each path of the file has in the TextureHandler and ModelHandler(-1 if it's not loaded)
+	{
+		textureOf = textures;
+		modelOf = models;
+	}
+
+	const Texture* getTexture(int32_t index) const
+	//note: throws if the texture is not loaded
+	{
+		if (index < 0) return nullptr;
+		if (index >= int32_t(textureOf.size()) || textureOf[index] < 0)
+			throw std::runtime_error("ERROR::SceneSerializer::load() INVALID TEXTURE REFERENCE IN THE SCENE FILE: " + path + ";\n");
+		return TextureHandler::instance().get(textureOf[index]);
+	}
+
+	const Model* getModel(int32_t index) const
+	//note: throws if the model is not loaded
+	{
+		if (index < 0) return nullptr;
+		if (index >= int32_t(modelOf.size()) || modelOf[index] < 0)
+			throw std::runtime_error("ERROR::SceneSerializer::load() INVALID MODEL REFERENCE IN THE SCENE FILE: " + path + ";\n");
+		return ModelHandler::instance().getModel(modelOf[index]);
+	}
+
+private:
+	std::vector<int32_t> savedIdOf; //indexed by entityIndex(saved id)
+	std::vector<Entity> newIdOf;
+	std::vector<int> textureOf; //indexed by the saved texture index
+	std::vector<int> modelOf; //indexed by the saved model id
+	std::string path; //the scene file(for the error messages)
+};
+
+
+//##################################################
+//SceneSerializer class definitions:
+
+
+void SceneSerializer::save(const std::string& path, Scene& scene)
+{
+	PROFILE_ZONE("SceneSerializer::save");
+
+	std::vector<Entity> entities;
+	scene.getEntities(entities);
+
+	std::vector<unsigned char> blob(sizeof(SceneFileHeader), 0);
+	alignBlob(blob);
+
+	//entity table:
+	uint32_t entityTableOffset = uint32_t(blob.size());
+	int32_t* table = appendRecords<int32_t>(blob, int(entities.size()));
+	for (size_t i = 0; i < entities.size(); ++i)
+		table[i] = entities[i];
+
+	//path tables(the records save the Textures and Models as their indices in the handlers, so the
+	//tables just have all the paths in the same order):
+	TextureHandler& textureHandler = TextureHandler::instance();
+	std::vector<std::string> texturePaths(textureHandler.getNumOfTextures());
+	for (int i = 0; i < int(texturePaths.size()); ++i)
+		texturePaths[i] = textureHandler.getPath(i);
+	SceneAssetTable textureTable = appendPaths(blob, texturePaths);
+
+	ModelHandler& modelHandler = ModelHandler::instance();
+	std::vector<std::string> modelPaths(modelHandler.getNumOfModels());
+	for (int i = 0; i < int(modelPaths.size()); ++i)
+		modelPaths[i] = modelHandler.getModelPath(i);
+	SceneAssetTable modelTable = appendPaths(blob, modelPaths);
+
+	//one block for each pool:
+	ScenePoolEntry pools[numOfScenePools];
+	void (*savers[numOfScenePools])(Scene&, std::vector<unsigned char>&) = {
+		saveTransforms, saveImages, saveDirLights, savePointLights, saveSphereRigidBodies,
+		saveBoxRigidBodies, saveCharacters, saveModels, saveInteractableObjects };
+	const uint32_t recordSizes[numOfScenePools] = {
+		sizeof(TransformRecord), sizeof(ImageRecord), sizeof(DirLightRecord), sizeof(PointLightRecord),
+		sizeof(SphereBodyRecord), sizeof(BoxBodyRecord), sizeof(CharacterRecord), sizeof(ModelRecord),
+		sizeof(InteractableRecord) };
+
+	for (int type = 0; type < numOfScenePools; ++type)
+	{
+		alignBlob(blob);
+		size_t begin = blob.size();
+		savers[type](scene, blob);
+
+		pools[type].offset = uint32_t(begin);
+		pools[type].recordSize = recordSizes[type];
+		pools[type].count = uint32_t((blob.size() - begin) / recordSizes[type]);
+		pools[type].reserved = 0;
+	}
+
+	//the header(written last, since the blob may have been reallocated):
+	SceneFileHeader* header = reinterpret_cast<SceneFileHeader*>(blob.data());
+	std::memcpy(header->magic, "GESC", 4);
+	header->version = SCENE_FILE_VERSION;
+	header->numOfEntities = uint32_t(entities.size());
+	header->entityTableOffset = entityTableOffset;
+	header->textures = textureTable;
+	header->models = modelTable;
+	std::memcpy(header->pools, pools, sizeof(pools));
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("ERROR::SceneSerializer::save() COULD NOT OPEN THE FILE: " + path + ";\n");
+	file.write(reinterpret_cast<const char*>(blob.data()), std::streamsize(blob.size()));
+	if (!file)
+		throw std::runtime_error("ERROR::SceneSerializer::save() COULD NOT WRITE THE FILE: " + path + ";\n");
+}
+
+
+//=================================================
+
+
+void SceneSerializer::load(const std::string& path, Scene& scene, std::vector<Entity>* loadedEntities, bool gpuResources)
+{
+	PROFILE_ZONE("SceneSerializer::load");
+
+	MappedFile file(path);
+	const unsigned char* data = file.getData();
+	size_t size = file.getSize();
+
+	//validate the header and the position of each block, so no record is read outside the file:
+	if (size < sizeof(SceneFileHeader))
+		throw std::runtime_error("ERROR::SceneSerializer::load() INVALID SCENE FILE: " + path + ";\n");
+
+	const SceneFileHeader* header = reinterpret_cast<const SceneFileHeader*>(data);
+	if (std::memcmp(header->magic, "GESC", 4) != 0)
+		throw std::runtime_error("ERROR::SceneSerializer::load() INVALID SCENE FILE: " + path + ";\n");
+	if (header->version != SCENE_FILE_VERSION)
+		throw std::runtime_error("ERROR::SceneSerializer::load() UNSUPPORTED SCENE FILE VERSION: " + path + ";\n");
+
+	auto fits = [size](uint64_t offset, uint64_t count, uint64_t recordSize) {
+		return offset % SCENE_FILE_ALIGNMENT == 0 && offset + count * recordSize <= size; };
+
+	if (!fits(header->entityTableOffset, header->numOfEntities, sizeof(int32_t)))
+		throw std::runtime_error("ERROR::SceneSerializer::load() CORRUPTED SCENE FILE: " + path + ";\n");
+
+	//find the assets of the path tables in the handlers:
+	auto readPaths = [&](const SceneAssetTable& table, int (*find)(const std::string&)) {
+		if (!fits(table.offset, table.count, sizeof(ScenePathRecord)))
+			throw std::runtime_error("ERROR::SceneSerializer::load() CORRUPTED SCENE FILE: " + path + ";\n");
+
+		const ScenePathRecord* records = reinterpret_cast<const ScenePathRecord*>(data + table.offset);
+		std::vector<int> indices(table.count);
+		for (uint32_t i = 0; i < table.count; ++i)
+		{
+			if (uint64_t(records[i].offset) + records[i].length > size)
+				throw std::runtime_error("ERROR::SceneSerializer::load() CORRUPTED SCENE FILE: " + path + ";\n");
+			indices[i] = find(std::string(reinterpret_cast<const char*>(data + records[i].offset), records[i].length));
+		}
+		return indices;
+	};
+	std::vector<int> textureIndices = readPaths(header->textures,
+		[](const std::string& p) { return TextureHandler::instance().findIndex(p); });
+	std::vector<int> modelIds = readPaths(header->models,
+		[](const std::string& p) { return ModelHandler::instance().findModelId(p); });
+
+	const uint32_t recordSizes[numOfScenePools] = {
+		sizeof(TransformRecord), sizeof(ImageRecord), sizeof(DirLightRecord), sizeof(PointLightRecord),
+		sizeof(SphereBodyRecord), sizeof(BoxBodyRecord), sizeof(CharacterRecord), sizeof(ModelRecord),
+		sizeof(InteractableRecord) };
+	for (int type = 0; type < numOfScenePools; ++type)
+	{
+		const ScenePoolEntry& pool = header->pools[type];
+		if (pool.recordSize != recordSizes[type] || !fits(pool.offset, pool.count, pool.recordSize))
+			throw std::runtime_error("ERROR::SceneSerializer::load() CORRUPTED SCENE FILE: " + path + ";\n");
+	}
+
+	//create the entities(their TransformComponents are added by loadTransforms()):
+	int numOfEntities = int(header->numOfEntities);
+	const int32_t* savedIds = reinterpret_cast<const int32_t*>(data + header->entityTableOffset);
+
+	std::vector<Entity> newIds(numOfEntities);
+	for (int i = 0; i < numOfEntities; ++i)
+		newIds[i] = scene.entities.create();
+
+	Relocator relocator(savedIds, numOfEntities, newIds, path);
+	relocator.setAssets(textureIndices, modelIds);
+
+	//fill the pools:
+	void (*loaders[numOfScenePools])(const unsigned char*, int, Scene&, const Relocator&) = {
+		loadTransforms, loadImages, loadDirLights, loadPointLights, loadSphereRigidBodies,
+		loadBoxRigidBodies, loadCharacters, loadModels, loadInteractableObjects };
+
+	for (int type = 0; type < numOfScenePools; ++type)
+	{
+		const ScenePoolEntry& pool = header->pools[type];
+		loaders[type](data + pool.offset, int(pool.count), scene, relocator);
+	}
+
+	//every entity must have a TransformComponent(even if the file didn't have one for it):
+	for (Entity id : newIds)
+		if (!scene.transformComponents.has(id))
+		{
+			TransformComponent comp(id);
+			comp.pool = &scene.transformComponents;
+			comp.changeLog = &scene.changedTransforms;
+			scene.transformComponents.push_back(comp);
+		}
+
+	if (gpuResources)
+		createGpuResources(scene);
+
+	if (loadedEntities)
+		loadedEntities->insert(loadedEntities->end(), newIds.begin(), newIds.end());
+}
+
+
+//=================================================
+
+
+void SceneSerializer::createGpuResources(Scene& scene)
+{
+	PROFILE_ZONE("SceneSerializer::createGpuResources");
+
+	for (int i = 0; i < scene.dirLightComponents.getSize(); ++i)
+	{
+		DirLightComponent& light = scene.dirLightComponents[i];
+		if (light.shadowCaster && !light.depthTexture)
+			light.createDepthTexture();
+	}
+
+	for (int i = 0; i < scene.pointLightComponents.getSize(); ++i)
+	{
+		PointLightComponent& light = scene.pointLightComponents[i];
+		if (!light.depthCubeMap)
+			light.createDepthCubeMap();
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveTransforms(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<TransformComponent>& pool = scene.transformComponents;
+	TransformRecord* records = appendRecords<TransformRecord>(blob, pool.getSize());
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const TransformComponent& comp = pool[i];
+		TransformRecord& r = records[i];
+		r.entity = comp.getEntityId();
+		r.parent = comp.parent;
+		r.actived = comp.isActived();
+		writeQuat(r.orientation, comp.orientation);
+		writeVec(r.translation, comp.translation);
+		writeVec(r.scale, comp.scale);
+		writeMat(r.transform, comp.transform);
+	}
+}
+
+void SceneSerializer::loadTransforms(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const TransformRecord* records = reinterpret_cast<const TransformRecord*>(data);
+	ComponentPool<TransformComponent>& pool = scene.transformComponents;
+	pool.reserve(pool.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const TransformRecord& r = records[i];
+		Entity id = relocator.getEntity(r.entity);
+		if (id == NULL_ENTITY || pool.has(id)) continue;
+
+		TransformComponent comp(id);
+		comp.pool = &pool;
+		comp.changeLog = &scene.changedTransforms;
+		comp.parent = relocator.getEntity(r.parent);
+		comp.orientation = readQuat(r.orientation);
+		comp.translation = readVec3(r.translation);
+		comp.scale = readVec3(r.scale);
+		comp.transform = readMat4(r.transform);
+		if (!r.actived) comp.disable();
+
+		pool.push_back(comp); //the world transform is computed later(worldDirty is true for new components)
+	}
+
+	//rebuild the children lists, now that all the transforms exist:
+	for (int i = 0; i < n; ++i)
+	{
+		const TransformRecord& r = records[i];
+		if (r.parent < 0) continue;
+
+		Entity id = relocator.getEntity(r.entity);
+		TransformComponent* comp = pool.getByEntity(id);
+		if (!comp || comp->parent == NULL_ENTITY) continue;
+
+		TransformComponent* parent = pool.getByEntity(comp->parent);
+		if (parent) parent->children.push_back(id);
+		else comp->parent = NULL_ENTITY; //the parent was not saved
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveImages(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<ImageComponent>& pool = scene.imageComponents;
+	ImageRecord* records = appendRecords<ImageRecord>(blob, pool.getSize());
+	TextureHandler& textures = TextureHandler::instance();
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const ImageComponent& comp = pool[i];
+		ImageRecord& r = records[i];
+		r.entity = comp.getEntityId();
+		r.actived = comp.isActived();
+		r.instanced = comp.instanced;
+		r.texture = textures.getIndex(comp.spt.getTexture());
+		r.normalMap = textures.getIndex(comp.normalMap);
+		r.emissionMap = textures.getIndex(comp.emissionMap);
+		writeVec(r.position, comp.spt.Position);
+		r.width = comp.spt.width;
+		r.height = comp.spt.height;
+		r.rows = comp.spt.rows;
+		r.columns = comp.spt.columns;
+		r.currentRow = comp.spt.currentRow;
+		r.currentColumn = comp.spt.currentColumn;
+		r.playing = comp.playing;
+		r.frameCounter = comp.frameCounter;
+	}
+}
+
+void SceneSerializer::loadImages(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const ImageRecord* records = reinterpret_cast<const ImageRecord*>(data);
+	scene.imageComponents.reserve(scene.imageComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const ImageRecord& r = records[i];
+		Entity id = relocator.getEntity(r.entity);
+		if (id == NULL_ENTITY) continue;
+
+		ImageComponent comp(id);
+		comp.instanced = r.instanced != 0;
+		comp.spt.setTexture(relocator.getTexture(r.texture));
+		comp.normalMap = relocator.getTexture(r.normalMap);
+		comp.emissionMap = relocator.getTexture(r.emissionMap);
+		comp.spt.Position = readVec3(r.position);
+		comp.spt.width = r.width;
+		comp.spt.height = r.height;
+		comp.spt.rows = r.rows;
+		comp.spt.columns = r.columns;
+		comp.spt.currentRow = r.currentRow;
+		comp.spt.currentColumn = r.currentColumn;
+		comp.playing = r.playing;
+		comp.frameCounter = r.frameCounter;
+		if (!r.actived) comp.disable();
+
+		scene.imageComponents.push_back(comp);
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveDirLights(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<DirLightComponent>& pool = scene.dirLightComponents;
+	DirLightRecord* records = appendRecords<DirLightRecord>(blob, pool.getSize());
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const DirLightComponent& comp = pool[i];
+		DirLightRecord& r = records[i];
+		r.entity = comp.getEntityId();
+		r.actived = comp.isActived();
+		r.resolution = comp.widht;
+		r.shadowCaster = comp.shadowCaster;
+		writeVec(r.ambient, comp.lightAmbient);
+		writeVec(r.color, comp.lightColor);
+		writeVec(r.direction, comp.direction);
+		writeVec(r.position, comp.position);
+	}
+}
+
+void SceneSerializer::loadDirLights(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const DirLightRecord* records = reinterpret_cast<const DirLightRecord*>(data);
+	scene.dirLightComponents.reserve(scene.dirLightComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const DirLightRecord& r = records[i];
+		Entity id = relocator.getEntity(r.entity);
+		if (id == NULL_ENTITY) continue;
+
+		DirLightComponent comp; //the depth texture is created by createGpuResources()
+		comp.entityId = id;
+		comp.widht = r.resolution;
+		comp.height = r.resolution;
+		comp.shadowCaster = r.shadowCaster != 0;
+		comp.lightAmbient = readVec3(r.ambient);
+		comp.lightColor = readVec3(r.color);
+		comp.direction = readVec3(r.direction);
+		comp.position = readVec3(r.position);
+		if (!r.actived) comp.disable();
+
+		scene.dirLightComponents.push_back(comp);
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::savePointLights(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<PointLightComponent>& pool = scene.pointLightComponents;
+	PointLightRecord* records = appendRecords<PointLightRecord>(blob, pool.getSize());
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const PointLightComponent& comp = pool[i];
+		PointLightRecord& r = records[i];
+		r.entity = comp.getEntityId();
+		r.actived = comp.isActived();
+		r.resolution = comp.width;
+		writeVec(r.ambient, comp.lightAmbient);
+		writeVec(r.color, comp.lightColor);
+		writeVec(r.position, comp.position);
+		r.constantAttenuation = float(comp.constantAttenuation);
+		r.linearAttenuation = float(comp.linearAttenuation);
+		r.quadraticAttenuation = float(comp.quadraticAttenuation);
+		r.radius = float(comp.radius);
+	}
+}
+
+void SceneSerializer::loadPointLights(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const PointLightRecord* records = reinterpret_cast<const PointLightRecord*>(data);
+	scene.pointLightComponents.reserve(scene.pointLightComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const PointLightRecord& r = records[i];
+		Entity id = relocator.getEntity(r.entity);
+		if (id == NULL_ENTITY) continue;
+
+		PointLightComponent comp; //the depth cube map is created by createGpuResources()
+		comp.entityId = id;
+		comp.width = r.resolution;
+		comp.height = r.resolution;
+		comp.lightAmbient = readVec3(r.ambient);
+		comp.lightColor = readVec3(r.color);
+		comp.position = readVec3(r.position);
+		comp.constantAttenuation = r.constantAttenuation;
+		comp.linearAttenuation = r.linearAttenuation;
+		comp.quadraticAttenuation = r.quadraticAttenuation;
+		comp.radius = r.radius;
+		if (!r.actived) comp.disable();
+
+		scene.pointLightComponents.push_back(comp);
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveSphereRigidBodies(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<RigidBodyComponent<Sphere>>& pool = scene.sphereRigidBodyComponents;
+	SphereBodyRecord* records = appendRecords<SphereBodyRecord>(blob, pool.getSize());
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const RigidBodyComponent<Sphere>& comp = pool[i];
+		SphereBodyRecord& r = records[i];
+		r.body.entity = comp.getEntityId();
+		r.body.actived = comp.isActived();
+		r.body.rotations = (comp.xRot ? 1 : 0) | (comp.yRot ? 2 : 0) | (comp.zRot ? 4 : 0);
+		r.body.fast = comp.fast;
+		r.body.layer = comp.layer;
+		r.body.friction = float(comp.friction);
+		r.body.restitution = float(comp.restitution);
+		r.body.mass = float(comp.mass);
+		writeVec(r.body.linearVelocity, comp.linearVelocity);
+		writeVec(r.body.forces, comp.forces);
+		writeVec(r.body.deltaSpace, comp.deltaSpace);
+		writeMat(r.body.inertia, comp.inertiaTersors);
+		r.radius = float(comp.shape.radius);
+		writeVec(r.pos, comp.shape.pos);
+	}
+}
+
+void SceneSerializer::loadSphereRigidBodies(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const SphereBodyRecord* records = reinterpret_cast<const SphereBodyRecord*>(data);
+	scene.sphereRigidBodyComponents.reserve(scene.sphereRigidBodyComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const SphereBodyRecord& r = records[i];
+		Entity id = relocator.getEntity(r.body.entity);
+		if (id == NULL_ENTITY) continue;
+
+		RigidBodyComponent<Sphere> comp(id, Sphere(r.radius, readVec3(r.pos)));
+		comp.xRot = (r.body.rotations & 1) != 0;
+		comp.yRot = (r.body.rotations & 2) != 0;
+		comp.zRot = (r.body.rotations & 4) != 0;
+		comp.fast = r.body.fast != 0;
+		comp.layer = r.body.layer;
+		comp.friction = r.body.friction;
+		comp.restitution = r.body.restitution;
+		comp.mass = r.body.mass;
+		comp.linearVelocity = readVec3(r.body.linearVelocity);
+		comp.forces = readVec3(r.body.forces);
+		comp.deltaSpace = readVec3(r.body.deltaSpace);
+		comp.inertiaTersors = readMat3(r.body.inertia);
+		if (!r.body.actived) comp.disable();
+
+		scene.sphereRigidBodyComponents.push_back(comp);
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveBoxRigidBodies(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<RigidBodyComponent<Box>>& pool = scene.boxRigidBodyComponents;
+	BoxBodyRecord* records = appendRecords<BoxBodyRecord>(blob, pool.getSize());
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const RigidBodyComponent<Box>& comp = pool[i];
+		BoxBodyRecord& r = records[i];
+		r.body.entity = comp.getEntityId();
+		r.body.actived = comp.isActived();
+		r.body.rotations = (comp.xRot ? 1 : 0) | (comp.yRot ? 2 : 0) | (comp.zRot ? 4 : 0);
+		r.body.fast = comp.fast;
+		r.body.layer = comp.layer;
+		r.body.friction = float(comp.friction);
+		r.body.restitution = float(comp.restitution);
+		r.body.mass = float(comp.mass);
+		writeVec(r.body.linearVelocity, comp.linearVelocity);
+		writeVec(r.body.forces, comp.forces);
+		writeVec(r.body.deltaSpace, comp.deltaSpace);
+		writeMat(r.body.inertia, comp.inertiaTersors);
+		writeVec(r.pos, comp.shape.pos);
+		writeVec(r.size, comp.shape.size);
+		for (int v = 0; v < 8; ++v)
+			writeVec(r.vertices + v * 3, comp.shape.vertices[v]);
+	}
+}
+
+void SceneSerializer::loadBoxRigidBodies(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const BoxBodyRecord* records = reinterpret_cast<const BoxBodyRecord*>(data);
+	scene.boxRigidBodyComponents.reserve(scene.boxRigidBodyComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const BoxBodyRecord& r = records[i];
+		Entity id = relocator.getEntity(r.body.entity);
+		if (id == NULL_ENTITY) continue;
+
+		Box box;
+		box.pos = readVec3(r.pos);
+		box.size = readVec3(r.size);
+		for (int v = 0; v < 8; ++v)
+			box.vertices[v] = readVec3(r.vertices + v * 3);
+
+		RigidBodyComponent<Box> comp(id, box);
+		comp.xRot = (r.body.rotations & 1) != 0;
+		comp.yRot = (r.body.rotations & 2) != 0;
+		comp.zRot = (r.body.rotations & 4) != 0;
+		comp.fast = r.body.fast != 0;
+		comp.layer = r.body.layer;
+		comp.friction = r.body.friction;
+		comp.restitution = r.body.restitution;
+		comp.mass = r.body.mass;
+		comp.linearVelocity = readVec3(r.body.linearVelocity);
+		comp.forces = readVec3(r.body.forces);
+		comp.deltaSpace = readVec3(r.body.deltaSpace);
+		comp.inertiaTersors = readMat3(r.body.inertia);
+		if (!r.body.actived) comp.disable();
+
+		scene.boxRigidBodyComponents.push_back(comp);
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveCharacters(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<CharacterComponent>& pool = scene.characterComponents;
+	CharacterRecord* records = appendRecords<CharacterRecord>(blob, pool.getSize());
+	ModelHandler& models = ModelHandler::instance();
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const CharacterComponent& comp = pool[i];
+		CharacterRecord& r = records[i];
+		r.entity = comp.getEntityId();
+		r.actived = comp.isActived();
+		r.movingSpeed = float(comp.movingSpeed);
+		r.runSpeedMultiplier = float(comp.runSpeedMultiplier);
+		r.jumpForce = float(comp.jumpForce);
+		r.jumpCooldown = comp.jumpCooldown;
+		r.maxHealth = float(comp.maxHealth);
+		r.health = float(comp.health);
+		r.maxMana = comp.maxMana;
+		r.mana = comp.mana;
+		r.maxEnergy = float(comp.maxEnergy);
+		r.energy = float(comp.energy);
+		r.enegyCostMultiplier = float(comp.enegyCostMultiplier);
+		r.energyRegenBoost = float(comp.energyRegenBoost);
+		r.xp = comp.xp;
+		r.lvl = comp.lvl;
+		r.charType = int32_t(comp.charType);
+		r.charState = int32_t(comp.charState);
+		r.charPreviouseState = int32_t(comp.charPreviouseState);
+		r.flags = (comp.walkUpActive ? 1 : 0) | (comp.walkDownActive ? 2 : 0) | (comp.walkLeftActive ? 4 : 0)
+			| (comp.walkRightActive ? 8 : 0) | (comp.running ? 16 : 0) | (comp.mustJump ? 32 : 0);
+		r.casting = comp.casting;
+		r.onGround = comp.onGround;
+		writeVec(r.direction, comp.direction);
+		r.speed = float(comp.speed);
+		r.model = models.getModelId(comp.model);
+		r.modelDirection = comp.modelDirection;
+		writeVec(r.pos, comp.pos);
+		r.currentAnimation = comp.currentAnimation;
+		r.animationTime = float(comp.animationTime);
+		r.currentRow = comp.currentRow;
+		r.currentColumn = comp.currentColumn;
+		r.playing = comp.playing;
+		r.frameCounter = comp.frameCounter;
+		for (int c = 0; c < MAX_NUM_OF_INTERACTABLE_OBJECTS; ++c)
+			r.childrenObjects[c] = comp.childrenObjects[c];
+	}
+}
+
+void SceneSerializer::loadCharacters(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const CharacterRecord* records = reinterpret_cast<const CharacterRecord*>(data);
+	scene.characterComponents.reserve(scene.characterComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const CharacterRecord& r = records[i];
+		Entity id = relocator.getEntity(r.entity);
+		if (id == NULL_ENTITY) continue;
+
+		CharacterComponent comp(id, r.charType);
+		comp.movingSpeed = r.movingSpeed;
+		comp.runSpeedMultiplier = r.runSpeedMultiplier;
+		comp.jumpForce = r.jumpForce;
+		comp.jumpCooldown = r.jumpCooldown;
+		comp.maxHealth = r.maxHealth;
+		comp.health = r.health;
+		comp.maxMana = r.maxMana;
+		comp.mana = r.mana;
+		comp.maxEnergy = r.maxEnergy;
+		comp.energy = r.energy;
+		comp.enegyCostMultiplier = r.enegyCostMultiplier;
+		comp.energyRegenBoost = r.energyRegenBoost;
+		comp.xp = r.xp;
+		comp.lvl = r.lvl;
+		comp.charState = CharacterState(r.charState);
+		comp.charPreviouseState = CharacterState(r.charPreviouseState);
+		comp.walkUpActive = (r.flags & 1) != 0;
+		comp.walkDownActive = (r.flags & 2) != 0;
+		comp.walkLeftActive = (r.flags & 4) != 0;
+		comp.walkRightActive = (r.flags & 8) != 0;
+		comp.running = (r.flags & 16) != 0;
+		comp.mustJump = (r.flags & 32) != 0;
+		comp.casting = r.casting;
+		comp.onGround = r.onGround;
+		comp.direction = readVec2(r.direction);
+		comp.speed = r.speed;
+		if (r.model >= 0) comp.setModel(relocator.getModel(r.model)); //also creates the bone transforms
+		comp.modelDirection = r.modelDirection;
+		comp.pos = readVec3(r.pos);
+		comp.currentAnimation = r.currentAnimation;
+		comp.animationTime = r.animationTime;
+		comp.currentRow = r.currentRow;
+		comp.currentColumn = r.currentColumn;
+		comp.playing = r.playing;
+		comp.frameCounter = r.frameCounter;
+		for (int c = 0; c < MAX_NUM_OF_INTERACTABLE_OBJECTS; ++c)
+			comp.childrenObjects[c] = relocator.getEntity(r.childrenObjects[c]);
+		if (!r.actived) comp.disable();
+
+		scene.characterComponents.push_back(comp);
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveModels(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<ModelComponent>& pool = scene.modelComponents;
+	ModelRecord* records = appendRecords<ModelRecord>(blob, pool.getSize());
+	ModelHandler& models = ModelHandler::instance();
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const ModelComponent& comp = pool[i];
+		ModelRecord& r = records[i];
+		r.entity = comp.getEntityId();
+		r.actived = comp.isActived();
+		r.model = models.getModelId(comp.model);
+		r.cullFace = comp.cullFace;
+		writeVec(r.pos, comp.pos);
+		r.currentRow = comp.currentRow;
+		r.currentColumn = comp.currentColumn;
+		r.playing = comp.playing;
+		r.frameCounter = comp.frameCounter;
+	}
+}
+
+void SceneSerializer::loadModels(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const ModelRecord* records = reinterpret_cast<const ModelRecord*>(data);
+	scene.modelComponents.reserve(scene.modelComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const ModelRecord& r = records[i];
+		Entity id = relocator.getEntity(r.entity);
+		if (id == NULL_ENTITY) continue;
+
+		ModelComponent comp(id);
+		if (r.model >= 0) comp.setModel(relocator.getModel(r.model));
+		comp.cullFace = r.cullFace != 0;
+		comp.pos = readVec3(r.pos);
+		comp.currentRow = r.currentRow;
+		comp.currentColumn = r.currentColumn;
+		comp.playing = r.playing;
+		comp.frameCounter = r.frameCounter;
+		if (!r.actived) comp.disable();
+
+		scene.modelComponents.push_back(comp);
+	}
+}
+
+
+//=================================================
+
+
+void SceneSerializer::saveInteractableObjects(Scene& scene, std::vector<unsigned char>& blob)
+{
+	ComponentPool<InteractableObjectComponent>& pool = scene.interactableObjectComponents;
+	InteractableRecord* records = appendRecords<InteractableRecord>(blob, pool.getSize());
+	ModelHandler& models = ModelHandler::instance();
+
+	for (int i = 0; i < pool.getSize(); ++i)
+	{
+		const InteractableObjectComponent& comp = pool[i];
+		InteractableRecord& r = records[i];
+		r.entity = comp.getEntityId();
+		r.actived = comp.isActived();
+		r.model = models.getModelId(comp.model);
+		r.holder = comp.holder;
+		r.caster = comp.caster;
+		writeMat(r.transform, comp.transform);
+		writeVec(r.hitBoxPos, comp.hitBox.pos);
+		writeVec(r.hitBoxSize, comp.hitBox.size);
+		for (int v = 0; v < 8; ++v)
+			writeVec(r.hitBoxVertices + v * 3, comp.hitBox.vertices[v]);
+		writeVec(r.pos, comp.pos);
+		r.currentAnimation = comp.currentAnimation;
+		r.animationTime = float(comp.animationTime);
+		r.playing = comp.playing;
+		r.frameCounter = comp.frameCounter;
+		r.currentRow = comp.currentRow;
+		r.currentColumn = comp.currentColumn;
+		r.currentEffect = int32_t(comp.currentEffect);
+		r.isEffectActive = comp.isEffectActive;
+		r.currentState = float(comp.currentState);
+		r.layer = comp.layer;
+	}
+}
+
+void SceneSerializer::loadInteractableObjects(const unsigned char* data, int n, Scene& scene, const Relocator& relocator)
+{
+	const InteractableRecord* records = reinterpret_cast<const InteractableRecord*>(data);
+	scene.interactableObjectComponents.reserve(scene.interactableObjectComponents.getSize() + n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const InteractableRecord& r = records[i];
+		Entity id = relocator.getEntity(r.entity);
+		if (id == NULL_ENTITY) continue;
+
+		InteractableObjectComponent comp;
+		comp.entityId = id;
+		if (r.model >= 0) comp.setModel(relocator.getModel(r.model));
+		comp.holder = relocator.getEntity(r.holder);
+		comp.caster = relocator.getEntity(r.caster);
+		comp.transform = readMat4(r.transform);
+		comp.hitBox.pos = readVec3(r.hitBoxPos);
+		comp.hitBox.size = readVec3(r.hitBoxSize);
+		for (int v = 0; v < 8; ++v)
+			comp.hitBox.vertices[v] = readVec3(r.hitBoxVertices + v * 3);
+		comp.pos = readVec3(r.pos);
+		comp.currentAnimation = r.currentAnimation;
+		comp.animationTime = r.animationTime;
+		comp.playing = r.playing;
+		comp.frameCounter = r.frameCounter;
+		comp.currentRow = r.currentRow;
+		comp.currentColumn = r.currentColumn;
+		comp.currentEffect = EffectType(r.currentEffect);
+		comp.isEffectActive = r.isEffectActive != 0;
+		comp.currentState = r.currentState;
+		comp.layer = r.layer;
+		if (!r.actived) comp.disable();
+
+		scene.interactableObjectComponents.push_back(comp);
+	}
+}
@@ -0,0 +1,145 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the SceneSerializer class, which saves
+a Scene to a binary file and loads it back, and the MappedFile class, used to read these files.
+	A scene file has a header(with a magic number, the format version and the position of each
+block), an entity table(the ids the entities had when the scene was saved) and one contiguous block
+of fixed size records for each component pool. Loading a scene is just mapping the file in memory
+and going through each block once, doing a relocation fix-up on the records: the saved entity ids are
+replaced by the ids of the new entities, and the Texture and Model references are replaced by pointers.
+These references are saved as indices in two path tables(the files the TextureHandler and ModelHandler
+loaded them from), so a scene doesn't depend on the order the assets are loaded in. The assets must be
+loaded before the scene, and a reference to one that isn't makes load() throw. Nothing is parsed.
+	The records only use fixed size types(floats and 32 bit integers), so a file is the same for the
+32 and 64 bit builds. A file saved with another SCENE_FILE_VERSION is refused.
+*/
+//#################################################################################
+
+#ifndef SCENE_SERIALIZER
+#define SCENE_SERIALIZER
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Entity.h"
+
+#include "GlobalDefines.h"
+
+
+#define SCENE_FILE_VERSION 5
+
+
+class Scene;
+
+
+//##################################################
+//MappedFile class declaration:
+
+
+/*
+	MappedFile - maps a whole file in memory(read only). The memory is released by the destructor
+*/
+class MappedFile
+{
+public:
+	MappedFile(const std::string&); //note: throws if the file cannot be opened
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* getData() const noexcept;
+	size_t getSize() const noexcept;
+
+private:
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+
+//##################################################
+//SceneSerializer class declaration:
+
+
+class SceneSerializer
+{
+public:
+
+	/*
+		save - write all the entities and components of the scene to the file.
+		Note: throws if the file cannot be written
+	*/
+	static void save(const std::string&, Scene&);
+
+	/*
+		load - add all the entities and components stored in the file to the scene(usually an empty one).
+		The new ids of the entities are appended to the vector, if it's not null, in the order they
+		were saved. If the last argument is false, no OpenGL call is made(so the scene can be loaded by a
+		worker thread), and createGpuResources() must be called later, by the thread that owns the context.
+		Note: throws if the file cannot be read, if it's not a valid scene file, or if it references a
+		Texture or Model that is not loaded(the entities added before that are not removed)
+	*/
+	static void load(const std::string&, Scene&, std::vector<Entity>* = nullptr, bool = true);
+
+	/*
+		createGpuResources - create the shadow maps of the lights loaded without them
+	*/
+	static void createGpuResources(Scene&);
+
+private:
+
+	SceneSerializer() = delete; //this class only has static functions
+
+	class Relocator; //the relocation fix-up done on load
+
+	//each of these appends the records of one pool to the blob:
+	static void saveTransforms(Scene&, std::vector<unsigned char>&);
+	static void saveImages(Scene&, std::vector<unsigned char>&);
+	static void saveDirLights(Scene&, std::vector<unsigned char>&);
+	static void savePointLights(Scene&, std::vector<unsigned char>&);
+	static void saveSphereRigidBodies(Scene&, std::vector<unsigned char>&);
+	static void saveBoxRigidBodies(Scene&, std::vector<unsigned char>&);
+	static void saveCharacters(Scene&, std::vector<unsigned char>&);
+	static void saveModels(Scene&, std::vector<unsigned char>&);
+	static void saveInteractableObjects(Scene&, std::vector<unsigned char>&);
+
+	//and each of these adds the components of n records(of one pool) to the scene:
+	static void loadTransforms(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadImages(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadDirLights(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadPointLights(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadSphereRigidBodies(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadBoxRigidBodies(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadCharacters(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadModels(const unsigned char*, int, Scene&, const Relocator&);
+	static void loadInteractableObjects(const unsigned char*, int, Scene&, const Relocator&);
+};
+
+
+#endif // !SCENE_SERIALIZER
@@ -0,0 +1,171 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+
+//the order of the bounds(for equal values the lower bounds come first, so touching boxes overlap):
+static inline bool boundLess(FLOAT_TYPE value1, int box1, FLOAT_TYPE value2, int box2) noexcept
+{
+	return value1 < value2 || (value1 == value2 && (box1 & 1) < (box2 & 1));
+}
+
+
+//SweepAndPrune definitions:
+
+
+void SweepAndPrune::update(const AABB* boxes, int n)
+{
+	PROFILE_ZONE("SweepAndPrune::update");
+
+	if (n != numOfBoxes) rebuild(boxes, n);
+	else
+	{
+		//the new values are written in the old order, which is almost the new one:
+		for (Bound& bound : bounds)
+		{
+			const AABB& box = boxes[bound.box >> 1];
+			bound.value = (bound.box & 1) ? box.max[axis] : box.min[axis];
+		}
+		insertionSort();
+	}
+
+	//--------------------------------------
+	//the sweep(a box is tested against the boxes that are open when its lower bound is reached):
+	pairs.clear();
+	active.clear();
+	activePosition.resize(n);
+	const int axis1 = (axis + 1) % 3;
+	const int axis2 = (axis + 2) % 3;
+
+	for (const Bound& bound : bounds)
+	{
+		int box = bound.box >> 1;
+		if (bound.box & 1) //upper bound, the box is closed
+		{
+			int position = activePosition[box];
+			active[position] = active.back();
+			activePosition[active[position].box] = position;
+			active.pop_back();
+			continue;
+		}
+
+		const AABB& bounds1 = boxes[box];
+		ActiveBox box1 = { bounds1.min[axis1], bounds1.max[axis1], bounds1.min[axis2], bounds1.max[axis2], box };
+		for (const ActiveBox& box2 : active)
+		{
+			//the active boxes overlap this one on the sweep axis(they began before it and didn't end yet):
+			bool overlap = (box1.min1 <= box2.max1) & (box2.min1 <= box1.max1) & (box1.min2 <= box2.max2) & (box2.min2 <= box1.max2);
+			if (overlap)
+				pairs.push_back(box < box2.box ? Pair{ box, box2.box } : Pair{ box2.box, box });
+		}
+
+		activePosition[box] = int(active.size());
+		active.push_back(box1);
+	}
+
+	//the same order the pairs had when all of them were tested:
+	std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) {
+		return a.first < b.first || (a.first == b.first && a.second < b.second);
+	});
+}
+
+
+//=================================================
+
+
+const std::vector<SweepAndPrune::Pair>& SweepAndPrune::getPairs() const noexcept
+{
+	return pairs;
+}
+
+void SweepAndPrune::clear() noexcept
+{
+	bounds.clear();
+	pairs.clear();
+	numOfBoxes = 0;
+}
+
+int SweepAndPrune::getSweepAxis() const noexcept
+{
+	return axis;
+}
+
+int SweepAndPrune::getNumOfSwaps() const noexcept
+{
+	return swaps;
+}
+
+
+//=================================================
+
+
+void SweepAndPrune::rebuild(const AABB* boxes, int n)
+{
+	numOfBoxes = n;
+	swaps = 0;
+
+	//sweep along the axis in which the centers vary the most(fewer boxes overlap on it):
+	glm::vec3 sum(0.0f), sumOfSquares(0.0f);
+	for (int i = 0; i < n; ++i)
+	{
+		glm::vec3 center = 0.5f * (boxes[i].min + boxes[i].max);
+		sum += center;
+		sumOfSquares += center * center;
+	}
+	glm::vec3 variance = n > 0 ? sumOfSquares / FLOAT_TYPE(n) - (sum * sum) / (FLOAT_TYPE(n) * FLOAT_TYPE(n)) : glm::vec3(0.0f);
+	axis = variance.x >= variance.y && variance.x >= variance.z ? 0 : (variance.y >= variance.z ? 1 : 2);
+
+	bounds.resize(2 * n);
+	for (int i = 0; i < n; ++i)
+	{
+		bounds[2 * i] = { boxes[i].min[axis], 2 * i };
+		bounds[2 * i + 1] = { boxes[i].max[axis], 2 * i + 1 };
+	}
+	std::sort(bounds.begin(), bounds.end(), [](const Bound& a, const Bound& b) {
+		return boundLess(a.value, a.box, b.value, b.box);
+	});
+}
+
+
+//=================================================
+
+
+void SweepAndPrune::insertionSort() noexcept
+{
+	swaps = 0;
+	for (int i = 1; i < int(bounds.size()); ++i)
+	{
+		Bound bound = bounds[i];
+		int j = i - 1;
+		while (j >= 0 && boundLess(bound.value, bound.box, bounds[j].value, bounds[j].box))
+		{
+			bounds[j + 1] = bounds[j];
+			--j;
+		}
+		swaps += i - 1 - j;
+		bounds[j + 1] = bound;
+	}
+}
@@ -0,0 +1,98 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the SweepAndPrune class, the broadphase used
+by the PhysicsEngine to find the pairs of box rigid bodies that may collide, so that the SAT test(see
+CollisionHandling.h) only runs for them.
+	The bounds of the AABBs on one axis(the one in which the bodies are most spread) are kept sorted between
+the steps. The bodies move little in each step, so the bounds are almost in order, and an insertion sort
+fixes them doing only one swap for each pair of bounds that passed each other. Then a sweep over the sorted
+bounds keeps the boxes whose interval contains the current bound, and tests only them on the other two axes.
+The cost of a step grows with the number of bodies plus the number of overlaps on the sweep axis, instead of
+with the square of the number of bodies.
+*/
+//#################################################################################
+
+#ifndef SWEEP_AND_PRUNE
+#define SWEEP_AND_PRUNE
+
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "PhysicalComponents.h"
+
+#include "GlobalDefines.h"
+
+
+class SweepAndPrune
+{
+public:
+
+	struct Pair //two overlapping boxes(the indices given to update(), with first < second)
+	{
+		int first;
+		int second;
+	};
+
+	/*
+		update - sort the bounds of the boxes again and find all the pairs that overlap. The boxes are
+		identified by their indices, so they must be given in the same order in each step(the bounds are
+		sorted from scratch only when the number of boxes changes). The pairs are sorted by their first
+		and then by their second index
+	*/
+	void update(const AABB* boxes, int numOfBoxes);
+	const std::vector<Pair>& getPairs() const noexcept;
+	void clear() noexcept; //forget the boxes(the next update() sorts the bounds from scratch)
+
+	int getSweepAxis() const noexcept; //0, 1 or 2(x, y or z)
+	int getNumOfSwaps() const noexcept; //the number of swaps done by the last insertion sort
+
+private:
+
+	struct Bound //the lower or upper bound of a box on the sweep axis
+	{
+		FLOAT_TYPE value;
+		int box; //the box index times two, plus one for the upper bound
+	};
+
+	void rebuild(const AABB*, int); //choose the sweep axis and sort the bounds with std::sort
+	void insertionSort() noexcept;
+
+	std::vector<Bound> bounds; //the two bounds of each box, sorted by value(lower bounds first if equal)
+	struct ActiveBox //the bounds of an active box on the other two axes(they always overlap on the sweep axis)
+	{
+		FLOAT_TYPE min1, max1;
+		FLOAT_TYPE min2, max2;
+		int box;
+	};
+
+	std::vector<ActiveBox> active; //the boxes whose interval contains the current bound(during the sweep)
+	std::vector<int> activePosition; //position of each box in active
+	std::vector<Pair> pairs;
+
+	int numOfBoxes = 0;
+	int axis = 0;
+	int swaps = 0;
+};
+
+
+#endif // !SWEEP_AND_PRUNE
@@ -20,6 +20,7 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "Texture.h"
+#include "GraphicsBackend.h"
 
 
 
@@ -31,6 +32,17 @@ Texture::Texture(std::string path, bool flipUVs)
 
 	std::cout << "Loading Texture: " << path << '\n';
 
+	if (GraphicsBackend::isNull()) //only the size is needed
+	{
+		if (!stbi_info(path.c_str(), &xSize, &ySize, &numOfChannels))
+		{
+			std::cerr << "->ERROR::CANNOT LOAD THE TEXTURE FROM FILE: " << path << ";\n";
+			throw std::logic_error("ERROR::FAILED TO LOAD TEXTURE FROM FILE IN Texture::Texture();\n");
+		}
+		format = numOfChannels == 1 ? GL_RED : numOfChannels == 3 ? GL_RGB : GL_RGBA;
+		return;
+	}
+
 	//generate a texture:
 	glGenTextures(1, &glId);
 	glBindTexture(GL_TEXTURE_2D, glId);
@@ -20,6 +20,7 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "TextureHandler.h"
+#include "Profiler.h"
 
 
 
@@ -32,14 +33,18 @@ gabrielgf6000@gmail.com
 TextureHandler::TextureHandler()
 {
 	textures.reserve(100);
+	paths.reserve(100);
 }
 
 
 void TextureHandler::addTexture(std::string path)
 //path should be relative to the project folder
 {
+	PROFILE_ZONE("TextureHandler::addTexture");
+
 	Texture texture(path);
 	textures.push_back(texture); 
+	paths.push_back(path);
 }
 
 const Texture* TextureHandler::get(int i)
@@ -52,4 +57,37 @@ const Texture* TextureHandler::get(int i)
 	myAssert(!(i >= textures.size()));
 	
 	return &textures[i];
-}
\ No newline at end of file
+}
+
+
+int TextureHandler::getIndex(const Texture* tex) const noexcept
+{
+	if (!tex || textures.empty()) return -1;
+
+	//the textures are stored in a vector, so the index is just the pointer offset:
+	if (tex < textures.data() || tex >= textures.data() + textures.size()) return -1;
+	return int(tex - textures.data());
+}
+
+
+int TextureHandler::getNumOfTextures() const noexcept
+{
+	return int(textures.size());
+}
+
+
+const std::string& TextureHandler::getPath(int i) const
+{
+	if (i < 0 || i >= int(paths.size()))
+		throw std::logic_error("ERROR::INVALID ARGUMENT PASSED TO TextureHandler::getPath();\n");
+
+	return paths[i];
+}
+
+
+int TextureHandler::findIndex(const std::string& path) const noexcept
+{
+	for (size_t i = 0; i < paths.size(); ++i)
+		if (paths[i] == path) return int(i);
+	return -1;
+}
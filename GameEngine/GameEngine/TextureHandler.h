@@ -34,6 +34,7 @@ TextureHandler class, that is used to load, store and manage all textures in the
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 #include "stb_image.h"
 #include "glad/glad.h"
@@ -68,10 +69,15 @@ public:
 
 	void addTexture(std::string); //construct and store a texture
 	const Texture* get(int i);  //returns textures[i]; note that i < 0 will give a nullptr
+	int getIndex(const Texture*) const noexcept; //the inverse of get(): returns -1 for nullptr or textures not stored here
+	int getNumOfTextures() const noexcept;
+	const std::string& getPath(int) const; //the path passed to addTexture()
+	int findIndex(const std::string&) const noexcept; //the index of the texture loaded from the path(-1 if there's none)
 
 private:
 	TextureHandler(); //this class is a singleton
 	std::vector<Texture> textures;
+	std::vector<std::string> paths; //paths[i] is the path textures[i] was loaded from
 	
 };
 
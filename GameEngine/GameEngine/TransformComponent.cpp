@@ -20,6 +20,8 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "TransformComponent.h"
+#include "ComponentPool.h"
+#include "MathKernels.h"
 
 
 
@@ -48,6 +50,7 @@ TransformComponent::TransformComponent()
 void TransformComponent::setTransform(glm::mat4 t) noexcept
 {
 	transform = t;
+	markDirty();
 }
 
 
@@ -63,7 +66,36 @@ void TransformComponent::update()
 
 void TransformComponent::setParent(Entity id)
 {
+	if (id == parent) return;
+	myAssert(id != getEntityId());
+
+	//remove this from the children of the old parent:
+	TransformComponent* oldParent = findTransform(parent);
+	if (oldParent)
+	{
+		std::vector<Entity>& siblings = oldParent->children;
+		for (size_t i = 0; i < siblings.size(); ++i)
+			if (siblings[i] == getEntityId()) { siblings[i] = siblings.back(); siblings.pop_back(); break; }
+	}
+
 	parent = id;
+
+	//and add it to the children of the new one:
+	TransformComponent* newParent = findTransform(parent);
+	if (newParent)
+		newParent->children.push_back(getEntityId());
+
+	if (pool) pool->touch(); //the hierarchy has changed
+
+	markDirty();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TransformComponent::setPool(ComponentPool<TransformComponent>* p) noexcept
+{
+	pool = p;
+	markDirty();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -87,6 +119,7 @@ void TransformComponent::setOrientation(FLOAT_TYPE angle, glm::vec3 n) noexcept
 		glm::vec3(0.0, scale.y, 0.0f),
 		glm::vec3(0.0f, 0.0f, scale.z)) * glm::toMat3(orientation);
 	transform[3] = glm::vec4(translation, 1.0f);
+	markDirty();
 }
 
 
@@ -103,6 +136,7 @@ void TransformComponent::setOrientation(glm::quat newOrientation) noexcept
 		glm::vec3(0.0, scale.y, 0.0f),
 		glm::vec3(0.0f, 0.0f, scale.z)) * glm::toMat3(orientation);
 	transform[3] = glm::vec4(translation, 1.0f);
+	markDirty();
 }
 
 
@@ -123,6 +157,7 @@ void TransformComponent::rotate(FLOAT_TYPE angle, glm::vec3 n) noexcept
 		glm::vec3(0.0, scale.y, 0.0f),
 		glm::vec3(0.0f, 0.0f, scale.z)));
 	transform[3] = glm::vec4(translation, 1.0f);
+	markDirty();
 	
 }
 
@@ -140,6 +175,7 @@ void TransformComponent::rotate(glm::quat rot) noexcept
 		glm::vec3(0.0, scale.y, 0.0f),
 		glm::vec3(0.0f, 0.0f, scale.z)));
 	transform[3] = glm::vec4(translation, 1.0f);
+	markDirty();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -149,6 +185,7 @@ void TransformComponent::move(glm::vec3 mv) noexcept
 {
 	translation += mv;
 	transform[3] = glm::vec4(translation, 1.0f); 
+	markDirty();
 }
 
 
@@ -164,6 +201,7 @@ void TransformComponent::setScale(glm::vec3 s) noexcept
 		glm::vec3(0.0, scale.y, 0.0f),
 		glm::vec3(0.0f, 0.0f, scale.z));
 	transform[3] = glm::vec4(translation, 1.0f);
+	markDirty();
 }
 
 
@@ -174,6 +212,7 @@ void TransformComponent::setPosition(glm::vec3 m) noexcept
 {
 	translation = m;
 	transform[3] = glm::vec4(translation, 1.0f); //update just the fourth collum of the transform matrix
+	markDirty();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -211,4 +250,140 @@ glm::mat4 TransformComponent::getScaledTransform(glm::vec3 s) const noexcept
 
 
 	return t;
-}
\ No newline at end of file
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+glm::mat4 TransformComponent::getWorldTransform() const noexcept
+{
+	updateWorld();
+	return worldTransform;
+}
+
+glm::mat4 TransformComponent::getRigidWorldTransform() const noexcept
+{
+	updateWorld();
+	return rigidWorldTransform;
+}
+
+glm::mat4 TransformComponent::getParentWorldTransform() const noexcept
+{
+	updateWorld();
+	return parentWorldTransform;
+}
+
+glm::quat TransformComponent::getWorldOrientation() const noexcept
+{
+	updateWorld();
+	return worldOrientation;
+}
+
+bool TransformComponent::isWorldDirty() const noexcept
+{
+	return worldDirty;
+}
+
+const std::vector<Entity>& TransformComponent::getChildren() const noexcept
+{
+	return children;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformComponent::markDirty() noexcept
+{
+	logChange();
+
+	//a dirty transform always has dirty children(a child can only be updated after its parent), so
+	//there's no need to go down a subtree that is already dirty:
+	if (worldDirty) return;
+
+	worldDirty = true;
+	for (Entity child : children)
+	{
+		TransformComponent* childComp = findTransform(child);
+		if (childComp) childComp->markDirty();
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformComponent::logChange() noexcept
+{
+	//like the dirty flag, there's no need to go down a subtree that is already logged:
+	if (logged || !changeLog) return;
+
+	logged = true;
+	changeLog->push_back(getEntityId());
+	for (Entity child : children)
+	{
+		TransformComponent* childComp = findTransform(child);
+		if (childComp) childComp->logChange();
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformComponent::updateWorld() const noexcept
+{
+	if (!worldDirty) return;
+
+	const TransformComponent* parentComp = findTransform(parent);
+	if (parentComp)
+	{
+		//the parent's scale doesn't affect its children, so use its transform without scale:
+		parentWorldTransform = parentComp->getRigidWorldTransform();
+		worldOrientation = parentComp->getWorldOrientation() * orientation;
+	}
+	else
+	{
+		parentWorldTransform = glm::mat4(1.0f);
+		worldOrientation = orientation;
+	}
+
+	//remove the scale, by normalizing the columns of the 3x3 uper matrix:
+	glm::mat4 rigidTransform = transform;
+	normalizeRows3(rigidTransform);
+
+	multiplyMat4(parentWorldTransform, transform, worldTransform);
+	multiplyMat4(parentWorldTransform, rigidTransform, rigidWorldTransform);
+	worldDirty = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformComponent::unlinkHierarchy() noexcept
+{
+	//the children become relative to world coordinates:
+	for (Entity child : children)
+	{
+		TransformComponent* childComp = findTransform(child);
+		if (!childComp) continue;
+		childComp->parent = -1;
+		childComp->markDirty();
+	}
+	children.clear();
+	if (pool) pool->touch();
+
+	setParent(-1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+TransformComponent* TransformComponent::findTransform(Entity id) const noexcept
+{
+	if (id < 0 || !pool) return nullptr;
+	return pool->getByEntity(id);
+}
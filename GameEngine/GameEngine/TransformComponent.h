@@ -19,6 +19,10 @@ gabrielgf6000@gmail.com
 
 
 The TransformComponent store the position, rotation and scale data about an object.
+	It also caches its world space transform(the combination with all its parents). The cache is
+marked dirty by every function that changes the transform or the parent, and the dirty flag is
+propagated to the children, so the world transforms are only recomputed(when read) for the
+subtrees that changed since the last frame.
 */
 //#############################################################################################
 
@@ -33,13 +37,22 @@ The TransformComponent store the position, rotation and scale data about an obje
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/euler_angles.hpp>
+#include <vector>
 #include "Entity.h"
 
 #include "GlobalDefines.h"
 
 
+template<typename T>
+class ComponentPool;
+
+
 class TransformComponent : public Component
 {
+	friend class Scene;
+	friend class TransformHierarchy;
+	friend class SceneSerializer;
+
 public:
 
 	TransformComponent(Entity);
@@ -49,6 +62,7 @@ public:
 	void update();
 
 	void setParent(Entity); //! put this function on world instead of here
+	void setPool(ComponentPool<TransformComponent>*) noexcept; //the pool used to find the parent and the children
 	Entity getParent() const noexcept; 
 
 	void setTransform(glm::mat4) noexcept;
@@ -71,6 +85,14 @@ public:
 	glm::mat4 getTransform() const noexcept;
 
 	glm::mat4 getScaledTransform(glm::vec3) const noexcept;
+
+	//world space transforms(read from the cache, recomputed only if this or a parent changed):
+	glm::mat4 getWorldTransform() const noexcept; //parents(without scale) * transform
+	glm::mat4 getRigidWorldTransform() const noexcept; //the same, but without this object's scale too
+	glm::mat4 getParentWorldTransform() const noexcept; //parents(without scale), identity for root objects
+	glm::quat getWorldOrientation() const noexcept; //parents orientation * orientation
+	bool isWorldDirty() const noexcept;
+	const std::vector<Entity>& getChildren() const noexcept;
 	
 
 private:
@@ -82,6 +104,27 @@ private:
 	glm::vec3 scale = glm::vec3(1.0f, 1.0f, 1.0f);
 
 	glm::mat4 transform; //a matrix that contains all the other three transformations
+
+	//hierarchy:
+	ComponentPool<TransformComponent>* pool = nullptr; //the pool of the scene that owns this transform
+	std::vector<Entity> children;
+
+	//world transform cache:
+	mutable glm::mat4 parentWorldTransform = glm::mat4(1.0f);
+	mutable glm::mat4 worldTransform = glm::mat4(1.0f);
+	mutable glm::mat4 rigidWorldTransform = glm::mat4(1.0f);
+	mutable glm::quat worldOrientation = glm::quat(1, glm::vec3(0.0f));
+	mutable bool worldDirty = true;
+
+	//change log(see Scene::collectChangedTransforms()):
+	std::vector<Entity>* changeLog = nullptr; //the list of the changed transforms of the scene that owns this one
+	bool logged = false; //if it's in the list(a logged transform always has logged children)
+
+	void markDirty() noexcept; //mark this transform and all its descendants
+	void logChange() noexcept; //add this transform and all its descendants to the change log
+	void updateWorld() const noexcept; //recompute the cache(and the parent's cache, if needed)
+	void unlinkHierarchy() noexcept; //remove this transform from the hierarchy(its children become roots)
+	TransformComponent* findTransform(Entity) const noexcept;
 };
 
 
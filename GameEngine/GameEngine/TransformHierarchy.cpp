@@ -0,0 +1,246 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "TransformHierarchy.h"
+#include "Profiler.h"
+#include "MathKernels.h"
+#include "JobSystem.h"
+
+
+
+//TransformHierarchy definitions:
+
+
+void TransformHierarchy::update(ComponentPool<TransformComponent>& pool)
+{
+	PROFILE_ZONE("TransformHierarchy::update");
+
+	prepare(pool);
+
+	//the levels are done in order, but the objects of each level are split between the job system threads:
+	for (int level = 0; level < getNumOfLevels(); ++level)
+		JobSystem::instance().parallelFor(getLevelBegin(level), getLevelEnd(level), TRANSFORM_HIERARCHY_GRAIN_SIZE,
+			[this](int first, int last) { updateRange(first, last); });
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformHierarchy::prepare(ComponentPool<TransformComponent>& pool)
+{
+	if (!isInSync(pool))
+		rebuild(pool);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformHierarchy::updateRange(int first, int last) noexcept
+{
+	const glm::mat4 identity(1.0f);
+
+	//gather the local data of the dirty objects:
+	for (int i = first; i < last; ++i)
+	{
+		const TransformComponent* comp = components[i];
+		recomputed[i] = comp->worldDirty;
+		if (!recomputed[i]) continue; //the cache is up to date
+
+		localTransforms[i] = comp->transform;
+		localOrientations[i] = comp->orientation;
+	}
+
+	//compute their world data. The parent is in a previous level, so its world transform is already computed(in
+	//this pass, or before it, in which case it's read from the parent's cache):
+	for (int i = first; i < last; ++i)
+	{
+		if (!recomputed[i]) continue;
+
+		int parent = parentIndices[i];
+		const glm::mat4& parentWorld = parent < 0 ? identity
+			: recomputed[parent] ? rigidWorldTransforms[parent] : components[parent]->rigidWorldTransform;
+
+		glm::mat4 rigidTransform = localTransforms[i];
+		normalizeRows3(rigidTransform); //the parent's scale doesn't affect its children
+
+		parentWorldTransforms[i] = parentWorld;
+		multiplyMat4(parentWorld, localTransforms[i], worldTransforms[i]);
+		multiplyMat4(parentWorld, rigidTransform, rigidWorldTransforms[i]);
+
+		if (parent < 0)
+			worldOrientations[i] = localOrientations[i];
+		else
+			worldOrientations[i] = (recomputed[parent] ? worldOrientations[parent] : components[parent]->worldOrientation)
+				* localOrientations[i];
+	}
+
+	//and write them back to the caches:
+	for (int i = first; i < last; ++i)
+	{
+		if (!recomputed[i]) continue;
+
+		TransformComponent* comp = components[i];
+		comp->parentWorldTransform = parentWorldTransforms[i];
+		comp->worldTransform = worldTransforms[i];
+		comp->rigidWorldTransform = rigidWorldTransforms[i];
+		comp->worldOrientation = worldOrientations[i];
+		comp->worldDirty = false;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+int TransformHierarchy::getNumOfLevels() const noexcept
+{
+	return levelOffsets.empty() ? 0 : int(levelOffsets.size()) - 1;
+}
+
+int TransformHierarchy::getLevelBegin(int level) const noexcept
+{
+	return levelOffsets[level];
+}
+
+int TransformHierarchy::getLevelEnd(int level) const noexcept
+{
+	return levelOffsets[level + 1];
+}
+
+int TransformHierarchy::getSize() const noexcept
+{
+	return int(components.size());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformHierarchy::clear() noexcept
+{
+	components.clear();
+	parentIndices.clear();
+	recomputed.clear();
+	localTransforms.clear();
+	localOrientations.clear();
+	parentWorldTransforms.clear();
+	worldTransforms.clear();
+	rigidWorldTransforms.clear();
+	worldOrientations.clear();
+	levelOffsets.clear();
+	builtFrom = nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool TransformHierarchy::isInSync(const ComponentPool<TransformComponent>& pool) const noexcept
+//check if no TransformComponent was added, removed or had its parent changed since the last rebuild
+//(if so, the pointers to the components are still valid too)
+{
+	return builtFrom == &pool && builtVersion == pool.getVersion();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void TransformHierarchy::rebuild(ComponentPool<TransformComponent>& pool)
+{
+	PROFILE_ZONE("TransformHierarchy::rebuild");
+
+	clear();
+	builtFrom = &pool;
+	builtVersion = pool.getVersion();
+
+	int n = pool.getSize();
+	if (n == 0) return;
+
+	//find the depth of each component(in the pool order):
+	TransformComponent* first = &pool[0];
+	std::vector<int> parentOf(n, -1);
+	std::vector<int> depths(n, -1);
+	for (int i = 0; i < n; ++i)
+	{
+		const TransformComponent* parent = pool.getByEntity(pool[i].getParent());
+		if (parent) parentOf[i] = int(parent - first);
+	}
+
+	std::vector<int> path;
+	int numOfLevels = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		//go up until a component whose depth is already known(or a root) is found:
+		int current = i;
+		while (current >= 0 && depths[current] < 0)
+		{
+			path.push_back(current);
+			current = parentOf[current];
+			if (int(path.size()) > n) //there's a cycle in the hierarchy
+			{
+				myAssert(false);
+				current = -1;
+				break;
+			}
+		}
+
+		int depth = current >= 0 ? depths[current] : -1;
+		while (!path.empty())
+		{
+			depths[path.back()] = ++depth;
+			path.pop_back();
+		}
+		if (depths[i] + 1 > numOfLevels) numOfLevels = depths[i] + 1;
+	}
+
+	//sort them by depth(counting sort, so the pool order is kept inside each level):
+	levelOffsets.assign(numOfLevels + 1, 0);
+	for (int i = 0; i < n; ++i)
+		++levelOffsets[depths[i] + 1];
+	for (int level = 0; level < numOfLevels; ++level)
+		levelOffsets[level + 1] += levelOffsets[level];
+
+	std::vector<int> positions(n);
+	std::vector<int> nextPosition(levelOffsets.begin(), levelOffsets.end() - 1);
+	for (int i = 0; i < n; ++i)
+		positions[i] = nextPosition[depths[i]]++;
+
+	//and fill the arrays:
+	components.resize(n);
+	parentIndices.resize(n);
+	recomputed.resize(n);
+	localTransforms.resize(n);
+	localOrientations.resize(n);
+	parentWorldTransforms.resize(n);
+	worldTransforms.resize(n);
+	rigidWorldTransforms.resize(n);
+	worldOrientations.resize(n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		int position = positions[i];
+		components[position] = &pool[i];
+		parentIndices[position] = parentOf[i] >= 0 ? positions[parentOf[i]] : -1;
+	}
+}
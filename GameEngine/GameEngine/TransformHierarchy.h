@@ -0,0 +1,96 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+
+
+This header is part of a self made game engine. It declares the TransformHierarchy class, which
+computes the world transform of all the TransformComponents of a scene in one linear pass.
+	The transforms are stored in contiguous arrays(one for each kind of data: the local matrix, the local
+orientation, the world matrices and the world orientation) sorted by depth, so every parent comes before
+its children and the world transform of a child is just its parent's(already computed) world transform
+times its own. The objects of the same depth are a contiguous range(a level), and the objects of a level
+don't depend on each other, so each level can be split between threads.
+	Each range is done in three loops: the local data of the dirty TransformComponents is gathered into
+the arrays, the world data is computed on the arrays alone, and the results are written back to the
+TransformComponents cache, so getWorldTransform() and the others don't have to recompute anything after
+the pass. Only the dirty objects are gathered, computed and written back.
+*/
+//#################################################################################
+
+#ifndef TRANSFORM_HIERARCHY
+#define TRANSFORM_HIERARCHY
+
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "ComponentPool.h"
+#include "Entity.h"
+#include "TransformComponent.h"
+
+#include "GlobalDefines.h"
+
+
+#define TRANSFORM_HIERARCHY_GRAIN_SIZE 1024 //number of objects updated by each job
+
+
+class TransformHierarchy
+{
+public:
+
+	void update(ComponentPool<TransformComponent>&); //update the world transform of all the dirty TransformComponents
+
+	//the update split in steps, so that the levels can be given to different threads:
+	void prepare(ComponentPool<TransformComponent>&); //rebuild the arrays, if the hierarchy has changed
+	void updateRange(int, int) noexcept; //update the objects in [first, last). They must be in the same level
+	int getNumOfLevels() const noexcept;
+	int getLevelBegin(int) const noexcept;
+	int getLevelEnd(int) const noexcept;
+
+	int getSize() const noexcept;
+	void clear() noexcept;
+
+private:
+
+	//sorted by depth(parents before children):
+	std::vector<TransformComponent*> components; //valid while the pool's version doesn't change
+	std::vector<int> parentIndices; //the position of the parent in these arrays(-1 for root objects)
+	std::vector<char> recomputed; //true if the object was recomputed in the current pass(so its data below is valid)
+
+	//gathered from the dirty components:
+	std::vector<glm::mat4> localTransforms;
+	std::vector<glm::quat> localOrientations;
+
+	//computed by the pass(and written back to the components):
+	std::vector<glm::mat4> parentWorldTransforms;
+	std::vector<glm::mat4> worldTransforms;
+	std::vector<glm::mat4> rigidWorldTransforms; //world transforms without scale, read by the children
+	std::vector<glm::quat> worldOrientations;
+
+	std::vector<int> levelOffsets; //the objects of depth d are in [levelOffsets[d], levelOffsets[d + 1])
+
+	const ComponentPool<TransformComponent>* builtFrom = nullptr; //the pool and its version when the arrays were built
+	unsigned int builtVersion = 0;
+
+	bool isInSync(const ComponentPool<TransformComponent>&) const noexcept;
+	void rebuild(ComponentPool<TransformComponent>&);
+};
+
+
+#endif // !TRANSFORM_HIERARCHY
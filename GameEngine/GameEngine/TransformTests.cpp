@@ -0,0 +1,130 @@
+//#############################################################################################
+/*
+Copyright[2020][Gabriel G. Fernandes]
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http ://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissionsand
+limitations under the License.
+
+by Gabriel G. Fernandes 19/12/2020
+gabrielgf6000@gmail.com
+*/
+//#############################################################################################
+
+#include "Benchmark.h"
+
+#include "ComponentPool.h"
+#include "Entity.h"
+#include "TransformComponent.h"
+#include "TransformHierarchy.h"
+#include "MathKernels.h"
+#include "BenchmarkHelpers.h"
+
+
+void benchmarkTransformHierarchy()
+{
+	const int sizes[] = { 50, 500, 5000, 50000, 100000 };
+	const int chainLenght = 8;
+
+	std::cout << "TransformHierarchy(chains of " << chainLenght << " objects):\n";
+
+	for (int n : sizes)
+	{
+		EntityAllocator allocator;
+		ComponentPool<TransformComponent> pool(n, TransformComponent());
+		TransformHierarchy hierarchy;
+
+		for (int i = 0; i < n; ++i)
+		{
+			Entity id = allocator.create();
+			TransformComponent tComp(id);
+			tComp.setPool(&pool);
+			pool.push_back(tComp);
+
+			TransformComponent* comp = pool.getByEntity(id);
+			comp->setPosition(glm::vec3(1.0f, 0.5f, 0.0f));
+			comp->rotate(10.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+			comp->setScale(glm::vec3(1.5f));
+			if (i % chainLenght != 0) comp->setParent(id - 1);
+		}
+
+		//--------------------------------------
+		//walking the parents of each object(what the full transform functions used to do):
+		int rounds = 200000 / n + 1;
+		FLOAT_TYPE sum = 0.0f;
+		auto start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			for (int i = 0; i < pool.getSize(); ++i)
+			{
+				const TransformComponent* current = &pool[i];
+				glm::mat4 fullTransform = current->getTransform();
+				while (current->getParent() >= 0)
+				{
+					current = pool.getByEntity(current->getParent());
+					glm::mat4 parentTransform = current->getTransform();
+					normalizeRows3(parentTransform);
+					fullTransform = parentTransform * fullTransform;
+				}
+				sum += fullTransform[3][0];
+			}
+		double walkCost = nanosecondsSince(start) / (double(rounds) * n);
+		benchmarkSink = sum;
+
+		//--------------------------------------
+		//the flattened pass(with every object dirty, as if all of them had moved):
+		hierarchy.update(pool); //build the arrays
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (int i = 0; i < pool.getSize(); i += chainLenght)
+				pool[i].move(glm::vec3(0.0f)); //marks the whole chain dirty
+			hierarchy.update(pool);
+		}
+		double passCost = nanosecondsSince(start) / (double(rounds) * n);
+		benchmarkSink = pool.back().getWorldTransform()[3][0];
+
+		//and with nothing moved(only the dirty flags are read):
+		start = BenchClock::now();
+		for (int r = 0; r < rounds; ++r)
+			hierarchy.update(pool);
+		double cleanPassCost = nanosecondsSince(start) / (double(rounds) * n);
+
+		//the cached world transforms must be the ones found by walking the parents:
+		int wrong = 0;
+		for (int i = 0; i < pool.getSize(); ++i)
+		{
+			const TransformComponent* current = &pool[i];
+			glm::mat4 fullTransform = current->getTransform();
+			while (current->getParent() >= 0)
+			{
+				current = pool.getByEntity(current->getParent());
+				glm::mat4 parentTransform = current->getTransform();
+				normalizeRows3(parentTransform);
+				fullTransform = parentTransform * fullTransform;
+			}
+
+			glm::mat4 cached = pool[i].getWorldTransform();
+			for (int c = 0; c < 4; ++c)
+				if (glm::length(cached[c] - fullTransform[c]) > 0.001f)
+				{
+					++wrong;
+					break;
+				}
+		}
+
+		std::cout << "  N = " << n
+			<< ", parent walk: " << walkCost << " ns/obj"
+			<< ", hierarchy pass(all moved): " << passCost << " ns/obj"
+			<< ", hierarchy pass(none moved): " << cleanPassCost << " ns/obj"
+			<< ", levels: " << hierarchy.getNumOfLevels()
+			<< ", world transforms: " << checkResult(wrong == 0) << '\n';
+	}
+}
@@ -20,6 +20,11 @@ gabrielgf6000@gmail.com
 //#############################################################################################
 
 #include "World.h"
+#include "Profiler.h"
+#include "SceneSerializer.h"
+
+#include <chrono>
+#include <memory>
 
 
 //Scene class definitions:
@@ -46,32 +51,13 @@ Scene::Scene(int id)
 
 Entity Scene::createEntity() noexcept
 {
-	Entity id = 0; 
-	auto next = entities.begin();
-	
-	for (auto iter = entities.begin(); iter != entities.end(); ++iter)
-	{
-		next = iter;
-		++next;
-
-		if (next == entities.end()) //no gap found, so put it at the end
-		{
-			++id;
-			break;
-		}
-
-		if (*next - *iter > 1) //if there's a gap between two elements
-		{
-			id = (*iter) + 1;
-			break;
-		}
-		++id;
-	}
-
-	entities.insert(id); //no elements in the entities set
+	Entity id = entities.create(); //O(1), the indices of deleted entities are reused
+	myAssert(id != NULL_ENTITY);
 
 	//Attach a Transform Component to it:
 	TransformComponent tComp(id);
+	tComp.changeLog = &changedTransforms;
+	tComp.setPool(&transformComponents); //used to find its parent and children
 	transformComponents.push_back(tComp);
 
 	return id;
@@ -85,58 +71,83 @@ void Scene::deleteEntity(Entity id)
 {
 	myAssert(getEntity(id));
 
-	//remove all of it's components:
-	
-	//transform component:
-	for(int i = 0; i < transformComponents.getSize(); ++i)
-		if (transformComponents[i].getEntityId() == id) { transformComponents.erase(i); break; }
+	//its children become relative to world coordinates(instead of pointing to a deleted parent):
+	getTransformComponent(id)->unlinkHierarchy();
 
-	//image component:
-	for(int i = 0; i < imageComponents.getSize(); ++i)
-		if (imageComponents[i].getEntityId() == id) { imageComponents.erase(i); break; }
+	//remove all of it's components(each pool finds the entity's component through its sparse set):
+	transformComponents.eraseEntity(id);
+	imageComponents.eraseEntity(id);
+	dirLightComponents.eraseEntity(id);
+	pointLightComponents.eraseEntity(id);
+	sphereRigidBodyComponents.eraseEntity(id);
+	boxRigidBodyComponents.eraseEntity(id);
+	characterComponents.eraseEntity(id);
+	modelComponents.eraseEntity(id);
+	interactableObjectComponents.eraseEntity(id);
 
-	//dirLight component:
-	for (int i = 0; i < dirLightComponents.getSize(); ++i)
-		if (dirLightComponents[i].getEntityId() == id) { dirLightComponents.erase(i); break; }
 
-	//pointLight component:
-	for (int i = 0; i < pointLightComponents.getSize(); ++i)
-		if (pointLightComponents[i].getEntityId() == id) { pointLightComponents.erase(i); break; }
+	entities.destroy(id); //remove it from the Entities container(this invalidates the id)
+}
+
 
-	//sphereRigidBody component:
-	for(int i = 0; i < sphereRigidBodyComponents.getSize(); ++i)
-		if (sphereRigidBodyComponents[i].getEntityId() == id) { sphereRigidBodyComponents.erase(i); break; }
+//==================================================================================================
 
-	//boxRigidBody component:
-	for (int i = 0; i < boxRigidBodyComponents.getSize(); ++i)
-		if (boxRigidBodyComponents[i].getEntityId() == id) { boxRigidBodyComponents.erase(i); break; }
 
-	//character component:
-	for (int i = 0; i < characterComponents.getSize(); ++i)
-		if (characterComponents[i].getEntityId() == id) { characterComponents.erase(i); break; }
+bool Scene::getEntity(Entity id) const noexcept
+{
+	return entities.isAlive(id);
+}
 
-	//model component:
-	for(int i = 0; i < modelComponents.getSize(); ++i)
-		if (modelComponents[i].getEntityId() == id) { modelComponents.erase(i); break; }
 
-	//interactableObject component:
-	for (int i = 0; i < interactableObjectComponents.getSize(); ++i)
-		if (interactableObjectComponents[i].getEntityId() == id) { interactableObjectComponents.erase(i); break; }
+//==================================================================================================
 
 
-	entities.erase(id); //remove it from the Entities container
+template<typename T>
+static int releaseBack(ComponentPool<T>& pool, int n) noexcept
+//remove up to n components from the end of the pool(which doesn't move any other component)
+{
+	int released = 0;
+	while (released < n && pool.getSize() > 0)
+	{
+		pool.erase(pool.getSize() - 1);
+		++released;
+	}
+	return released;
 }
 
 
-//==================================================================================================
+int Scene::releaseComponents(int n)
+//used to free a Scene over several frames. The lights go first, since they own GPU memory
+{
+	int released = 0;
+	while (released < n && dirLightComponents.getSize() > 0)
+	{
+		dirLightComponents.back().clearMemory();
+		dirLightComponents.erase(dirLightComponents.getSize() - 1);
+		++released;
+	}
+	while (released < n && pointLightComponents.getSize() > 0)
+	{
+		pointLightComponents.back().clearMemory();
+		pointLightComponents.erase(pointLightComponents.getSize() - 1);
+		++released;
+	}
 
+	released += releaseBack(imageComponents, n - released);
+	released += releaseBack(sphereRigidBodyComponents, n - released);
+	released += releaseBack(boxRigidBodyComponents, n - released);
+	released += releaseBack(characterComponents, n - released);
+	released += releaseBack(modelComponents, n - released);
+	released += releaseBack(interactableObjectComponents, n - released);
+	released += releaseBack(transformComponents, n - released);
 
-bool Scene::getEntity(Entity id) const noexcept
-{
-	for (auto iter = entities.begin(); iter != entities.end(); ++iter)
-		if (*iter == id) return true;
+	if (released < n) //everything was removed
+	{
+		entities.clear();
+		transformHierarchy.clear();
+	}
 
-	return false; //there's no Entity with such id in the Scene
+	return released;
 }
 
 
@@ -145,7 +156,16 @@ bool Scene::getEntity(Entity id) const noexcept
 
 int Scene::getNumOfEntities() const noexcept
 {
-	return entities.size();
+	return entities.getCount();
+}
+
+
+//==================================================================================================
+
+
+void Scene::getEntities(std::vector<Entity>& out) const
+{
+	entities.getAlive(out);
 }
 
 
@@ -161,13 +181,27 @@ unsigned int Scene::getId() const noexcept
 //==================================================================================================
 
 
+void Scene::collectChangedTransforms(std::vector<Entity>& out)
+{
+	for (Entity id : changedTransforms)
+	{
+		TransformComponent* tComp = transformComponents.getByEntity(id);
+		if (tComp) tComp->logged = false; //it's logged again when it changes
+		out.push_back(id);
+	}
+	changedTransforms.clear();
+}
+
+
+//==================================================================================================
+
+
 ImageComponent* Scene::getImageComponent(Entity id)
 {
-	for (int i = 0; i < imageComponents.getSize(); ++i)
-		if (imageComponents[i].getEntityId() == id) return &(imageComponents[i]);
-	myAssert(false);
+	ImageComponent* comp = imageComponents.getByEntity(id);
+	myAssert(comp);
 
-	return nullptr;
+	return comp;
 }
 
 
@@ -176,11 +210,10 @@ ImageComponent* Scene::getImageComponent(Entity id)
 
 TransformComponent* Scene::getTransformComponent(Entity id)
 {
-	for (int i = 0; i < transformComponents.getSize(); ++i)
-		if (transformComponents[i].getEntityId() == id) return &(transformComponents[i]);
-	myAssert(false);
+	TransformComponent* comp = transformComponents.getByEntity(id);
+	myAssert(comp);
 
-	return nullptr;
+	return comp;
 }
 
 
@@ -189,11 +222,10 @@ TransformComponent* Scene::getTransformComponent(Entity id)
 
 DirLightComponent* Scene::getDirLightComponent(Entity id)
 {
-	for (int i = 0; i < dirLightComponents.getSize(); ++i)
-		if (dirLightComponents[i].getEntityId() == id) return &(dirLightComponents[i]);
-	myAssert(false);
+	DirLightComponent* comp = dirLightComponents.getByEntity(id);
+	myAssert(comp);
 
-	return nullptr;
+	return comp;
 }
 
 
@@ -202,11 +234,10 @@ DirLightComponent* Scene::getDirLightComponent(Entity id)
 
 PointLightComponent* Scene::getPointLightComponent(Entity id)
 {
-	for (int i = 0; i < pointLightComponents.getSize(); ++i)
-		if (pointLightComponents[i].getEntityId() == id) return &(pointLightComponents[i]);
-	myAssert(false);
-	return nullptr;
+	PointLightComponent* comp = pointLightComponents.getByEntity(id);
+	myAssert(comp);
 
+	return comp;
 }
 
 
@@ -215,12 +246,10 @@ PointLightComponent* Scene::getPointLightComponent(Entity id)
 
 RigidBodyComponent<Sphere>* Scene::getSphereRigidBodyComponent(Entity id)
 {
-	for (int i = 0; i < sphereRigidBodyComponents.getSize(); ++i)
-		if (sphereRigidBodyComponents[i].getEntityId() == id) return &(sphereRigidBodyComponents[i]);
-	myAssert(false);
-
-	return nullptr;
+	RigidBodyComponent<Sphere>* comp = sphereRigidBodyComponents.getByEntity(id);
+	myAssert(comp);
 
+	return comp;
 }
 
 
@@ -229,11 +258,10 @@ RigidBodyComponent<Sphere>* Scene::getSphereRigidBodyComponent(Entity id)
 
 RigidBodyComponent<Box>* Scene::getBoxRigidBodyComponent(Entity id)
 {
-	for (int i = 0; i < boxRigidBodyComponents.getSize(); ++i)
-		if (boxRigidBodyComponents[i].getEntityId() == id) return &(boxRigidBodyComponents[i]);
-	myAssert(false);
+	RigidBodyComponent<Box>* comp = boxRigidBodyComponents.getByEntity(id);
+	myAssert(comp);
 
-	return nullptr;
+	return comp;
 }
 
 
@@ -242,11 +270,10 @@ RigidBodyComponent<Box>* Scene::getBoxRigidBodyComponent(Entity id)
 
 CharacterComponent* Scene::getCharacterComponent(Entity id)
 {
-	for (int i = 0; i < characterComponents.getSize(); ++i)
-		if (characterComponents[i].getEntityId() == id) return &(characterComponents[i]);
-	myAssert(false);
-	
-	return nullptr;
+	CharacterComponent* comp = characterComponents.getByEntity(id);
+	myAssert(comp);
+
+	return comp;
 }
 
 
@@ -255,11 +282,10 @@ CharacterComponent* Scene::getCharacterComponent(Entity id)
 
 ModelComponent* Scene::getModelComponent(Entity id)
 {
-	for (int i = 0; i < modelComponents.getSize(); ++i)
-		if (modelComponents[i].getEntityId() == id) return &(modelComponents[i]);
-	myAssert(false);
+	ModelComponent* comp = modelComponents.getByEntity(id);
+	myAssert(comp);
 
-	return nullptr;
+	return comp;
 }
 
 
@@ -269,11 +295,10 @@ ModelComponent* Scene::getModelComponent(Entity id)
 
 InteractableObjectComponent* Scene::getInteractableObjectComponent(Entity id)
 {
-	for (int i = 0; i < interactableObjectComponents.getSize(); ++i)
-		if (interactableObjectComponents[i].getEntityId() == id) return &(interactableObjectComponents[i]);
-	myAssert(false);
+	InteractableObjectComponent* comp = interactableObjectComponents.getByEntity(id);
+	myAssert(comp);
 
-	return nullptr;
+	return comp;
 }
 
 
@@ -282,6 +307,19 @@ InteractableObjectComponent* Scene::getInteractableObjectComponent(Entity id)
 
 World::~World()
 {
+	//wait for the worker threads(the Scenes they were loading are just deleted):
+	for (auto iter = loadingScenes.begin(); iter != loadingScenes.end(); ++iter)
+	{
+		try
+		{
+			delete iter->scene.get();
+		}
+		catch (...) {}
+	}
+
+	for (auto iter = releasingScenes.begin(); iter != releasingScenes.end(); ++iter)
+		delete (*iter);
+
 	for (auto iter = scenes.begin(); iter != scenes.end(); ++iter)
 	{
 		delete (*iter); //delete the Scene that (*iter) points to
@@ -303,27 +341,173 @@ void World::initalize()
 //==================================================================================================
 
 
+void World::update()
+//called at the frame boundary, so no system is using the Scenes while they are published or changed
+{
+	PROFILE_ZONE("World::update");
+
+	//publish the Scenes whose loading has ended:
+	for (auto iter = loadingScenes.begin(); iter != loadingScenes.end();)
+	{
+		if (iter->scene.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++iter;
+			continue;
+		}
+
+		try
+		{
+			Scene* scene = iter->scene.get();
+			SceneSerializer::createGpuResources(*scene); //only the thread that owns the OpenGL context can do this
+			publishScene(scene);
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "!WARNING: World::update() COULD NOT LOAD THE SCENE " << iter->sceneId << ": " << e.what();
+		}
+		iter = loadingScenes.erase(iter);
+	}
+
+	//release a part of the unloaded Scenes(before the Scene change, so a Scene unloaded now is only released by
+	//the next call, when the frame captured from it was already rendered):
+	int budget = SCENE_RELEASE_BUDGET;
+	while (budget > 0 && !releasingScenes.empty())
+	{
+		Scene* scene = releasingScenes.front();
+		int released = scene->releaseComponents(budget);
+		if (released < budget) //the Scene is empty, so deleting it is cheap
+		{
+			delete scene;
+			releasingScenes.pop_front();
+		}
+		budget -= released;
+	}
+
+	//the requested Scene change:
+	if (requestedScene >= 0 && isSceneLoaded(requestedScene))
+	{
+		Scene* previous = currentScene;
+		setCurrentScene(requestedScene);
+		if (unloadPreviousScene && previous && previous != currentScene)
+			unloadScene(previous->getId());
+		requestedScene = -1;
+	}
+}
+
+//==================================================================================================
+
 void World::loadScene(std::string path, int id)
-//load the data of a Scene from file
+//load the data of a Scene from file(see SceneSerializer.h). The Scene is created if it doesn't exist, or
+//replaced by a new one if it does(note: the current Scene cannot be replaced)
 {
-	
+	PROFILE_ZONE("World::loadScene");
+
+	myAssert(id >= 0);
+	std::unique_ptr<Scene> scene(new Scene(id));
+	SceneSerializer::load(path, *scene);
+	publishScene(scene.release());
 }
 
 //==================================================================================================
 
-void World::saveSceneData(std::string, int)
-//save a Scene data in a file
+void World::loadSceneAsync(std::string path, int id)
+{
+	myAssert(id >= 0);
+	if (isSceneLoading(id))
+	{
+		std::cout << "!WARNING: World::loadSceneAsync() CALLED FOR A SCENE THAT IS ALREADY BEING LOADED;\n";
+		return;
+	}
+
+	LoadingScene loading;
+	loading.sceneId = id;
+	loading.scene = std::async(std::launch::async, [path, id]() {
+		Profiler::instance().setThreadName("Scene streaming");
+		std::unique_ptr<Scene> scene(new Scene(id));
+		SceneSerializer::load(path, *scene, nullptr, false); //no OpenGL calls in this thread
+		return scene.release();
+	});
+	loadingScenes.push_back(std::move(loading));
+}
+
+//==================================================================================================
+
+bool World::isSceneLoaded(int id) const noexcept
 {
+	for (auto iter = scenes.begin(); iter != scenes.end(); ++iter)
+		if (int((*iter)->getId()) == id) return true;
+	return false;
+}
+
+bool World::isSceneLoading(int id) const noexcept
+{
+	for (auto iter = loadingScenes.begin(); iter != loadingScenes.end(); ++iter)
+		if (iter->sceneId == id) return true;
+	return false;
+}
+
+bool World::isReleasingScenes() const noexcept
+{
+	return !releasingScenes.empty();
+}
+
+//==================================================================================================
+
+void World::requestCurrentScene(int id, bool unloadPrevious)
+{
+	myAssert(isSceneLoaded(id) || isSceneLoading(id));
+	requestedScene = id;
+	unloadPreviousScene = unloadPrevious;
+}
+
+//==================================================================================================
+
+void World::publishScene(Scene* scene)
+{
+	int id = int(scene->getId());
+	for (auto iter = scenes.begin(); iter != scenes.end(); ++iter)
+		if (int((*iter)->getId()) == id)
+		{
+			if (*iter == currentScene) //the current Scene cannot be replaced
+			{
+				std::cout << "!WARNING: THE LOADED SCENE " << id << " IS THE CURRENT SCENE, SO IT WAS NOT REPLACED;\n";
+				releasingScenes.push_back(scene);
+				return;
+			}
+			releasingScenes.push_back(*iter); //the old one is released over the next frames
+			*iter = scene;
+			return;
+		}
+
+	scenes.push_back(scene);
+	if (id >= numberOfScenes) numberOfScenes = id + 1;
+}
+
+//==================================================================================================
 
+void World::saveSceneData(std::string path, int id)
+//save a Scene data in a file
+{
+	PROFILE_ZONE("World::saveSceneData");
 
+	Scene* scene = getScene(id);
+	myAssert(scene);
+	SceneSerializer::save(path, *scene);
 }
 
 //==================================================================================================
 
 void World::unloadScene(int id)
 {
-	if (!currentScene) return;
-	if (currentScene->getId() == id) myAssert(false);
+	if (currentScene && int(currentScene->getId()) == id) myAssert(false);
+
+	for (auto iter = scenes.begin(); iter != scenes.end(); ++iter)
+		if (int((*iter)->getId()) == id)
+		{
+			releasingScenes.push_back(*iter); //freed by update(), a bit in each frame
+			scenes.erase(iter);
+			return;
+		}
 }
 
 //==================================================================================================
@@ -332,7 +516,7 @@ void World::setCurrentScene(int id)
 {
 	myAssert(id >= 0 && id < numberOfScenes);
 	for (auto iter = scenes.begin(); iter != scenes.end(); ++iter)
-		if ((*iter)->getId() == id)
+		if (int((*iter)->getId()) == id)
 		{
 			currentScene = *iter;
 			return;
@@ -346,5 +530,6 @@ Scene* World::getScene(int id)
 {
 	myAssert(id >= 0 && id < numberOfScenes);
 	for (auto iter = scenes.begin(); iter != scenes.end(); ++iter)
-		if ((*iter)->getId() == id) return *iter;
+		if (int((*iter)->getId()) == id) return *iter;
+	return nullptr; //the Scene was unloaded
 }
\ No newline at end of file
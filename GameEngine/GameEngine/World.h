@@ -21,6 +21,10 @@ gabrielgf6000@gmail.com
 
 This header defines the world class, it is responsible for storing all the scenes in the game. 
 The Scene class stores entities and components that belongs to a specific area in the game. 
+	Scenes can be streamed: loadSceneAsync() builds a Scene in a worker thread while the current one
+keeps being used, and World::update(), called at each frame boundary, publishes it and does the requested
+Scene change. Unloaded Scenes are released a few thousand components per frame, so a Scene transition
+never stalls a frame.
 */
 //#################################################################################################
 
@@ -34,8 +38,10 @@ The Scene class stores entities and components that belongs to a specific area i
 #include <string>
 #include <iostream>
 #include <list>
-#include <set>
+#include <vector>
+#include <future>
 #include "ObjectPool.h"
+#include "ComponentPool.h"
 #include "Entity.h"
 
 #include "hudHandling.h"
@@ -47,9 +53,13 @@ The Scene class stores entities and components that belongs to a specific area i
 #include "ModelComponent.h"
 #include "InteractableObjectComponent.h"
 #include "ParticleSystem.h"
+#include "TransformHierarchy.h"
 
 #include "GlobalDefines.h"
 
+
+#define SCENE_RELEASE_BUDGET 4000 //number of components of unloaded Scenes released in each frame
+
 //############################################################################################################
 
 
@@ -58,6 +68,8 @@ class Scene
 public:
 	Scene(int);
 
+	friend class SceneSerializer; //creates the entities and their TransformComponents directly(faster than createEntity())
+
 //Functions:
 	Entity createEntity() noexcept;
 	//this function will create an Entity, add a TransformComponent to it and return it's id
@@ -66,11 +78,21 @@ public:
 	//remove a entity and all of its components from the scene
 
 	bool getEntity(Entity) const noexcept; 
-	//returns true if the passed entity is in the scene
+	//returns true if the passed entity is in the scene(false for the handle of a deleted entity)
+
+	int releaseComponents(int); //remove up to n components(freeing their GPU memory). Returns how many were removed
 
 	int getNumOfEntities() const noexcept;
+	void getEntities(std::vector<Entity>&) const; //append all the entities of the scene to the vector
 	unsigned int getId() const noexcept;
 
+	/*
+		collectChangedTransforms - append to the vector the entities whose TransformComponent(or the one of a
+		parent) changed since the last call, once each. Used by the PhysicsEngine, so the static and sleeping
+		bodies that weren't moved are never visited
+	*/
+	void collectChangedTransforms(std::vector<Entity>&);
+
 	ImageComponent* getImageComponent(Entity);
 	TransformComponent* getTransformComponent(Entity);
 	DirLightComponent* getDirLightComponent(Entity);
@@ -90,22 +112,26 @@ public:
 	std::list<RigidBodyComponent<Sphere>> sphereRigidBodyComponents;
 	std::list<RigidBodyComponent<Box>> boxRigidBodyComponents;
 	std::list<CharacterComponent> characterComponents;*/
-	ObjectPool<TransformComponent> transformComponents;
-	ObjectPool<ImageComponent> imageComponents;
-	ObjectPool<DirLightComponent> dirLightComponents;
-	ObjectPool<PointLightComponent> pointLightComponents;
-	ObjectPool<RigidBodyComponent<Sphere>> sphereRigidBodyComponents;
-	ObjectPool<RigidBodyComponent<Box>> boxRigidBodyComponents;
-	ObjectPool<CharacterComponent> characterComponents;
-	ObjectPool<ModelComponent> modelComponents;
-	ObjectPool<InteractableObjectComponent> interactableObjectComponents;
+	//each pool also indexes its components by Entity(see ComponentPool.h), so
+	//the get*Component functions and pool.has(Entity) are O(1):
+	ComponentPool<TransformComponent> transformComponents;
+	ComponentPool<ImageComponent> imageComponents;
+	ComponentPool<DirLightComponent> dirLightComponents;
+	ComponentPool<PointLightComponent> pointLightComponents;
+	ComponentPool<RigidBodyComponent<Sphere>> sphereRigidBodyComponents;
+	ComponentPool<RigidBodyComponent<Box>> boxRigidBodyComponents;
+	ComponentPool<CharacterComponent> characterComponents;
+	ComponentPool<ModelComponent> modelComponents;
+	ComponentPool<InteractableObjectComponent> interactableObjectComponents;
 
 	ParticleSystem particleSystem;
+	TransformHierarchy transformHierarchy; //updates the world transform of all the transformComponents in one pass
 
 private:
 //Private Data:
-	std::set<Entity> entities;
+	EntityAllocator entities;
 	int sceneId;
+	std::vector<Entity> changedTransforms; //logged by the TransformComponents(see TransformComponent::logChange())
 };
 
 
@@ -123,12 +149,29 @@ public:
 //Functions:
 
 	void initalize();
+	void update(); //should be called once per frame, at the frame boundary(see the functions below)
 	void loadScene(std::string, int sceneId); //load a Scene from file
 	void saveSceneData(std::string, int sceneId); //save a Scene data in the file
-	void unloadScene(int sceneId); //free the memory of a Scene. Note: the current Scene cannot be unloaded;
+	void unloadScene(int sceneId); //the Scene is removed now, and its memory is freed over the next frames. Note: the current Scene cannot be unloaded;
 	void setCurrentScene(int);
 	Scene* getScene(int);
 
+	/*
+		loadSceneAsync - load a Scene from file in a worker thread. The Scene is added to the World by the first
+		update() after the loading ends(a Scene with the same id is replaced, and unloaded). 
+		Note: no texture or model should be added to the TextureHandler and the ModelHandler while a Scene is loading
+	*/
+	void loadSceneAsync(std::string, int sceneId);
+	bool isSceneLoaded(int sceneId) const noexcept; //true if the Scene is in the World(so it can be used)
+	bool isSceneLoading(int sceneId) const noexcept;
+	bool isReleasingScenes() const noexcept; //true while the memory of unloaded Scenes is being freed
+
+	/*
+		requestCurrentScene - make the Scene the current one in the first update() in which it's loaded. If the
+		second argument is true, the previous current Scene is unloaded after the change
+	*/
+	void requestCurrentScene(int sceneId, bool unloadPrevious = false);
+
 //Public data:
 	Scene* currentScene = nullptr;
 
@@ -141,6 +184,19 @@ private:
 //Private data:
 	int numberOfScenes = 1;
 	std::list<Scene*> scenes;
+
+	//streaming:
+	struct LoadingScene
+	{
+		int sceneId;
+		std::future<Scene*> scene; //ready when the worker thread finishes
+	};
+	std::list<LoadingScene> loadingScenes;
+	std::list<Scene*> releasingScenes; //unloaded Scenes, released a bit in each update()
+	int requestedScene = -1;
+	bool unloadPreviousScene = false;
+
+	void publishScene(Scene*); //add a loaded Scene to the World(replacing the one with the same id)
 };
 
 
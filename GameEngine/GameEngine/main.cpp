@@ -21,18 +21,103 @@ gabrielgf6000@gmail.com
 
 
 #include "Game.h"
+#include "Benchmark.h"
+#include "Profiler.h"
 #include "stb_image.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <string>
 
-int main()
+
+#define HEADLESS_DEFAULT_TICKS 3600 //about one minute of simulation(see PhysicsEngine::timeStep)
+
+
+static int parseTicks(const char* text)
+//the tick count of "-headless", or HEADLESS_DEFAULT_TICKS if it isn't a positive number
+{
+	char* end = nullptr;
+	errno = 0;
+	long ticks = std::strtol(text, &end, 10);
+	if (end == text || *end != '\0' || errno == ERANGE || ticks <= 0 || ticks > INT_MAX)
+	{
+		std::cout << "!WARNING: invalid tick count " << text << ", running " << HEADLESS_DEFAULT_TICKS << " ticks;\n"
+			<< "usage: -headless [ticks] [-profile [file]]\n";
+		return HEADLESS_DEFAULT_TICKS;
+	}
+	return int(ticks);
+}
+
+
+int main(int argc, char* argv[])
 try {
+	//the flags can be given in any order and combined(e.g. "-headless 600 -profile headless.json"), each one
+	//followed by its optional argument:
+	//	"-benchmark [results file]" runs the engine benchmarks instead of the game
+	//	"-profile [file]" records the profiler zones, and writes them to a Chrome trace file when the game ends
+	//	"-headless [ticks]" runs the simulation without a window, as fast as possible(see Game::initializeHeadless())
+	bool benchmark = false, profile = false, headless = false;
+	std::string resultsPath, tracePath = "profile.json";
+	int ticks = HEADLESS_DEFAULT_TICKS;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string flag = argv[i];
+		const char* value = i + 1 < argc && argv[i + 1][0] != '-' ? argv[i + 1] : nullptr;
+		if (flag == "-benchmark")
+		{
+			benchmark = true;
+			if (value) resultsPath = value;
+		}
+		else if (flag == "-profile")
+		{
+			profile = true;
+			if (value) tracePath = value;
+		}
+		else if (flag == "-headless")
+		{
+			headless = true;
+			if (value) ticks = parseTicks(value);
+		}
+		else
+		{
+			std::cout << "!WARNING: unknown argument " << flag << " ignored;\n";
+			continue;
+		}
+		if (value) ++i;
+	}
+
+	if (benchmark)
+	{
+		int failedChecks = resultsPath.empty() ? runBenchmarks() : runBenchmarks(resultsPath);
+		return failedChecks > 0 ? 1 : 0;
+	}
+
+	Profiler::instance().setEnabled(profile);
+	Profiler::instance().setThreadName("Main");
+
 	Game game;
 	//game.handleMultiplayer();
-	game.initializeWindow();
-	game.initializeGame();
+	if (headless)
+	{
+		game.initializeHeadless();
+		game.initializeGame();
+		game.headlessLoop(ticks);
+	}
+	else
+	{
+		game.initializeWindow();
+		game.initializeGame();
+		game.gameLoop();
+	}
 
-	game.gameLoop();
+	if (profile)
+	{
+		Profiler::instance().printStats(std::cout);
+		if (Profiler::instance().exportChromeTrace(tracePath))
+			std::cout << "Trace written to " << tracePath << '\n';
+	}
 
 	return 0;
 }